@@ -0,0 +1,244 @@
+#include "autosaver.h"
+#include "encounterarchive.h"
+#include "initiativetracker.h"
+#include "trace.h"
+#include <QFile>
+
+/**
+ * @brief Erstellt einen AutoSaver für einen Tracker
+ *
+ * @param tracker Der zu speichernde Tracker
+ * @param filename Die Datei für das automatische Speichern
+ * @param parent Das Elternobjekt
+ */
+AutoSaver::AutoSaver(InitiativeTracker *tracker, const QString &filename, QObject *parent)
+    : QObject(parent)
+    , m_tracker(tracker)
+    , m_filename(filename)
+    , m_active(false)
+    , m_dirty(false)
+    , m_runningJobs(0)
+{
+    m_timer.setSingleShot(true);
+    m_timer.setInterval(DefaultDelay);
+    connect(&m_timer, &QTimer::timeout, this, &AutoSaver::save);
+
+    // Ein Thread genügt und hält die Reihenfolge der Aufträge ein
+    m_pool.setMaxThreadCount(1);
+
+    connect(m_tracker, &InitiativeTracker::rowsInserted, this, &AutoSaver::onTrackerChanged);
+    connect(m_tracker, &InitiativeTracker::rowsRemoved, this, &AutoSaver::onTrackerChanged);
+    connect(m_tracker, &InitiativeTracker::rowsUpdated, this, &AutoSaver::onTrackerChanged);
+    connect(m_tracker, &InitiativeTracker::rowsReset, this, &AutoSaver::onTrackerChanged);
+}
+
+/**
+ * @brief Wartet auf alle laufenden Speichervorgänge
+ *
+ * Danach meldet kein Auftrag mehr ein Ergebnis an dieses Objekt.
+ */
+AutoSaver::~AutoSaver()
+{
+    m_pool.waitForDone();
+}
+
+/**
+ * @brief Beginnt, nach Änderungen automatisch zu speichern
+ */
+void AutoSaver::start()
+{
+    m_active = true;
+}
+
+/**
+ * @brief Gibt die Datei für das automatische Speichern zurück
+ *
+ * @return Der Dateiname
+ */
+QString AutoSaver::filename() const
+{
+    return m_filename;
+}
+
+/**
+ * @brief Gibt die Wartezeit nach einer Änderung zurück
+ *
+ * @return Die Wartezeit in Millisekunden
+ */
+int AutoSaver::delay() const
+{
+    return m_timer.interval();
+}
+
+/**
+ * @brief Legt die Wartezeit nach einer Änderung fest
+ *
+ * @param milliseconds Die Wartezeit in Millisekunden
+ */
+void AutoSaver::setDelay(int milliseconds)
+{
+    m_timer.setInterval(milliseconds);
+}
+
+/**
+ * @brief Gibt an, ob es ungespeicherte Änderungen gibt
+ *
+ * @return true, wenn seit dem letzten Schnappschuss etwas geändert wurde
+ */
+bool AutoSaver::isDirty() const
+{
+    return m_dirty;
+}
+
+/**
+ * @brief Gibt an, ob gerade im Hintergrund gespeichert wird
+ *
+ * @return true, solange ein Auftrag nicht gemeldet wurde
+ */
+bool AutoSaver::isSaving() const
+{
+    return m_runningJobs > 0;
+}
+
+/**
+ * @brief Speichert den aktuellen Stand sofort im Hintergrund
+ */
+void AutoSaver::save()
+{
+    m_timer.stop();
+    m_dirty = false;
+    startJob(m_filename);
+}
+
+/**
+ * @brief Speichert den aktuellen Stand im Hintergrund in eine andere Datei
+ *
+ * @param filename Der Dateiname
+ */
+void AutoSaver::saveAs(const QString &filename)
+{
+    startJob(filename);
+}
+
+/**
+ * @brief Speichert den aktuellen Stand im Hintergrund als Begegnung in einem Archiv
+ *
+ * @param archiveFilename Der Dateiname des Archivs
+ * @param name Der Name der Begegnung
+ */
+void AutoSaver::saveEncounter(const QString &archiveFilename, const QString &name)
+{
+    startJob(archiveFilename, name);
+}
+
+/**
+ * @brief Wartet auf laufende Aufträge und speichert ungespeicherte Änderungen sofort
+ *
+ * Das Ergebnis eines gerade beendeten Auftrags ist hier noch nicht gemeldet.
+ * Lief noch ein Auftrag, wird der aktuelle Stand daher zur Sicherheit
+ * direkt geschrieben.
+ *
+ * @return true, wenn danach alles gespeichert ist
+ */
+bool AutoSaver::saveAndWait()
+{
+    m_timer.stop();
+    const bool pending = m_dirty || m_runningJobs > 0;
+    m_pool.waitForDone();
+    if (!pending) {
+        return true;
+    }
+
+    m_tracker->compactNames();
+    const bool success = write(m_filename, m_tracker->snapshot(), m_tracker->session());
+    m_dirty = !success;
+    return success;
+}
+
+/**
+ * @brief Merkt eine Änderung vor und startet die Wartezeit
+ *
+ * Die Wartezeit wird bei weiteren Änderungen nicht verlängert. Auch bei
+ * ständigen Änderungen wird also spätestens nach delay() gespeichert.
+ */
+void AutoSaver::onTrackerChanged()
+{
+    if (!m_active) {
+        return;
+    }
+
+    m_dirty = true;
+    if (!m_timer.isActive()) {
+        m_timer.start();
+    }
+}
+
+/**
+ * @brief Übergibt einen Schnappschuss an den Hintergrund-Thread
+ *
+ * @param filename Die zu schreibende Datei
+ * @param encounter Der Name der Begegnung, wenn filename ein Archiv ist
+ */
+void AutoSaver::startJob(const QString &filename, const QString &encounter)
+{
+    // Beide Kopien sind billig: die Spalten werden nur geteilt
+    m_tracker->compactNames();
+    const CharacterStore store = m_tracker->snapshot();
+    const SnapshotFile::Session session = m_tracker->session();
+
+    ++m_runningJobs;
+    m_pool.start([this, filename, encounter, store, session]() {
+        const bool success = write(filename, store, session, encounter);
+        QMetaObject::invokeMethod(this, [this, filename, success]() {
+            finishJob(filename, success);
+        }, Qt::QueuedConnection);
+    });
+}
+
+/**
+ * @brief Wertet einen beendeten Auftrag im GUI-Thread aus
+ *
+ * @param filename Die geschriebene Datei
+ * @param success Das Ergebnis
+ */
+void AutoSaver::finishJob(const QString &filename, bool success)
+{
+    --m_runningJobs;
+
+    // Ein fehlgeschlagenes automatisches Speichern wird bei der nächsten Änderung wiederholt
+    if (!success && filename == m_filename) {
+        m_dirty = true;
+    }
+
+    emit saveFinished(filename, success);
+}
+
+/**
+ * @brief Schreibt einen Schnappschuss im Format der Dateiendung
+ *
+ * Läuft im Hintergrund-Thread und greift deshalb nur auf die Parameter zu.
+ *
+ * @param filename Der Dateiname
+ * @param store Die Charaktere
+ * @param session Die Sitzung
+ * @param encounter Der Name der Begegnung; ist er gesetzt, ist filename ein Archiv
+ * @return true, wenn die Datei vollständig geschrieben wurde
+ */
+bool AutoSaver::write(const QString &filename, const CharacterStore &store,
+                      const SnapshotFile::Session &session, const QString &encounter)
+{
+    bool success = false;
+    if (!encounter.isEmpty()) {
+        // Ein beschädigtes Archiv wird nicht durch ein leeres ersetzt
+        EncounterArchive archive(filename);
+        success = (archive.open() || !QFile::exists(filename)) && archive.save(encounter, store, session);
+    } else if (filename.endsWith(".dndsnap", Qt::CaseInsensitive)) {
+        success = SnapshotFile::write(filename, store, session);
+    } else {
+        success = InitiativeTracker::writeJsonFile(filename, store, session);
+    }
+    if (!success) {
+        TRACE_WARNING(lcStorage) << "Speichern im Hintergrund fehlgeschlagen:" << filename;
+    }
+    return success;
+}
@@ -0,0 +1,188 @@
+#ifndef AUTOSAVER_H
+#define AUTOSAVER_H
+
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+#include <QTimer>
+#include "characterstore.h"
+#include "snapshotfile.h"
+
+class InitiativeTracker;
+
+/**
+ * @brief Der AutoSaver speichert den Tracker im Hintergrund, ohne die Oberfläche anzuhalten.
+ *
+ * Nach der ersten Änderung wartet der AutoSaver delay() Millisekunden, damit
+ * mehrere Änderungen kurz hintereinander zu einem Speichervorgang werden.
+ * Dann nimmt er einen Schnappschuss des Trackers (InitiativeTracker::snapshot()
+ * teilt sich die Spalten und kostet keine Kopie) und schreibt ihn in einem
+ * eigenen Thread. Der GUI-Thread und damit Tabelle und WebSocket-Server
+ * laufen währenddessen weiter; ändert der Tracker eine Spalte, wird nur
+ * diese kopiert, der Schnappschuss bleibt unverändert.
+ *
+ * Geschrieben wird über QSaveFile: Die alte Datei wird erst ersetzt, wenn die
+ * neue vollständig ist. Ein Absturz während des Speicherns hinterlässt also
+ * immer eine gültige Datei.
+ *
+ * Alle Speichervorgänge laufen nacheinander in einem einzigen Thread. Ein
+ * späterer Auftrag überschreibt eine Datei daher nie mit einem älteren Stand.
+ *
+ * Qt-Konzept: QThreadPool
+ * QThreadPool führt Aufgaben in Threads aus, die wiederverwendet werden. Das
+ * Ergebnis kommt mit QMetaObject::invokeMethod() und Qt::QueuedConnection
+ * zurück in den GUI-Thread, wo das Signal saveFinished() gesendet wird.
+ */
+class AutoSaver : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Erstellt einen AutoSaver für einen Tracker.
+     *
+     * Automatisch gespeichert wird erst nach start().
+     *
+     * @param tracker Der zu speichernde Tracker
+     * @param filename Die Datei für das automatische Speichern
+     * @param parent Das Elternobjekt
+     */
+    AutoSaver(InitiativeTracker *tracker, const QString &filename = "characters.json",
+              QObject *parent = nullptr);
+
+    /**
+     * @brief Wartet auf alle laufenden Speichervorgänge.
+     */
+    ~AutoSaver() override;
+
+    /**
+     * @brief Beginnt, nach Änderungen automatisch zu speichern.
+     */
+    void start();
+
+    /**
+     * @brief Gibt die Datei für das automatische Speichern zurück.
+     *
+     * @return Der Dateiname
+     */
+    QString filename() const;
+
+    /**
+     * @brief Gibt die Wartezeit nach einer Änderung zurück.
+     *
+     * @return Die Wartezeit in Millisekunden
+     */
+    int delay() const;
+
+    /**
+     * @brief Legt die Wartezeit nach einer Änderung fest.
+     *
+     * @param milliseconds Die Wartezeit in Millisekunden
+     */
+    void setDelay(int milliseconds);
+
+    /**
+     * @brief Gibt an, ob es Änderungen gibt, die noch nicht gespeichert werden.
+     *
+     * @return true, wenn seit dem letzten Schnappschuss etwas geändert wurde
+     */
+    bool isDirty() const;
+
+    /**
+     * @brief Gibt an, ob gerade im Hintergrund gespeichert wird.
+     *
+     * @return true, solange ein Auftrag nicht mit saveFinished() gemeldet wurde
+     */
+    bool isSaving() const;
+
+    /**
+     * @brief Speichert den aktuellen Stand sofort im Hintergrund.
+     */
+    void save();
+
+    /**
+     * @brief Speichert den aktuellen Stand im Hintergrund in eine andere Datei.
+     *
+     * Das Format ergibt sich aus der Dateiendung: ".dndsnap" als Snapshot,
+     * sonst JSON.
+     *
+     * @param filename Der Dateiname
+     */
+    void saveAs(const QString &filename);
+
+    /**
+     * @brief Speichert den aktuellen Stand im Hintergrund als Begegnung in einem Archiv.
+     *
+     * Das Archiv wird wie bei saveAs() im Hintergrund-Thread neu geschrieben
+     * (siehe EncounterArchive::save()).
+     *
+     * @param archiveFilename Der Dateiname des Archivs
+     * @param name Der Name der Begegnung
+     */
+    void saveEncounter(const QString &archiveFilename, const QString &name);
+
+    /**
+     * @brief Wartet auf laufende Aufträge und speichert ungespeicherte Änderungen sofort.
+     *
+     * Für das Beenden des Programms gedacht; blockiert den aufrufenden Thread.
+     *
+     * @return true, wenn danach alles gespeichert ist
+     */
+    bool saveAndWait();
+
+    static constexpr int DefaultDelay = 2000;  ///< Standard-Wartezeit nach einer Änderung in ms
+
+signals:
+    /**
+     * @brief Wird gesendet, wenn ein Speichervorgang beendet ist.
+     *
+     * @param filename Die geschriebene Datei
+     * @param success true, wenn die Datei vollständig geschrieben wurde
+     */
+    void saveFinished(const QString &filename, bool success);
+
+private slots:
+    /**
+     * @brief Merkt eine Änderung des Trackers vor und startet die Wartezeit.
+     */
+    void onTrackerChanged();
+
+private:
+    /**
+     * @brief Übergibt einen Schnappschuss an den Hintergrund-Thread.
+     *
+     * @param filename Die zu schreibende Datei
+     * @param encounter Der Name der Begegnung, wenn filename ein Archiv ist
+     */
+    void startJob(const QString &filename, const QString &encounter = QString());
+
+    /**
+     * @brief Wertet einen beendeten Auftrag im GUI-Thread aus.
+     *
+     * @param filename Die geschriebene Datei
+     * @param success Das Ergebnis
+     */
+    void finishJob(const QString &filename, bool success);
+
+    /**
+     * @brief Schreibt einen Schnappschuss im Format der Dateiendung.
+     *
+     * @param filename Der Dateiname
+     * @param store Die Charaktere
+     * @param session Die Sitzung
+     * @param encounter Der Name der Begegnung; ist er gesetzt, ist filename ein Archiv
+     * @return true, wenn die Datei vollständig geschrieben wurde
+     */
+    static bool write(const QString &filename, const CharacterStore &store,
+                      const SnapshotFile::Session &session, const QString &encounter = QString());
+
+    InitiativeTracker *m_tracker;  ///< Der zu speichernde Tracker
+    QString m_filename;            ///< Die Datei für das automatische Speichern
+    QTimer m_timer;                ///< Wartezeit zwischen Änderung und Speichern
+    QThreadPool m_pool;            ///< Ein einzelner Thread für alle Speichervorgänge
+    bool m_active;                 ///< Wird nach Änderungen automatisch gespeichert?
+    bool m_dirty;                  ///< Gibt es ungespeicherte Änderungen?
+    int m_runningJobs;             ///< Aufträge, deren Ergebnis noch aussteht
+};
+
+#endif // AUTOSAVER_H
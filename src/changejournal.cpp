@@ -0,0 +1,627 @@
+#include "changejournal.h"
+#include "initiativetracker.h"
+#include "trace.h"
+#include <QSaveFile>
+#include <QVector>
+#include <QtEndian>
+#include <cstring>
+
+namespace {
+
+const char Magic[8] = { 'D', 'N', 'D', 'J', 'R', 'N', 'L', '\0' };
+
+// Positionen im Kopf und im Eintrag
+const int VersionOffset = 8;
+const int GenerationOffset = 12;
+const int RecordHeaderSize = 8;  // Länge und Prüfsumme, danach folgt der Typ
+
+/**
+ * @brief Berechnet die FNV-1a-Prüfsumme eines Eintrags
+ *
+ * @param data Typ und Nutzdaten des Eintrags
+ * @param size Die Länge in Byte
+ * @return Die Prüfsumme
+ */
+quint32 checksum(const char *data, quint32 size)
+{
+    quint32 hash = 2166136261u;
+    for (quint32 i = 0; i < size; ++i) {
+        hash ^= uchar(data[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief Hängt eine 32-Bit-Zahl in Little Endian an
+ *
+ * @param out Der Puffer
+ * @param value Die Zahl
+ */
+void appendUInt32(QByteArray *out, quint32 value)
+{
+    uchar bytes[sizeof(value)];
+    qToLittleEndian<quint32>(value, bytes);
+    out->append(reinterpret_cast<const char *>(bytes), sizeof(bytes));
+}
+
+/**
+ * @brief Hängt eine 64-Bit-Zahl in Little Endian an
+ *
+ * @param out Der Puffer
+ * @param value Die Zahl
+ */
+void appendUInt64(QByteArray *out, quint64 value)
+{
+    uchar bytes[sizeof(value)];
+    qToLittleEndian<quint64>(value, bytes);
+    out->append(reinterpret_cast<const char *>(bytes), sizeof(bytes));
+}
+
+/**
+ * @brief Hängt einen String als Länge und UTF-16 an
+ *
+ * @param out Der Puffer
+ * @param text Der String
+ */
+void appendString(QByteArray *out, const QString &text)
+{
+    appendUInt32(out, quint32(text.size()));
+    const int start = out->size();
+    out->resize(start + text.size() * int(sizeof(quint16)));
+    qToLittleEndian<quint16>(text.utf16(), text.size(), out->data() + start);
+}
+
+/**
+ * @brief Liest einen String aus UTF-16 in Little Endian
+ *
+ * @param data Die Zeichen
+ * @param length Die Anzahl der Zeichen
+ * @return Der String
+ */
+QString readString(const uchar *data, quint32 length)
+{
+    QVector<quint16> utf16(int(length));
+    qFromLittleEndian<quint16>(data, length, utf16.data());
+    return QString(reinterpret_cast<const QChar *>(utf16.constData()), int(length));
+}
+
+/**
+ * @brief Beginnt einen Eintrag; Länge und Prüfsumme folgen in endRecord()
+ *
+ * @param out Der Puffer
+ * @param type Der Typ des Eintrags
+ * @return Die Position des Eintrags im Puffer
+ */
+int beginRecord(QByteArray *out, quint8 type)
+{
+    const int start = out->size();
+    appendUInt32(out, 0);
+    appendUInt32(out, 0);
+    out->append(char(type));
+    return start;
+}
+
+/**
+ * @brief Trägt Länge und Prüfsumme eines fertigen Eintrags ein
+ *
+ * @param out Der Puffer
+ * @param start Die Position aus beginRecord()
+ */
+void endRecord(QByteArray *out, int start)
+{
+    const int bodyStart = start + RecordHeaderSize;
+    const quint32 length = quint32(out->size() - bodyStart);
+    uchar *data = reinterpret_cast<uchar *>(out->data());
+    qToLittleEndian<quint32>(length, data + start);
+    qToLittleEndian<quint32>(checksum(out->constData() + bodyStart, length), data + start + 4);
+}
+
+/**
+ * @brief Baut den Kopf einer Journal-Datei
+ *
+ * @param generation Die Generation
+ * @return Der Kopf
+ */
+QByteArray journalHeader(quint32 generation)
+{
+    QByteArray header(Magic, sizeof(Magic));
+    appendUInt32(&header, ChangeJournal::Version);
+    appendUInt32(&header, generation);
+    return header;
+}
+
+} // namespace
+
+/**
+ * @brief Erstellt ein Journal für einen Tracker
+ *
+ * @param tracker Der zu beobachtende Tracker
+ * @param snapshotFilename Der Snapshot, auf dem das Journal aufbaut
+ * @param journalFilename Die Journal-Datei
+ * @param parent Das Elternobjekt
+ */
+ChangeJournal::ChangeJournal(InitiativeTracker *tracker, const QString &snapshotFilename,
+                             const QString &journalFilename, QObject *parent)
+    : QObject(parent)
+    , m_tracker(tracker)
+    , m_snapshotFilename(snapshotFilename)
+    , m_journalFilename(journalFilename)
+    , m_generation(0)
+    , m_compactionThreshold(DefaultCompactionThreshold)
+    , m_rowCount(0)
+{
+    // Bis start() bzw. compact() ist keine Datei geöffnet und die Slots tun nichts
+    connect(m_tracker, &InitiativeTracker::rowsInserted, this, &ChangeJournal::onRowsInserted);
+    connect(m_tracker, &InitiativeTracker::rowsRemoved, this, &ChangeJournal::onRowsRemoved);
+    connect(m_tracker, &InitiativeTracker::rowsUpdated, this, &ChangeJournal::onRowsUpdated);
+    connect(m_tracker, &InitiativeTracker::rowsReset, this, &ChangeJournal::onRowsReset);
+}
+
+/**
+ * @brief Stellt den Stand aus Snapshot und Journal wieder her
+ *
+ * @return true, wenn der Tracker wiederhergestellt wurde
+ */
+bool ChangeJournal::recover()
+{
+    QFile file(m_journalFilename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const QByteArray data = file.readAll();
+    file.close();
+
+    const quint32 generation = headerGeneration(data);
+    if (generation == 0) {
+        TRACE_WARNING(lcStorage) << "Ungültiges Journal:" << m_journalFilename;
+        return false;
+    }
+
+    // Nur ein Snapshot derselben Generation ist die Grundlage des Journals
+    CharacterStore store;
+    SnapshotFile::Session session;
+    if (!SnapshotFile::read(m_snapshotFilename, &store, &session)
+        || session.journalGeneration != generation) {
+        TRACE_INFO(lcStorage) << "Journal gehört nicht zum Snapshot und wird ignoriert:" << m_journalFilename;
+        m_generation = qMax(m_generation, generation);
+        return false;
+    }
+
+    const int records = replay(data, &store, &session);
+    m_generation = generation;
+    m_tracker->restore(store, session);
+    TRACE_INFO(lcStorage) << "Stand aus dem Journal wiederhergestellt:" << records << "Einträge";
+    return true;
+}
+
+/**
+ * @brief Beginnt mit dem Aufzeichnen
+ *
+ * @return true, wenn Snapshot und Journal angelegt wurden
+ */
+bool ChangeJournal::start()
+{
+    return isActive() || compact();
+}
+
+/**
+ * @brief Schreibt den aktuellen Stand als Snapshot und leert das Journal
+ *
+ * Zuerst wird der Snapshot mit der neuen Generation geschrieben, danach das
+ * leere Journal. Beide Dateien werden über QSaveFile ersetzt, ein Absturz
+ * dazwischen hinterlässt also einen vollständigen Snapshot und ein
+ * veraltetes Journal, das recover() ignoriert.
+ *
+ * @return true, wenn Snapshot und neues Journal geschrieben wurden
+ */
+bool ChangeJournal::compact()
+{
+    // Die neue Generation muss sich von der eines vorhandenen Journals
+    // unterscheiden, sonst könnte es nach einem Absturz als gültig gelten
+    if (!isActive()) {
+        QFile existing(m_journalFilename);
+        if (existing.open(QIODevice::ReadOnly)) {
+            m_generation = qMax(m_generation, headerGeneration(existing.read(HeaderSize)));
+        }
+    }
+
+    const quint32 generation = m_generation + 1;
+    const SnapshotFile::Session session = m_tracker->session();
+    SnapshotFile::Session snapshotSession = session;
+    snapshotSession.journalGeneration = generation;
+
+    m_file.close();
+    m_tracker->compactNames();
+    if (!SnapshotFile::write(m_snapshotFilename, m_tracker->store(), snapshotSession)) {
+        TRACE_WARNING(lcStorage) << "Journal konnte nicht verdichtet werden, Aufzeichnung beendet";
+        return false;
+    }
+
+    const QByteArray header = journalHeader(generation);
+    QSaveFile journal(m_journalFilename);
+    if (!journal.open(QIODevice::WriteOnly) || journal.write(header) != header.size() || !journal.commit()) {
+        TRACE_WARNING(lcStorage) << "Journal konnte nicht angelegt werden:" << m_journalFilename;
+        return false;
+    }
+
+    m_file.setFileName(m_journalFilename);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        TRACE_WARNING(lcStorage) << "Journal konnte nicht geöffnet werden:" << m_journalFilename;
+        return false;
+    }
+
+    m_generation = generation;
+    m_rowCount = m_tracker->size();
+    m_lastSession = session;
+    TRACE_EVENT(JournalCompacted, m_rowCount, qint32(generation));
+    return true;
+}
+
+/**
+ * @brief Gibt an, ob das Journal Änderungen aufzeichnet
+ *
+ * @return true nach einem erfolgreichen start()
+ */
+bool ChangeJournal::isActive() const
+{
+    return m_file.isOpen();
+}
+
+/**
+ * @brief Gibt die aktuelle Generation zurück
+ *
+ * @return Die Generation
+ */
+quint32 ChangeJournal::generation() const
+{
+    return m_generation;
+}
+
+/**
+ * @brief Gibt die Größe der Journal-Datei zurück
+ *
+ * @return Die Größe in Byte
+ */
+qint64 ChangeJournal::size() const
+{
+    return m_file.isOpen() ? m_file.size() : 0;
+}
+
+/**
+ * @brief Gibt die Größe zurück, ab der das Journal verdichtet wird
+ *
+ * @return Die Größe in Byte
+ */
+qint64 ChangeJournal::compactionThreshold() const
+{
+    return m_compactionThreshold;
+}
+
+/**
+ * @brief Legt die Größe fest, ab der das Journal verdichtet wird
+ *
+ * @param bytes Die Größe in Byte
+ */
+void ChangeJournal::setCompactionThreshold(qint64 bytes)
+{
+    m_compactionThreshold = bytes;
+}
+
+/**
+ * @brief Zeichnet neue Zeilen vollständig auf
+ *
+ * @param first Der erste neue Index
+ * @param last Der letzte neue Index
+ */
+void ChangeJournal::onRowsInserted(int first, int last)
+{
+    if (!isActive()) {
+        return;
+    }
+
+    QByteArray records;
+    appendSessionIfChanged(&records);
+
+    const CharacterStore &store = m_tracker->store();
+    for (int row = first; row <= last; ++row) {
+        const int start = beginRecord(&records, InsertRecord);
+        appendUInt32(&records, quint32(row));
+        for (int field = 0; field < CharacterStore::FieldCount; ++field) {
+            appendUInt32(&records, quint32(store.value(row, CharacterStore::Field(field))));
+        }
+        appendString(&records, store.name(row));
+        endRecord(&records, start);
+    }
+    m_rowCount += last - first + 1;
+
+    commit(records);
+}
+
+/**
+ * @brief Zeichnet entfernte Zeilen auf
+ *
+ * @param first Der erste entfernte Index
+ * @param last Der letzte entfernte Index
+ */
+void ChangeJournal::onRowsRemoved(int first, int last)
+{
+    if (!isActive()) {
+        return;
+    }
+
+    QByteArray records;
+    appendSessionIfChanged(&records);
+
+    const int start = beginRecord(&records, RemoveRecord);
+    appendUInt32(&records, quint32(first));
+    appendUInt32(&records, quint32(last - first + 1));
+    endRecord(&records, start);
+    m_rowCount -= last - first + 1;
+
+    commit(records);
+}
+
+/**
+ * @brief Zeichnet die neuen Werte der geänderten Spalten auf
+ *
+ * Ein Batch meldet Änderungen vor den eingefügten Zeilen. Zeilen, die das
+ * Journal noch nicht kennt, werden hier übersprungen; sie folgen vollständig
+ * in onRowsInserted().
+ *
+ * @param first Der erste betroffene Index
+ * @param last Der letzte betroffene Index
+ * @param fields Bitmaske der geänderten Spalten
+ */
+void ChangeJournal::onRowsUpdated(int first, int last, quint32 fields)
+{
+    if (!isActive()) {
+        return;
+    }
+
+    QByteArray records;
+    appendSessionIfChanged(&records);
+
+    const CharacterStore &store = m_tracker->store();
+    last = qMin(last, m_rowCount - 1);
+    if (first <= last) {
+        // Pro Spalte ein Eintrag; ein Wurf für alle ist damit ein einziger Block
+        QVector<int> values;
+        for (int field = 0; field < CharacterStore::FieldCount; ++field) {
+            if (!(fields & CharacterStore::fieldBit(CharacterStore::Field(field)))) {
+                continue;
+            }
+            const int start = beginRecord(&records, ColumnRecord);
+            appendUInt32(&records, quint32(field));
+            appendUInt32(&records, quint32(first));
+            appendUInt32(&records, quint32(last - first + 1));
+            const int valuesStart = records.size();
+            records.resize(valuesStart + (last - first + 1) * int(sizeof(qint32)));
+            values.resize(last - first + 1);
+            store.readValues(CharacterStore::Field(field), first, last - first + 1, values.data());
+            qToLittleEndian<qint32>(values.constData(), last - first + 1, records.data() + valuesStart);
+            endRecord(&records, start);
+        }
+
+        if (fields & CharacterStore::NameBit) {
+            for (int row = first; row <= last; ++row) {
+                const int start = beginRecord(&records, NameRecord);
+                appendUInt32(&records, quint32(row));
+                appendString(&records, store.name(row));
+                endRecord(&records, start);
+            }
+        }
+    }
+
+    commit(records);
+}
+
+/**
+ * @brief Verdichtet das Journal nach einem Reset
+ *
+ * Nach einem Reset (z.B. Laden einer Datei) ist der neue Stand als Snapshot
+ * kleiner und schneller geschrieben als jede Zeile einzeln im Journal.
+ */
+void ChangeJournal::onRowsReset()
+{
+    if (isActive()) {
+        compact();
+    }
+}
+
+/**
+ * @brief Hängt einen Sitzungseintrag an, falls sich die Sitzung geändert hat
+ *
+ * @param out Die Einträge dieser Benachrichtigung
+ */
+void ChangeJournal::appendSessionIfChanged(QByteArray *out)
+{
+    const SnapshotFile::Session session = m_tracker->session();
+    if (session.seed == m_lastSession.seed
+        && session.rollEvents == m_lastSession.rollEvents
+        && session.nextRollKey == m_lastSession.nextRollKey) {
+        return;
+    }
+
+    const int start = beginRecord(out, SessionRecord);
+    appendUInt64(out, session.seed);
+    appendUInt64(out, session.rollEvents);
+    appendUInt32(out, quint32(session.nextRollKey));
+    endRecord(out, start);
+    m_lastSession = session;
+}
+
+/**
+ * @brief Schreibt die Einträge einer Benachrichtigung und verdichtet bei Bedarf
+ *
+ * @param records Die Einträge
+ */
+void ChangeJournal::commit(const QByteArray &records)
+{
+    if (records.isEmpty()) {
+        return;
+    }
+
+    // Ein write() pro Benachrichtigung; flush() übergibt die Daten dem Betriebssystem
+    if (m_file.write(records) != records.size() || !m_file.flush()) {
+        TRACE_WARNING(lcStorage) << "Journal konnte nicht geschrieben werden, Aufzeichnung beendet";
+        m_file.close();
+        return;
+    }
+
+    if (m_file.size() >= m_compactionThreshold) {
+        compact();
+    }
+}
+
+/**
+ * @brief Spielt eine Journal-Datei auf Store und Sitzung ab
+ *
+ * @param data Der Inhalt der Journal-Datei
+ * @param store Der Stand des Snapshots, wird fortgeschrieben
+ * @param session Die Sitzung des Snapshots, wird fortgeschrieben
+ * @return Die Anzahl der abgespielten Einträge
+ */
+int ChangeJournal::replay(const QByteArray &data, CharacterStore *store, SnapshotFile::Session *session)
+{
+    const uchar *bytes = reinterpret_cast<const uchar *>(data.constData());
+    const qint64 size = data.size();
+    qint64 position = HeaderSize;
+    int count = 0;
+
+    while (position + RecordHeaderSize < size) {
+        const quint32 length = qFromLittleEndian<quint32>(bytes + position);
+        const quint32 sum = qFromLittleEndian<quint32>(bytes + position + 4);
+        const qint64 body = position + RecordHeaderSize;
+
+        // Ein abgeschnittener oder beschädigter Eintrag beendet das Journal
+        if (length == 0 || body + length > size
+            || checksum(data.constData() + body, length) != sum
+            || !apply(bytes[body], bytes + body + 1, length - 1, store, session)) {
+            break;
+        }
+
+        position = body + length;
+        ++count;
+    }
+
+    if (position != size) {
+        TRACE_WARNING(lcStorage) << "Journal endet mit einem unvollständigen Eintrag, verworfen:"
+                                 << size - position << "Byte";
+    }
+    return count;
+}
+
+/**
+ * @brief Wendet einen einzelnen Eintrag an
+ *
+ * @param type Der Typ des Eintrags
+ * @param data Die Nutzdaten
+ * @param size Die Länge der Nutzdaten
+ * @param store Der fortzuschreibende Store
+ * @param session Die fortzuschreibende Sitzung
+ * @return false, wenn der Eintrag nicht zum Stand passt
+ */
+bool ChangeJournal::apply(quint8 type, const uchar *data, quint32 size,
+                          CharacterStore *store, SnapshotFile::Session *session)
+{
+    switch (type) {
+    case SessionRecord:
+        if (size != 20) {
+            return false;
+        }
+        session->seed = qFromLittleEndian<quint64>(data);
+        session->rollEvents = qFromLittleEndian<quint64>(data + 8);
+        session->nextRollKey = qFromLittleEndian<qint32>(data + 16);
+        return true;
+
+    case InsertRecord: {
+        const quint32 fixedSize = 4 + CharacterStore::FieldCount * 4 + 4;
+        if (size < fixedSize) {
+            return false;
+        }
+        // Eingefügt wird immer am Ende
+        const qint32 row = qFromLittleEndian<qint32>(data);
+        const quint32 nameLength = qFromLittleEndian<quint32>(data + fixedSize - 4);
+        if (row != store->size() || quint64(size) != fixedSize + quint64(nameLength) * 2) {
+            return false;
+        }
+        store->resize(row + 1);
+        for (int field = 0; field < CharacterStore::FieldCount; ++field) {
+            store->setValue(row, CharacterStore::Field(field), qFromLittleEndian<qint32>(data + 4 + 4 * field));
+        }
+        store->setName(row, readString(data + fixedSize, nameLength));
+        return true;
+    }
+
+    case RemoveRecord: {
+        if (size != 8) {
+            return false;
+        }
+        const qint32 first = qFromLittleEndian<qint32>(data);
+        const qint32 count = qFromLittleEndian<qint32>(data + 4);
+        if (first < 0 || count < 1 || qint64(first) + count > store->size()) {
+            return false;
+        }
+        if (first == 0 && count == store->size()) {
+            store->clear();
+        } else {
+            for (int row = first + count - 1; row >= first; --row) {
+                store->removeAt(row);
+            }
+        }
+        return true;
+    }
+
+    case ColumnRecord: {
+        if (size < 12) {
+            return false;
+        }
+        const quint32 field = qFromLittleEndian<quint32>(data);
+        const qint32 first = qFromLittleEndian<qint32>(data + 4);
+        const qint32 count = qFromLittleEndian<qint32>(data + 8);
+        if (field >= quint32(CharacterStore::FieldCount) || first < 0 || count < 0
+            || qint64(first) + count > store->size() || quint64(size) != 12 + quint64(count) * 4) {
+            return false;
+        }
+        QVector<int> values(count);
+        qFromLittleEndian<qint32>(data + 12, count, values.data());
+        store->writeValues(CharacterStore::Field(field), first, count, values.constData());
+        return true;
+    }
+
+    case NameRecord: {
+        if (size < 8) {
+            return false;
+        }
+        const qint32 row = qFromLittleEndian<qint32>(data);
+        const quint32 nameLength = qFromLittleEndian<quint32>(data + 4);
+        if (row < 0 || row >= store->size() || quint64(size) != 8 + quint64(nameLength) * 2) {
+            return false;
+        }
+        store->setName(row, readString(data + 8, nameLength));
+        return true;
+    }
+
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief Liest die Generation aus dem Kopf einer Journal-Datei
+ *
+ * @param data Der Inhalt der Journal-Datei (mindestens der Kopf)
+ * @return Die Generation oder 0, wenn der Kopf ungültig ist
+ */
+quint32 ChangeJournal::headerGeneration(const QByteArray &data)
+{
+    if (data.size() < HeaderSize || std::memcmp(data.constData(), Magic, sizeof(Magic)) != 0) {
+        return 0;
+    }
+    const uchar *bytes = reinterpret_cast<const uchar *>(data.constData());
+    if (qFromLittleEndian<quint32>(bytes + VersionOffset) != Version) {
+        return 0;
+    }
+    return qFromLittleEndian<quint32>(bytes + GenerationOffset);
+}
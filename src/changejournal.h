@@ -0,0 +1,230 @@
+#ifndef CHANGEJOURNAL_H
+#define CHANGEJOURNAL_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include "characterstore.h"
+#include "snapshotfile.h"
+
+class InitiativeTracker;
+
+/**
+ * @brief Das ChangeJournal speichert jede Änderung am Tracker sofort, ohne die ganze Liste neu zu schreiben.
+ *
+ * Das Journal hört auf die feinen Signale des InitiativeTracker (rowsInserted(),
+ * rowsRemoved(), rowsUpdated()) und hängt für jede Benachrichtigung die neuen
+ * Werte der betroffenen Zeilen an eine Datei an. Ein Wurf für eine ganze
+ * Spalte ist damit ein einziger Eintrag, eine geänderte Zelle ein paar Byte.
+ * Nach jedem Eintrag wird die Datei geleert (flush()), sodass die Änderung
+ * einen Absturz des Programms übersteht. Ein fsync() nach jedem Eintrag wäre
+ * für einen Absturz des Betriebssystems nötig, ist aber um Größenordnungen
+ * langsamer und wird bewusst nicht gemacht.
+ *
+ * Wird das Journal größer als compactionThreshold() oder meldet der Tracker
+ * rowsReset(), wird es verdichtet: Der aktuelle Stand wird als Snapshot
+ * geschrieben und das Journal mit einer neuen Generation geleert. Der
+ * Snapshot trägt die Generation des Journals, das auf ihm aufbaut. Stimmen
+ * die Generationen beim Start nicht überein (z.B. Absturz zwischen Snapshot
+ * und neuem Journal oder ein späterer saveSnapshot()), ist das Journal
+ * veraltet und wird ignoriert.
+ *
+ * Aufbau der Journal-Datei (alle Zahlen Little Endian):
+ * - Kopf (16 Byte): "DNDJRNL" + '\0', Version, Generation
+ * - Einträge: Länge, Prüfsumme (FNV-1a über Typ und Nutzdaten), Typ (1 Byte), Nutzdaten
+ *
+ * Ein unvollständiger oder beschädigter letzter Eintrag (Absturz mitten im
+ * Schreiben) beendet die Wiederherstellung; alle Einträge davor bleiben gültig.
+ *
+ * Qt-Konzept: Beobachter über Signale
+ * Der Tracker kennt das Journal nicht. Jede Änderung, die die Tabelle
+ * erreicht, erreicht auf demselben Weg auch das Journal.
+ */
+class ChangeJournal : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Erstellt ein Journal für einen Tracker.
+     *
+     * Das Journal schreibt erst nach start().
+     *
+     * @param tracker Der zu beobachtende Tracker
+     * @param snapshotFilename Der Snapshot, auf dem das Journal aufbaut
+     * @param journalFilename Die Journal-Datei
+     * @param parent Das Elternobjekt
+     */
+    ChangeJournal(InitiativeTracker *tracker,
+                  const QString &snapshotFilename = "characters.dndsnap",
+                  const QString &journalFilename = "characters.journal",
+                  QObject *parent = nullptr);
+
+    /**
+     * @brief Stellt den Stand nach einem Absturz wieder her.
+     *
+     * Lädt den Snapshot und spielt das Journal ab, wenn beide zur selben
+     * Generation gehören. Andernfalls bleibt der Tracker unverändert.
+     *
+     * @return true, wenn der Tracker aus Snapshot und Journal wiederhergestellt wurde
+     */
+    bool recover();
+
+    /**
+     * @brief Beginnt mit dem Aufzeichnen.
+     *
+     * Schreibt zuerst den aktuellen Stand als Snapshot (siehe compact()).
+     * Nach einem Schreibfehler endet die Aufzeichnung; start() beginnt sie neu.
+     *
+     * @return true, wenn Snapshot und Journal angelegt wurden
+     */
+    bool start();
+
+    /**
+     * @brief Schreibt den aktuellen Stand als Snapshot und leert das Journal.
+     *
+     * Danach ist das Journal aktiv, auch wenn start() nicht aufgerufen wurde.
+     *
+     * @return true, wenn Snapshot und neues Journal geschrieben wurden
+     */
+    bool compact();
+
+    /**
+     * @brief Gibt an, ob das Journal Änderungen aufzeichnet.
+     *
+     * @return true nach einem erfolgreichen start()
+     */
+    bool isActive() const;
+
+    /**
+     * @brief Gibt die aktuelle Generation zurück.
+     *
+     * @return Die Generation von Journal und zugehörigem Snapshot
+     */
+    quint32 generation() const;
+
+    /**
+     * @brief Gibt die Größe der Journal-Datei zurück.
+     *
+     * @return Die Größe in Byte, einschließlich Kopf
+     */
+    qint64 size() const;
+
+    /**
+     * @brief Gibt die Größe zurück, ab der das Journal verdichtet wird.
+     *
+     * @return Die Größe in Byte
+     */
+    qint64 compactionThreshold() const;
+
+    /**
+     * @brief Legt die Größe fest, ab der das Journal verdichtet wird.
+     *
+     * @param bytes Die Größe in Byte
+     */
+    void setCompactionThreshold(qint64 bytes);
+
+    static constexpr quint32 Version = 1;                            ///< Aktuelle Formatversion
+    static constexpr int HeaderSize = 16;                            ///< Größe des Kopfes in Byte
+    static constexpr qint64 DefaultCompactionThreshold = 1024 * 1024; ///< Standardgröße für compact()
+
+private slots:
+    /**
+     * @brief Zeichnet neue Zeilen vollständig auf.
+     *
+     * @param first Der erste neue Index
+     * @param last Der letzte neue Index
+     */
+    void onRowsInserted(int first, int last);
+
+    /**
+     * @brief Zeichnet entfernte Zeilen auf.
+     *
+     * @param first Der erste entfernte Index
+     * @param last Der letzte entfernte Index
+     */
+    void onRowsRemoved(int first, int last);
+
+    /**
+     * @brief Zeichnet die neuen Werte der geänderten Spalten auf.
+     *
+     * @param first Der erste betroffene Index
+     * @param last Der letzte betroffene Index
+     * @param fields Bitmaske der geänderten Spalten
+     */
+    void onRowsUpdated(int first, int last, quint32 fields);
+
+    /**
+     * @brief Verdichtet das Journal, weil sich die Liste grundlegend geändert hat.
+     */
+    void onRowsReset();
+
+private:
+    /**
+     * @brief Die Typen der Einträge. Die Nummern stehen in der Datei.
+     */
+    enum RecordType : quint8 {
+        SessionRecord = 1,  ///< Seed, Ereigniszähler, nächster Würfelschlüssel
+        InsertRecord = 2,   ///< Eine neue Zeile mit allen Spalten und Namen
+        RemoveRecord = 3,   ///< Erster Index und Anzahl entfernter Zeilen
+        ColumnRecord = 4,   ///< Neue Werte einer Spalte für einen Zeilenbereich
+        NameRecord = 5      ///< Neuer Name einer Zeile
+    };
+
+    /**
+     * @brief Hängt einen Sitzungseintrag an, falls sich die Sitzung geändert hat.
+     *
+     * @param out Die Einträge dieser Benachrichtigung
+     */
+    void appendSessionIfChanged(QByteArray *out);
+
+    /**
+     * @brief Schreibt die Einträge einer Benachrichtigung und verdichtet bei Bedarf.
+     *
+     * @param records Die Einträge
+     */
+    void commit(const QByteArray &records);
+
+    /**
+     * @brief Spielt eine Journal-Datei auf Store und Sitzung ab.
+     *
+     * @param data Der Inhalt der Journal-Datei
+     * @param store Der Stand des Snapshots, wird fortgeschrieben
+     * @param session Die Sitzung des Snapshots, wird fortgeschrieben
+     * @return Die Anzahl der abgespielten Einträge
+     */
+    static int replay(const QByteArray &data, CharacterStore *store, SnapshotFile::Session *session);
+
+    /**
+     * @brief Wendet einen einzelnen Eintrag an.
+     *
+     * @param type Der Typ des Eintrags
+     * @param data Die Nutzdaten
+     * @param size Die Länge der Nutzdaten
+     * @param store Der fortzuschreibende Store
+     * @param session Die fortzuschreibende Sitzung
+     * @return false, wenn der Eintrag nicht zum Stand passt
+     */
+    static bool apply(quint8 type, const uchar *data, quint32 size,
+                      CharacterStore *store, SnapshotFile::Session *session);
+
+    /**
+     * @brief Liest die Generation aus dem Kopf einer Journal-Datei.
+     *
+     * @param data Der Inhalt der Journal-Datei
+     * @return Die Generation oder 0, wenn der Kopf ungültig ist
+     */
+    static quint32 headerGeneration(const QByteArray &data);
+
+    InitiativeTracker *m_tracker;        ///< Der beobachtete Tracker
+    QString m_snapshotFilename;          ///< Der Snapshot, auf dem das Journal aufbaut
+    QString m_journalFilename;           ///< Die Journal-Datei
+    QFile m_file;                        ///< Die zum Anhängen geöffnete Journal-Datei
+    quint32 m_generation;                ///< Die aktuelle Generation
+    qint64 m_compactionThreshold;        ///< Größe, ab der verdichtet wird
+    int m_rowCount;                      ///< Die Zeilenzahl, die das Journal kennt
+    SnapshotFile::Session m_lastSession; ///< Die zuletzt aufgezeichnete Sitzung
+};
+
+#endif // CHANGEJOURNAL_H
@@ -1,9 +1,6 @@
 #include "character.h"
-
-// Initialisierung der statischen Klassenvariablen
-std::random_device Character::s_rd;  // Erzeugt einen zufälligen Seed
-std::mt19937 Character::s_gen(Character::s_rd());  // Initialisiert den Mersenne-Twister mit dem Seed
-std::uniform_int_distribution<> Character::s_d20(1, 20);  // Erzeugt eine Gleichverteilung für Zahlen von 1 bis 20 (W20)
+#include "randomstream.h"
+#include <QtGlobal>
 
 /**
  * @brief Standardkonstruktor
@@ -12,8 +9,8 @@ std::uniform_int_distribution<> Character::s_d20(1, 20);  // Erzeugt eine Gleich
  * Der Initiative-Wurf wird ebenfalls auf 0 gesetzt, bis rollInitiative() aufgerufen wird.
  */
 Character::Character()
-    : m_name(""), m_initiativeModifier(0), m_initiativeRoll(0),
-      m_willSave(0), m_reflexSave(0), m_fortitudeSave(0),
+    : m_name(""), m_initiativeModifier(0),
+      m_willSave(0), m_reflexSave(0), m_fortitudeSave(0), m_initiativeRoll(0),
       m_lastWillSaveRoll(0), m_lastReflexSaveRoll(0), m_lastFortitudeSaveRoll(0)
 {
     // Initialisiert einen leeren Charakter
@@ -29,8 +26,8 @@ Character::Character()
  * @param initiativeModifier Der Initiative-Modifikator des Charakters
  */
 Character::Character(const QString &name, int initiativeModifier)
-    : m_name(name), m_initiativeModifier(initiativeModifier), m_initiativeRoll(0),
-      m_willSave(0), m_reflexSave(0), m_fortitudeSave(0),
+    : m_name(name), m_initiativeModifier(packModifier(initiativeModifier)),
+      m_willSave(0), m_reflexSave(0), m_fortitudeSave(0), m_initiativeRoll(0),
       m_lastWillSaveRoll(0), m_lastReflexSaveRoll(0), m_lastFortitudeSaveRoll(0)
 {
     // Initialisiert einen Charakter mit den angegebenen Werten
@@ -49,8 +46,9 @@ Character::Character(const QString &name, int initiativeModifier)
  * @param fortitudeSave Der Wert des Fortitude-Rettungswurfs
  */
 Character::Character(const QString &name, int initiativeModifier, int willSave, int reflexSave, int fortitudeSave)
-    : m_name(name), m_initiativeModifier(initiativeModifier), m_initiativeRoll(0),
-      m_willSave(willSave), m_reflexSave(reflexSave), m_fortitudeSave(fortitudeSave),
+    : m_name(name), m_initiativeModifier(packModifier(initiativeModifier)),
+      m_willSave(packModifier(willSave)), m_reflexSave(packModifier(reflexSave)),
+      m_fortitudeSave(packModifier(fortitudeSave)), m_initiativeRoll(0),
       m_lastWillSaveRoll(0), m_lastReflexSaveRoll(0), m_lastFortitudeSaveRoll(0)
 {
     // Initialisiert einen Charakter mit den angegebenen Werten
@@ -93,7 +91,7 @@ int Character::getInitiativeModifier() const
  */
 void Character::setInitiativeModifier(int modifier)
 {
-    m_initiativeModifier = modifier;
+    m_initiativeModifier = packModifier(modifier);
 }
 
 /**
@@ -106,6 +104,16 @@ int Character::getInitiativeRoll() const
     return m_initiativeRoll;
 }
 
+/**
+ * @brief Setzt den gewürfelten Initiative-Wert
+ * 
+ * @param roll Der gewürfelte Initiative-Wert
+ */
+void Character::setInitiativeRoll(int roll)
+{
+    m_initiativeRoll = packRoll(roll);
+}
+
 /**
  * @brief Würfelt die Initiative für den Charakter
  * 
@@ -115,7 +123,7 @@ int Character::getInitiativeRoll() const
 void Character::rollInitiative()
 {
     // Generiert eine Zufallszahl zwischen 1 und 20 (W20)
-    m_initiativeRoll = s_d20(s_gen);
+    m_initiativeRoll = packRoll(RandomStream::rollD20());
 }
 
 /**
@@ -148,7 +156,7 @@ int Character::getWillSave() const
  */
 void Character::setWillSave(int modifier)
 {
-    m_willSave = modifier;
+    m_willSave = packModifier(modifier);
 }
 
 /**
@@ -168,7 +176,7 @@ int Character::getReflexSave() const
  */
 void Character::setReflexSave(int modifier)
 {
-    m_reflexSave = modifier;
+    m_reflexSave = packModifier(modifier);
 }
 
 /**
@@ -188,7 +196,7 @@ int Character::getFortitudeSave() const
  */
 void Character::setFortitudeSave(int modifier)
 {
-    m_fortitudeSave = modifier;
+    m_fortitudeSave = packModifier(modifier);
 }
 
 /**
@@ -201,7 +209,7 @@ void Character::setFortitudeSave(int modifier)
  */
 int Character::rollWillSave()
 {
-    m_lastWillSaveRoll = s_d20(s_gen);
+    m_lastWillSaveRoll = packRoll(RandomStream::rollD20());
     return m_lastWillSaveRoll + m_willSave;
 }
 
@@ -215,7 +223,7 @@ int Character::rollWillSave()
  */
 int Character::rollReflexSave()
 {
-    m_lastReflexSaveRoll = s_d20(s_gen);
+    m_lastReflexSaveRoll = packRoll(RandomStream::rollD20());
     return m_lastReflexSaveRoll + m_reflexSave;
 }
 
@@ -229,7 +237,7 @@ int Character::rollReflexSave()
  */
 int Character::rollFortitudeSave()
 {
-    m_lastFortitudeSaveRoll = s_d20(s_gen);
+    m_lastFortitudeSaveRoll = packRoll(RandomStream::rollD20());
     return m_lastFortitudeSaveRoll + m_fortitudeSave;
 }
 
@@ -261,4 +269,66 @@ int Character::getLastReflexSaveRoll() const
 int Character::getLastFortitudeSaveRoll() const
 {
     return m_lastFortitudeSaveRoll;
-} 
\ No newline at end of file
+}
+
+/**
+ * @brief Setzt den gewürfelten Wert des letzten Will-Rettungswurfs
+ * 
+ * @param roll Der gewürfelte Wert
+ */
+void Character::setLastWillSaveRoll(int roll)
+{
+    m_lastWillSaveRoll = packRoll(roll);
+}
+
+/**
+ * @brief Setzt den gewürfelten Wert des letzten Reflex-Rettungswurfs
+ * 
+ * @param roll Der gewürfelte Wert
+ */
+void Character::setLastReflexSaveRoll(int roll)
+{
+    m_lastReflexSaveRoll = packRoll(roll);
+}
+
+/**
+ * @brief Setzt den gewürfelten Wert des letzten Fortitude-Rettungswurfs
+ * 
+ * @param roll Der gewürfelte Wert
+ */
+void Character::setLastFortitudeSaveRoll(int roll)
+{
+    m_lastFortitudeSaveRoll = packRoll(roll);
+}
+
+/**
+ * @brief Würfelt einen W20 mit dem Mersenne-Twister des aktuellen Threads
+ * 
+ * @return Ein Wert zwischen 1 und 20
+ */
+int Character::rollD20()
+{
+    return RandomStream::rollD20();
+}
+
+/**
+ * @brief Begrenzt einen Modifikator auf den Bereich von qint16
+ * 
+ * @param value Der Modifikator
+ * @return Der gepackte Modifikator
+ */
+qint16 Character::packModifier(int value)
+{
+    return qint16(qBound(-32768, value, 32767));
+}
+
+/**
+ * @brief Begrenzt einen Wurf auf den Bereich von quint8
+ * 
+ * @param value Der Wurf
+ * @return Der gepackte Wurf
+ */
+quint8 Character::packRoll(int value)
+{
+    return quint8(qBound(0, value, 255));
+}
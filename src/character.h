@@ -2,7 +2,6 @@
 #define CHARACTER_H
 
 #include <QString>
-#include <random>
 
 /**
  * @brief Die Character-Klasse repräsentiert einen Charakter im D&D-Spiel.
@@ -15,6 +14,14 @@
  * Eine Klasse ist eine Blaupause für Objekte. Sie definiert Attribute (Daten)
  * und Methoden (Funktionen), die auf diesen Daten operieren. Dies ist ein
  * grundlegendes Konzept der objektorientierten Programmierung.
+ * 
+ * C++ Konzept: Datentypen fester Breite
+ * Ein W20-Wurf liegt zwischen 0 und 20, ein Modifikator selten über ±30.
+ * Statt acht ints (32 Byte) speichert die Klasse die Modifikatoren als qint16
+ * und die Würfe als quint8, zusammen 12 Byte. Getter und Setter arbeiten
+ * weiterhin mit int; Werte außerhalb des Bereichs werden beim Setzen auf
+ * die Grenzen des Typs begrenzt. Die Modifikatoren stehen vor den Würfen,
+ * damit der Compiler keine Füllbytes einfügen muss.
  */
 class Character {
 public:
@@ -105,13 +112,22 @@ public:
      */
     int getInitiativeRoll() const;
     
+    /**
+     * @brief Setzt den gewürfelten Initiative-Wert.
+     * 
+     * Wird verwendet, um einen gespeicherten Wurf wiederherzustellen.
+     * 
+     * @param roll Der gewürfelte Initiative-Wert (0 = noch nicht gewürfelt)
+     */
+    void setInitiativeRoll(int roll);
+    
     /**
      * @brief Würfelt die Initiative für den Charakter (W20).
      * 
      * C++ Konzept: Zufallszahlengenerierung in C++11
      * Diese Methode verwendet die C++11-Zufallszahlenbibliothek, die bessere
-     * Zufallszahlen erzeugt als die alte rand()-Funktion. Sie verwendet statische
-     * Klassenvariablen für den Generator und die Verteilung.
+     * Zufallszahlen erzeugt als die alte rand()-Funktion. Der Generator stammt
+     * aus RandomStream und gehört dem aufrufenden Thread.
      */
     void rollInitiative();
     
@@ -208,6 +224,57 @@ public:
      */
     int getLastFortitudeSaveRoll() const;
     
+    /**
+     * @brief Setzt den letzten gewürfelten Willenskraft-Rettungswurf.
+     * 
+     * @param roll Der gewürfelte Wert (0 = noch nicht gewürfelt)
+     */
+    void setLastWillSaveRoll(int roll);
+    
+    /**
+     * @brief Setzt den letzten gewürfelten Reflex-Rettungswurf.
+     * 
+     * @param roll Der gewürfelte Wert (0 = noch nicht gewürfelt)
+     */
+    void setLastReflexSaveRoll(int roll);
+    
+    /**
+     * @brief Setzt den letzten gewürfelten Konstitution-Rettungswurf.
+     * 
+     * @param roll Der gewürfelte Wert (0 = noch nicht gewürfelt)
+     */
+    void setLastFortitudeSaveRoll(int roll);
+    
+    /**
+     * @brief Würfelt einen einzelnen W20 mit dem Generator des aktuellen Threads.
+     * 
+     * C++ Konzept: Statische Methoden
+     * Statische Methoden gehören zur Klasse und benötigen kein Objekt. So kann
+     * z.B. der InitiativeTracker würfeln, ohne einen Character zu erzeugen.
+     * 
+     * @return Ein Wert zwischen 1 und 20
+     */
+    static int rollD20();
+    
+    /**
+     * @brief Begrenzt einen Modifikator auf den Bereich von qint16.
+     * 
+     * Alle Stellen, die Modifikatoren speichern (Character und
+     * CharacterStore), begrenzen damit auf denselben Bereich.
+     * 
+     * @param value Der Modifikator
+     * @return Der gepackte Modifikator
+     */
+    static qint16 packModifier(int value);
+    
+    /**
+     * @brief Begrenzt einen Wurf auf den Bereich von quint8.
+     * 
+     * @param value Der Wurf
+     * @return Der gepackte Wurf
+     */
+    static quint8 packRoll(int value);
+    
 private:
     /**
      * C++ Konzept: Datenkapselung
@@ -216,27 +283,18 @@ private:
      * Der Zugriff erfolgt nur über öffentliche Methoden (Getter und Setter).
      */
     QString m_name;                  ///< Der Name des Charakters
-    int m_initiativeModifier;        ///< Der Initiative-Modifikator des Charakters
-    int m_initiativeRoll;            ///< Der gewürfelte Initiative-Wert (1-20)
-    
-    // Neue Attribute für Rettungswürfe
-    int m_willSave;                  ///< Der Willenskraft-Rettungswurf-Modifikator
-    int m_reflexSave;                ///< Der Reflex-Rettungswurf-Modifikator
-    int m_fortitudeSave;             ///< Der Konstitution-Rettungswurf-Modifikator
-    int m_lastWillSaveRoll;          ///< Der letzte gewürfelte Willenskraft-Rettungswurf
-    int m_lastReflexSaveRoll;        ///< Der letzte gewürfelte Reflex-Rettungswurf
-    int m_lastFortitudeSaveRoll;     ///< Der letzte gewürfelte Konstitution-Rettungswurf
-    
-    /**
-     * C++ Konzept: Statische Klassenvariablen
-     * Statische Variablen gehören zur Klasse, nicht zu einzelnen Objekten.
-     * Sie werden von allen Instanzen der Klasse geteilt. Hier werden sie für
-     * die Zufallszahlengenerierung verwendet, damit nicht jedes Character-Objekt
-     * seinen eigenen Generator erstellen muss.
-     */
-    static std::random_device s_rd;  ///< Zufallszahlengenerator für den Seed
-    static std::mt19937 s_gen;       ///< Mersenne-Twister-Generator für bessere Zufallszahlen
-    static std::uniform_int_distribution<> s_d20; ///< Gleichverteilung für W20 (1-20)
+    
+    // Modifikatoren (je 16 Bit)
+    qint16 m_initiativeModifier;     ///< Der Initiative-Modifikator des Charakters
+    qint16 m_willSave;               ///< Der Willenskraft-Rettungswurf-Modifikator
+    qint16 m_reflexSave;             ///< Der Reflex-Rettungswurf-Modifikator
+    qint16 m_fortitudeSave;          ///< Der Konstitution-Rettungswurf-Modifikator
+    
+    // Würfe (je 8 Bit, 0 = noch nicht gewürfelt)
+    quint8 m_initiativeRoll;         ///< Der gewürfelte Initiative-Wert (1-20)
+    quint8 m_lastWillSaveRoll;       ///< Der letzte gewürfelte Willenskraft-Rettungswurf
+    quint8 m_lastReflexSaveRoll;     ///< Der letzte gewürfelte Reflex-Rettungswurf
+    quint8 m_lastFortitudeSaveRoll;  ///< Der letzte gewürfelte Konstitution-Rettungswurf
 };
 
 #endif // CHARACTER_H 
\ No newline at end of file
@@ -0,0 +1,694 @@
+#include "characterstore.h"
+
+#include <algorithm>
+#include <utility>
+
+/**
+ * @brief Gibt zu einer Wurf-Spalte die Spalte ihres Würfelereignisses zurück
+ *
+ * @param rollField Die Wurf-Spalte
+ * @return Die zugehörige Ereignis-Spalte
+ */
+CharacterStore::Field CharacterStore::rollEventField(Field rollField)
+{
+    switch (rollField) {
+    case InitiativeRoll:
+        return InitiativeRollEvent;
+    case LastWillSaveRoll:
+        return WillSaveRollEvent;
+    case LastReflexSaveRoll:
+        return ReflexSaveRollEvent;
+    case LastFortitudeSaveRoll:
+        return FortitudeSaveRollEvent;
+    default:
+        Q_ASSERT_X(false, "CharacterStore::rollEventField", "keine Wurf-Spalte");
+        return FieldCount;
+    }
+}
+
+/**
+ * @brief Prüft, ob eine Spalte einen Modifikator enthält
+ *
+ * @param field Die Spalte
+ * @return true für die vier Modifikator-Spalten
+ */
+bool CharacterStore::isModifierField(Field field)
+{
+    return field == InitiativeModifier || field == WillSave
+        || field == ReflexSave || field == FortitudeSave;
+}
+
+/**
+ * @brief Prüft, ob eine Spalte einen Wurf enthält
+ *
+ * @param field Die Spalte
+ * @return true für die vier Wurf-Spalten
+ */
+bool CharacterStore::isRollField(Field field)
+{
+    return field == InitiativeRoll || field == LastWillSaveRoll
+        || field == LastReflexSaveRoll || field == LastFortitudeSaveRoll;
+}
+
+/**
+ * @brief Begrenzt einen Wert auf den Bereich seiner Spalte
+ *
+ * @param field Die Spalte
+ * @param value Der Wert
+ * @return Der begrenzte Wert
+ */
+int CharacterStore::packValue(Field field, int value)
+{
+    if (isModifierField(field)) {
+        return Character::packModifier(value);
+    }
+    if (isRollField(field)) {
+        return Character::packRoll(value);
+    }
+    return value;
+}
+
+/**
+ * @brief Gibt die Position einer Spalte in ihrem Array zurück
+ *
+ * @param field Die Spalte
+ * @return Der Index in m_modifiers, m_rolls bzw. m_columns
+ */
+int CharacterStore::slot(Field field)
+{
+    static const int slots[FieldCount] = {
+        0, 0, 1, 2, 3,   // InitiativeModifier, InitiativeRoll, WillSave, ReflexSave, FortitudeSave
+        1, 2, 3,         // LastWillSaveRoll, LastReflexSaveRoll, LastFortitudeSaveRoll
+        0, 1, 2, 3, 4    // RollKey und die vier Würfelereignisse
+    };
+    return slots[field];
+}
+
+/**
+ * @brief Ruft eine Funktion für jede Spalte auf
+ *
+ * @param function Eine generische Funktion, die einen QVector erhält
+ */
+template <typename Function>
+void CharacterStore::forEachColumn(Function function)
+{
+    for (QVector<ModifierValue> &column : m_modifiers) {
+        function(column);
+    }
+    for (QVector<RollValue> &column : m_rolls) {
+        function(column);
+    }
+    for (QVector<int> &column : m_columns) {
+        function(column);
+    }
+}
+
+/**
+ * @brief Gibt das Bit einer Spalte in einer FieldMask zurück
+ *
+ * @param field Die Spalte
+ * @return Die Maske mit genau diesem Bit
+ */
+CharacterStore::FieldMask CharacterStore::fieldBit(Field field)
+{
+    return 1u << field;
+}
+
+/**
+ * @brief Gibt die Anzahl der gespeicherten Charaktere zurück
+ *
+ * @return Die Anzahl der Charaktere
+ */
+int CharacterStore::size() const
+{
+    return m_nameIds.size();
+}
+
+/**
+ * @brief Prüft, ob der Store leer ist
+ *
+ * @return true, wenn keine Charaktere gespeichert sind
+ */
+bool CharacterStore::isEmpty() const
+{
+    return m_nameIds.isEmpty();
+}
+
+/**
+ * @brief Reserviert Speicher in allen Spalten
+ *
+ * @param count Die erwartete Anzahl an Charakteren
+ */
+void CharacterStore::reserve(int count)
+{
+    m_nameIds.reserve(count);
+    forEachColumn([count](auto &column) { column.reserve(count); });
+}
+
+/**
+ * @brief Setzt die Anzahl der Charaktere in allen Spalten
+ *
+ * @param count Die neue Anzahl an Charakteren
+ */
+void CharacterStore::resize(int count)
+{
+    const int oldCount = m_nameIds.size();
+    m_nameIds.resize(count);
+    forEachColumn([count](auto &column) { column.resize(count); });
+
+    // Neue Zeilen bekommen den leeren Namen und dieselben Vorgaben wie bei append()
+    for (int i = oldCount; i < count; ++i) {
+        m_nameIds[i] = NamePool::EmptyId;
+    }
+    for (QVector<int> &column : m_columns) {
+        for (int i = oldCount; i < count; ++i) {
+            column[i] = -1;
+        }
+    }
+}
+
+/**
+ * @brief Zerlegt einen Charakter in seine Spalten und hängt ihn an
+ *
+ * @param character Der anzuhängende Charakter
+ */
+void CharacterStore::append(const Character &character)
+{
+    m_nameIds.append(m_namePool.intern(character.getName()));
+    m_modifiers[slot(InitiativeModifier)].append(Character::packModifier(character.getInitiativeModifier()));
+    m_modifiers[slot(WillSave)].append(Character::packModifier(character.getWillSave()));
+    m_modifiers[slot(ReflexSave)].append(Character::packModifier(character.getReflexSave()));
+    m_modifiers[slot(FortitudeSave)].append(Character::packModifier(character.getFortitudeSave()));
+    m_rolls[slot(InitiativeRoll)].append(Character::packRoll(character.getInitiativeRoll()));
+    m_rolls[slot(LastWillSaveRoll)].append(Character::packRoll(character.getLastWillSaveRoll()));
+    m_rolls[slot(LastReflexSaveRoll)].append(Character::packRoll(character.getLastReflexSaveRoll()));
+    m_rolls[slot(LastFortitudeSaveRoll)].append(Character::packRoll(character.getLastFortitudeSaveRoll()));
+    for (QVector<int> &column : m_columns) {
+        column.append(-1);
+    }
+}
+
+/**
+ * @brief Hängt alle Charaktere eines anderen Stores spaltenweise an
+ *
+ * @param other Der anzuhängende Store
+ */
+void CharacterStore::append(const CharacterStore &other)
+{
+    for (int i = 0; i < ModifierCount; ++i) {
+        m_modifiers[i] += other.m_modifiers[i];
+    }
+    for (int i = 0; i < RollCount; ++i) {
+        m_rolls[i] += other.m_rolls[i];
+    }
+    for (int i = 0; i < IntCount; ++i) {
+        m_columns[i] += other.m_columns[i];
+    }
+
+    // Ids des anderen Pools auf den eigenen abbilden, jeden Namen nur einmal
+    QVector<NamePool::Id> ids(other.m_namePool.size(), NamePool::InvalidId);
+    m_nameIds.reserve(m_nameIds.size() + other.size());
+    for (const NamePool::Id otherId : other.m_nameIds) {
+        NamePool::Id &id = ids[int(otherId)];
+        if (id == NamePool::InvalidId) {
+            id = m_namePool.intern(other.m_namePool.name(otherId));
+        }
+        m_nameIds.append(id);
+    }
+}
+
+/**
+ * @brief Entfernt einen Charakter aus allen Spalten
+ *
+ * @param index Der Index des zu entfernenden Charakters
+ */
+void CharacterStore::removeAt(int index)
+{
+    m_nameIds.removeAt(index);
+    forEachColumn([index](auto &column) { column.removeAt(index); });
+}
+
+/**
+ * @brief Leert alle Spalten und den NamePool
+ */
+void CharacterStore::clear()
+{
+    m_nameIds.clear();
+    m_namePool.clear();
+    forEachColumn([](auto &column) { column.clear(); });
+}
+
+/**
+ * @brief Setzt einen Character aus den Spalten zusammen
+ *
+ * @param index Der Index des Charakters
+ * @return Eine Kopie des Charakters
+ */
+Character CharacterStore::at(int index) const
+{
+    Character character(name(index),
+                        value(index, InitiativeModifier),
+                        value(index, WillSave),
+                        value(index, ReflexSave),
+                        value(index, FortitudeSave));
+    character.setInitiativeRoll(value(index, InitiativeRoll));
+    character.setLastWillSaveRoll(value(index, LastWillSaveRoll));
+    character.setLastReflexSaveRoll(value(index, LastReflexSaveRoll));
+    character.setLastFortitudeSaveRoll(value(index, LastFortitudeSaveRoll));
+    return character;
+}
+
+/**
+ * @brief Überschreibt alle Werte eines Charakters
+ *
+ * @param index Der Index des Charakters
+ * @param character Die neuen Werte
+ * @return Die Bitmaske der geänderten Spalten
+ */
+CharacterStore::FieldMask CharacterStore::set(int index, const Character &character)
+{
+    FieldMask changed = 0;
+    const NamePool::Id id = m_namePool.intern(character.getName());
+    if (m_nameIds.at(index) != id) {
+        m_nameIds[index] = id;
+        changed |= NameBit;
+    }
+    changed |= setChanged(index, InitiativeModifier, character.getInitiativeModifier());
+    changed |= setChanged(index, WillSave, character.getWillSave());
+    changed |= setChanged(index, ReflexSave, character.getReflexSave());
+    changed |= setChanged(index, FortitudeSave, character.getFortitudeSave());
+    changed |= setRoll(index, InitiativeRoll, character.getInitiativeRoll());
+    changed |= setRoll(index, LastWillSaveRoll, character.getLastWillSaveRoll());
+    changed |= setRoll(index, LastReflexSaveRoll, character.getLastReflexSaveRoll());
+    changed |= setRoll(index, LastFortitudeSaveRoll, character.getLastFortitudeSaveRoll());
+    return changed;
+}
+
+/**
+ * @brief Setzt einen Wert nur, wenn er sich unterscheidet
+ *
+ * Vergleicht den begrenzten Wert lesend, damit eine geteilte Spalte
+ * (Schnappschuss) bei unverändertem Wert nicht kopiert wird.
+ *
+ * @param index Der Index des Charakters
+ * @param field Die Spalte
+ * @param value Der neue Wert
+ * @return Das Bit der Spalte oder 0
+ */
+CharacterStore::FieldMask CharacterStore::setChanged(int index, Field field, int value)
+{
+    if (this->value(index, field) == packValue(field, value)) {
+        return 0;
+    }
+    setValue(index, field, value);
+    return fieldBit(field);
+}
+
+/**
+ * @brief Setzt einen Wurf und verwirft bei Änderung sein Würfelereignis
+ *
+ * @param index Der Index des Charakters
+ * @param rollField Die Wurf-Spalte
+ * @param value Der neue Wurf
+ * @return Die Bits von Wurf und Ereignis oder 0
+ */
+CharacterStore::FieldMask CharacterStore::setRoll(int index, Field rollField, int value)
+{
+    if (setChanged(index, rollField, value) == 0) {
+        return 0;
+    }
+    const Field eventField = rollEventField(rollField);
+    m_columns[slot(eventField)][index] = -1;
+    return fieldBit(rollField) | fieldBit(eventField);
+}
+
+/**
+ * @brief Gibt eine schreibgeschützte Sicht auf einen Charakter zurück
+ *
+ * @param index Der Index des Charakters
+ * @return Die Sicht auf den Charakter
+ */
+CharacterView CharacterStore::view(int index) const
+{
+    return CharacterView(this, index);
+}
+
+/**
+ * @brief Gibt einen Iterator auf den ersten Charakter zurück
+ *
+ * @return Der Anfangs-Iterator
+ */
+CharacterStore::ConstIterator CharacterStore::begin() const
+{
+    return ConstIterator(this, 0);
+}
+
+/**
+ * @brief Gibt einen Iterator hinter den letzten Charakter zurück
+ *
+ * @return Der End-Iterator
+ */
+CharacterStore::ConstIterator CharacterStore::end() const
+{
+    return ConstIterator(this, size());
+}
+
+/**
+ * @brief Gibt alle Charaktere als QVector<Character> zurück
+ *
+ * @return Eine Liste aller Charaktere
+ */
+QVector<Character> CharacterStore::toVector() const
+{
+    QVector<Character> characters;
+    characters.reserve(size());
+    for (int i = 0; i < size(); ++i) {
+        characters.append(at(i));
+    }
+    return characters;
+}
+
+/**
+ * @brief Gibt den Namen eines Charakters zurück
+ *
+ * @param index Der Index des Charakters
+ * @return Der Name des Charakters
+ */
+const QString &CharacterStore::name(int index) const
+{
+    return m_namePool.name(m_nameIds.at(index));
+}
+
+/**
+ * @brief Setzt den Namen eines Charakters
+ *
+ * @param index Der Index des Charakters
+ * @param name Der neue Name
+ */
+void CharacterStore::setName(int index, const QString &name)
+{
+    m_nameIds[index] = m_namePool.intern(name);
+}
+
+/**
+ * @brief Gibt die Id des Namens eines Charakters zurück
+ *
+ * @param index Der Index des Charakters
+ * @return Die Id im NamePool
+ */
+NamePool::Id CharacterStore::nameId(int index) const
+{
+    return m_nameIds.at(index);
+}
+
+/**
+ * @brief Setzt den Namen eines Charakters über seine Id
+ *
+ * @param index Der Index des Charakters
+ * @param id Die Id im NamePool
+ */
+void CharacterStore::setNameId(int index, NamePool::Id id)
+{
+    Q_ASSERT(int(id) < m_namePool.size());
+    m_nameIds[index] = id;
+}
+
+/**
+ * @brief Nimmt einen Namen in den NamePool auf
+ *
+ * @param name Der Name
+ * @return Die Id des Namens
+ */
+NamePool::Id CharacterStore::internName(const QString &name)
+{
+    return m_namePool.intern(name);
+}
+
+/**
+ * @brief Gibt den Pool aller Namen zurück
+ *
+ * @return Der NamePool
+ */
+const NamePool &CharacterStore::namePool() const
+{
+    return m_namePool;
+}
+
+/**
+ * @brief Entfernt alle nicht mehr benutzten Namen aus dem Pool
+ *
+ * Die benutzten Namen behalten ihre Reihenfolge im Pool.
+ *
+ * @return Die Anzahl der entfernten Namen
+ */
+int CharacterStore::compactNames()
+{
+    const int oldSize = m_namePool.size();
+    QVector<NamePool::Id> ids(oldSize, NamePool::InvalidId);
+    ids[int(NamePool::EmptyId)] = NamePool::EmptyId;
+    int used = 1;
+    for (const NamePool::Id id : std::as_const(m_nameIds)) {
+        if (ids.at(int(id)) == NamePool::InvalidId) {
+            ids[int(id)] = id;
+            ++used;
+        }
+    }
+    if (used == oldSize) {
+        return 0;
+    }
+
+    // Neuer Pool in der alten Reihenfolge, danach die Ids der Charaktere abbilden
+    NamePool pool;
+    pool.reserve(used);
+    for (int id = 1; id < oldSize; ++id) {
+        if (ids.at(id) != NamePool::InvalidId) {
+            ids[id] = pool.intern(m_namePool.name(NamePool::Id(id)));
+        }
+    }
+    for (NamePool::Id &id : m_nameIds) {
+        id = ids.at(int(id));
+    }
+    m_namePool = pool;
+    return oldSize - used;
+}
+
+/**
+ * @brief Gibt einen numerischen Wert eines Charakters zurück
+ *
+ * @param index Der Index des Charakters
+ * @param field Die Spalte
+ * @return Der gespeicherte Wert
+ */
+int CharacterStore::value(int index, Field field) const
+{
+    if (isModifierField(field)) {
+        return m_modifiers[slot(field)].at(index);
+    }
+    if (isRollField(field)) {
+        return m_rolls[slot(field)].at(index);
+    }
+    return m_columns[slot(field)].at(index);
+}
+
+/**
+ * @brief Setzt einen numerischen Wert eines Charakters
+ *
+ * Modifikatoren und Würfe werden wie in Character begrenzt.
+ *
+ * @param index Der Index des Charakters
+ * @param field Die Spalte
+ * @param value Der neue Wert
+ */
+void CharacterStore::setValue(int index, Field field, int value)
+{
+    if (isModifierField(field)) {
+        m_modifiers[slot(field)][index] = Character::packModifier(value);
+    } else if (isRollField(field)) {
+        m_rolls[slot(field)][index] = Character::packRoll(value);
+    } else {
+        m_columns[slot(field)][index] = value;
+    }
+}
+
+/**
+ * @brief Liest einen Bereich einer beliebigen Spalte als int
+ *
+ * @param field Die Spalte
+ * @param first Der erste Index
+ * @param count Die Anzahl der Werte
+ * @param out Nimmt count Werte auf
+ */
+void CharacterStore::readValues(Field field, int first, int count, int *out) const
+{
+    Q_ASSERT(first >= 0 && count >= 0 && first + count <= size());
+    if (isModifierField(field)) {
+        std::copy_n(m_modifiers[slot(field)].constData() + first, count, out);
+    } else if (isRollField(field)) {
+        std::copy_n(m_rolls[slot(field)].constData() + first, count, out);
+    } else {
+        std::copy_n(m_columns[slot(field)].constData() + first, count, out);
+    }
+}
+
+/**
+ * @brief Schreibt einen Bereich einer beliebigen Spalte aus int-Werten
+ *
+ * @param field Die Spalte
+ * @param first Der erste Index
+ * @param count Die Anzahl der Werte
+ * @param values count Werte, die auf den Bereich der Spalte begrenzt werden
+ */
+void CharacterStore::writeValues(Field field, int first, int count, const int *values)
+{
+    Q_ASSERT(first >= 0 && count >= 0 && first + count <= size());
+    if (isModifierField(field)) {
+        std::transform(values, values + count, m_modifiers[slot(field)].data() + first,
+                       &Character::packModifier);
+    } else if (isRollField(field)) {
+        std::transform(values, values + count, m_rolls[slot(field)].data() + first,
+                       &Character::packRoll);
+    } else {
+        std::copy_n(values, count, m_columns[slot(field)].data() + first);
+    }
+}
+
+/**
+ * @brief Berechnet die Gesamt-Initiative eines Charakters
+ *
+ * @param index Der Index des Charakters
+ * @return Wurf + Modifikator
+ */
+int CharacterStore::totalInitiative(int index) const
+{
+    return m_rolls[slot(InitiativeRoll)].at(index) + m_modifiers[slot(InitiativeModifier)].at(index);
+}
+
+/**
+ * @brief Gibt einen Zeiger auf eine Spalte zurück
+ *
+ * QVector::data() löst bei geteilten Daten eine Kopie aus (Copy-on-Write),
+ * sodass Schreibzugriffe über den Zeiger keine anderen Kopien verändern.
+ *
+ * @param field Die Spalte
+ * @return Zeiger auf den Anfang der Spalte
+ */
+int *CharacterStore::column(Field field)
+{
+    Q_ASSERT_X(field >= RollKey, "CharacterStore::column", "keine qint32-Spalte");
+    return m_columns[slot(field)].data();
+}
+
+/**
+ * @brief Gibt einen konstanten Zeiger auf eine Spalte zurück
+ *
+ * @param field Die Spalte
+ * @return Zeiger auf den Anfang der Spalte
+ */
+const int *CharacterStore::column(Field field) const
+{
+    Q_ASSERT_X(field >= RollKey, "CharacterStore::column", "keine qint32-Spalte");
+    return m_columns[slot(field)].constData();
+}
+
+/**
+ * @brief Gibt einen Zeiger auf eine Modifikator-Spalte zurück
+ *
+ * @param field Die Modifikator-Spalte
+ * @return Zeiger auf den Anfang der Spalte
+ */
+CharacterStore::ModifierValue *CharacterStore::modifierColumn(Field field)
+{
+    Q_ASSERT_X(isModifierField(field), "CharacterStore::modifierColumn", "keine Modifikator-Spalte");
+    return m_modifiers[slot(field)].data();
+}
+
+/**
+ * @brief Gibt einen konstanten Zeiger auf eine Modifikator-Spalte zurück
+ *
+ * @param field Die Modifikator-Spalte
+ * @return Zeiger auf den Anfang der Spalte
+ */
+const CharacterStore::ModifierValue *CharacterStore::modifierColumn(Field field) const
+{
+    Q_ASSERT_X(isModifierField(field), "CharacterStore::modifierColumn", "keine Modifikator-Spalte");
+    return m_modifiers[slot(field)].constData();
+}
+
+/**
+ * @brief Gibt einen Zeiger auf eine Wurf-Spalte zurück
+ *
+ * @param field Die Wurf-Spalte
+ * @return Zeiger auf den Anfang der Spalte
+ */
+CharacterStore::RollValue *CharacterStore::rollColumn(Field field)
+{
+    Q_ASSERT_X(isRollField(field), "CharacterStore::rollColumn", "keine Wurf-Spalte");
+    return m_rolls[slot(field)].data();
+}
+
+/**
+ * @brief Gibt einen konstanten Zeiger auf eine Wurf-Spalte zurück
+ *
+ * @param field Die Wurf-Spalte
+ * @return Zeiger auf den Anfang der Spalte
+ */
+const CharacterStore::RollValue *CharacterStore::rollColumn(Field field) const
+{
+    Q_ASSERT_X(isRollField(field), "CharacterStore::rollColumn", "keine Wurf-Spalte");
+    return m_rolls[slot(field)].constData();
+}
+
+/**
+ * @brief Erstellt einen Iterator auf die angegebene Position
+ *
+ * @param store Der durchlaufene Store
+ * @param index Die aktuelle Position
+ */
+CharacterStore::ConstIterator::ConstIterator(const CharacterStore *store, int index)
+    : m_store(store)
+    , m_index(index)
+{
+}
+
+/**
+ * @brief Gibt die Sicht auf den aktuellen Charakter zurück
+ *
+ * @return Die CharacterView der aktuellen Position
+ */
+CharacterView CharacterStore::ConstIterator::operator*() const
+{
+    return CharacterView(m_store, m_index);
+}
+
+/**
+ * @brief Geht zum nächsten Charakter
+ *
+ * @return Der Iterator selbst
+ */
+CharacterStore::ConstIterator &CharacterStore::ConstIterator::operator++()
+{
+    ++m_index;
+    return *this;
+}
+
+/**
+ * @brief Vergleicht zwei Iteratoren
+ *
+ * @param other Der andere Iterator
+ * @return true, wenn beide auf dieselbe Position zeigen
+ */
+bool CharacterStore::ConstIterator::operator==(const ConstIterator &other) const
+{
+    return m_store == other.m_store && m_index == other.m_index;
+}
+
+/**
+ * @brief Vergleicht zwei Iteratoren auf Ungleichheit
+ *
+ * @param other Der andere Iterator
+ * @return true, wenn die Positionen verschieden sind
+ */
+bool CharacterStore::ConstIterator::operator!=(const ConstIterator &other) const
+{
+    return !(*this == other);
+}
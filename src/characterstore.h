@@ -0,0 +1,521 @@
+#ifndef CHARACTERSTORE_H
+#define CHARACTERSTORE_H
+
+#include <QVector>
+#include <QString>
+#include "character.h"
+#include "characterview.h"
+#include "namepool.h"
+
+/**
+ * @brief Die CharacterStore-Klasse speichert alle Charaktere spaltenweise.
+ *
+ * Statt eines QVector<Character>, in dem jedes Element Name und alle Werte
+ * zusammen enthält, hält der Store für jedes Attribut ein eigenes,
+ * zusammenhängendes Array. Die Namen liegen getrennt in einem NamePool; die
+ * Namensspalte enthält pro Charakter nur die Id des Namens. Hundert "Goblin"
+ * teilen sich so einen einzigen String, und nameId() vergleicht zwei Namen
+ * ohne die Zeichen anzusehen.
+ *
+ * C++ Konzept: Structure of Arrays (SoA)
+ * Bei einer "Array of Structures" (AoS) liegen alle Attribute eines Objekts
+ * hintereinander im Speicher. Eine Schleife, die nur ein Attribut bearbeitet
+ * (z.B. alle Initiative-Würfe), lädt dabei trotzdem die kompletten Objekte in
+ * den Cache. Bei SoA liegen gleiche Attribute direkt nebeneinander, sodass
+ * solche Schleifen nur die Daten lesen, die sie wirklich brauchen.
+ *
+ * Nach außen bleibt die Character-Klasse der Werttyp: at() setzt einen
+ * Character aus den Spalten zusammen, append() und set() zerlegen ihn wieder.
+ *
+ * Zusätzlich zu den Werten eines Character hält der Store für jeden Eintrag
+ * einen Würfelschlüssel und für jeden Wurf die Nummer des Würfelereignisses,
+ * aus dem er stammt. Damit kann der InitiativeTracker jeden Wurf mit der
+ * DiceEngine nachrechnen.
+ *
+ * Lesender Zugriff ohne Kopie erfolgt über view() bzw. die Iteratoren, die
+ * CharacterView-Objekte liefern, oder direkt über die Spaltenzeiger.
+ *
+ * C++ Konzept: Datentypen fester Breite
+ * Die Spalten sind so schmal wie ihre Werte: Modifikatoren als qint16, Würfe
+ * als quint8 und nur Würfelschlüssel und -ereignisse als qint32. Eine Zeile
+ * belegt so BytesPerRow Byte statt 13 ints und einer Namens-Id. Wie bei
+ * Character werden Werte außerhalb des Bereichs beim Setzen begrenzt
+ * (Character::packModifier(), Character::packRoll()); jeder Weg in den
+ * Store, auch Laden und Journal, speichert damit denselben Bereich.
+ *
+ * Qt-Konzept: Implizites Teilen (Copy-on-Write)
+ * Alle Spalten sind QVectors. Eine Kopie des Stores teilt sich die Daten mit
+ * dem Original, bis eine der beiden Seiten schreibt; erst dann wird die
+ * betroffene Spalte kopiert. Eine Kopie ist daher ein billiger, unveränderlicher
+ * Schnappschuss.
+ */
+class CharacterStore
+{
+public:
+    /**
+     * @brief Die numerischen Spalten des Stores.
+     */
+    enum Field {
+        InitiativeModifier,     ///< Initiative-Modifikator
+        InitiativeRoll,         ///< Gewürfelter Initiative-Wert (0 = nicht gewürfelt)
+        WillSave,               ///< Willenskraft-Modifikator
+        ReflexSave,             ///< Reflex-Modifikator
+        FortitudeSave,          ///< Konstitution-Modifikator
+        LastWillSaveRoll,       ///< Letzter Willenskraft-Wurf
+        LastReflexSaveRoll,     ///< Letzter Reflex-Wurf
+        LastFortitudeSaveRoll,  ///< Letzter Konstitution-Wurf
+        RollKey,                ///< Würfelschlüssel (Position in jedem Würfelereignis)
+        InitiativeRollEvent,    ///< Würfelereignis des Initiative-Wurfs (-1 = unbekannt)
+        WillSaveRollEvent,      ///< Würfelereignis des Willenskraft-Wurfs (-1 = unbekannt)
+        ReflexSaveRollEvent,    ///< Würfelereignis des Reflex-Wurfs (-1 = unbekannt)
+        FortitudeSaveRollEvent, ///< Würfelereignis des Konstitution-Wurfs (-1 = unbekannt)
+        FieldCount              ///< Anzahl der Spalten
+    };
+
+    typedef qint16 ModifierValue;  ///< Speichertyp der Modifikator-Spalten
+    typedef quint8 RollValue;      ///< Speichertyp der Wurf-Spalten
+
+    /**
+     * @brief Belegter Speicher pro Zeile in Byte (Spalten und Namens-Id).
+     */
+    static constexpr int BytesPerRow = 4 * int(sizeof(ModifierValue)) + 4 * int(sizeof(RollValue))
+        + (FieldCount - RollKey) * int(sizeof(qint32)) + int(sizeof(NamePool::Id));
+
+    /**
+     * @brief Prüft, ob eine Spalte einen Modifikator enthält (ModifierValue).
+     *
+     * @param field Die Spalte
+     * @return true für InitiativeModifier, WillSave, ReflexSave und FortitudeSave
+     */
+    static bool isModifierField(Field field);
+
+    /**
+     * @brief Prüft, ob eine Spalte einen Wurf enthält (RollValue).
+     *
+     * @param field Die Spalte
+     * @return true für InitiativeRoll und die LastXxxSaveRoll-Spalten
+     */
+    static bool isRollField(Field field);
+
+    /**
+     * @brief Begrenzt einen Wert auf den Bereich seiner Spalte.
+     *
+     * @param field Die Spalte
+     * @param value Der Wert
+     * @return Der Wert, wie ihn die Spalte speichert
+     */
+    static int packValue(Field field, int value);
+
+    /**
+     * @brief Gibt zu einer Wurf-Spalte die Spalte ihres Würfelereignisses zurück.
+     *
+     * @param rollField InitiativeRoll oder eine der LastXxxSaveRoll-Spalten
+     * @return Die zugehörige XxxRollEvent-Spalte
+     */
+    static Field rollEventField(Field rollField);
+
+    /**
+     * @brief Bitmaske geänderter Spalten.
+     *
+     * Bit f steht für die Spalte Field f, NameBit für den Namen.
+     */
+    typedef quint32 FieldMask;
+
+    static constexpr FieldMask NameBit = 1u << FieldCount;    ///< Bit für den Namen
+    static constexpr FieldMask AllFields = (NameBit << 1) - 1; ///< Alle Spalten und der Name
+
+    /**
+     * @brief Gibt das Bit einer Spalte in einer FieldMask zurück.
+     *
+     * @param field Die Spalte
+     * @return Die Maske mit genau diesem Bit
+     */
+    static FieldMask fieldBit(Field field);
+
+    /**
+     * @brief Ein Vorwärts-Iterator, der für jeden Charakter eine CharacterView liefert.
+     */
+    class ConstIterator
+    {
+    public:
+        /**
+         * @brief Erstellt einen Iterator auf die angegebene Position.
+         *
+         * @param store Der durchlaufene Store
+         * @param index Die aktuelle Position
+         */
+        ConstIterator(const CharacterStore *store, int index);
+
+        /**
+         * @brief Gibt die Sicht auf den aktuellen Charakter zurück.
+         *
+         * @return Die CharacterView der aktuellen Position
+         */
+        CharacterView operator*() const;
+
+        /**
+         * @brief Geht zum nächsten Charakter.
+         *
+         * @return Der Iterator selbst
+         */
+        ConstIterator &operator++();
+
+        /**
+         * @brief Vergleicht zwei Iteratoren.
+         *
+         * @param other Der andere Iterator
+         * @return true, wenn beide auf dieselbe Position zeigen
+         */
+        bool operator==(const ConstIterator &other) const;
+
+        /**
+         * @brief Vergleicht zwei Iteratoren auf Ungleichheit.
+         *
+         * @param other Der andere Iterator
+         * @return true, wenn die Positionen verschieden sind
+         */
+        bool operator!=(const ConstIterator &other) const;
+
+    private:
+        const CharacterStore *m_store;  ///< Der durchlaufene Store
+        int m_index;                    ///< Die aktuelle Position
+    };
+
+    /**
+     * @brief Gibt die Anzahl der gespeicherten Charaktere zurück.
+     *
+     * @return Die Anzahl der Charaktere
+     */
+    int size() const;
+
+    /**
+     * @brief Prüft, ob der Store leer ist.
+     *
+     * @return true, wenn keine Charaktere gespeichert sind
+     */
+    bool isEmpty() const;
+
+    /**
+     * @brief Reserviert Speicher für die angegebene Anzahl an Charakteren.
+     *
+     * @param count Die erwartete Anzahl an Charakteren
+     */
+    void reserve(int count);
+
+    /**
+     * @brief Setzt die Anzahl der Charaktere, z.B. vor dem spaltenweisen Füllen beim Laden.
+     *
+     * Neue Charaktere haben einen leeren Namen, Zahlenwerte 0 und wie bei
+     * append() keinen Würfelschlüssel und keine Würfelereignisse (-1).
+     *
+     * @param count Die neue Anzahl an Charakteren
+     */
+    void resize(int count);
+
+    /**
+     * @brief Hängt einen Charakter an das Ende aller Spalten an.
+     *
+     * Würfelschlüssel und Würfelereignisse werden mit -1 angelegt.
+     *
+     * @param character Der anzuhängende Charakter
+     */
+    void append(const Character &character);
+
+    /**
+     * @brief Hängt alle Charaktere eines anderen Stores spaltenweise an.
+     *
+     * Jede Spalte wird in einem Stück kopiert. Die Namen werden über ihre
+     * Ids übernommen; jeder unterschiedliche Name wird dabei nur einmal in
+     * den eigenen NamePool aufgenommen. Würfelschlüssel und Würfelereignisse
+     * werden unverändert übernommen.
+     *
+     * @param other Der anzuhängende Store
+     */
+    void append(const CharacterStore &other);
+
+    /**
+     * @brief Entfernt den Charakter an der angegebenen Position aus allen Spalten.
+     *
+     * @param index Der Index des zu entfernenden Charakters
+     */
+    void removeAt(int index);
+
+    /**
+     * @brief Entfernt alle Charaktere.
+     */
+    void clear();
+
+    /**
+     * @brief Setzt einen Character aus den Spalten zusammen.
+     *
+     * @param index Der Index des Charakters
+     * @return Eine Kopie des Charakters
+     */
+    Character at(int index) const;
+
+    /**
+     * @brief Überschreibt alle Werte eines Charakters.
+     *
+     * Der Würfelschlüssel bleibt erhalten. Für jeden Wurf, dessen Wert sich
+     * ändert, wird das Würfelereignis auf -1 gesetzt, da der neue Wert nicht
+     * mehr aus der DiceEngine stammt.
+     *
+     * @param index Der Index des Charakters
+     * @param character Die neuen Werte
+     * @return Die Bitmaske der tatsächlich geänderten Spalten
+     */
+    FieldMask set(int index, const Character &character);
+
+    /**
+     * @brief Gibt eine schreibgeschützte Sicht auf einen Charakter zurück.
+     *
+     * @param index Der Index des Charakters
+     * @return Die Sicht, gültig bis zur nächsten Änderung des Stores
+     */
+    CharacterView view(int index) const;
+
+    /**
+     * @brief Gibt einen Iterator auf den ersten Charakter zurück.
+     *
+     * Ermöglicht for (CharacterView character : store) ohne Kopien.
+     *
+     * @return Der Anfangs-Iterator
+     */
+    ConstIterator begin() const;
+
+    /**
+     * @brief Gibt einen Iterator hinter den letzten Charakter zurück.
+     *
+     * @return Der End-Iterator
+     */
+    ConstIterator end() const;
+
+    /**
+     * @brief Gibt alle Charaktere als QVector<Character> zurück.
+     *
+     * @return Eine Liste aller Charaktere in Speicherreihenfolge
+     */
+    QVector<Character> toVector() const;
+
+    /**
+     * @brief Gibt den Namen eines Charakters zurück.
+     *
+     * @param index Der Index des Charakters
+     * @return Der Name des Charakters
+     */
+    const QString &name(int index) const;
+
+    /**
+     * @brief Setzt den Namen eines Charakters.
+     *
+     * Der Name wird in den NamePool aufgenommen, falls er dort noch fehlt.
+     *
+     * @param index Der Index des Charakters
+     * @param name Der neue Name
+     */
+    void setName(int index, const QString &name);
+
+    /**
+     * @brief Gibt die Id des Namens eines Charakters zurück.
+     *
+     * Zwei Charaktere heißen genau dann gleich, wenn ihre Ids gleich sind.
+     *
+     * @param index Der Index des Charakters
+     * @return Die Id im namePool()
+     */
+    NamePool::Id nameId(int index) const;
+
+    /**
+     * @brief Setzt den Namen eines Charakters über seine Id.
+     *
+     * @param index Der Index des Charakters
+     * @param id Eine Id aus namePool() bzw. von internName()
+     */
+    void setNameId(int index, NamePool::Id id);
+
+    /**
+     * @brief Nimmt einen Namen in den NamePool auf.
+     *
+     * @param name Der Name
+     * @return Die Id des Namens
+     */
+    NamePool::Id internName(const QString &name);
+
+    /**
+     * @brief Gibt den Pool aller Namen zurück.
+     *
+     * @return Der NamePool
+     */
+    const NamePool &namePool() const;
+
+    /**
+     * @brief Entfernt alle Namen aus dem Pool, die kein Charakter mehr benutzt.
+     *
+     * Umbenannte und entfernte Charaktere lassen ihre Namen im Pool zurück.
+     * Der Pool wird mit den benutzten Namen neu aufgebaut; die Ids der
+     * Charaktere ändern sich dabei, EmptyId bleibt erhalten. Sind alle Namen
+     * in Benutzung, bleibt der Store unverändert (und geteilt).
+     *
+     * @return Die Anzahl der entfernten Namen
+     */
+    int compactNames();
+
+    /**
+     * @brief Gibt einen numerischen Wert eines Charakters zurück.
+     *
+     * @param index Der Index des Charakters
+     * @param field Die Spalte
+     * @return Der gespeicherte Wert
+     */
+    int value(int index, Field field) const;
+
+    /**
+     * @brief Setzt einen numerischen Wert eines Charakters.
+     *
+     * Der Wert wird auf den Bereich der Spalte begrenzt (siehe packValue()).
+     *
+     * @param index Der Index des Charakters
+     * @param field Die Spalte
+     * @param value Der neue Wert
+     */
+    void setValue(int index, Field field, int value);
+
+    /**
+     * @brief Setzt einen Wert nur, wenn er sich unterscheidet.
+     *
+     * Verglichen wird mit dem begrenzten Wert, ein auf den alten Wert
+     * begrenzter neuer Wert gilt also als unverändert.
+     *
+     * @param index Der Index des Charakters
+     * @param field Die Spalte
+     * @param value Der neue Wert
+     * @return Das Bit der Spalte oder 0, wenn der Wert gleich war
+     */
+    FieldMask setChanged(int index, Field field, int value);
+
+    /**
+     * @brief Liest einen Bereich einer beliebigen Spalte als int.
+     *
+     * Für Laden und Speichern, die alle Spalten gleich behandeln.
+     *
+     * @param field Die Spalte
+     * @param first Der erste Index
+     * @param count Die Anzahl der Werte
+     * @param out Nimmt count Werte auf
+     */
+    void readValues(Field field, int first, int count, int *out) const;
+
+    /**
+     * @brief Schreibt einen Bereich einer beliebigen Spalte aus int-Werten.
+     *
+     * Jeder Wert wird auf den Bereich der Spalte begrenzt.
+     *
+     * @param field Die Spalte
+     * @param first Der erste Index
+     * @param count Die Anzahl der Werte
+     * @param values count Werte
+     */
+    void writeValues(Field field, int first, int count, const int *values);
+
+    /**
+     * @brief Gibt die Gesamt-Initiative (Wurf + Modifikator) zurück.
+     *
+     * @param index Der Index des Charakters
+     * @return Die Gesamt-Initiative
+     */
+    int totalInitiative(int index) const;
+
+    /**
+     * @brief Gibt einen Zeiger auf den Anfang einer qint32-Spalte zurück.
+     *
+     * Damit können Schleifen über alle Charaktere direkt auf dem
+     * zusammenhängenden Array arbeiten. Der Zeiger ist nur bis zur nächsten
+     * Größenänderung des Stores gültig.
+     *
+     * @param field RollKey oder eine der XxxRollEvent-Spalten
+     * @return Zeiger auf size() aufeinanderfolgende Werte
+     */
+    int *column(Field field);
+
+    /**
+     * @brief Gibt einen konstanten Zeiger auf den Anfang einer qint32-Spalte zurück.
+     *
+     * @param field RollKey oder eine der XxxRollEvent-Spalten
+     * @return Zeiger auf size() aufeinanderfolgende Werte
+     */
+    const int *column(Field field) const;
+
+    /**
+     * @brief Gibt einen Zeiger auf den Anfang einer Modifikator-Spalte zurück.
+     *
+     * Beim Schreiben über den Zeiger wird nicht begrenzt; der Typ erlaubt
+     * ohnehin nur den Bereich der Spalte.
+     *
+     * @param field Eine Spalte, für die isModifierField() gilt
+     * @return Zeiger auf size() aufeinanderfolgende Werte
+     */
+    ModifierValue *modifierColumn(Field field);
+
+    /**
+     * @brief Gibt einen konstanten Zeiger auf den Anfang einer Modifikator-Spalte zurück.
+     *
+     * @param field Eine Spalte, für die isModifierField() gilt
+     * @return Zeiger auf size() aufeinanderfolgende Werte
+     */
+    const ModifierValue *modifierColumn(Field field) const;
+
+    /**
+     * @brief Gibt einen Zeiger auf den Anfang einer Wurf-Spalte zurück.
+     *
+     * @param field Eine Spalte, für die isRollField() gilt
+     * @return Zeiger auf size() aufeinanderfolgende Werte
+     */
+    RollValue *rollColumn(Field field);
+
+    /**
+     * @brief Gibt einen konstanten Zeiger auf den Anfang einer Wurf-Spalte zurück.
+     *
+     * @param field Eine Spalte, für die isRollField() gilt
+     * @return Zeiger auf size() aufeinanderfolgende Werte
+     */
+    const RollValue *rollColumn(Field field) const;
+
+private:
+    /**
+     * @brief Setzt einen Wurf und verwirft bei Änderung sein Würfelereignis.
+     *
+     * @param index Der Index des Charakters
+     * @param rollField Die Wurf-Spalte
+     * @param value Der neue Wurf
+     * @return Die Bits von Wurf und Ereignis oder 0, wenn der Wurf gleich war
+     */
+    FieldMask setRoll(int index, Field rollField, int value);
+
+    /**
+     * @brief Gibt die Position einer Spalte in ihrem Array zurück.
+     *
+     * @param field Die Spalte
+     * @return Der Index in m_modifiers, m_rolls bzw. m_columns
+     */
+    static int slot(Field field);
+
+    /**
+     * @brief Ruft eine Funktion für jede Spalte auf, unabhängig von ihrem Typ.
+     *
+     * @param function Eine generische Funktion, die einen QVector erhält
+     */
+    template <typename Function>
+    void forEachColumn(Function function);
+
+    static constexpr int ModifierCount = 4;             ///< Anzahl der Modifikator-Spalten
+    static constexpr int RollCount = 4;                 ///< Anzahl der Wurf-Spalten
+    static constexpr int IntCount = FieldCount - RollKey; ///< Anzahl der qint32-Spalten
+
+    NamePool m_namePool;                          ///< Jeder unterschiedliche Name genau einmal
+    QVector<NamePool::Id> m_nameIds;              ///< Die Id des Namens pro Charakter
+    QVector<ModifierValue> m_modifiers[ModifierCount]; ///< Die Modifikator-Spalten
+    QVector<RollValue> m_rolls[RollCount];        ///< Die Wurf-Spalten
+    QVector<int> m_columns[IntCount];             ///< Würfelschlüssel und Würfelereignisse
+};
+
+#endif // CHARACTERSTORE_H
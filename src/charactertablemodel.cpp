@@ -0,0 +1,385 @@
+#include "charactertablemodel.h"
+#include "initiativetracker.h"
+#include <QBrush>
+#include <QColor>
+#include <QFont>
+#include <climits>
+
+/**
+ * @brief Erstellt das Modell und verbindet es mit den Signalen des Trackers
+ *
+ * @param tracker Der Tracker, dessen Daten angezeigt werden
+ * @param parent Das Elternobjekt
+ */
+CharacterTableModel::CharacterTableModel(InitiativeTracker *tracker, QObject *parent)
+    : QAbstractTableModel(parent)
+    , m_tracker(tracker)
+    , m_rowCount(tracker->size())
+{
+    connect(m_tracker, &InitiativeTracker::rowsInserted, this, &CharacterTableModel::onRowsInserted);
+    connect(m_tracker, &InitiativeTracker::rowsAboutToBeRemoved, this, &CharacterTableModel::onRowsAboutToBeRemoved);
+    connect(m_tracker, &InitiativeTracker::rowsRemoved, this, &CharacterTableModel::onRowsRemoved);
+    connect(m_tracker, &InitiativeTracker::rowsUpdated, this, &CharacterTableModel::onRowsUpdated);
+    connect(m_tracker, &InitiativeTracker::rowsReset, this, &CharacterTableModel::onRowsReset);
+}
+
+/**
+ * @brief Gibt die Anzahl der Zeilen zurück
+ *
+ * @param parent Muss ungültig sein
+ * @return Die Anzahl der Charaktere
+ */
+int CharacterTableModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_rowCount;
+}
+
+/**
+ * @brief Gibt die Anzahl der Spalten zurück
+ *
+ * @param parent Muss ungültig sein
+ * @return ColumnCount
+ */
+int CharacterTableModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+/**
+ * @brief Liest den Wert einer Zelle direkt aus dem Tracker
+ *
+ * @param index Die Zelle
+ * @param role Die angefragte Rolle
+ * @return Der Wert oder ein ungültiges QVariant
+ */
+QVariant CharacterTableModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_rowCount) {
+        return QVariant();
+    }
+
+    const CharacterView character = m_tracker->characterView(index.row());
+
+    switch (role) {
+    case Qt::DisplayRole:
+    case Qt::EditRole:
+        switch (index.column()) {
+        case NameColumn:
+            return character.getName();
+        case InitiativeModifierColumn:
+            return character.getInitiativeModifier();
+        case TotalInitiativeColumn:
+            return formatResult(character.getInitiativeRoll(), character.getInitiativeModifier());
+        case WillSaveColumn:
+            return character.getWillSave();
+        case WillResultColumn:
+            return formatResult(character.getLastWillSaveRoll(), character.getWillSave());
+        case ReflexSaveColumn:
+            return character.getReflexSave();
+        case ReflexResultColumn:
+            return formatResult(character.getLastReflexSaveRoll(), character.getReflexSave());
+        case FortitudeSaveColumn:
+            return character.getFortitudeSave();
+        case FortitudeResultColumn:
+            return formatResult(character.getLastFortitudeSaveRoll(), character.getFortitudeSave());
+        default:
+            // Die Würfeln-Spalten haben keinen Text
+            return QVariant();
+        }
+
+    case Qt::FontRole:
+        if (index.column() == NameColumn || index.column() == TotalInitiativeColumn) {
+            QFont boldFont;
+            boldFont.setBold(true);
+            return boldFont;
+        }
+        return QVariant();
+
+    case Qt::ForegroundRole: {
+        // Gewürfelte Ergebnisse werden dunkelgrün dargestellt
+        int roll = 0;
+        switch (index.column()) {
+        case TotalInitiativeColumn:
+            roll = character.getInitiativeRoll();
+            break;
+        case WillResultColumn:
+            roll = character.getLastWillSaveRoll();
+            break;
+        case ReflexResultColumn:
+            roll = character.getLastReflexSaveRoll();
+            break;
+        case FortitudeResultColumn:
+            roll = character.getLastFortitudeSaveRoll();
+            break;
+        default:
+            break;
+        }
+        if (roll > 0) {
+            return QBrush(QColor(0, 100, 0));
+        }
+        return QVariant();
+    }
+
+    case CharacterIndexRole:
+        return index.row();
+
+    case SortRole:
+        // Nicht gewürfelte Ergebnisse sortieren ans Ende
+        switch (index.column()) {
+        case NameColumn:
+            return character.getName();
+        case InitiativeModifierColumn:
+            return character.getInitiativeModifier();
+        case TotalInitiativeColumn:
+            return character.getInitiativeRoll() > 0 ? character.getTotalInitiative() : INT_MIN;
+        case WillSaveColumn:
+            return character.getWillSave();
+        case WillResultColumn:
+            return character.getLastWillSaveRoll() > 0
+                ? character.getLastWillSaveRoll() + character.getWillSave() : INT_MIN;
+        case ReflexSaveColumn:
+            return character.getReflexSave();
+        case ReflexResultColumn:
+            return character.getLastReflexSaveRoll() > 0
+                ? character.getLastReflexSaveRoll() + character.getReflexSave() : INT_MIN;
+        case FortitudeSaveColumn:
+            return character.getFortitudeSave();
+        case FortitudeResultColumn:
+            return character.getLastFortitudeSaveRoll() > 0
+                ? character.getLastFortitudeSaveRoll() + character.getFortitudeSave() : INT_MIN;
+        default:
+            return QVariant();
+        }
+
+    default:
+        return QVariant();
+    }
+}
+
+/**
+ * @brief Schreibt einen geänderten Modifikator in den Tracker
+ *
+ * Das Modell ändert selbst nichts. Der Tracker meldet die Änderung über
+ * rowsUpdated(), woraufhin onRowsUpdated() die Zellen neu zeichnen lässt.
+ *
+ * @param index Die Zelle
+ * @param value Der neue Wert
+ * @param role Die Rolle
+ * @return true, wenn der Wert übernommen wurde
+ */
+bool CharacterTableModel::setData(const QModelIndex &index, const QVariant &value, int role)
+{
+    if (!index.isValid() || role != Qt::EditRole || index.row() >= m_tracker->size()) {
+        return false;
+    }
+
+    // Ungültige Eingaben werden abgelehnt, die Zelle zeigt weiter den alten Wert
+    bool ok = false;
+    const int newValue = value.toInt(&ok);
+    if (!ok) {
+        return false;
+    }
+
+    switch (index.column()) {
+    case InitiativeModifierColumn:
+        m_tracker->setInitiativeModifier(index.row(), newValue);
+        return true;
+    case WillSaveColumn:
+        m_tracker->setWillSave(index.row(), newValue);
+        return true;
+    case ReflexSaveColumn:
+        m_tracker->setReflexSave(index.row(), newValue);
+        return true;
+    case FortitudeSaveColumn:
+        m_tracker->setFortitudeSave(index.row(), newValue);
+        return true;
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief Gibt an, welche Zellen bearbeitet werden können
+ *
+ * @param index Die Zelle
+ * @return Die Flags der Zelle
+ */
+Qt::ItemFlags CharacterTableModel::flags(const QModelIndex &index) const
+{
+    if (!index.isValid()) {
+        return Qt::NoItemFlags;
+    }
+
+    Qt::ItemFlags itemFlags = Qt::ItemIsSelectable | Qt::ItemIsEnabled;
+    switch (index.column()) {
+    case InitiativeModifierColumn:
+    case WillSaveColumn:
+    case ReflexSaveColumn:
+    case FortitudeSaveColumn:
+        itemFlags |= Qt::ItemIsEditable;
+        break;
+    default:
+        break;
+    }
+    return itemFlags;
+}
+
+/**
+ * @brief Gibt die Spaltenüberschriften zurück
+ *
+ * @param section Die Spalte bzw. Zeile
+ * @param orientation Horizontal oder vertikal
+ * @param role Die angefragte Rolle
+ * @return Die Überschrift
+ */
+QVariant CharacterTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+
+    switch (section) {
+    case NameColumn:               return QStringLiteral("Name");
+    case InitiativeModifierColumn: return QStringLiteral("Initiative Mod");
+    case TotalInitiativeColumn:    return QStringLiteral("Initiative Ergebnis");
+    case WillSaveColumn:           return QStringLiteral("Willenskraft");
+    case WillResultColumn:         return QStringLiteral("Will Ergebnis");
+    case ReflexSaveColumn:         return QStringLiteral("Reflex");
+    case ReflexResultColumn:       return QStringLiteral("Reflex Ergebnis");
+    case FortitudeSaveColumn:      return QStringLiteral("Konstitution");
+    case FortitudeResultColumn:    return QStringLiteral("Konst. Ergebnis");
+    case RollInitiativeColumn:
+    case RollWillColumn:
+    case RollReflexColumn:
+    case RollFortitudeColumn:      return QStringLiteral("Würfeln");
+    default:                       return QVariant();
+    }
+}
+
+/**
+ * @brief Berechnet die von geänderten Store-Spalten betroffenen Tabellenspalten
+ *
+ * @param fields Bitmaske der geänderten Store-Spalten
+ * @return Bitmaske der Tabellenspalten
+ */
+quint32 CharacterTableModel::columnsForFields(CharacterStore::FieldMask fields)
+{
+    quint32 columns = 0;
+    if (fields & CharacterStore::NameBit) {
+        columns |= 1u << NameColumn;
+    }
+    if (fields & CharacterStore::fieldBit(CharacterStore::InitiativeModifier)) {
+        columns |= (1u << InitiativeModifierColumn) | (1u << TotalInitiativeColumn);
+    }
+    if (fields & CharacterStore::fieldBit(CharacterStore::InitiativeRoll)) {
+        columns |= 1u << TotalInitiativeColumn;
+    }
+    if (fields & CharacterStore::fieldBit(CharacterStore::WillSave)) {
+        columns |= (1u << WillSaveColumn) | (1u << WillResultColumn);
+    }
+    if (fields & CharacterStore::fieldBit(CharacterStore::LastWillSaveRoll)) {
+        columns |= 1u << WillResultColumn;
+    }
+    if (fields & CharacterStore::fieldBit(CharacterStore::ReflexSave)) {
+        columns |= (1u << ReflexSaveColumn) | (1u << ReflexResultColumn);
+    }
+    if (fields & CharacterStore::fieldBit(CharacterStore::LastReflexSaveRoll)) {
+        columns |= 1u << ReflexResultColumn;
+    }
+    if (fields & CharacterStore::fieldBit(CharacterStore::FortitudeSave)) {
+        columns |= (1u << FortitudeSaveColumn) | (1u << FortitudeResultColumn);
+    }
+    if (fields & CharacterStore::fieldBit(CharacterStore::LastFortitudeSaveRoll)) {
+        columns |= 1u << FortitudeResultColumn;
+    }
+    // Würfelschlüssel und Würfelereignisse werden nicht angezeigt
+    return columns;
+}
+
+/**
+ * @brief Meldet neu angehängte Charaktere an die View
+ *
+ * @param first Der erste neue Index
+ * @param last Der letzte neue Index
+ */
+void CharacterTableModel::onRowsInserted(int first, int last)
+{
+    beginInsertRows(QModelIndex(), first, last);
+    m_rowCount += last - first + 1;
+    endInsertRows();
+}
+
+/**
+ * @brief Kündigt der View das Entfernen an, solange die Daten noch da sind
+ *
+ * @param first Der erste zu entfernende Index
+ * @param last Der letzte zu entfernende Index
+ */
+void CharacterTableModel::onRowsAboutToBeRemoved(int first, int last)
+{
+    beginRemoveRows(QModelIndex(), first, last);
+}
+
+/**
+ * @brief Schließt das Entfernen ab
+ *
+ * @param first Der erste entfernte Index
+ * @param last Der letzte entfernte Index
+ */
+void CharacterTableModel::onRowsRemoved(int first, int last)
+{
+    m_rowCount -= last - first + 1;
+    endRemoveRows();
+}
+
+/**
+ * @brief Meldet nur die geänderten Zellen an die View
+ *
+ * @param first Der erste betroffene Index
+ * @param last Der letzte betroffene Index
+ * @param fields Bitmaske der geänderten Store-Spalten
+ */
+void CharacterTableModel::onRowsUpdated(int first, int last, quint32 fields)
+{
+    const quint32 columns = columnsForFields(fields);
+    if (columns == 0 || m_rowCount == 0) {
+        return;
+    }
+
+    // Kleinster und größter betroffener Spaltenindex
+    int firstColumn = 0;
+    while (!(columns & (1u << firstColumn))) {
+        ++firstColumn;
+    }
+    int lastColumn = ColumnCount - 1;
+    while (!(columns & (1u << lastColumn))) {
+        --lastColumn;
+    }
+
+    emit dataChanged(index(first, firstColumn), index(qMin(last, m_rowCount - 1), lastColumn));
+}
+
+/**
+ * @brief Setzt das Modell nach einer grundlegenden Änderung zurück
+ */
+void CharacterTableModel::onRowsReset()
+{
+    beginResetModel();
+    m_rowCount = m_tracker->size();
+    endResetModel();
+}
+
+/**
+ * @brief Formatiert ein Wurfergebnis
+ *
+ * @param roll Der Wurf (0 = nicht gewürfelt)
+ * @param modifier Der Modifikator
+ * @return "Summe (Wurf)" oder "-"
+ */
+QString CharacterTableModel::formatResult(int roll, int modifier)
+{
+    if (roll <= 0) {
+        return QStringLiteral("-");
+    }
+    return QString("%1 (%2)").arg(roll + modifier).arg(roll);
+}
@@ -0,0 +1,192 @@
+#ifndef CHARACTERTABLEMODEL_H
+#define CHARACTERTABLEMODEL_H
+
+#include <QAbstractTableModel>
+#include "characterstore.h"
+
+class InitiativeTracker;
+
+/**
+ * @brief Das CharacterTableModel stellt die Charaktere des InitiativeTracker als Tabelle dar.
+ *
+ * Früher wurde bei jeder Änderung ein QStandardItemModel komplett geleert und
+ * mit 13 QStandardItems pro Charakter neu gefüllt. Dieses Modell speichert
+ * selbst keine Daten, sondern liest in data() direkt aus dem CharacterStore
+ * des Trackers. Über die genauen Signale des Trackers (rowsInserted(),
+ * rowsRemoved(), rowsUpdated(), rowsReset()) meldet es nur die tatsächlich
+ * betroffenen Zellen an die View. Ein einzelner Wurf zeichnet damit nur eine
+ * Zelle neu.
+ *
+ * Qt-Konzept: Model/View
+ * Eine View (z.B. QTableView) fragt ihre Daten über QAbstractItemModel::data()
+ * ab, und zwar nur für die gerade sichtbaren Zellen. Ein eigenes Modell
+ * überschreibt rowCount(), columnCount() und data() und meldet Änderungen mit
+ * dataChanged() bzw. begin/endInsertRows() usw.
+ *
+ * Qt-Konzept: Rollen
+ * data() wird mit einer Rolle aufgerufen: Qt::DisplayRole für den Text,
+ * Qt::FontRole für die Schrift, Qt::ForegroundRole für die Textfarbe usw.
+ * So braucht es keine Objekte pro Zelle, um das Aussehen zu beschreiben.
+ */
+class CharacterTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Die Spalten der Tabelle.
+     */
+    enum Column {
+        NameColumn,                 ///< Name
+        InitiativeModifierColumn,   ///< Initiative-Modifikator (editierbar)
+        TotalInitiativeColumn,      ///< Gesamt-Initiative mit Wurf
+        RollInitiativeColumn,       ///< Würfeln-Schaltfläche Initiative
+        WillSaveColumn,             ///< Willenskraft-Modifikator (editierbar)
+        WillResultColumn,           ///< Willenskraft-Ergebnis
+        RollWillColumn,             ///< Würfeln-Schaltfläche Willenskraft
+        ReflexSaveColumn,           ///< Reflex-Modifikator (editierbar)
+        ReflexResultColumn,         ///< Reflex-Ergebnis
+        RollReflexColumn,           ///< Würfeln-Schaltfläche Reflex
+        FortitudeSaveColumn,        ///< Konstitution-Modifikator (editierbar)
+        FortitudeResultColumn,      ///< Konstitution-Ergebnis
+        RollFortitudeColumn,        ///< Würfeln-Schaltfläche Konstitution
+        ColumnCount                 ///< Anzahl der Spalten
+    };
+
+    /**
+     * @brief Zusätzliche Rollen des Modells.
+     */
+    enum Role {
+        CharacterIndexRole = Qt::UserRole,  ///< Index des Charakters im Tracker
+        SortRole = Qt::UserRole + 2         ///< Zahlenwert zum Sortieren
+    };
+
+    /**
+     * @brief Erstellt das Modell für einen Tracker.
+     *
+     * @param tracker Der Tracker, dessen Daten angezeigt werden
+     * @param parent Das Elternobjekt
+     */
+    explicit CharacterTableModel(InitiativeTracker *tracker, QObject *parent = nullptr);
+
+    /**
+     * @brief Gibt die Anzahl der Zeilen zurück.
+     *
+     * @param parent Muss ungültig sein (Tabelle ohne Hierarchie)
+     * @return Die Anzahl der Charaktere
+     */
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+
+    /**
+     * @brief Gibt die Anzahl der Spalten zurück.
+     *
+     * @param parent Muss ungültig sein (Tabelle ohne Hierarchie)
+     * @return ColumnCount
+     */
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+
+    /**
+     * @brief Liest den Wert einer Zelle direkt aus dem Tracker.
+     *
+     * @param index Die Zelle
+     * @param role Die angefragte Rolle
+     * @return Der Wert oder ein ungültiges QVariant
+     */
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    /**
+     * @brief Schreibt einen geänderten Modifikator in den Tracker.
+     *
+     * @param index Die Zelle
+     * @param value Der neue Wert (muss eine Ganzzahl sein)
+     * @param role Muss Qt::EditRole sein
+     * @return true, wenn der Wert übernommen wurde
+     */
+    bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
+
+    /**
+     * @brief Gibt an, welche Zellen bearbeitet werden können.
+     *
+     * @param index Die Zelle
+     * @return Die Flags der Zelle
+     */
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
+
+    /**
+     * @brief Gibt die Spaltenüberschriften zurück.
+     *
+     * @param section Die Spalte bzw. Zeile
+     * @param orientation Horizontal oder vertikal
+     * @param role Die angefragte Rolle
+     * @return Die Überschrift
+     */
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    /**
+     * @brief Berechnet, welche Tabellenspalten von geänderten Store-Spalten betroffen sind.
+     *
+     * @param fields Bitmaske der geänderten Store-Spalten
+     * @return Bitmaske der Tabellenspalten (Bit c = Column c)
+     */
+    static quint32 columnsForFields(CharacterStore::FieldMask fields);
+
+private slots:
+    /**
+     * @brief Meldet neu angehängte Charaktere an die View.
+     *
+     * @param first Der erste neue Index
+     * @param last Der letzte neue Index
+     */
+    void onRowsInserted(int first, int last);
+
+    /**
+     * @brief Kündigt der View das Entfernen an (beginRemoveRows()).
+     *
+     * @param first Der erste zu entfernende Index
+     * @param last Der letzte zu entfernende Index
+     */
+    void onRowsAboutToBeRemoved(int first, int last);
+
+    /**
+     * @brief Schließt das Entfernen ab (endRemoveRows()).
+     *
+     * @param first Der erste entfernte Index
+     * @param last Der letzte entfernte Index
+     */
+    void onRowsRemoved(int first, int last);
+
+    /**
+     * @brief Meldet geänderte Zellen an die View.
+     *
+     * @param first Der erste betroffene Index
+     * @param last Der letzte betroffene Index
+     * @param fields Bitmaske der geänderten Store-Spalten
+     */
+    void onRowsUpdated(int first, int last, quint32 fields);
+
+    /**
+     * @brief Setzt das Modell nach einer grundlegenden Änderung zurück.
+     */
+    void onRowsReset();
+
+private:
+    /**
+     * @brief Formatiert ein Wurfergebnis als "Summe (Wurf)" oder "-".
+     *
+     * @param roll Der Wurf (0 = nicht gewürfelt)
+     * @param modifier Der Modifikator
+     * @return Der anzuzeigende Text
+     */
+    static QString formatResult(int roll, int modifier);
+
+    InitiativeTracker *m_tracker;  ///< Die Datenquelle
+
+    /**
+     * Die Zeilenzahl, die die View zuletzt gemeldet bekommen hat. Der Tracker
+     * hängt neue Charaktere an, bevor er rowsInserted() sendet;
+     * beginInsertRows() muss aber noch die alte Zeilenzahl sehen.
+     */
+    int m_rowCount;
+};
+
+#endif // CHARACTERTABLEMODEL_H
@@ -0,0 +1,134 @@
+#include "characterview.h"
+#include "characterstore.h"
+
+/**
+ * @brief Erstellt eine Sicht auf einen Charakter
+ *
+ * @param store Der Store, in dem der Charakter liegt
+ * @param index Der Index des Charakters
+ */
+CharacterView::CharacterView(const CharacterStore *store, int index)
+    : m_store(store)
+    , m_index(index)
+{
+}
+
+/**
+ * @brief Gibt den Index des Charakters im Store zurück
+ *
+ * @return Der Index
+ */
+int CharacterView::index() const
+{
+    return m_index;
+}
+
+/**
+ * @brief Gibt den Namen des Charakters zurück
+ *
+ * @return Eine Referenz auf den Namen im Store
+ */
+const QString &CharacterView::getName() const
+{
+    return m_store->name(m_index);
+}
+
+/**
+ * @brief Gibt den Initiative-Modifikator zurück
+ *
+ * @return Der Initiative-Modifikator
+ */
+int CharacterView::getInitiativeModifier() const
+{
+    return m_store->value(m_index, CharacterStore::InitiativeModifier);
+}
+
+/**
+ * @brief Gibt den gewürfelten Initiative-Wert zurück
+ *
+ * @return Der Initiative-Wurf
+ */
+int CharacterView::getInitiativeRoll() const
+{
+    return m_store->value(m_index, CharacterStore::InitiativeRoll);
+}
+
+/**
+ * @brief Gibt die Gesamt-Initiative zurück
+ *
+ * @return Wurf + Modifikator
+ */
+int CharacterView::getTotalInitiative() const
+{
+    return m_store->totalInitiative(m_index);
+}
+
+/**
+ * @brief Gibt den Willenskraft-Modifikator zurück
+ *
+ * @return Der Willenskraft-Modifikator
+ */
+int CharacterView::getWillSave() const
+{
+    return m_store->value(m_index, CharacterStore::WillSave);
+}
+
+/**
+ * @brief Gibt den Reflex-Modifikator zurück
+ *
+ * @return Der Reflex-Modifikator
+ */
+int CharacterView::getReflexSave() const
+{
+    return m_store->value(m_index, CharacterStore::ReflexSave);
+}
+
+/**
+ * @brief Gibt den Konstitution-Modifikator zurück
+ *
+ * @return Der Konstitution-Modifikator
+ */
+int CharacterView::getFortitudeSave() const
+{
+    return m_store->value(m_index, CharacterStore::FortitudeSave);
+}
+
+/**
+ * @brief Gibt den letzten Willenskraft-Wurf zurück
+ *
+ * @return Der letzte Willenskraft-Wurf
+ */
+int CharacterView::getLastWillSaveRoll() const
+{
+    return m_store->value(m_index, CharacterStore::LastWillSaveRoll);
+}
+
+/**
+ * @brief Gibt den letzten Reflex-Wurf zurück
+ *
+ * @return Der letzte Reflex-Wurf
+ */
+int CharacterView::getLastReflexSaveRoll() const
+{
+    return m_store->value(m_index, CharacterStore::LastReflexSaveRoll);
+}
+
+/**
+ * @brief Gibt den letzten Konstitution-Wurf zurück
+ *
+ * @return Der letzte Konstitution-Wurf
+ */
+int CharacterView::getLastFortitudeSaveRoll() const
+{
+    return m_store->value(m_index, CharacterStore::LastFortitudeSaveRoll);
+}
+
+/**
+ * @brief Erstellt eine eigenständige Kopie als Character
+ *
+ * @return Der Charakter als Werttyp
+ */
+Character CharacterView::toCharacter() const
+{
+    return m_store->at(m_index);
+}
@@ -0,0 +1,127 @@
+#ifndef CHARACTERVIEW_H
+#define CHARACTERVIEW_H
+
+#include <QString>
+#include "character.h"
+
+class CharacterStore;
+
+/**
+ * @brief Die CharacterView-Klasse ist eine schreibgeschützte Sicht auf einen Charakter im Store.
+ *
+ * Eine CharacterView besteht nur aus einem Zeiger auf den CharacterStore und
+ * einem Index. Die Getter lesen direkt aus den Spalten, statt wie
+ * CharacterStore::at() einen Character mit eigenem Namen zusammenzusetzen.
+ * Sie hat dieselben Getter wie Character, damit lesender Code unverändert
+ * bleiben kann.
+ *
+ * Eine Sicht ist nur gültig, solange der Store nicht verändert wird. Wer
+ * Daten über eine Änderung hinaus braucht, verwendet
+ * InitiativeTracker::snapshot().
+ *
+ * C++ Konzept: Views (Sichten)
+ * Eine View besitzt keine Daten, sondern verweist nur auf Daten, die einem
+ * anderen Objekt gehören. Das Kopieren einer View ist daher so billig wie das
+ * Kopieren eines Zeigers.
+ */
+class CharacterView
+{
+public:
+    /**
+     * @brief Erstellt eine Sicht auf einen Charakter.
+     *
+     * @param store Der Store, in dem der Charakter liegt
+     * @param index Der Index des Charakters
+     */
+    CharacterView(const CharacterStore *store, int index);
+
+    /**
+     * @brief Gibt den Index des Charakters im Store zurück.
+     *
+     * @return Der Index
+     */
+    int index() const;
+
+    /**
+     * @brief Gibt den Namen des Charakters zurück.
+     *
+     * @return Eine Referenz auf den Namen im Store
+     */
+    const QString &getName() const;
+
+    /**
+     * @brief Gibt den Initiative-Modifikator zurück.
+     *
+     * @return Der Initiative-Modifikator
+     */
+    int getInitiativeModifier() const;
+
+    /**
+     * @brief Gibt den gewürfelten Initiative-Wert zurück.
+     *
+     * @return Der Initiative-Wurf (0 = nicht gewürfelt)
+     */
+    int getInitiativeRoll() const;
+
+    /**
+     * @brief Gibt die Gesamt-Initiative (Wurf + Modifikator) zurück.
+     *
+     * @return Die Gesamt-Initiative
+     */
+    int getTotalInitiative() const;
+
+    /**
+     * @brief Gibt den Willenskraft-Modifikator zurück.
+     *
+     * @return Der Willenskraft-Modifikator
+     */
+    int getWillSave() const;
+
+    /**
+     * @brief Gibt den Reflex-Modifikator zurück.
+     *
+     * @return Der Reflex-Modifikator
+     */
+    int getReflexSave() const;
+
+    /**
+     * @brief Gibt den Konstitution-Modifikator zurück.
+     *
+     * @return Der Konstitution-Modifikator
+     */
+    int getFortitudeSave() const;
+
+    /**
+     * @brief Gibt den letzten Willenskraft-Wurf zurück.
+     *
+     * @return Der letzte Willenskraft-Wurf
+     */
+    int getLastWillSaveRoll() const;
+
+    /**
+     * @brief Gibt den letzten Reflex-Wurf zurück.
+     *
+     * @return Der letzte Reflex-Wurf
+     */
+    int getLastReflexSaveRoll() const;
+
+    /**
+     * @brief Gibt den letzten Konstitution-Wurf zurück.
+     *
+     * @return Der letzte Konstitution-Wurf
+     */
+    int getLastFortitudeSaveRoll() const;
+
+    /**
+     * @brief Erstellt eine eigenständige Kopie als Character.
+     *
+     * @return Der Charakter als Werttyp
+     */
+    Character toCharacter() const;
+
+private:
+    const CharacterStore *m_store;  ///< Der Store, der die Daten besitzt
+    int m_index;                    ///< Der Index im Store
+};
+
+#endif // CHARACTERVIEW_H
@@ -0,0 +1,235 @@
+#include "commanddispatcher.h"
+#include "initiativetracker.h"
+#include "trace.h"
+#include <QVector>
+#include <algorithm>
+
+/**
+ * @brief Erstellt einen Dispatcher mit den Standardbefehlen
+ *
+ * @param tracker Der Tracker, auf den die Standardbefehle wirken
+ */
+CommandDispatcher::CommandDispatcher(InitiativeTracker *tracker)
+    : m_tracker(tracker)
+{
+    registerCommand(QStringLiteral("rollInitiative"),
+                    QStringLiteral("Initiative für alle Charaktere gewürfelt"),
+                    [tracker](const QJsonObject &, QString *) {
+                        tracker->rollAllInitiatives();
+                        return true;
+                    });
+    registerCommand(QStringLiteral("rollWillSave"),
+                    QStringLiteral("Willenskraft für alle Charaktere gewürfelt"),
+                    [tracker](const QJsonObject &, QString *) {
+                        tracker->rollAllWillSaves();
+                        return true;
+                    });
+    registerCommand(QStringLiteral("rollReflexSave"),
+                    QStringLiteral("Reflex für alle Charaktere gewürfelt"),
+                    [tracker](const QJsonObject &, QString *) {
+                        tracker->rollAllReflexSaves();
+                        return true;
+                    });
+    registerCommand(QStringLiteral("rollFortitudeSave"),
+                    QStringLiteral("Konstitution für alle Charaktere gewürfelt"),
+                    [tracker](const QJsonObject &, QString *) {
+                        tracker->rollAllFortitudeSaves();
+                        return true;
+                    });
+}
+
+/**
+ * @brief Registriert einen Befehl oder ersetzt einen vorhandenen
+ *
+ * @param name Der Name des Befehls
+ * @param successMessage Die Meldung der Erfolgsantwort
+ * @param handler Die auszuführende Funktion
+ */
+void CommandDispatcher::registerCommand(const QString &name, const QString &successMessage, const Handler &handler)
+{
+    Command command;
+    command.handler = handler;
+    command.success = makeResponse(true, successMessage);
+    m_commands.insert(name, command);
+}
+
+/**
+ * @brief Prüft, ob ein Befehl registriert ist
+ *
+ * @param name Der Name des Befehls
+ * @return true, wenn der Befehl bekannt ist
+ */
+bool CommandDispatcher::contains(const QString &name) const
+{
+    return m_commands.contains(name);
+}
+
+/**
+ * @brief Gibt die Namen aller registrierten Befehle zurück
+ *
+ * @return Die Namen in alphabetischer Reihenfolge
+ */
+QStringList CommandDispatcher::commands() const
+{
+    QStringList names = m_commands.keys();
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+/**
+ * @brief Prüft, ob eine Nachricht einen oder mehrere Befehle enthält
+ *
+ * @param message Die Nachricht
+ * @return true, wenn das Feld "command" oder "commands" vorhanden ist
+ */
+bool CommandDispatcher::isCommand(const QJsonObject &message)
+{
+    return message.contains(QLatin1String("command")) || message.contains(QLatin1String("commands"));
+}
+
+/**
+ * @brief Führt den Befehl oder die Befehle einer Nachricht aus
+ *
+ * @param message Die Nachricht mit dem Feld "command" oder "commands"
+ * @return Die Antwort
+ */
+CommandDispatcher::Response CommandDispatcher::dispatch(const QJsonObject &message) const
+{
+    const QJsonValue batch = message.value(QLatin1String("commands"));
+    if (!batch.isUndefined()) {
+        if (!batch.isArray()) {
+            return errorResponse(QStringLiteral("\"commands\" muss eine Liste sein"));
+        }
+        return dispatchBatch(batch.toArray());
+    }
+
+    const QString name = message.value(QLatin1String("command")).toString();
+    const auto it = m_commands.constFind(name);
+    if (it == m_commands.constEnd()) {
+        TRACE_DEBUG(lcNet) << "Unbekannter Befehl:" << name;
+        return errorResponse(QStringLiteral("Unbekannter Befehl: ") + name);
+    }
+
+    QString error;
+    if (!it->handler(message, &error)) {
+        TRACE_DEBUG(lcNet) << "Befehl fehlgeschlagen:" << name << error;
+        return errorResponse(error);
+    }
+    return it->success;
+}
+
+/**
+ * @brief Führt mehrere Befehle in einem Tracker-Batch aus
+ *
+ * Zuerst werden alle Namen nachgeschlagen, damit ein Tippfehler im letzten
+ * Befehl nicht erst nach den vorherigen auffällt. Danach laufen die Befehle
+ * in einem ChangeBatch, der Tracker meldet seine Änderungen also einmal.
+ * Schlägt ein Befehl fehl, wird der Tracker auf den Schnappschuss vor dem
+ * Stapel zurückgesetzt.
+ *
+ * @param commands Die Befehle als Objekte mit dem Feld "command" oder als Namen
+ * @return Eine gemeinsame Antwort mit dem Feld "results"
+ */
+CommandDispatcher::Response CommandDispatcher::dispatchBatch(const QJsonArray &commands) const
+{
+    if (commands.isEmpty()) {
+        return errorResponse(QStringLiteral("Keine Befehle angegeben"));
+    }
+    if (commands.size() > MaxBatchSize) {
+        return errorResponse(QStringLiteral("Zu viele Befehle (höchstens %1)").arg(MaxBatchSize));
+    }
+
+    QVector<QJsonObject> messages;
+    QVector<const Command *> table;
+    messages.reserve(commands.size());
+    table.reserve(commands.size());
+    for (int i = 0; i < commands.size(); ++i) {
+        const QJsonValue value = commands.at(i);
+        const QJsonObject message = value.isString()
+            ? QJsonObject{ { QStringLiteral("command"), value } }
+            : value.toObject();
+        const QString name = message.value(QLatin1String("command")).toString();
+        const auto it = m_commands.constFind(name);
+        if (it == m_commands.constEnd()) {
+            TRACE_DEBUG(lcNet) << "Unbekannter Befehl im Stapel:" << i << name;
+            return errorResponse(QStringLiteral("Befehl %1: Unbekannter Befehl: %2").arg(i + 1).arg(name));
+        }
+        messages.append(message);
+        table.append(&it.value());
+    }
+
+    // Der Schnappschuss teilt sich die Spalten mit dem Tracker; kopiert
+    // werden nur die Spalten, die die Befehle tatsächlich ändern
+    const CharacterStore before = m_tracker->snapshot();
+    const SnapshotFile::Session session = m_tracker->session();
+
+    QJsonArray results;
+    bool success = true;
+    {
+        InitiativeTracker::ChangeBatch batch(m_tracker);
+        for (int i = 0; i < table.size(); ++i) {
+            QString error;
+            if (!table.at(i)->handler(messages.at(i), &error)) {
+                TRACE_DEBUG(lcNet) << "Befehl im Stapel fehlgeschlagen:" << i << error;
+                results.append(errorResponse(error).object);
+                success = false;
+                break;
+            }
+            results.append(table.at(i)->success.object);
+        }
+
+        // Noch im Batch, die Oberfläche sieht also nur den alten Zustand
+        if (!success) {
+            m_tracker->restore(before, session);
+        }
+    }
+
+    Response response;
+    response.success = success;
+    response.object[QLatin1String("status")] = success ? QStringLiteral("success") : QStringLiteral("error");
+    response.object[QLatin1String("message")] = success
+        ? QStringLiteral("%1 Befehle ausgeführt").arg(results.size())
+        : QStringLiteral("Befehl %1 fehlgeschlagen, keine Änderung übernommen").arg(results.size());
+    response.object[QLatin1String("results")] = results;
+    encodeResponse(&response);
+    return response;
+}
+
+/**
+ * @brief Baut eine Fehlerantwort
+ *
+ * @param message Die Fehlermeldung
+ * @return Die Antwort mit status "error"
+ */
+CommandDispatcher::Response CommandDispatcher::errorResponse(const QString &message)
+{
+    return makeResponse(false, message);
+}
+
+/**
+ * @brief Baut eine Antwort aus Status und Meldung
+ *
+ * @param success Erfolg oder Fehler
+ * @param message Die Meldung
+ * @return Die Antwort mit Objekt, JSON-Text und CBOR
+ */
+CommandDispatcher::Response CommandDispatcher::makeResponse(bool success, const QString &message)
+{
+    Response response;
+    response.success = success;
+    response.object[QLatin1String("status")] = success ? QStringLiteral("success") : QStringLiteral("error");
+    response.object[QLatin1String("message")] = message;
+    encodeResponse(&response);
+    return response;
+}
+
+/**
+ * @brief Ergänzt eine Antwort um die kodierten Formen ihres Objekts
+ *
+ * @param response Die Antwort, deren Objekt bereits gesetzt ist
+ */
+void CommandDispatcher::encodeResponse(Response *response)
+{
+    response->json = MessageCodec::encode(response->object, MessageCodec::Json);
+    response->cbor = MessageCodec::encode(response->object, MessageCodec::Cbor);
+}
@@ -0,0 +1,180 @@
+#ifndef COMMANDDISPATCHER_H
+#define COMMANDDISPATCHER_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QString>
+#include <QStringList>
+#include <functional>
+#include "messagecodec.h"
+
+class InitiativeTracker;
+
+/**
+ * @brief Der CommandDispatcher führt die Befehle der WebSocket-Schnittstelle aus.
+ *
+ * Jeder Befehl ("rollInitiative", "rollWillSave", ...) wird einmal mit
+ * seinem Namen, einer Funktion und der Erfolgsmeldung registriert. Eine
+ * Nachricht wie {"command": "rollInitiative"} wird dann mit einem einzigen
+ * Nachschlagen in einer Hash-Tabelle zugeordnet, statt den Namen
+ * nacheinander mit jedem bekannten Befehl zu vergleichen.
+ *
+ * Die Antwort auf einen erfolgreichen Befehl ändert sich nie. Sie wird
+ * deshalb bei der Registrierung einmal als QJsonObject und fertig kodiert
+ * (JSON und CBOR, siehe MessageCodec) gebaut und danach nur noch geteilt. Fehlerantworten haben
+ * dasselbe Format: {"status": "error", "message": "..."}.
+ *
+ * Die Standardbefehle des Trackers registriert der Konstruktor. Weitere
+ * Befehle können mit registerCommand() hinzugefügt oder ersetzt werden.
+ *
+ * Mehrere Befehle können in einer Nachricht gesendet werden:
+ * {"commands": [{"command": "rollInitiative"}, "rollWillSave"]}. Sie laufen
+ * der Reihe nach in einem InitiativeTracker::ChangeBatch, die Oberfläche
+ * wird also nur einmal aktualisiert, und der Client erhält eine einzige
+ * Antwort mit dem Ergebnis jedes Befehls unter "results". Unbekannte
+ * Befehle werden vorab erkannt; dann wird kein Befehl des Stapels
+ * ausgeführt. Schlägt ein Befehl fehl, werden die folgenden übersprungen
+ * und die Änderungen der vorherigen zurückgenommen: Der Stapel wirkt ganz
+ * oder gar nicht.
+ *
+ * C++ Konzept: std::function
+ * std::function kann jede aufrufbare Einheit aufnehmen: freie Funktionen,
+ * Lambdas mit Captures oder gebundene Methoden. So kann die Tabelle
+ * beliebige Befehle speichern, ohne dass jeder eine eigene Klasse braucht.
+ */
+class CommandDispatcher
+{
+public:
+    /**
+     * @brief Die Funktion eines Befehls.
+     *
+     * Erhält die ganze Nachricht, damit Befehle weitere Felder lesen können.
+     * Gibt false zurück und setzt error, wenn der Befehl fehlschlägt.
+     */
+    typedef std::function<bool(const QJsonObject &message, QString *error)> Handler;
+
+    /**
+     * @brief Die Antwort auf eine Nachricht.
+     */
+    struct Response {
+        bool success = false;  ///< Wurde der Befehl ausgeführt?
+        QJsonObject object;    ///< Die Antwort als JSON-Objekt
+        QByteArray json;       ///< Die Antwort als kompakter JSON-Text (UTF-8)
+        QByteArray cbor;       ///< Die Antwort als CBOR
+
+        /**
+         * @brief Gibt die kodierte Antwort zurück.
+         *
+         * @param encoding Die Kodierung des Clients
+         * @return json oder cbor
+         */
+        const QByteArray &encoded(MessageCodec::Encoding encoding) const
+        {
+            return encoding == MessageCodec::Cbor ? cbor : json;
+        }
+    };
+
+    static constexpr int MaxBatchSize = 256;  ///< Höchstzahl der Befehle in einer Nachricht
+
+    /**
+     * @brief Erstellt einen Dispatcher mit den Standardbefehlen für einen Tracker.
+     *
+     * @param tracker Der Tracker, auf den die Standardbefehle wirken
+     */
+    explicit CommandDispatcher(InitiativeTracker *tracker);
+
+    /**
+     * @brief Registriert einen Befehl oder ersetzt einen vorhandenen.
+     *
+     * @param name Der Name des Befehls, wie er im Feld "command" steht
+     * @param successMessage Die Meldung der Erfolgsantwort
+     * @param handler Die auszuführende Funktion
+     */
+    void registerCommand(const QString &name, const QString &successMessage, const Handler &handler);
+
+    /**
+     * @brief Prüft, ob ein Befehl registriert ist.
+     *
+     * @param name Der Name des Befehls
+     * @return true, wenn der Befehl bekannt ist
+     */
+    bool contains(const QString &name) const;
+
+    /**
+     * @brief Gibt die Namen aller registrierten Befehle zurück.
+     *
+     * @return Die Namen in alphabetischer Reihenfolge
+     */
+    QStringList commands() const;
+
+    /**
+     * @brief Prüft, ob eine Nachricht einen oder mehrere Befehle enthält.
+     *
+     * @param message Die Nachricht
+     * @return true, wenn das Feld "command" oder "commands" vorhanden ist
+     */
+    static bool isCommand(const QJsonObject &message);
+
+    /**
+     * @brief Führt den Befehl oder die Befehle einer Nachricht aus.
+     *
+     * Enthält die Nachricht das Feld "commands", wird sie wie mit
+     * dispatchBatch() ausgeführt.
+     *
+     * @param message Die Nachricht mit dem Feld "command" oder "commands"
+     * @return Die Antwort; bei einem einzelnen Befehl die vorab gebaute
+     */
+    Response dispatch(const QJsonObject &message) const;
+
+    /**
+     * @brief Führt mehrere Befehle in einem Tracker-Batch aus.
+     *
+     * Schlägt ein Befehl fehl, setzt der Dispatcher Charaktere und Sitzung
+     * auf den Stand vor dem Stapel zurück (InitiativeTracker::snapshot()
+     * und restore()). "results" endet dann mit dem Fehler.
+     *
+     * @param commands Die Befehle als Objekte mit dem Feld "command" oder als Namen
+     * @return Eine gemeinsame Antwort mit dem Feld "results"
+     */
+    Response dispatchBatch(const QJsonArray &commands) const;
+
+    /**
+     * @brief Baut eine Fehlerantwort.
+     *
+     * @param message Die Fehlermeldung
+     * @return Die Antwort mit status "error"
+     */
+    static Response errorResponse(const QString &message);
+
+private:
+    /**
+     * @brief Ein registrierter Befehl.
+     */
+    struct Command {
+        Handler handler;   ///< Die auszuführende Funktion
+        Response success;  ///< Die vorab gebaute Erfolgsantwort
+    };
+
+    /**
+     * @brief Baut eine Antwort aus Status und Meldung.
+     *
+     * @param success Erfolg oder Fehler
+     * @param message Die Meldung
+     * @return Die Antwort mit Objekt, JSON-Text und CBOR
+     */
+    static Response makeResponse(bool success, const QString &message);
+
+    /**
+     * @brief Ergänzt eine Antwort um die kodierten Formen ihres Objekts.
+     *
+     * @param response Die Antwort, deren Objekt bereits gesetzt ist
+     */
+    static void encodeResponse(Response *response);
+
+    InitiativeTracker *m_tracker;        ///< Der Tracker für Batches
+    QHash<QString, Command> m_commands;  ///< Die Befehlstabelle
+};
+
+#endif // COMMANDDISPATCHER_H
@@ -0,0 +1,399 @@
+#include "diceengine.h"
+#include <QThreadPool>
+#include <QSemaphore>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#  include <immintrin.h>
+#  if defined(__GNUC__) || defined(__clang__)
+#    define DICEENGINE_HAVE_AVX2 1
+#    define DICEENGINE_TARGET_AVX2 __attribute__((target("avx2")))
+#  elif defined(__AVX2__)
+#    define DICEENGINE_HAVE_AVX2 1
+#    define DICEENGINE_TARGET_AVX2
+#  endif
+#endif
+
+// Konstanten von Philox4x32 (Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3")
+static const quint32 PHILOX_M0 = 0xD2511F53u;
+static const quint32 PHILOX_M1 = 0xCD9E8D57u;
+static const quint32 PHILOX_W0 = 0x9E3779B9u;
+static const quint32 PHILOX_W1 = 0xBB67AE85u;
+static const int PHILOX_ROUNDS = 10;
+
+// Ein Durchlauf erzeugt 8 Blöcke (eine AVX2-Spur je Block) zu je 4 Wörtern.
+// Wort w von Spur l landet an Position w * 8 + l, sodass jedes Register
+// direkt als 8 aufeinanderfolgende Werte gespeichert werden kann.
+static const int LANES = 8;
+static const int WORDS = 4;
+static const int CHUNK = LANES * WORDS;
+
+// Ab dieser Anzahl an Würfen lohnt sich die Verteilung auf mehrere Threads
+static const int PARALLEL_THRESHOLD = 65536;
+
+/**
+ * @brief Bildet ein 32-Bit-Zufallswort gleichmäßig auf 1-20 ab
+ *
+ * Verwendet die Multiplikationsmethode von Lemire: (x * 20) / 2^32.
+ * Die Abweichung von der Gleichverteilung liegt unter 20 / 2^32.
+ */
+static inline int toD20(quint32 x)
+{
+    return static_cast<int>((static_cast<quint64>(x) * 20u) >> 32) + 1;
+}
+
+/**
+ * @brief Berechnet die acht Blöcke eines Durchlaufs skalar
+ *
+ * @param key Der Schlüssel
+ * @param firstBlock Der Zähler des ersten Blocks
+ * @param batch Die Batch-Nummer
+ * @param out Puffer für CHUNK Werte
+ */
+static void chunkScalar(const quint32 key[2], quint32 firstBlock, quint64 batch, int *out)
+{
+    for (int lane = 0; lane < LANES; ++lane) {
+        const quint32 counter[4] = {
+            firstBlock + static_cast<quint32>(lane),
+            static_cast<quint32>(batch),
+            static_cast<quint32>(batch >> 32),
+            0u
+        };
+        quint32 words[4];
+        DiceEngine::philox(counter, key, words);
+        for (int w = 0; w < WORDS; ++w) {
+            out[w * LANES + lane] = toD20(words[w]);
+        }
+    }
+}
+
+#ifdef DICEENGINE_HAVE_AVX2
+
+/**
+ * @brief Multipliziert acht 32-Bit-Spuren mit einer Konstante (32x32 -> 64 Bit)
+ *
+ * _mm256_mul_epu32 multipliziert nur die geraden Spuren. Die ungeraden Spuren
+ * werden dafür um 32 Bit nach unten verschoben und danach wieder eingemischt.
+ */
+DICEENGINE_TARGET_AVX2
+static inline void mulHiLo(__m256i a, __m256i m, __m256i &hi, __m256i &lo)
+{
+    const __m256i even = _mm256_mul_epu32(a, m);
+    const __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), m);
+    lo = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA);
+    hi = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+}
+
+/**
+ * @brief Bildet acht Zufallswörter auf 1-20 ab und speichert sie
+ */
+DICEENGINE_TARGET_AVX2
+static inline void storeD20(int *out, __m256i x)
+{
+    const __m256i twenty = _mm256_set1_epi32(20);
+    __m256i hi;
+    __m256i lo;
+    mulHiLo(x, twenty, hi, lo);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out),
+                        _mm256_add_epi32(hi, _mm256_set1_epi32(1)));
+}
+
+/**
+ * @brief Berechnet die acht Blöcke eines Durchlaufs mit AVX2
+ *
+ * @param key Der Schlüssel
+ * @param firstBlock Der Zähler des ersten Blocks
+ * @param batch Die Batch-Nummer
+ * @param out Puffer für CHUNK Werte
+ */
+DICEENGINE_TARGET_AVX2
+static void chunkAvx2(const quint32 key[2], quint32 firstBlock, quint64 batch, int *out)
+{
+    const __m256i m0 = _mm256_set1_epi32(static_cast<int>(PHILOX_M0));
+    const __m256i m1 = _mm256_set1_epi32(static_cast<int>(PHILOX_M1));
+
+    __m256i c0 = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(firstBlock)),
+                                  _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    __m256i c1 = _mm256_set1_epi32(static_cast<int>(static_cast<quint32>(batch)));
+    __m256i c2 = _mm256_set1_epi32(static_cast<int>(static_cast<quint32>(batch >> 32)));
+    __m256i c3 = _mm256_setzero_si256();
+
+    quint32 k0 = key[0];
+    quint32 k1 = key[1];
+    for (int round = 0; round < PHILOX_ROUNDS; ++round) {
+        if (round > 0) {
+            k0 += PHILOX_W0;
+            k1 += PHILOX_W1;
+        }
+        __m256i hi0, lo0, hi1, lo1;
+        mulHiLo(c0, m0, hi0, lo0);
+        mulHiLo(c2, m1, hi1, lo1);
+        const __m256i n0 = _mm256_xor_si256(_mm256_xor_si256(hi1, c1), _mm256_set1_epi32(static_cast<int>(k0)));
+        const __m256i n2 = _mm256_xor_si256(_mm256_xor_si256(hi0, c3), _mm256_set1_epi32(static_cast<int>(k1)));
+        c0 = n0;
+        c1 = lo1;
+        c2 = n2;
+        c3 = lo0;
+    }
+
+    storeD20(out, c0);
+    storeD20(out + LANES, c1);
+    storeD20(out + 2 * LANES, c2);
+    storeD20(out + 3 * LANES, c3);
+}
+
+#endif // DICEENGINE_HAVE_AVX2
+
+typedef void (*ChunkFunction)(const quint32 key[2], quint32 firstBlock, quint64 batch, int *out);
+
+/**
+ * @brief Füllt die Positionen [first, first + count) durchlaufweise
+ *
+ * Werte vor der ersten Durchlaufgrenze werden einzeln nachgerechnet. Ein
+ * unvollständiger letzter Durchlauf wird in einen Zwischenpuffer geschrieben,
+ * damit nie über das Ende von out hinaus geschrieben wird.
+ */
+static void fillWith(ChunkFunction chunk, quint64 seed, quint64 batch, int first, int *out, int count)
+{
+    // Kopf bis zur nächsten Durchlaufgrenze
+    while (count > 0 && first % CHUNK != 0) {
+        *out++ = DiceEngine::d20At(seed, batch, first++);
+        --count;
+    }
+
+    const quint32 key[2] = { static_cast<quint32>(seed), static_cast<quint32>(seed >> 32) };
+    const quint32 firstBlock = static_cast<quint32>(first / CHUNK) * LANES;
+    const int fullChunks = count / CHUNK;
+    for (int c = 0; c < fullChunks; ++c) {
+        chunk(key, firstBlock + static_cast<quint32>(c) * LANES, batch, out + c * CHUNK);
+    }
+
+    const int rest = count - fullChunks * CHUNK;
+    if (rest > 0) {
+        int tail[CHUNK];
+        chunk(key, firstBlock + static_cast<quint32>(fullChunks) * LANES, batch, tail);
+        for (int i = 0; i < rest; ++i) {
+            out[fullChunks * CHUNK + i] = tail[i];
+        }
+    }
+}
+
+/**
+ * @brief Erstellt eine Engine mit dem angegebenen Seed
+ *
+ * @param seed Der 64-Bit-Schlüssel des Generators
+ */
+DiceEngine::DiceEngine(quint64 seed)
+    : m_seed(seed), m_batch(0)
+{
+}
+
+/**
+ * @brief Gibt den Seed der Engine zurück
+ *
+ * @return Der 64-Bit-Schlüssel
+ */
+quint64 DiceEngine::seed() const
+{
+    return m_seed;
+}
+
+/**
+ * @brief Gibt die Nummer des nächsten Batches zurück
+ *
+ * @return Die Anzahl der bisher gewürfelten Batches
+ */
+quint64 DiceEngine::batch() const
+{
+    return m_batch;
+}
+
+/**
+ * @brief Setzt die Nummer des nächsten Batches
+ *
+ * @param batch Die Nummer des nächsten Batches
+ */
+void DiceEngine::setBatch(quint64 batch)
+{
+    m_batch = batch;
+}
+
+/**
+ * @brief Reserviert die Nummer für einen neuen Batch
+ *
+ * @return Die reservierte Batch-Nummer
+ */
+quint64 DiceEngine::nextBatch()
+{
+    return m_batch++;
+}
+
+/**
+ * @brief Füllt einen Puffer mit W20-Ergebnissen und startet einen neuen Batch
+ *
+ * @param out Der Zielpuffer
+ * @param count Die Anzahl der Würfe
+ */
+void DiceEngine::rollD20(int *out, int count)
+{
+    fillD20Parallel(m_seed, nextBatch(), 0, out, count);
+}
+
+/**
+ * @brief Füllt einen Puffer mit den W20-Ergebnissen eines Batches
+ *
+ * @param seed Der Schlüssel
+ * @param batch Die Batch-Nummer
+ * @param first Die Position des ersten Werts innerhalb des Batches
+ * @param out Der Zielpuffer
+ * @param count Die Anzahl der Würfe
+ */
+void DiceEngine::fillD20(quint64 seed, quint64 batch, int first, int *out, int count)
+{
+#ifdef DICEENGINE_HAVE_AVX2
+    if (isAvx2Available()) {
+        fillWith(chunkAvx2, seed, batch, first, out, count);
+        return;
+    }
+#endif
+    fillWith(chunkScalar, seed, batch, first, out, count);
+}
+
+/**
+ * @brief Füllt einen Puffer immer über den skalaren Pfad
+ *
+ * @param seed Der Schlüssel
+ * @param batch Die Batch-Nummer
+ * @param first Die Position des ersten Werts innerhalb des Batches
+ * @param out Der Zielpuffer
+ * @param count Die Anzahl der Würfe
+ */
+void DiceEngine::fillD20Scalar(quint64 seed, quint64 batch, int first, int *out, int count)
+{
+    fillWith(chunkScalar, seed, batch, first, out, count);
+}
+
+/**
+ * @brief Verteilt das Füllen eines großen Puffers auf den globalen Thread-Pool
+ *
+ * Jede Aufgabe bearbeitet einen eigenen, an Durchlaufgrenzen ausgerichteten
+ * Abschnitt. Der aufrufende Thread übernimmt den ersten Abschnitt selbst und
+ * wartet danach auf die übrigen. Ist der Pool ausgelastet, wird ein Abschnitt
+ * direkt im aufrufenden Thread berechnet.
+ *
+ * @param seed Der Schlüssel
+ * @param batch Die Batch-Nummer
+ * @param first Die Position des ersten Werts innerhalb des Batches
+ * @param out Der Zielpuffer
+ * @param count Die Anzahl der Würfe
+ */
+void DiceEngine::fillD20Parallel(quint64 seed, quint64 batch, int first, int *out, int count)
+{
+    QThreadPool *pool = QThreadPool::globalInstance();
+    const int threads = pool->maxThreadCount();
+    if (count < PARALLEL_THRESHOLD || threads < 2) {
+        fillD20(seed, batch, first, out, count);
+        return;
+    }
+
+    // Abschnittsgröße auf ganze Durchläufe aufrunden
+    int part = (count + threads - 1) / threads;
+    part = (part + CHUNK - 1) / CHUNK * CHUNK;
+
+    QSemaphore done;
+    int started = 0;
+    for (int offset = part; offset < count; offset += part) {
+        const int n = qMin(part, count - offset);
+        const int position = first + offset;
+        int *target = out + offset;
+        const bool queued = pool->tryStart([seed, batch, position, target, n, &done]() {
+            fillD20(seed, batch, position, target, n);
+            done.release();
+        });
+        if (queued) {
+            ++started;
+        } else {
+            fillD20(seed, batch, position, target, n);
+        }
+    }
+
+    fillD20(seed, batch, first, out, qMin(part, count));
+    done.acquire(started);
+}
+
+/**
+ * @brief Berechnet einen einzelnen Wurf eines Batches nach
+ *
+ * @param seed Der Schlüssel
+ * @param batch Die Batch-Nummer
+ * @param position Die Position innerhalb des Batches
+ * @return Das W20-Ergebnis (1-20)
+ */
+int DiceEngine::d20At(quint64 seed, quint64 batch, int position)
+{
+    const int chunk = position / CHUNK;
+    const int offset = position % CHUNK;
+    const quint32 key[2] = { static_cast<quint32>(seed), static_cast<quint32>(seed >> 32) };
+    const quint32 counter[4] = {
+        static_cast<quint32>(chunk) * LANES + static_cast<quint32>(offset % LANES),
+        static_cast<quint32>(batch),
+        static_cast<quint32>(batch >> 32),
+        0u
+    };
+    quint32 words[4];
+    philox(counter, key, words);
+    return toD20(words[offset / LANES]);
+}
+
+/**
+ * @brief Prüft, ob der AVX2-Pfad verwendet wird
+ *
+ * @return true, wenn AVX2 verfügbar ist
+ */
+bool DiceEngine::isAvx2Available()
+{
+#if defined(DICEENGINE_HAVE_AVX2) && (defined(__GNUC__) || defined(__clang__))
+    static const bool available = __builtin_cpu_supports("avx2");
+    return available;
+#elif defined(DICEENGINE_HAVE_AVX2)
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief Berechnet einen Philox4x32-10-Block
+ *
+ * @param counter Die vier 32-Bit-Wörter des Zählers
+ * @param key Die zwei 32-Bit-Wörter des Schlüssels
+ * @param out Die vier 32-Bit-Wörter des Ergebnisses
+ */
+void DiceEngine::philox(const quint32 counter[4], const quint32 key[2], quint32 out[4])
+{
+    quint32 c0 = counter[0];
+    quint32 c1 = counter[1];
+    quint32 c2 = counter[2];
+    quint32 c3 = counter[3];
+    quint32 k0 = key[0];
+    quint32 k1 = key[1];
+
+    for (int round = 0; round < PHILOX_ROUNDS; ++round) {
+        if (round > 0) {
+            k0 += PHILOX_W0;
+            k1 += PHILOX_W1;
+        }
+        const quint64 p0 = static_cast<quint64>(PHILOX_M0) * c0;
+        const quint64 p1 = static_cast<quint64>(PHILOX_M1) * c2;
+        const quint32 n0 = static_cast<quint32>(p1 >> 32) ^ c1 ^ k0;
+        const quint32 n2 = static_cast<quint32>(p0 >> 32) ^ c3 ^ k1;
+        c1 = static_cast<quint32>(p1);
+        c3 = static_cast<quint32>(p0);
+        c0 = n0;
+        c2 = n2;
+    }
+
+    out[0] = c0;
+    out[1] = c1;
+    out[2] = c2;
+    out[3] = c3;
+}
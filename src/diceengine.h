@@ -0,0 +1,159 @@
+#ifndef DICEENGINE_H
+#define DICEENGINE_H
+
+#include <QtGlobal>
+
+/**
+ * @brief Die DiceEngine-Klasse würfelt viele W20 auf einmal.
+ *
+ * Statt für jeden Charakter einzeln den Mersenne-Twister aufzurufen, füllt
+ * die Engine einen ganzen Puffer mit Würfelergebnissen. Als Generator dient
+ * Philox4x32-10, ein zählerbasierter Zufallszahlengenerator: Jeder Wert ergibt
+ * sich nur aus einem Schlüssel (dem Seed) und einem Zähler. Es gibt keinen
+ * Zustand, der von Wurf zu Wurf weitergereicht werden muss, daher lassen sich
+ * acht Zähler gleichzeitig in den 256-Bit-Registern von AVX2 verarbeiten.
+ *
+ * Auf Prozessoren ohne AVX2 (oder anderen Architekturen) wird ein skalarer
+ * Pfad verwendet, der bitgenau dieselben Ergebnisse liefert.
+ *
+ * Jeder Aufruf von rollD20() ist ein "Batch" mit eigener Nummer. Der Wert an
+ * Position i eines Batches kann mit d20At() jederzeit einzeln nachgerechnet
+ * werden.
+ *
+ * Weil jeder Wert nur von (Seed, Batch, Position) abhängt, können große
+ * Batches abschnittsweise auf mehrere Threads verteilt werden. Das Ergebnis
+ * ist unabhängig von der Anzahl der Threads immer dasselbe.
+ *
+ * C++ Konzept: SIMD (Single Instruction, Multiple Data)
+ * SIMD-Befehle führen dieselbe Operation auf mehreren Werten gleichzeitig aus.
+ * Mit AVX2 werden acht 32-Bit-Zahlen in einem Register verarbeitet. Über
+ * Intrinsics (z.B. _mm256_mul_epu32) können diese Befehle direkt aus C++
+ * verwendet werden.
+ */
+class DiceEngine
+{
+public:
+    /**
+     * @brief Erstellt eine Engine mit dem angegebenen Seed.
+     *
+     * @param seed Der 64-Bit-Schlüssel des Generators
+     */
+    explicit DiceEngine(quint64 seed);
+
+    /**
+     * @brief Gibt den Seed der Engine zurück.
+     *
+     * @return Der 64-Bit-Schlüssel
+     */
+    quint64 seed() const;
+
+    /**
+     * @brief Gibt die Nummer des nächsten Batches zurück.
+     *
+     * @return Die Anzahl der bisher gewürfelten Batches
+     */
+    quint64 batch() const;
+
+    /**
+     * @brief Setzt die Nummer des nächsten Batches.
+     *
+     * Wird beim Laden einer gespeicherten Sitzung verwendet, damit neue Würfe
+     * keine bereits vergebenen Batch-Nummern wiederverwenden.
+     *
+     * @param batch Die Nummer des nächsten Batches
+     */
+    void setBatch(quint64 batch);
+
+    /**
+     * @brief Reserviert die Nummer für einen neuen Batch.
+     *
+     * Für Aufrufer, die die Werte selbst über fillD20() oder d20At() berechnen,
+     * z.B. weil die Positionen nicht bei 0 beginnen.
+     *
+     * @return Die reservierte Batch-Nummer
+     */
+    quint64 nextBatch();
+
+    /**
+     * @brief Füllt einen Puffer mit W20-Ergebnissen und startet einen neuen Batch.
+     *
+     * Große Puffer werden über fillD20Parallel() auf mehrere Threads verteilt.
+     *
+     * @param out Der Zielpuffer
+     * @param count Die Anzahl der Würfe
+     */
+    void rollD20(int *out, int count);
+
+    /**
+     * @brief Füllt einen Puffer mit den W20-Ergebnissen eines Batches.
+     *
+     * Wählt zur Laufzeit den AVX2-Pfad, falls der Prozessor ihn unterstützt.
+     * out[0] erhält den Wert an Position first des Batches.
+     *
+     * @param seed Der Schlüssel
+     * @param batch Die Batch-Nummer
+     * @param first Die Position des ersten Werts innerhalb des Batches
+     * @param out Der Zielpuffer
+     * @param count Die Anzahl der Würfe
+     */
+    static void fillD20(quint64 seed, quint64 batch, int first, int *out, int count);
+
+    /**
+     * @brief Wie fillD20(), verwendet aber immer den skalaren Pfad.
+     *
+     * @param seed Der Schlüssel
+     * @param batch Die Batch-Nummer
+     * @param first Die Position des ersten Werts innerhalb des Batches
+     * @param out Der Zielpuffer
+     * @param count Die Anzahl der Würfe
+     */
+    static void fillD20Scalar(quint64 seed, quint64 batch, int first, int *out, int count);
+
+    /**
+     * @brief Wie fillD20(), verteilt große Puffer aber auf den Thread-Pool.
+     *
+     * Qt-Konzept: QThreadPool
+     * Der globale QThreadPool hält so viele Worker-Threads bereit, wie der
+     * Rechner Kerne hat. Aufgaben werden mit start() oder tryStart() übergeben;
+     * die Threads werden wiederverwendet, statt jedes Mal neu erzeugt zu werden.
+     *
+     * @param seed Der Schlüssel
+     * @param batch Die Batch-Nummer
+     * @param first Die Position des ersten Werts innerhalb des Batches
+     * @param out Der Zielpuffer
+     * @param count Die Anzahl der Würfe
+     */
+    static void fillD20Parallel(quint64 seed, quint64 batch, int first, int *out, int count);
+
+    /**
+     * @brief Berechnet einen einzelnen Wurf eines Batches in O(1) nach.
+     *
+     * @param seed Der Schlüssel
+     * @param batch Die Batch-Nummer
+     * @param position Die Position innerhalb des Batches
+     * @return Das W20-Ergebnis (1-20)
+     */
+    static int d20At(quint64 seed, quint64 batch, int position);
+
+    /**
+     * @brief Prüft, ob der AVX2-Pfad auf diesem Prozessor verwendet wird.
+     *
+     * @return true, wenn AVX2 verfügbar ist
+     */
+    static bool isAvx2Available();
+
+    /**
+     * @brief Berechnet einen Philox4x32-10-Block.
+     *
+     * @param counter Die vier 32-Bit-Wörter des Zählers
+     * @param key Die zwei 32-Bit-Wörter des Schlüssels
+     * @param out Die vier 32-Bit-Wörter des Ergebnisses
+     */
+    static void philox(const quint32 counter[4], const quint32 key[2], quint32 out[4]);
+
+private:
+    quint64 m_seed;   ///< Der Schlüssel des Generators
+    quint64 m_batch;  ///< Die Nummer des nächsten Batches
+};
+
+#endif // DICEENGINE_H
@@ -0,0 +1,359 @@
+#include "encounterarchive.h"
+#include "trace.h"
+#include <QDataStream>
+#include <QFile>
+#include <QSaveFile>
+#include <cstring>
+
+namespace {
+
+const char Magic[8] = { 'D', 'N', 'D', 'A', 'R', 'C', 'H', '\0' };
+
+const int MaxNameLength = 1024;  // Längere Namen gelten als beschädigter Index
+
+} // namespace
+
+/**
+ * @brief Erstellt ein Archiv für eine Datei
+ *
+ * @param filename Der Dateiname des Archivs
+ */
+EncounterArchive::EncounterArchive(const QString &filename)
+    : m_filename(filename)
+{
+}
+
+/**
+ * @brief Liest Kopf und Index des Archivs
+ *
+ * Die komprimierten Begegnungen werden nicht gelesen, nur ihre Positionen
+ * gegen die Dateigröße geprüft.
+ *
+ * @return true, wenn die Datei ein gültiges Archiv ist
+ */
+bool EncounterArchive::open()
+{
+    m_entries.clear();
+
+    QFile file(m_filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        TRACE_INFO(lcStorage) << "Archiv existiert nicht oder konnte nicht geöffnet werden:" << m_filename;
+        return false;
+    }
+    const quint64 fileSize = quint64(file.size());
+
+    QDataStream stream(&file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+
+    char magic[sizeof(Magic)];
+    quint32 version = 0;
+    quint32 count = 0;
+    quint64 indexOffset = 0;
+    quint64 indexSize = 0;
+    stream.readRawData(magic, sizeof(magic));
+    stream >> version >> count >> indexOffset >> indexSize;
+
+    const bool headerValid = stream.status() == QDataStream::Ok
+        && std::memcmp(magic, Magic, sizeof(Magic)) == 0
+        && version == Version
+        && indexOffset >= HeaderSize
+        && indexOffset <= fileSize && indexSize <= fileSize - indexOffset;
+    if (!headerValid || !file.seek(qint64(indexOffset))) {
+        TRACE_WARNING(lcStorage) << "Ungültiges oder veraltetes Archiv:" << m_filename;
+        return false;
+    }
+
+    // Nur der Index wird gelesen; jede Begegnung muss vor ihm liegen
+    QVector<Entry> entries;
+    for (quint32 i = 0; i < count; ++i) {
+        Entry entry;
+        quint32 characterCount = 0;
+        quint32 nameLength = 0;
+        stream >> entry.offset >> entry.size >> characterCount >> nameLength;
+        if (stream.status() != QDataStream::Ok || nameLength > quint32(MaxNameLength)
+            || entry.offset < HeaderSize || entry.offset > indexOffset
+            || entry.size > indexOffset - entry.offset) {
+            TRACE_WARNING(lcStorage) << "Beschädigter Index im Archiv:" << m_filename;
+            return false;
+        }
+
+        QVector<quint16> utf16(int(nameLength));
+        for (quint16 &c : utf16) {
+            stream >> c;
+        }
+        entry.name = QString(reinterpret_cast<const QChar *>(utf16.constData()), int(nameLength));
+        entry.characterCount = int(characterCount);
+        entries.append(entry);
+    }
+    if (stream.status() != QDataStream::Ok || quint64(file.pos()) != indexOffset + indexSize) {
+        TRACE_WARNING(lcStorage) << "Beschädigter Index im Archiv:" << m_filename;
+        return false;
+    }
+
+    m_entries = entries;
+    return true;
+}
+
+/**
+ * @brief Gibt den Dateinamen des Archivs zurück
+ *
+ * @return Der Dateiname
+ */
+QString EncounterArchive::filename() const
+{
+    return m_filename;
+}
+
+/**
+ * @brief Gibt die Anzahl der Begegnungen zurück
+ *
+ * @return Die Anzahl
+ */
+int EncounterArchive::count() const
+{
+    return m_entries.size();
+}
+
+/**
+ * @brief Gibt die Namen aller Begegnungen zurück
+ *
+ * @return Die Namen in der gespeicherten Reihenfolge
+ */
+QStringList EncounterArchive::names() const
+{
+    QStringList result;
+    for (const Entry &entry : m_entries) {
+        result.append(entry.name);
+    }
+    return result;
+}
+
+/**
+ * @brief Gibt den Index des Archivs zurück
+ *
+ * @return Ein Eintrag pro Begegnung
+ */
+QVector<EncounterArchive::Entry> EncounterArchive::entries() const
+{
+    return m_entries;
+}
+
+/**
+ * @brief Prüft, ob das Archiv eine Begegnung enthält
+ *
+ * @param name Der Name der Begegnung
+ * @return true, wenn es eine Begegnung mit diesem Namen gibt
+ */
+bool EncounterArchive::contains(const QString &name) const
+{
+    return indexOf(name) >= 0;
+}
+
+/**
+ * @brief Lädt eine einzelne Begegnung
+ *
+ * @param name Der Name der Begegnung
+ * @param store Erhält die Charaktere
+ * @param session Erhält die Sitzung
+ * @return true, wenn die Begegnung gefunden und gültig war
+ */
+bool EncounterArchive::load(const QString &name, CharacterStore *store, SnapshotFile::Session *session) const
+{
+    const int index = indexOf(name);
+    if (index < 0) {
+        TRACE_WARNING(lcStorage) << "Begegnung nicht im Archiv:" << name;
+        return false;
+    }
+    const Entry &entry = m_entries.at(index);
+
+    // Nur die Bytes dieser einen Begegnung lesen
+    QFile file(m_filename);
+    if (!file.open(QIODevice::ReadOnly) || !file.seek(qint64(entry.offset))) {
+        TRACE_WARNING(lcStorage) << "Archiv konnte nicht gelesen werden:" << m_filename;
+        return false;
+    }
+    const QByteArray compressed = file.read(qint64(entry.size));
+    if (quint64(compressed.size()) != entry.size) {
+        TRACE_WARNING(lcStorage) << "Archiv ist kürzer als sein Index:" << m_filename;
+        return false;
+    }
+
+    const QByteArray data = qUncompress(compressed);
+    if (data.isEmpty()
+        || !SnapshotFile::fromData(reinterpret_cast<const uchar *>(data.constData()), quint64(data.size()),
+                                   store, session)) {
+        TRACE_WARNING(lcStorage) << "Beschädigte Begegnung im Archiv:" << name;
+        return false;
+    }
+
+    TRACE_EVENT(FileLoaded, store->size(), index);
+    return true;
+}
+
+/**
+ * @brief Speichert eine Begegnung
+ *
+ * @param name Der Name der Begegnung
+ * @param store Die Charaktere
+ * @param session Die Sitzung
+ * @return true, wenn das Archiv vollständig geschrieben wurde
+ */
+bool EncounterArchive::save(const QString &name, const CharacterStore &store, const SnapshotFile::Session &session)
+{
+    if (name.isEmpty() || name.size() > MaxNameLength) {
+        return false;
+    }
+
+    // Die Journal-Generation gehört zur laufenden Sitzung, nicht ins Archiv
+    SnapshotFile::Session archived = session;
+    archived.journalGeneration = 0;
+    const QByteArray compressed = qCompress(SnapshotFile::toData(store, archived));
+
+    Entry entry;
+    entry.name = name;
+    entry.characterCount = store.size();
+
+    QVector<Entry> entries = m_entries;
+    int newEntry = indexOf(name);
+    if (newEntry >= 0) {
+        entries[newEntry] = entry;
+    } else {
+        newEntry = entries.size();
+        entries.append(entry);
+    }
+
+    if (!rewrite(entries, newEntry, compressed)) {
+        return false;
+    }
+    TRACE_EVENT(FileSaved, store.size(), newEntry);
+    return true;
+}
+
+/**
+ * @brief Entfernt eine Begegnung
+ *
+ * @param name Der Name der Begegnung
+ * @return true, wenn die Begegnung entfernt und das Archiv geschrieben wurde
+ */
+bool EncounterArchive::remove(const QString &name)
+{
+    const int index = indexOf(name);
+    if (index < 0) {
+        return false;
+    }
+
+    QVector<Entry> entries = m_entries;
+    entries.remove(index);
+    return rewrite(entries, -1, QByteArray());
+}
+
+/**
+ * @brief Prüft die Kennung am Dateianfang
+ *
+ * @param filename Der Dateiname
+ * @return true, wenn die Datei ein Archiv ist
+ */
+bool EncounterArchive::isArchive(const QString &filename)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    return file.read(sizeof(Magic)) == QByteArray(Magic, sizeof(Magic));
+}
+
+/**
+ * @brief Gibt die Position einer Begegnung im Index zurück
+ *
+ * @param name Der Name der Begegnung
+ * @return Die Position oder -1
+ */
+int EncounterArchive::indexOf(const QString &name) const
+{
+    for (int i = 0; i < m_entries.size(); ++i) {
+        if (m_entries.at(i).name == name) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Schreibt das Archiv mit geändertem Index neu
+ *
+ * Die Positionen in entries beziehen sich noch auf die alte Datei; von dort
+ * werden die unveränderten Begegnungen Stück für Stück kopiert.
+ *
+ * @param entries Der neue Index
+ * @param newEntry Position des neuen Eintrags in entries (-1 = keiner)
+ * @param newData Die komprimierten Daten des neuen Eintrags
+ * @return true, wenn das Archiv vollständig geschrieben wurde
+ */
+bool EncounterArchive::rewrite(const QVector<Entry> &entries, int newEntry, const QByteArray &newData)
+{
+    // Neue Positionen berechnen; die Daten folgen lückenlos auf den Kopf
+    QVector<Entry> written = entries;
+    quint64 offset = HeaderSize;
+    for (int i = 0; i < written.size(); ++i) {
+        if (i == newEntry) {
+            written[i].size = quint64(newData.size());
+        }
+        written[i].offset = offset;
+        offset += written[i].size;
+    }
+
+    QByteArray index;
+    {
+        QDataStream stream(&index, QIODevice::WriteOnly);
+        stream.setByteOrder(QDataStream::LittleEndian);
+        for (const Entry &entry : written) {
+            stream << entry.offset << entry.size << quint32(entry.characterCount) << quint32(entry.name.size());
+            for (const QChar c : entry.name) {
+                stream << quint16(c.unicode());
+            }
+        }
+    }
+
+    QFile source(m_filename);
+    if (written.size() > (newEntry >= 0 ? 1 : 0) && !source.open(QIODevice::ReadOnly)) {
+        TRACE_WARNING(lcStorage) << "Archiv konnte nicht gelesen werden:" << m_filename;
+        return false;
+    }
+
+    QSaveFile file(m_filename);
+    if (!file.open(QIODevice::WriteOnly)) {
+        TRACE_WARNING(lcStorage) << "Archiv konnte nicht geschrieben werden:" << m_filename;
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.writeRawData(Magic, sizeof(Magic));
+    stream << Version << quint32(written.size()) << offset << quint64(index.size());
+
+    // Unveränderte Begegnungen komprimiert übernehmen, ohne sie zu entpacken
+    for (int i = 0; i < written.size(); ++i) {
+        if (i == newEntry) {
+            stream.writeRawData(newData.constData(), newData.size());
+            continue;
+        }
+        const QByteArray data = source.seek(qint64(entries.at(i).offset))
+            ? source.read(qint64(entries.at(i).size)) : QByteArray();
+        if (quint64(data.size()) != entries.at(i).size) {
+            TRACE_WARNING(lcStorage) << "Archiv ist kürzer als sein Index:" << m_filename;
+            file.cancelWriting();
+            return false;
+        }
+        stream.writeRawData(data.constData(), data.size());
+    }
+    stream.writeRawData(index.constData(), index.size());
+    source.close();
+
+    if (stream.status() != QDataStream::Ok || !file.commit()) {
+        TRACE_WARNING(lcStorage) << "Archiv konnte nicht geschrieben werden:" << m_filename;
+        return false;
+    }
+
+    m_entries = written;
+    return true;
+}
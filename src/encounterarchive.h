@@ -0,0 +1,165 @@
+#ifndef ENCOUNTERARCHIVE_H
+#define ENCOUNTERARCHIVE_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "characterstore.h"
+#include "snapshotfile.h"
+
+/**
+ * @brief Die EncounterArchive-Klasse speichert viele benannte Begegnungen in einer Datei.
+ *
+ * Jede Begegnung wird als Snapshot (siehe SnapshotFile::toData()) aufgebaut,
+ * einzeln mit qCompress() komprimiert und hintereinander in die Datei
+ * geschrieben. Ein Index am Ende der Datei nennt für jede Begegnung Name,
+ * Position, Länge und Anzahl der Charaktere; der Kopf zeigt auf den Index.
+ *
+ * open() liest nur Kopf und Index. load() springt mit seek() zu genau einer
+ * Begegnung, liest und entpackt nur diese. Die übrigen Begegnungen werden
+ * dabei nicht gelesen, egal wie viele das Archiv enthält.
+ *
+ * Aufbau (alle Zahlen Little Endian):
+ * - Kopf (32 Byte): "DNDARCH" + '\0', Version, Anzahl der Begegnungen,
+ *   Position und Länge des Index
+ * - Daten: die komprimierten Begegnungen
+ * - Index: pro Begegnung Position (64 Bit), Länge (64 Bit), Anzahl der
+ *   Charaktere, Länge des Namens und der Name als UTF-16
+ *
+ * save() und remove() schreiben das Archiv über QSaveFile neu. Die
+ * unveränderten Begegnungen werden dabei komprimiert kopiert, ohne sie zu
+ * entpacken.
+ */
+class EncounterArchive
+{
+public:
+    /**
+     * @brief Ein Eintrag im Index.
+     */
+    struct Entry {
+        QString name;            ///< Der Name der Begegnung
+        quint64 offset = 0;      ///< Position der komprimierten Daten in der Datei
+        quint64 size = 0;        ///< Länge der komprimierten Daten
+        int characterCount = 0;  ///< Anzahl der Charaktere
+    };
+
+    static constexpr quint32 Version = 1;      ///< Aktuelle Formatversion
+    static constexpr quint32 HeaderSize = 32;  ///< Größe des Kopfes in Byte
+
+    /**
+     * @brief Erstellt ein Archiv für eine Datei.
+     *
+     * Die Datei wird erst mit open() gelesen.
+     *
+     * @param filename Der Dateiname des Archivs
+     */
+    explicit EncounterArchive(const QString &filename);
+
+    /**
+     * @brief Liest Kopf und Index des Archivs.
+     *
+     * @return true, wenn die Datei ein gültiges Archiv ist
+     */
+    bool open();
+
+    /**
+     * @brief Gibt den Dateinamen des Archivs zurück.
+     *
+     * @return Der Dateiname
+     */
+    QString filename() const;
+
+    /**
+     * @brief Gibt die Anzahl der Begegnungen zurück.
+     *
+     * @return Die Anzahl
+     */
+    int count() const;
+
+    /**
+     * @brief Gibt die Namen aller Begegnungen in der gespeicherten Reihenfolge zurück.
+     *
+     * @return Die Namen
+     */
+    QStringList names() const;
+
+    /**
+     * @brief Gibt den Index des Archivs zurück.
+     *
+     * @return Ein Eintrag pro Begegnung
+     */
+    QVector<Entry> entries() const;
+
+    /**
+     * @brief Prüft, ob das Archiv eine Begegnung enthält.
+     *
+     * @param name Der Name der Begegnung
+     * @return true, wenn es eine Begegnung mit diesem Namen gibt
+     */
+    bool contains(const QString &name) const;
+
+    /**
+     * @brief Lädt eine einzelne Begegnung.
+     *
+     * Bei einem Fehler bleiben store und session unverändert.
+     *
+     * @param name Der Name der Begegnung
+     * @param store Erhält die Charaktere
+     * @param session Erhält die Sitzung
+     * @return true, wenn die Begegnung gefunden und gültig war
+     */
+    bool load(const QString &name, CharacterStore *store, SnapshotFile::Session *session) const;
+
+    /**
+     * @brief Speichert eine Begegnung.
+     *
+     * Eine vorhandene Begegnung gleichen Namens wird ersetzt, sonst wird die
+     * neue am Ende angehängt. Fehlt die Datei, wird ein neues Archiv angelegt.
+     *
+     * @param name Der Name der Begegnung
+     * @param store Die Charaktere
+     * @param session Die Sitzung
+     * @return true, wenn das Archiv vollständig geschrieben wurde
+     */
+    bool save(const QString &name, const CharacterStore &store, const SnapshotFile::Session &session);
+
+    /**
+     * @brief Entfernt eine Begegnung.
+     *
+     * @param name Der Name der Begegnung
+     * @return true, wenn die Begegnung entfernt und das Archiv geschrieben wurde
+     */
+    bool remove(const QString &name);
+
+    /**
+     * @brief Prüft anhand der Kennung am Dateianfang, ob eine Datei ein Archiv ist.
+     *
+     * @param filename Der Dateiname
+     * @return true, wenn die Datei mit "DNDARCH" beginnt
+     */
+    static bool isArchive(const QString &filename);
+
+private:
+    /**
+     * @brief Gibt die Position einer Begegnung im Index zurück.
+     *
+     * @param name Der Name der Begegnung
+     * @return Die Position oder -1
+     */
+    int indexOf(const QString &name) const;
+
+    /**
+     * @brief Schreibt das Archiv mit geändertem Index neu.
+     *
+     * @param entries Der neue Index, Positionen noch aus der alten Datei
+     * @param newEntry Position des neuen Eintrags in entries (-1 = keiner)
+     * @param newData Die komprimierten Daten des neuen Eintrags
+     * @return true, wenn das Archiv vollständig geschrieben wurde
+     */
+    bool rewrite(const QVector<Entry> &entries, int newEntry, const QByteArray &newData);
+
+    QString m_filename;        ///< Der Dateiname des Archivs
+    QVector<Entry> m_entries;  ///< Der Index
+};
+
+#endif // ENCOUNTERARCHIVE_H
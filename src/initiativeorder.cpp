@@ -0,0 +1,160 @@
+#include "initiativeorder.h"
+#include "characterstore.h"
+#include <algorithm>
+#include <numeric>
+
+/**
+ * @brief Entfernt alle Einträge
+ */
+void InitiativeOrder::clear()
+{
+    m_order.clear();
+    m_totals.clear();
+}
+
+/**
+ * @brief Baut die Reihenfolge komplett aus dem Store neu auf
+ *
+ * @param store Der Store mit den aktuellen Werten
+ */
+void InitiativeOrder::rebuild(const CharacterStore &store)
+{
+    const int count = store.size();
+    const CharacterStore::RollValue *rolls = store.rollColumn(CharacterStore::InitiativeRoll);
+    const CharacterStore::ModifierValue *modifiers = store.modifierColumn(CharacterStore::InitiativeModifier);
+
+    // Übernimmt die Schlüssel aus den beiden Spalten
+    m_totals.resize(count);
+    for (int i = 0; i < count; ++i) {
+        m_totals[i] = rolls[i] + modifiers[i];
+    }
+
+    // Sortiert die Indizes absteigend nach Initiative, bei Gleichstand nach Index
+    m_order.resize(count);
+    std::iota(m_order.begin(), m_order.end(), 0);
+    const int *totals = m_totals.constData();
+    std::sort(m_order.begin(), m_order.end(), [totals](int a, int b) {
+        return totals[a] > totals[b] || (totals[a] == totals[b] && a < b);
+    });
+}
+
+/**
+ * @brief Fügt einen neu angehängten Charakter ein
+ *
+ * @param index Der Index des Charakters
+ * @param total Die Gesamt-Initiative des Charakters
+ */
+void InitiativeOrder::append(int index, int total)
+{
+    m_totals.append(total);
+    m_order.insert(lowerBound(total, index), index);
+}
+
+/**
+ * @brief Entfernt einen Charakter aus der Reihenfolge
+ *
+ * @param index Der Index des entfernten Charakters
+ */
+void InitiativeOrder::remove(int index)
+{
+    m_order.removeAt(rank(index));
+    m_totals.removeAt(index);
+
+    // Die nachfolgenden Charaktere rücken im Store um eins nach vorne.
+    // Die relative Reihenfolge bleibt dabei erhalten.
+    for (int &entry : m_order) {
+        if (entry > index) {
+            --entry;
+        }
+    }
+}
+
+/**
+ * @brief Aktualisiert die Gesamt-Initiative eines Charakters
+ *
+ * Die neue Position wird per binärer Suche bestimmt, solange der Eintrag noch
+ * mit seinem alten Schlüssel im Array steht. Danach verschiebt std::rotate nur
+ * die Einträge zwischen alter und neuer Position.
+ *
+ * @param index Der Index des Charakters
+ * @param total Die neue Gesamt-Initiative
+ */
+void InitiativeOrder::update(int index, int total)
+{
+    if (m_totals[index] == total) {
+        return;
+    }
+
+    const int oldPos = rank(index);
+    const int insertPos = lowerBound(total, index);
+    m_totals[index] = total;
+
+    int *order = m_order.data();
+    if (insertPos > oldPos) {
+        // Nach hinten: der Bereich dazwischen rückt eine Position vor
+        std::rotate(order + oldPos, order + oldPos + 1, order + insertPos);
+    } else if (insertPos < oldPos) {
+        // Nach vorne: der Bereich dazwischen rückt eine Position zurück
+        std::rotate(order + insertPos, order + oldPos, order + oldPos + 1);
+    }
+}
+
+/**
+ * @brief Gibt die Anzahl der Einträge zurück
+ *
+ * @return Die Anzahl der Charaktere
+ */
+int InitiativeOrder::size() const
+{
+    return m_order.size();
+}
+
+/**
+ * @brief Gibt die Position eines Charakters in der Reihenfolge zurück
+ *
+ * @param index Der Index des Charakters
+ * @return Der Rang (0 = höchste Initiative)
+ */
+int InitiativeOrder::rank(int index) const
+{
+    return lowerBound(m_totals[index], index);
+}
+
+/**
+ * @brief Gibt den Charakter-Index an einer Position zurück
+ *
+ * @param rank Die Position in der Reihenfolge
+ * @return Der Index des Charakters im Store
+ */
+int InitiativeOrder::indexAt(int rank) const
+{
+    return m_order[rank];
+}
+
+/**
+ * @brief Gibt die sortierten Charakter-Indizes zurück
+ *
+ * @return Die Indizes, höchste Initiative zuerst
+ */
+const QVector<int> &InitiativeOrder::indices() const
+{
+    return m_order;
+}
+
+/**
+ * @brief Sucht die erste Position, deren Eintrag nicht vor (total, index) liegt
+ *
+ * @param total Die Gesamt-Initiative des Schlüssels
+ * @param index Der Charakter-Index des Schlüssels
+ * @return Die Einfügeposition
+ */
+int InitiativeOrder::lowerBound(int total, int index) const
+{
+    const int *totals = m_totals.constData();
+    auto it = std::lower_bound(m_order.constBegin(), m_order.constEnd(), index,
+                               [totals, total](int entry, int key) {
+                                   return totals[entry] > total
+                                       || (totals[entry] == total && entry < key);
+                               });
+    return static_cast<int>(it - m_order.constBegin());
+}
@@ -0,0 +1,116 @@
+#ifndef INITIATIVEORDER_H
+#define INITIATIVEORDER_H
+
+#include <QVector>
+
+class CharacterStore;
+
+/**
+ * @brief Die InitiativeOrder-Klasse hält die Initiative-Reihenfolge dauerhaft sortiert.
+ *
+ * Statt bei jeder Abfrage alle Charaktere zu kopieren und neu zu sortieren,
+ * speichert diese Klasse eine sortierte Permutation der Charakter-Indizes.
+ * Ändert sich die Initiative eines einzelnen Charakters, wird nur dessen
+ * Eintrag verschoben.
+ *
+ * Die Reihenfolge ist absteigend nach Gesamt-Initiative; bei Gleichstand
+ * kommt der Charakter mit dem kleineren Index zuerst. Dadurch ist jeder
+ * Schlüssel eindeutig und die Position eines Charakters lässt sich per
+ * binärer Suche in O(log n) finden.
+ *
+ * C++ Konzept: Binäre Suche auf sortierten Daten
+ * std::lower_bound findet in einem sortierten Bereich die erste Position,
+ * an der ein Wert eingefügt werden kann, ohne die Sortierung zu verletzen.
+ * Das Verschieben eines einzelnen Eintrags erledigt std::rotate, das nur den
+ * Bereich zwischen alter und neuer Position bewegt.
+ */
+class InitiativeOrder
+{
+public:
+    /**
+     * @brief Entfernt alle Einträge.
+     */
+    void clear();
+
+    /**
+     * @brief Baut die Reihenfolge komplett aus dem Store neu auf (O(n log n)).
+     *
+     * Wird verwendet, wenn sich viele Werte gleichzeitig ändern, z.B. nach
+     * rollAllInitiatives() oder dem Laden einer Datei.
+     *
+     * @param store Der Store mit den aktuellen Werten
+     */
+    void rebuild(const CharacterStore &store);
+
+    /**
+     * @brief Fügt einen neu angehängten Charakter ein.
+     *
+     * @param index Der Index des Charakters (muss gleich size() sein)
+     * @param total Die Gesamt-Initiative des Charakters
+     */
+    void append(int index, int total);
+
+    /**
+     * @brief Entfernt einen Charakter aus der Reihenfolge.
+     *
+     * Alle größeren Indizes rücken wie im Store um eins nach vorne.
+     *
+     * @param index Der Index des entfernten Charakters
+     */
+    void remove(int index);
+
+    /**
+     * @brief Aktualisiert die Gesamt-Initiative eines Charakters.
+     *
+     * @param index Der Index des Charakters
+     * @param total Die neue Gesamt-Initiative
+     */
+    void update(int index, int total);
+
+    /**
+     * @brief Gibt die Anzahl der Einträge zurück.
+     *
+     * @return Die Anzahl der Charaktere
+     */
+    int size() const;
+
+    /**
+     * @brief Gibt die Position eines Charakters in der Reihenfolge zurück (O(log n)).
+     *
+     * @param index Der Index des Charakters
+     * @return Der Rang (0 = höchste Initiative)
+     */
+    int rank(int index) const;
+
+    /**
+     * @brief Gibt den Charakter-Index an einer Position der Reihenfolge zurück.
+     *
+     * @param rank Die Position (0 = höchste Initiative)
+     * @return Der Index des Charakters im Store
+     */
+    int indexAt(int rank) const;
+
+    /**
+     * @brief Gibt die sortierten Charakter-Indizes zurück.
+     *
+     * Erlaubt das Durchlaufen in Initiative-Reihenfolge, ohne Charaktere zu kopieren.
+     *
+     * @return Die Indizes, höchste Initiative zuerst
+     */
+    const QVector<int> &indices() const;
+
+private:
+    /**
+     * @brief Sucht die erste Position, deren Eintrag nicht vor (total, index) liegt.
+     *
+     * @param total Die Gesamt-Initiative des Schlüssels
+     * @param index Der Charakter-Index des Schlüssels
+     * @return Die Einfügeposition
+     */
+    int lowerBound(int total, int index) const;
+
+    QVector<int> m_order;   ///< Charakter-Indizes in Initiative-Reihenfolge
+    QVector<int> m_totals;  ///< Gesamt-Initiative je Charakter-Index
+};
+
+#endif // INITIATIVEORDER_H
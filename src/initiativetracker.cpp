@@ -1,8 +1,26 @@
 #include "initiativetracker.h"
+#include "encounterarchive.h"
+#include "rostercsvreader.h"
+#include "rosterstreamreader.h"
+#include "snapshotfile.h"
+#include "trace.h"
 #include <algorithm>
+#include <limits>
 #include <QDir>
+#include <QSaveFile>
 #include <QStandardPaths>
-#include <QDebug>
+#include <random>
+
+/**
+ * @brief Erzeugt einen 64-Bit-Seed aus dem Zufallsgerät des Systems
+ * 
+ * @return Ein zufälliger Seed für die DiceEngine
+ */
+static quint64 randomSeed()
+{
+    std::random_device rd;
+    return (static_cast<quint64>(rd()) << 32) | static_cast<quint64>(rd());
+}
 
 /**
  * @brief Konstruktor für den InitiativeTracker
@@ -13,7 +31,56 @@
  */
 InitiativeTracker::InitiativeTracker(QObject *parent)
     : QObject(parent)
+    , m_dice(randomSeed())
+    , m_nextRollKey(0)
+    , m_batchDepth(0)
+    , m_pendingReset(false)
+    , m_pendingInsertFirst(-1)
+    , m_pendingUpdateFirst(-1)
+    , m_pendingUpdateLast(-1)
+    , m_pendingFields(0)
+    , m_pendingSignals(0)
+{
+}
+
+/**
+ * @brief Beginnt einen Batch
+ * 
+ * @param tracker Der Tracker, dessen Änderungen gesammelt werden
+ */
+InitiativeTracker::ChangeBatch::ChangeBatch(InitiativeTracker *tracker)
+    : m_tracker(tracker)
+{
+    m_tracker->beginChanges();
+}
+
+/**
+ * @brief Beendet den Batch
+ */
+InitiativeTracker::ChangeBatch::~ChangeBatch()
+{
+    m_tracker->endChanges();
+}
+
+/**
+ * @brief Beginnt das Sammeln von Änderungen
+ */
+void InitiativeTracker::beginChanges()
+{
+    ++m_batchDepth;
+}
+
+/**
+ * @brief Beendet das Sammeln von Änderungen
+ * 
+ * Erst beim Ende des äußersten Batches werden die Signale gesendet.
+ */
+void InitiativeTracker::endChanges()
 {
+    Q_ASSERT(m_batchDepth > 0);
+    if (--m_batchDepth == 0) {
+        flushChanges();
+    }
 }
 
 /**
@@ -23,17 +90,52 @@ InitiativeTracker::InitiativeTracker(QObject *parent)
  */
 void InitiativeTracker::addCharacter(const Character &character)
 {
-    qDebug() << "InitiativeTracker::addCharacter: Start - Name:" << character.getName();
-    
     // Füge den Charakter zur Liste hinzu
-    m_characters.append(character);
-    qDebug() << "InitiativeTracker::addCharacter: Charakter hinzugefügt, neue Größe:" << m_characters.size();
+    m_store.append(character);
+    m_store.setValue(m_store.size() - 1, CharacterStore::RollKey, m_nextRollKey++);
+    m_order.append(m_store.size() - 1, character.getTotalInitiative());
+    notifyInserted(m_store.size() - 1, m_store.size() - 1);
+    TRACE_EVENT(CharacterAdded, m_store.size() - 1, 0);
+    TRACE_DEBUG(lcTracker) << "addCharacter:" << character.getName() << "neue Größe:" << m_store.size();
     
     // Sende ein Signal, dass sich die Charakterliste geändert hat
-    qDebug() << "InitiativeTracker::addCharacter: Sende Signal charactersChanged";
-    emit charactersChanged();
+    notifyCoarse(CharactersChangedSignal);
+}
+
+/**
+ * @brief Hängt viele Charaktere auf einmal an
+ * 
+ * @param characters Die anzuhängenden Charaktere
+ */
+void InitiativeTracker::appendCharacters(const CharacterStore &characters)
+{
+    if (characters.isEmpty()) {
+        return;
+    }
+    
+    const int first = m_store.size();
+    m_store.append(characters);
+    const int count = m_store.size();
+    
+    // Neue Würfelschlüssel; Ereignisse aus einer anderen Sitzung gelten hier nicht
+    int *keys = m_store.column(CharacterStore::RollKey);
+    for (int i = first; i < count; ++i) {
+        keys[i] = m_nextRollKey++;
+    }
+    for (CharacterStore::Field field : { CharacterStore::InitiativeRollEvent,
+                                         CharacterStore::WillSaveRollEvent,
+                                         CharacterStore::ReflexSaveRollEvent,
+                                         CharacterStore::FortitudeSaveRollEvent }) {
+        int *column = m_store.column(field);
+        std::fill(column + first, column + count, -1);
+    }
     
-    qDebug() << "InitiativeTracker::addCharacter: Ende";
+    // Einmal sortieren ist billiger als jeden Charakter einzeln einzufügen
+    m_order.rebuild(m_store);
+    notifyInserted(first, count - 1);
+    TRACE_DEBUG(lcTracker) << "appendCharacters:" << count - first << "neue Größe:" << count;
+    
+    notifyCoarse(CharactersChangedSignal);
 }
 
 /**
@@ -44,12 +146,16 @@ void InitiativeTracker::addCharacter(const Character &character)
 void InitiativeTracker::removeCharacter(int index)
 {
     // Überprüfe, ob der Index gültig ist
-    if (index >= 0 && index < m_characters.size()) {
+    if (index >= 0 && index < m_store.size()) {
         // Entferne den Charakter aus der Liste
-        m_characters.removeAt(index);
+        notifyAboutToBeRemoved(index, index);
+        m_store.removeAt(index);
+        m_order.remove(index);
+        notifyRemoved(index, index);
+        TRACE_EVENT(CharacterRemoved, index, 1);
         
         // Sende ein Signal, dass sich die Charakterliste geändert hat
-        emit charactersChanged();
+        notifyCoarse(CharactersChangedSignal);
     }
 }
 
@@ -59,10 +165,19 @@ void InitiativeTracker::removeCharacter(int index)
 void InitiativeTracker::clearCharacters()
 {
     // Leere die Charakterliste
-    m_characters.clear();
+    const int count = m_store.size();
+    if (count > 0) {
+        notifyAboutToBeRemoved(0, count - 1);
+    }
+    m_store.clear();
+    m_order.clear();
+    if (count > 0) {
+        notifyRemoved(0, count - 1);
+        TRACE_EVENT(CharacterRemoved, 0, count);
+    }
     
     // Sende ein Signal, dass sich die Charakterliste geändert hat
-    emit charactersChanged();
+    notifyCoarse(CharactersChangedSignal);
 }
 
 /**
@@ -72,7 +187,143 @@ void InitiativeTracker::clearCharacters()
  */
 QVector<Character> InitiativeTracker::getCharacters() const
 {
-    return m_characters;
+    return m_store.toVector();
+}
+
+/**
+ * @brief Gibt die Anzahl der Charaktere zurück
+ * 
+ * @return Die Anzahl der Charaktere
+ */
+int InitiativeTracker::size() const
+{
+    return m_store.size();
+}
+
+/**
+ * @brief Prüft, ob keine Charaktere vorhanden sind
+ * 
+ * @return true, wenn die Liste leer ist
+ */
+bool InitiativeTracker::isEmpty() const
+{
+    return m_store.isEmpty();
+}
+
+/**
+ * @brief Gibt lesenden Zugriff auf die gespeicherten Charaktere
+ * 
+ * @return Eine konstante Referenz auf den CharacterStore
+ */
+const CharacterStore &InitiativeTracker::store() const
+{
+    return m_store;
+}
+
+/**
+ * @brief Gibt eine schreibgeschützte Sicht auf einen Charakter zurück
+ * 
+ * @param index Der Index des Charakters
+ * @return Die Sicht auf den Charakter
+ */
+CharacterView InitiativeTracker::characterView(int index) const
+{
+    Q_ASSERT(index >= 0 && index < m_store.size());
+    return m_store.view(index);
+}
+
+/**
+ * @brief Gibt einen unveränderlichen Schnappschuss aller Charaktere zurück
+ * 
+ * @return Eine implizit geteilte Kopie des Stores
+ */
+CharacterStore InitiativeTracker::snapshot() const
+{
+    return m_store;
+}
+
+/**
+ * @brief Gibt eine Kopie eines einzelnen Charakters zurück
+ * 
+ * @param index Der Index des Charakters
+ * @return Der Charakter oder ein leerer Charakter bei ungültigem Index
+ */
+Character InitiativeTracker::getCharacter(int index) const
+{
+    // Überprüfe, ob der Index gültig ist
+    if (index < 0 || index >= m_store.size()) {
+        qWarning() << "Ungültiger Index:" << index;
+        return Character();
+    }
+    
+    return m_store.at(index);
+}
+
+/**
+ * @brief Setzt den Initiative-Modifikator eines Charakters
+ * 
+ * @param index Der Index des Charakters
+ * @param modifier Der neue Initiative-Modifikator
+ */
+void InitiativeTracker::setInitiativeModifier(int index, int modifier)
+{
+    if (index >= 0 && index < m_store.size()) {
+        // Ein unveränderter (oder auf den alten Wert begrenzter) Modifikator
+        // ändert weder Reihenfolge noch Anzeige
+        if (m_store.setChanged(index, CharacterStore::InitiativeModifier, modifier) == 0) {
+            return;
+        }
+        m_order.update(index, m_store.totalInitiative(index));
+        notifyUpdated(index, index, CharacterStore::fieldBit(CharacterStore::InitiativeModifier));
+    }
+}
+
+/**
+ * @brief Setzt den Willenskraft-Modifikator eines Charakters
+ * 
+ * @param index Der Index des Charakters
+ * @param modifier Der neue Willenskraft-Modifikator
+ */
+void InitiativeTracker::setWillSave(int index, int modifier)
+{
+    if (index >= 0 && index < m_store.size()) {
+        const CharacterStore::FieldMask changed = m_store.setChanged(index, CharacterStore::WillSave, modifier);
+        if (changed != 0) {
+            notifyUpdated(index, index, changed);
+        }
+    }
+}
+
+/**
+ * @brief Setzt den Reflex-Modifikator eines Charakters
+ * 
+ * @param index Der Index des Charakters
+ * @param modifier Der neue Reflex-Modifikator
+ */
+void InitiativeTracker::setReflexSave(int index, int modifier)
+{
+    if (index >= 0 && index < m_store.size()) {
+        const CharacterStore::FieldMask changed = m_store.setChanged(index, CharacterStore::ReflexSave, modifier);
+        if (changed != 0) {
+            notifyUpdated(index, index, changed);
+        }
+    }
+}
+
+/**
+ * @brief Setzt den Konstitution-Modifikator eines Charakters
+ * 
+ * @param index Der Index des Charakters
+ * @param modifier Der neue Konstitution-Modifikator
+ */
+void InitiativeTracker::setFortitudeSave(int index, int modifier)
+{
+    if (index >= 0 && index < m_store.size()) {
+        const CharacterStore::FieldMask changed = m_store.setChanged(index, CharacterStore::FortitudeSave, modifier);
+        if (changed != 0) {
+            notifyUpdated(index, index, changed);
+        }
+    }
 }
 
 /**
@@ -84,12 +335,14 @@ QVector<Character> InitiativeTracker::getCharacters() const
 void InitiativeTracker::updateCharacter(int index, const Character &character)
 {
     // Überprüfe, ob der Index gültig ist
-    if (index >= 0 && index < m_characters.size()) {
+    if (index >= 0 && index < m_store.size()) {
         // Aktualisiere den Charakter
-        m_characters[index] = character;
+        const CharacterStore::FieldMask changed = m_store.set(index, character);
+        m_order.update(index, character.getTotalInitiative());
+        notifyUpdated(index, index, changed);
         
         // Sende ein Signal, dass sich die Charakterliste geändert hat
-        emit charactersChanged();
+        notifyCoarse(CharactersChangedSignal);
     }
 }
 
@@ -98,13 +351,17 @@ void InitiativeTracker::updateCharacter(int index, const Character &character)
  */
 void InitiativeTracker::rollAllInitiatives()
 {
+    // Die Signale erst senden, wenn auch die Reihenfolge aktuell ist
+    ChangeBatch batch(this);
+    
     // Würfle die Initiative für jeden Charakter
-    for (int i = 0; i < m_characters.size(); ++i) {
-        m_characters[i].rollInitiative();
-    }
+    rollColumn(CharacterStore::InitiativeRoll);
+    
+    // Alle Schlüssel haben sich geändert, daher einmal komplett neu sortieren
+    m_order.rebuild(m_store);
     
     // Sende ein Signal, dass die Initiative gewürfelt wurde
-    emit initiativeRolled();
+    notifyCoarse(InitiativeRolledSignal);
 }
 
 /**
@@ -115,12 +372,16 @@ void InitiativeTracker::rollAllInitiatives()
 void InitiativeTracker::rollInitiativeForCharacter(int index)
 {
     // Überprüfe, ob der Index gültig ist
-    if (index >= 0 && index < m_characters.size()) {
+    if (index >= 0 && index < m_store.size()) {
+        // Die Signale erst senden, wenn auch die Reihenfolge aktuell ist
+        ChangeBatch batch(this);
+        
         // Würfle die Initiative für den Charakter
-        m_characters[index].rollInitiative();
+        rollSingle(index, CharacterStore::InitiativeRoll);
+        m_order.update(index, m_store.totalInitiative(index));
         
         // Sende ein Signal, dass die Initiative gewürfelt wurde
-        emit initiativeRolled();
+        notifyCoarse(InitiativeRolledSignal);
     }
 }
 
@@ -131,18 +392,198 @@ void InitiativeTracker::rollInitiativeForCharacter(int index)
  */
 QVector<Character> InitiativeTracker::getSortedInitiativeOrder() const
 {
-    // Erstelle eine Kopie der Charakterliste
-    QVector<Character> sortedCharacters = m_characters;
-    
-    // Sortiere die Charaktere nach Initiative (absteigend)
-    std::sort(sortedCharacters.begin(), sortedCharacters.end(), 
-              [](const Character &a, const Character &b) {
-                  return a.getTotalInitiative() > b.getTotalInitiative();
-              });
+    // Setze die Charaktere in der bereits sortierten Reihenfolge zusammen
+    QVector<Character> sortedCharacters;
+    sortedCharacters.reserve(m_store.size());
+    for (int index : m_order.indices()) {
+        sortedCharacters.append(m_store.at(index));
+    }
     
     return sortedCharacters;
 }
 
+/**
+ * @brief Gibt den sortierten Initiative-Index zurück
+ * 
+ * @return Der Index mit den Charakter-Indizes, höchste Initiative zuerst
+ */
+const InitiativeOrder &InitiativeTracker::initiativeOrder() const
+{
+    return m_order;
+}
+
+/**
+ * @brief Gibt den Rang eines Charakters in der Initiative-Reihenfolge zurück
+ * 
+ * @param index Der Index des Charakters
+ * @return Der Rang oder -1 bei ungültigem Index
+ */
+int InitiativeTracker::initiativeRank(int index) const
+{
+    if (index < 0 || index >= m_store.size()) {
+        return -1;
+    }
+    
+    return m_order.rank(index);
+}
+
+/**
+ * @brief Gibt den Sitzungsschlüssel zurück
+ * 
+ * @return Der Seed der DiceEngine
+ */
+quint64 InitiativeTracker::sessionSeed() const
+{
+    return m_dice.seed();
+}
+
+/**
+ * @brief Gibt die Anzahl der bisherigen Würfelereignisse zurück
+ * 
+ * @return Die Nummer des nächsten Würfelereignisses
+ */
+quint64 InitiativeTracker::rollEventCount() const
+{
+    return m_dice.batch();
+}
+
+/**
+ * @brief Beginnt eine neue Sitzung mit dem angegebenen Schlüssel
+ * 
+ * @param seed Der neue Sitzungsschlüssel
+ */
+void InitiativeTracker::setSessionSeed(quint64 seed)
+{
+    m_dice = DiceEngine(seed);
+    
+    // Die vorhandenen Würfe lassen sich mit dem neuen Schlüssel nicht nachrechnen
+    for (CharacterStore::Field field : { CharacterStore::InitiativeRollEvent,
+                                         CharacterStore::WillSaveRollEvent,
+                                         CharacterStore::ReflexSaveRollEvent,
+                                         CharacterStore::FortitudeSaveRollEvent }) {
+        int *events = m_store.column(field);
+        std::fill(events, events + m_store.size(), -1);
+    }
+    
+    if (!m_store.isEmpty()) {
+        notifyUpdated(0, m_store.size() - 1,
+                      CharacterStore::fieldBit(CharacterStore::InitiativeRollEvent)
+                      | CharacterStore::fieldBit(CharacterStore::WillSaveRollEvent)
+                      | CharacterStore::fieldBit(CharacterStore::ReflexSaveRollEvent)
+                      | CharacterStore::fieldBit(CharacterStore::FortitudeSaveRollEvent));
+    }
+}
+
+/**
+ * @brief Gibt den Zustand der Sitzung zurück
+ * 
+ * @return Sitzungsschlüssel, Ereigniszähler und nächster Würfelschlüssel
+ */
+SnapshotFile::Session InitiativeTracker::session() const
+{
+    SnapshotFile::Session state;
+    state.seed = m_dice.seed();
+    state.rollEvents = m_dice.batch();
+    state.nextRollKey = m_nextRollKey;
+    return state;
+}
+
+/**
+ * @brief Übernimmt Charaktere und Sitzung
+ * 
+ * @param store Die Charaktere
+ * @param session Die fortzusetzende Sitzung
+ */
+void InitiativeTracker::restore(const CharacterStore &store, const SnapshotFile::Session &session)
+{
+    // Setze die gespeicherte Sitzung fort; Würfelschlüssel und -ereignisse
+    // stehen schon in den Spalten
+    m_store = store;
+    m_dice = DiceEngine(session.seed);
+    m_dice.setBatch(session.rollEvents);
+    m_nextRollKey = session.nextRollKey;
+    
+    // Ein beschädigter Zähler darf keine Schlüssel doppelt vergeben
+    for (int i = 0; i < m_store.size(); ++i) {
+        m_nextRollKey = qMax(m_nextRollKey, m_store.value(i, CharacterStore::RollKey) + 1);
+    }
+    
+    finishLoading();
+}
+
+/**
+ * @brief Gibt den Würfelschlüssel eines Charakters zurück
+ * 
+ * @param index Der Index des Charakters
+ * @return Der Würfelschlüssel oder -1 bei ungültigem Index
+ */
+int InitiativeTracker::rollKey(int index) const
+{
+    if (index < 0 || index >= m_store.size()) {
+        return -1;
+    }
+    
+    return m_store.value(index, CharacterStore::RollKey);
+}
+
+/**
+ * @brief Gibt das Würfelereignis eines Wurfs zurück
+ * 
+ * @param index Der Index des Charakters
+ * @param rollField Die Wurf-Spalte
+ * @return Die Ereignisnummer oder -1
+ */
+int InitiativeTracker::rollEvent(int index, CharacterStore::Field rollField) const
+{
+    if (index < 0 || index >= m_store.size()) {
+        return -1;
+    }
+    
+    return m_store.value(index, CharacterStore::rollEventField(rollField));
+}
+
+/**
+ * @brief Berechnet einen Wurf dieser Sitzung nach
+ * 
+ * @param event Die Nummer des Würfelereignisses
+ * @param rollKey Der Würfelschlüssel des Charakters
+ * @return Das W20-Ergebnis (1-20)
+ */
+int InitiativeTracker::replayRoll(quint64 event, int rollKey) const
+{
+    return DiceEngine::d20At(m_dice.seed(), event, rollKey);
+}
+
+/**
+ * @brief Prüft alle nachprüfbaren Würfe gegen die DiceEngine
+ * 
+ * @return true, wenn alle Würfe übereinstimmen
+ */
+bool InitiativeTracker::verifyRolls() const
+{
+    const int *keys = m_store.column(CharacterStore::RollKey);
+    
+    for (CharacterStore::Field field : { CharacterStore::InitiativeRoll,
+                                         CharacterStore::LastWillSaveRoll,
+                                         CharacterStore::LastReflexSaveRoll,
+                                         CharacterStore::LastFortitudeSaveRoll }) {
+        const CharacterStore::RollValue *rolls = m_store.rollColumn(field);
+        const int *events = m_store.column(CharacterStore::rollEventField(field));
+        for (int i = 0; i < m_store.size(); ++i) {
+            if (events[i] < 0) {
+                continue;
+            }
+            if (replayRoll(events[i], keys[i]) != rolls[i]) {
+                qWarning() << "Wurf passt nicht zur Sitzung:" << m_store.name(i)
+                           << "Spalte" << field << "Ereignis" << events[i];
+                return false;
+            }
+        }
+    }
+    
+    return true;
+}
+
 /**
  * @brief Speichert die Charakterliste in einer Datei
  * 
@@ -150,39 +591,75 @@ QVector<Character> InitiativeTracker::getSortedInitiativeOrder() const
  * @return true, wenn das Speichern erfolgreich war, sonst false
  */
 bool InitiativeTracker::saveToFile(const QString &filename)
+{
+    return writeJsonFile(filename, m_store, session());
+}
+
+/**
+ * @brief Schreibt Charaktere und Sitzung als JSON-Datei
+ * 
+ * Greift auf keine Member zu und darf daher in einem anderen Thread laufen.
+ * 
+ * @param filename Der Dateiname
+ * @param store Die zu speichernden Charaktere
+ * @param session Die zu speichernde Sitzung
+ * @return true, wenn die Datei vollständig geschrieben wurde
+ */
+bool InitiativeTracker::writeJsonFile(const QString &filename, const CharacterStore &store,
+                                      const SnapshotFile::Session &session)
 {
     // Erstelle ein JSON-Array für die Charaktere
     QJsonArray charactersArray;
     
     // Füge jeden Charakter als JSON-Objekt hinzu
-    for (const Character &character : m_characters) {
+    for (int i = 0; i < store.size(); ++i) {
         QJsonObject characterObject;
-        characterObject["name"] = character.getName();
-        characterObject["initiativeModifier"] = character.getInitiativeModifier();
-        characterObject["initiativeRoll"] = character.getInitiativeRoll();
-        characterObject["willSave"] = character.getWillSave();
-        characterObject["reflexSave"] = character.getReflexSave();
-        characterObject["fortitudeSave"] = character.getFortitudeSave();
-        characterObject["lastWillSaveRoll"] = character.getLastWillSaveRoll();
-        characterObject["lastReflexSaveRoll"] = character.getLastReflexSaveRoll();
-        characterObject["lastFortitudeSaveRoll"] = character.getLastFortitudeSaveRoll();
+        characterObject["name"] = store.name(i);
+        characterObject["initiativeModifier"] = store.value(i, CharacterStore::InitiativeModifier);
+        characterObject["initiativeRoll"] = store.value(i, CharacterStore::InitiativeRoll);
+        characterObject["willSave"] = store.value(i, CharacterStore::WillSave);
+        characterObject["reflexSave"] = store.value(i, CharacterStore::ReflexSave);
+        characterObject["fortitudeSave"] = store.value(i, CharacterStore::FortitudeSave);
+        characterObject["lastWillSaveRoll"] = store.value(i, CharacterStore::LastWillSaveRoll);
+        characterObject["lastReflexSaveRoll"] = store.value(i, CharacterStore::LastReflexSaveRoll);
+        characterObject["lastFortitudeSaveRoll"] = store.value(i, CharacterStore::LastFortitudeSaveRoll);
+        characterObject["rollKey"] = store.value(i, CharacterStore::RollKey);
+        characterObject["initiativeRollEvent"] = store.value(i, CharacterStore::InitiativeRollEvent);
+        characterObject["willSaveRollEvent"] = store.value(i, CharacterStore::WillSaveRollEvent);
+        characterObject["reflexSaveRollEvent"] = store.value(i, CharacterStore::ReflexSaveRollEvent);
+        characterObject["fortitudeSaveRollEvent"] = store.value(i, CharacterStore::FortitudeSaveRollEvent);
         
         charactersArray.append(characterObject);
     }
     
-    // Erstelle ein JSON-Dokument mit dem Array
-    QJsonDocument document(charactersArray);
+    // Der Sitzungsschlüssel wird als Hex-String gespeichert, da JSON-Zahlen
+    // Doubles sind und keine 64-Bit-Ganzzahlen exakt darstellen
+    QJsonObject sessionObject;
+    sessionObject["seed"] = QString::number(session.seed, 16);
+    sessionObject["rollEvents"] = QString::number(session.rollEvents);
+    sessionObject["nextRollKey"] = session.nextRollKey;
     
-    // Öffne die Datei zum Schreiben
-    QFile file(filename);
+    // Erstelle ein JSON-Dokument mit Sitzung und Charakteren
+    QJsonObject rootObject;
+    rootObject["session"] = sessionObject;
+    rootObject["characters"] = charactersArray;
+    QJsonDocument document(rootObject);
+    
+    // Öffne die Datei zum Schreiben. QSaveFile schreibt in eine temporäre
+    // Datei und ersetzt die alte erst mit commit().
+    QSaveFile file(filename);
     if (!file.open(QIODevice::WriteOnly)) {
-        qDebug() << "Fehler beim Öffnen der Datei zum Schreiben:" << filename;
+        TRACE_WARNING(lcStorage) << "Fehler beim Öffnen der Datei zum Schreiben:" << filename;
         return false;
     }
     
     // Schreibe das JSON-Dokument in die Datei
-    file.write(document.toJson());
-    file.close();
+    const QByteArray json = document.toJson();
+    if (file.write(json) != json.size() || !file.commit()) {
+        TRACE_WARNING(lcStorage) << "Fehler beim Schreiben der Datei:" << filename;
+        return false;
+    }
+    TRACE_EVENT(FileSaved, store.size(), 0);
     
     return true;
 }
@@ -198,52 +675,180 @@ bool InitiativeTracker::loadFromFile(const QString &filename)
     // Öffne die Datei zum Lesen
     QFile file(filename);
     if (!file.exists() || !file.open(QIODevice::ReadOnly)) {
-        qDebug() << "Datei existiert nicht oder konnte nicht geöffnet werden:" << filename;
+        TRACE_INFO(lcStorage) << "Datei existiert nicht oder konnte nicht geöffnet werden:" << filename;
         return false;
     }
     
-    // Lese den Inhalt der Datei
-    QByteArray data = file.readAll();
+    // Lies die Datei blockweise; die aktuelle Liste bleibt bei einem Fehler erhalten
+    CharacterStore loaded;
+    RosterStreamReader reader;
+    connect(&reader, &RosterStreamReader::progress, this, &InitiativeTracker::loadProgress);
+    if (!reader.read(&file, &loaded)) {
+        TRACE_WARNING(lcStorage) << "Ungültiges JSON-Format in der Datei:" << filename << reader.errorString();
+        return false;
+    }
     file.close();
     
-    // Parse den JSON-Inhalt
-    QJsonDocument document = QJsonDocument::fromJson(data);
-    if (document.isNull() || !document.isArray()) {
-        qDebug() << "Ungültiges JSON-Format in der Datei:" << filename;
+    if (reader.hasSession()) {
+        // Setze die gespeicherte Sitzung fort, ohne Ereignisse doppelt zu vergeben
+        const SnapshotFile::Session session = reader.session();
+        m_dice = DiceEngine(session.seed);
+        m_dice.setBatch(session.rollEvents);
+        m_nextRollKey = qMax(m_nextRollKey, session.nextRollKey);
+        for (int i = 0; i < loaded.size(); ++i) {
+            m_nextRollKey = qMax(m_nextRollKey, loaded.value(i, CharacterStore::RollKey) + 1);
+        }
+    } else {
+        // Würfelschlüssel und Ereignisse gelten nur innerhalb der gespeicherten Sitzung
+        for (CharacterStore::Field field : { CharacterStore::RollKey,
+                                             CharacterStore::InitiativeRollEvent,
+                                             CharacterStore::WillSaveRollEvent,
+                                             CharacterStore::ReflexSaveRollEvent,
+                                             CharacterStore::FortitudeSaveRollEvent }) {
+            int *column = loaded.column(field);
+            std::fill(column, column + loaded.size(), -1);
+        }
+    }
+    
+    // Charaktere ohne gespeicherten Schlüssel erhalten einen neuen
+    for (int i = 0; i < loaded.size(); ++i) {
+        if (loaded.value(i, CharacterStore::RollKey) < 0) {
+            loaded.setValue(i, CharacterStore::RollKey, m_nextRollKey++);
+        }
+    }
+    m_store = loaded;
+    
+    finishLoading();
+    
+    return true;
+}
+
+/**
+ * @brief Speichert Charaktere und Sitzung als binären Snapshot
+ * 
+ * @param filename Der Dateiname des Snapshots
+ * @return true, wenn das Speichern erfolgreich war, sonst false
+ */
+bool InitiativeTracker::saveSnapshot(const QString &filename)
+{
+    compactNames();
+    if (!SnapshotFile::write(filename, m_store, session())) {
+        return false;
+    }
+    
+    TRACE_EVENT(FileSaved, m_store.size(), 0);
+    return true;
+}
+
+/**
+ * @brief Gibt Namen frei, die kein Charakter mehr benutzt
+ * 
+ * @return Die Anzahl der freigegebenen Namen
+ */
+int InitiativeTracker::compactNames()
+{
+    const int removed = m_store.compactNames();
+    if (removed > 0) {
+        TRACE_DEBUG(lcTracker) << "compactNames:" << removed << "Namen freigegeben";
+    }
+    return removed;
+}
+
+/**
+ * @brief Importiert eine Monsterliste im CSV- oder TSV-Format
+ * 
+ * Die Datei wird mit QFile::map() eingeblendet und ohne Kopie an den
+ * RosterCsvReader übergeben.
+ * 
+ * @param filename Der Dateiname
+ * @return true, wenn der Import erfolgreich war, sonst false
+ */
+bool InitiativeTracker::importCsvFile(const QString &filename)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        TRACE_INFO(lcStorage) << "Datei existiert nicht oder konnte nicht geöffnet werden:" << filename;
+        return false;
+    }
+    
+    // Leere Dateien lassen sich nicht einblenden
+    const qint64 size = file.size();
+    uchar *mapped = size > 0 ? file.map(0, size) : nullptr;
+    const QByteArray data = mapped
+        ? QByteArray::fromRawData(reinterpret_cast<const char *>(mapped), int(size))
+        : file.readAll();
+    
+    CharacterStore imported;
+    RosterCsvReader reader;
+    const bool success = reader.read(data, &imported);
+    if (mapped) {
+        file.unmap(mapped);
+    }
+    if (!success) {
+        TRACE_WARNING(lcStorage) << "Ungültige CSV-Datei:" << filename << reader.errorString();
         return false;
     }
     
-    // Leere die aktuelle Charakterliste
-    m_characters.clear();
+    appendCharacters(imported);
+    TRACE_INFO(lcStorage) << imported.size() << "Charaktere importiert aus:" << filename
+                          << "in" << reader.chunkCount() << "Blöcken";
     
-    // Füge jeden Charakter aus dem JSON-Array hinzu
-    QJsonArray charactersArray = document.array();
-    for (const QJsonValue &value : charactersArray) {
-        QJsonObject characterObject = value.toObject();
-        
-        // Erstelle einen neuen Charakter mit den Daten aus dem JSON-Objekt
-        Character character(
-            characterObject["name"].toString(),
-            characterObject["initiativeModifier"].toInt(),
-            characterObject["willSave"].toInt(),
-            characterObject["reflexSave"].toInt(),
-            characterObject["fortitudeSave"].toInt()
-        );
-        
-        // Setze die Initiative-Werte, falls vorhanden
-        if (characterObject.contains("initiativeRoll")) {
-            // Hier müssten wir eigentlich die rollInitiative-Methode aufrufen,
-            // aber wir können den Wert nicht direkt setzen, da er privat ist.
-            // Stattdessen würfeln wir neu und überschreiben später.
-            character.rollInitiative();
-        }
-        
-        // Füge den Charakter zur Liste hinzu
-        m_characters.append(character);
+    return true;
+}
+
+/**
+ * @brief Lädt Charaktere und Sitzung aus einem binären Snapshot
+ * 
+ * @param filename Der Dateiname des Snapshots
+ * @return true, wenn das Laden erfolgreich war, sonst false
+ */
+bool InitiativeTracker::loadSnapshot(const QString &filename)
+{
+    CharacterStore loaded;
+    SnapshotFile::Session loadedSession;
+    if (!SnapshotFile::read(filename, &loaded, &loadedSession)) {
+        return false;
     }
     
-    // Sende ein Signal, dass sich die Charakterliste geändert hat
-    emit charactersChanged();
+    restore(loaded, loadedSession);
+    
+    return true;
+}
+
+/**
+ * @brief Speichert Charaktere und Sitzung als Begegnung in einem Archiv
+ * 
+ * @param archiveFilename Der Dateiname des Archivs
+ * @param name Der Name der Begegnung
+ * @return true, wenn das Speichern erfolgreich war, sonst false
+ */
+bool InitiativeTracker::saveEncounter(const QString &archiveFilename, const QString &name)
+{
+    // Ein fehlendes Archiv wird neu angelegt, ein beschädigtes nicht überschrieben
+    EncounterArchive archive(archiveFilename);
+    if (!archive.open() && QFile::exists(archiveFilename)) {
+        return false;
+    }
+    return archive.save(name, m_store, session());
+}
+
+/**
+ * @brief Lädt eine einzelne Begegnung aus einem Archiv
+ * 
+ * @param archiveFilename Der Dateiname des Archivs
+ * @param name Der Name der Begegnung
+ * @return true, wenn das Laden erfolgreich war, sonst false
+ */
+bool InitiativeTracker::loadEncounter(const QString &archiveFilename, const QString &name)
+{
+    EncounterArchive archive(archiveFilename);
+    CharacterStore loaded;
+    SnapshotFile::Session loadedSession;
+    if (!archive.open() || !archive.load(name, &loaded, &loadedSession)) {
+        return false;
+    }
+    
+    restore(loaded, loadedSession);
     
     return true;
 }
@@ -254,12 +859,10 @@ bool InitiativeTracker::loadFromFile(const QString &filename)
 void InitiativeTracker::rollAllWillSaves()
 {
     // Würfle Willenskraft-Rettungswürfe für jeden Charakter
-    for (int i = 0; i < m_characters.size(); ++i) {
-        m_characters[i].rollWillSave();
-    }
+    rollColumn(CharacterStore::LastWillSaveRoll);
     
     // Sende ein Signal, dass Rettungswürfe gewürfelt wurden
-    emit savesRolled();
+    notifyCoarse(SavesRolledSignal);
 }
 
 /**
@@ -270,12 +873,12 @@ void InitiativeTracker::rollAllWillSaves()
 void InitiativeTracker::rollWillSaveForCharacter(int index)
 {
     // Überprüfe, ob der Index gültig ist
-    if (index >= 0 && index < m_characters.size()) {
+    if (index >= 0 && index < m_store.size()) {
         // Würfle den Willenskraft-Rettungswurf für den Charakter
-        m_characters[index].rollWillSave();
+        rollSingle(index, CharacterStore::LastWillSaveRoll);
         
         // Sende ein Signal, dass Rettungswürfe gewürfelt wurden
-        emit savesRolled();
+        notifyCoarse(SavesRolledSignal);
     }
 }
 
@@ -285,12 +888,10 @@ void InitiativeTracker::rollWillSaveForCharacter(int index)
 void InitiativeTracker::rollAllReflexSaves()
 {
     // Würfle Reflex-Rettungswürfe für jeden Charakter
-    for (int i = 0; i < m_characters.size(); ++i) {
-        m_characters[i].rollReflexSave();
-    }
+    rollColumn(CharacterStore::LastReflexSaveRoll);
     
     // Sende ein Signal, dass Rettungswürfe gewürfelt wurden
-    emit savesRolled();
+    notifyCoarse(SavesRolledSignal);
 }
 
 /**
@@ -301,12 +902,12 @@ void InitiativeTracker::rollAllReflexSaves()
 void InitiativeTracker::rollReflexSaveForCharacter(int index)
 {
     // Überprüfe, ob der Index gültig ist
-    if (index >= 0 && index < m_characters.size()) {
+    if (index >= 0 && index < m_store.size()) {
         // Würfle den Reflex-Rettungswurf für den Charakter
-        m_characters[index].rollReflexSave();
+        rollSingle(index, CharacterStore::LastReflexSaveRoll);
         
         // Sende ein Signal, dass Rettungswürfe gewürfelt wurden
-        emit savesRolled();
+        notifyCoarse(SavesRolledSignal);
     }
 }
 
@@ -316,12 +917,10 @@ void InitiativeTracker::rollReflexSaveForCharacter(int index)
 void InitiativeTracker::rollAllFortitudeSaves()
 {
     // Würfle Konstitution-Rettungswürfe für jeden Charakter
-    for (int i = 0; i < m_characters.size(); ++i) {
-        m_characters[i].rollFortitudeSave();
-    }
+    rollColumn(CharacterStore::LastFortitudeSaveRoll);
     
     // Sende ein Signal, dass Rettungswürfe gewürfelt wurden
-    emit savesRolled();
+    notifyCoarse(SavesRolledSignal);
 }
 
 /**
@@ -332,31 +931,279 @@ void InitiativeTracker::rollAllFortitudeSaves()
 void InitiativeTracker::rollFortitudeSaveForCharacter(int index)
 {
     // Überprüfe, ob der Index gültig ist
-    if (index >= 0 && index < m_characters.size()) {
+    if (index >= 0 && index < m_store.size()) {
         // Würfle den Konstitution-Rettungswurf für den Charakter
-        m_characters[index].rollFortitudeSave();
+        rollSingle(index, CharacterStore::LastFortitudeSaveRoll);
         
         // Sende ein Signal, dass Rettungswürfe gewürfelt wurden
-        emit savesRolled();
+        notifyCoarse(SavesRolledSignal);
     }
 }
 
-Character& InitiativeTracker::getCharacterRef(int index)
+/**
+ * @brief Würfelt einen W20 für jeden Eintrag einer Wurf-Spalte
+ * 
+ * Die DiceEngine füllt einen int-Puffer in einem Stück, der danach in die
+ * schmale Wurf-Spalte übernommen wird; Namen und übrige Werte bleiben
+ * unberührt.
+ * 
+ * @param field Die Wurf-Spalte im CharacterStore
+ */
+void InitiativeTracker::rollColumn(CharacterStore::Field field)
 {
-    // Überprüfe, ob die Liste leer ist
-    if (m_characters.isEmpty()) {
-        qWarning() << "Zugriff auf leere Charakterliste";
-        // Füge einen temporären Charakter hinzu, um einen Absturz zu vermeiden
-        m_characters.append(Character("Temporär", 0, 0, 0, 0));
-        return m_characters[0];
+    if (m_store.isEmpty()) {
+        return;
     }
     
-    // Überprüfe, ob der Index gültig ist
-    if (index < 0 || index >= m_characters.size()) {
-        // Wenn nicht, gib eine Referenz auf den ersten Charakter zurück
-        qWarning() << "Ungültiger Index:" << index;
-        return m_characters[0];
+    const quint64 event = nextRollEvent();
+    const int count = m_store.size();
+    const int *keys = m_store.column(CharacterStore::RollKey);
+    QVector<int> rolls(count);
+    
+    // Ohne entfernte Charaktere sind die Schlüssel lückenlos und die ganze
+    // Spalte wird in einem Stück gefüllt
+    for (int row = 0; row < count; ) {
+        int run = 1;
+        while (row + run < count && keys[row + run] == keys[row] + run) {
+            ++run;
+        }
+        DiceEngine::fillD20Parallel(m_dice.seed(), event, keys[row], rolls.data() + row, run);
+        row += run;
+    }
+    m_store.writeValues(field, 0, count, rolls.constData());
+    
+    const CharacterStore::Field eventField = CharacterStore::rollEventField(field);
+    int *events = m_store.column(eventField);
+    std::fill(events, events + count, static_cast<int>(event));
+    TRACE_EVENT(ColumnRolled, field, count);
+    
+    notifyUpdated(0, count - 1, CharacterStore::fieldBit(field) | CharacterStore::fieldBit(eventField));
+}
+
+/**
+ * @brief Reserviert die Nummer für das nächste Würfelereignis
+ * 
+ * @return Eine Ereignisnummer im Bereich 0 bis INT_MAX
+ */
+quint64 InitiativeTracker::nextRollEvent()
+{
+    const quint64 lastEvent = static_cast<quint64>(std::numeric_limits<int>::max());
+    if (m_dice.batch() > lastEvent) {
+        // Die Ereignisspalten fassen keine weitere Nummer; die alten Würfe
+        // werden mit dem neuen Schlüssel als nicht nachprüfbar markiert
+        TRACE_INFO(lcTracker) << "Alle Würfelereignisse vergeben, beginne neue Sitzung";
+        setSessionSeed(randomSeed());
+    }
+    
+    const quint64 event = m_dice.nextBatch();
+    Q_ASSERT(event <= lastEvent);
+    return event;
+}
+
+/**
+ * @brief Würfelt einen W20 für einen einzelnen Charakter
+ * 
+ * @param index Der Index des Charakters
+ * @param field Die Wurf-Spalte im CharacterStore
+ */
+void InitiativeTracker::rollSingle(int index, CharacterStore::Field field)
+{
+    const quint64 event = nextRollEvent();
+    const int key = m_store.value(index, CharacterStore::RollKey);
+    m_store.setValue(index, field, DiceEngine::d20At(m_dice.seed(), event, key));
+    const CharacterStore::Field eventField = CharacterStore::rollEventField(field);
+    m_store.setValue(index, eventField, static_cast<int>(event));
+    TRACE_EVENT(SingleRolled, field, index);
+    
+    notifyUpdated(index, index, CharacterStore::fieldBit(field) | CharacterStore::fieldBit(eventField));
+}
+
+/**
+ * @brief Baut die Reihenfolge neu auf und meldet den neuen Stand
+ */
+void InitiativeTracker::finishLoading()
+{
+    // Baue die Initiative-Reihenfolge für die geladenen Charaktere auf
+    m_order.rebuild(m_store);
+    notifyReset();
+    TRACE_EVENT(FileLoaded, m_store.size(), 0);
+    
+    // Sende ein Signal, dass sich die Charakterliste geändert hat
+    notifyCoarse(CharactersChangedSignal);
+}
+
+/**
+ * @brief Meldet eingefügte Zeilen oder merkt sie im Batch vor
+ * 
+ * @param first Der erste neue Index
+ * @param last Der letzte neue Index
+ */
+void InitiativeTracker::notifyInserted(int first, int last)
+{
+    if (m_batchDepth == 0) {
+        emit rowsInserted(first, last);
+        return;
+    }
+    
+    // Eingefügt wird nur am Ende, der erste neue Index genügt
+    if (m_pendingInsertFirst < 0) {
+        m_pendingInsertFirst = first;
+    }
+}
+
+/**
+ * @brief Meldet Zeilen, die gleich entfernt werden
+ * 
+ * Im Batch wird nichts gesendet; notifyRemoved() merkt dort einen Reset vor.
+ * 
+ * @param first Der erste zu entfernende Index
+ * @param last Der letzte zu entfernende Index
+ */
+void InitiativeTracker::notifyAboutToBeRemoved(int first, int last)
+{
+    if (m_batchDepth == 0) {
+        emit rowsAboutToBeRemoved(first, last);
+    }
+}
+
+/**
+ * @brief Meldet entfernte Zeilen oder merkt sie im Batch vor
+ * 
+ * Entfernte Zeilen verschieben alle folgenden Indizes. Im Batch würde das
+ * die gesammelten Bereiche ungültig machen, daher wird dort ein Reset gemeldet.
+ * 
+ * @param first Der erste entfernte Index
+ * @param last Der letzte entfernte Index
+ */
+void InitiativeTracker::notifyRemoved(int first, int last)
+{
+    if (m_batchDepth == 0) {
+        emit rowsRemoved(first, last);
+        return;
+    }
+    
+    m_pendingReset = true;
+}
+
+/**
+ * @brief Meldet geänderte Werte oder merkt sie im Batch vor
+ * 
+ * @param first Der erste betroffene Index
+ * @param last Der letzte betroffene Index
+ * @param fields Die geänderten Spalten
+ */
+void InitiativeTracker::notifyUpdated(int first, int last, CharacterStore::FieldMask fields)
+{
+    if (fields == 0) {
+        return;
+    }
+    
+    if (m_batchDepth == 0) {
+        emit rowsUpdated(first, last, fields);
+        return;
+    }
+    
+    if (m_pendingReset) {
+        return;
+    }
+    
+    // Änderungen an Zeilen, die im selben Batch eingefügt wurden, sind im
+    // Einfügen bereits enthalten
+    if (m_pendingInsertFirst >= 0) {
+        last = qMin(last, m_pendingInsertFirst - 1);
+        if (first > last) {
+            return;
+        }
     }
     
-    return m_characters[index];
-} 
\ No newline at end of file
+    if (m_pendingUpdateFirst < 0) {
+        m_pendingUpdateFirst = first;
+        m_pendingUpdateLast = last;
+    } else {
+        m_pendingUpdateFirst = qMin(m_pendingUpdateFirst, first);
+        m_pendingUpdateLast = qMax(m_pendingUpdateLast, last);
+    }
+    m_pendingFields |= fields;
+}
+
+/**
+ * @brief Meldet eine grundlegende Änderung oder merkt sie im Batch vor
+ */
+void InitiativeTracker::notifyReset()
+{
+    if (m_batchDepth == 0) {
+        emit rowsReset();
+        return;
+    }
+    
+    m_pendingReset = true;
+}
+
+/**
+ * @brief Sendet ein grobes Signal oder merkt es im Batch vor
+ * 
+ * @param signal Das zu sendende Signal
+ */
+void InitiativeTracker::notifyCoarse(CoarseSignal signal)
+{
+    if (m_batchDepth > 0) {
+        m_pendingSignals |= signal;
+        return;
+    }
+    
+    switch (signal) {
+    case CharactersChangedSignal:
+        emit charactersChanged();
+        break;
+    case InitiativeRolledSignal:
+        emit initiativeRolled();
+        break;
+    case SavesRolledSignal:
+        emit savesRolled();
+        break;
+    }
+}
+
+/**
+ * @brief Sendet alle im Batch gesammelten Signale
+ * 
+ * Der Sammelzustand wird vor dem Senden zurückgesetzt, damit Slots, die den
+ * Tracker erneut ändern, mit einem sauberen Zustand beginnen.
+ */
+void InitiativeTracker::flushChanges()
+{
+    const bool reset = m_pendingReset;
+    const int insertFirst = m_pendingInsertFirst;
+    const int updateFirst = m_pendingUpdateFirst;
+    const int updateLast = m_pendingUpdateLast;
+    const CharacterStore::FieldMask fields = m_pendingFields;
+    const int pendingSignals = m_pendingSignals;
+    
+    m_pendingReset = false;
+    m_pendingInsertFirst = -1;
+    m_pendingUpdateFirst = -1;
+    m_pendingUpdateLast = -1;
+    m_pendingFields = 0;
+    m_pendingSignals = 0;
+    
+    if (reset) {
+        emit rowsReset();
+    } else {
+        if (updateFirst >= 0) {
+            emit rowsUpdated(updateFirst, updateLast, fields);
+        }
+        if (insertFirst >= 0 && insertFirst < m_store.size()) {
+            emit rowsInserted(insertFirst, m_store.size() - 1);
+        }
+    }
+    
+    if (pendingSignals & CharactersChangedSignal) {
+        emit charactersChanged();
+    }
+    if (pendingSignals & InitiativeRolledSignal) {
+        emit initiativeRolled();
+    }
+    if (pendingSignals & SavesRolledSignal) {
+        emit savesRolled();
+    }
+}
@@ -9,6 +9,10 @@
 #include <QJsonArray>
 #include <QJsonObject>
 #include "character.h"
+#include "characterstore.h"
+#include "initiativeorder.h"
+#include "diceengine.h"
+#include "snapshotfile.h"
 
 /**
  * @brief Die InitiativeTracker-Klasse verwaltet die Charaktere und ihre Initiative-Werte.
@@ -22,6 +26,20 @@
  * - Verwendung des Signale-und-Slots-Mechanismus
  * - Nutzung des Qt-Metaobjektsystems
  * - Speicherverwaltung durch Eltern-Kind-Beziehungen
+ * 
+ * Alle Würfe des Trackers stammen aus einer DiceEngine, deren Seed der
+ * Sitzungsschlüssel ist. Jede Würfelaktion (ein Einzelwurf oder eine ganze
+ * Spalte) erhält eine fortlaufende Ereignisnummer, jeder Charakter beim
+ * Hinzufügen einen festen Würfelschlüssel. Ein Wurf ist damit eindeutig durch
+ * (Sitzungsschlüssel, Ereignis, Würfelschlüssel) bestimmt und kann mit
+ * replayRoll() in O(1) nachgerechnet werden, ohne alle vorherigen Würfe zu
+ * wiederholen. Sitzungsschlüssel und Ereigniszähler werden mitgespeichert.
+ * 
+ * Neben den groben Signalen charactersChanged(), initiativeRolled() und
+ * savesRolled() meldet der Tracker jede Änderung genau: rowsInserted(),
+ * rowsAboutToBeRemoved()/rowsRemoved() und rowsUpdated() mit Zeilenbereich
+ * und einer Bitmaske der geänderten Spalten. Innerhalb eines ChangeBatch werden alle Änderungen
+ * gesammelt und am Ende als eine Benachrichtigung gesendet.
  */
 class InitiativeTracker : public QObject {
     Q_OBJECT
@@ -39,6 +57,60 @@ public:
      */
     explicit InitiativeTracker(QObject *parent = nullptr);
     
+    /**
+     * @brief Fasst alle Änderungen während seiner Lebensdauer zu einer Benachrichtigung zusammen.
+     * 
+     * Beispiel:
+     * @code
+     * {
+     *     InitiativeTracker::ChangeBatch batch(&tracker);
+     *     tracker.addCharacter(goblin);
+     *     tracker.addCharacter(orc);
+     *     tracker.rollAllInitiatives();
+     * }   // Hier werden die gesammelten Signale einmal gesendet
+     * @endcode
+     * 
+     * C++ Konzept: RAII (Resource Acquisition Is Initialization)
+     * Der Konstruktor beginnt den Batch, der Destruktor beendet ihn. Dadurch
+     * wird der Batch auch bei einem vorzeitigen return sicher abgeschlossen,
+     * ähnlich wie bei QSignalBlocker oder QMutexLocker.
+     * 
+     * Batches dürfen verschachtelt werden; gesendet wird beim Ende des äußersten.
+     */
+    class ChangeBatch
+    {
+    public:
+        /**
+         * @brief Beginnt einen Batch.
+         * 
+         * @param tracker Der Tracker, dessen Änderungen gesammelt werden
+         */
+        explicit ChangeBatch(InitiativeTracker *tracker);
+        
+        /**
+         * @brief Beendet den Batch und sendet ggf. die gesammelten Signale.
+         */
+        ~ChangeBatch();
+        
+    private:
+        Q_DISABLE_COPY(ChangeBatch)
+        
+        InitiativeTracker *m_tracker;  ///< Der betroffene Tracker
+    };
+    
+    /**
+     * @brief Beginnt das Sammeln von Änderungen.
+     * 
+     * Jedes beginChanges() braucht ein passendes endChanges(). Meist ist
+     * ChangeBatch einfacher.
+     */
+    void beginChanges();
+    
+    /**
+     * @brief Beendet das Sammeln und sendet beim äußersten Aufruf die Signale.
+     */
+    void endChanges();
+    
     /**
      * @brief Fügt einen Charakter zur Liste hinzu.
      * 
@@ -51,6 +123,18 @@ public:
      */
     void addCharacter(const Character &character);
     
+    /**
+     * @brief Hängt viele Charaktere auf einmal an.
+     * 
+     * Die Spalten werden in einem Stück kopiert, die Initiative-Reihenfolge
+     * wird einmal neu aufgebaut und rowsInserted() bzw. charactersChanged()
+     * werden nur einmal gesendet. Jeder Charakter erhält einen neuen
+     * Würfelschlüssel; mitgebrachte Würfelereignisse werden verworfen.
+     * 
+     * @param characters Die anzuhängenden Charaktere
+     */
+    void appendCharacters(const CharacterStore &characters);
+    
     /**
      * @brief Entfernt einen Charakter aus der Liste anhand seines Index.
      * 
@@ -74,22 +158,103 @@ public:
     /**
      * @brief Gibt die aktuelle Charakterliste zurück.
      * 
-     * Qt-Konzept: Wertesemantik
-     * QVector verwendet Wertesemantik mit implizitem Sharing. Das bedeutet, dass
-     * beim Zurückgeben des Vektors eine flache Kopie erstellt wird, die effizient ist,
-     * da die Daten erst bei Änderungen tatsächlich kopiert werden (Copy-on-Write).
+     * Die Charaktere werden dabei aus den Spalten des CharacterStore
+     * zusammengesetzt. Das kostet O(n) und sollte nicht für reine
+     * Größenabfragen verwendet werden.
      * 
      * @return Ein QVector mit allen Charakteren
      */
     QVector<Character> getCharacters() const;
     
     /**
-     * @brief Gibt eine Referenz auf einen Charakter zurück.
+     * @brief Gibt die Anzahl der Charaktere zurück.
+     * 
+     * @return Die Anzahl der Charaktere
+     */
+    int size() const;
+    
+    /**
+     * @brief Prüft, ob keine Charaktere vorhanden sind.
+     * 
+     * Billiger als getCharacters().isEmpty(), da nichts kopiert wird.
+     * 
+     * @return true, wenn die Liste leer ist
+     */
+    bool isEmpty() const;
+    
+    /**
+     * @brief Gibt lesenden Zugriff auf die gespeicherten Charaktere.
+     * 
+     * Über die Referenz kann ohne Kopie iteriert werden, z.B. mit
+     * for (CharacterView character : tracker.store()). Die Sichten sind nur
+     * bis zur nächsten Änderung des Trackers gültig.
+     * 
+     * @return Eine konstante Referenz auf den CharacterStore
+     */
+    const CharacterStore &store() const;
+    
+    /**
+     * @brief Gibt eine schreibgeschützte Sicht auf einen Charakter zurück.
+     * 
+     * @param index Der Index des Charakters (muss gültig sein)
+     * @return Die Sicht auf den Charakter
+     */
+    CharacterView characterView(int index) const;
+    
+    /**
+     * @brief Gibt einen unveränderlichen Schnappschuss aller Charaktere zurück.
+     * 
+     * Der Schnappschuss teilt sich die Spalten mit dem Tracker (implizites
+     * Teilen) und kostet beim Erstellen keine Kopie der Daten. Erst wenn der
+     * Tracker danach eine Spalte ändert, wird diese eine Spalte kopiert. Der
+     * Schnappschuss bleibt dadurch über beliebige Änderungen hinweg gültig.
+     * 
+     * @return Der Schnappschuss
+     */
+    CharacterStore snapshot() const;
+    
+    /**
+     * @brief Gibt eine Kopie eines einzelnen Charakters zurück.
      * 
      * @param index Der Index des Charakters in der Liste
-     * @return Eine Referenz auf den Charakter
+     * @return Der Charakter oder ein leerer Charakter bei ungültigem Index
+     */
+    Character getCharacter(int index) const;
+    
+    /**
+     * @brief Setzt den Initiative-Modifikator eines Charakters.
+     * 
+     * Ersetzt den früheren Schreibzugriff über eine Character-Referenz, die
+     * es bei spaltenweiser Speicherung nicht mehr gibt.
+     * 
+     * @param index Der Index des Charakters
+     * @param modifier Der neue Initiative-Modifikator
+     */
+    void setInitiativeModifier(int index, int modifier);
+    
+    /**
+     * @brief Setzt den Willenskraft-Modifikator eines Charakters.
+     * 
+     * @param index Der Index des Charakters
+     * @param modifier Der neue Willenskraft-Modifikator
+     */
+    void setWillSave(int index, int modifier);
+    
+    /**
+     * @brief Setzt den Reflex-Modifikator eines Charakters.
+     * 
+     * @param index Der Index des Charakters
+     * @param modifier Der neue Reflex-Modifikator
      */
-    Character& getCharacterRef(int index);
+    void setReflexSave(int index, int modifier);
+    
+    /**
+     * @brief Setzt den Konstitution-Modifikator eines Charakters.
+     * 
+     * @param index Der Index des Charakters
+     * @param modifier Der neue Konstitution-Modifikator
+     */
+    void setFortitudeSave(int index, int modifier);
     
     /**
      * @brief Aktualisiert einen Charakter in der Liste.
@@ -118,10 +283,114 @@ public:
     /**
      * @brief Gibt die sortierte Liste der Charaktere nach Initiative zurück.
      * 
+     * Die Reihenfolge wird nicht mehr bei jedem Aufruf sortiert, sondern aus
+     * dem laufend gepflegten InitiativeOrder-Index gelesen.
+     * 
      * @return Die sortierte Liste der Charaktere als QVector
      */
     QVector<Character> getSortedInitiativeOrder() const;
     
+    /**
+     * @brief Gibt den sortierten Initiative-Index zurück.
+     * 
+     * Erlaubt das Durchlaufen in Initiative-Reihenfolge und Rang-Abfragen,
+     * ohne Charaktere zu kopieren.
+     * 
+     * @return Der Index mit den Charakter-Indizes, höchste Initiative zuerst
+     */
+    const InitiativeOrder &initiativeOrder() const;
+    
+    /**
+     * @brief Gibt den Rang eines Charakters in der Initiative-Reihenfolge zurück.
+     * 
+     * @param index Der Index des Charakters
+     * @return Der Rang (0 = höchste Initiative) oder -1 bei ungültigem Index
+     */
+    int initiativeRank(int index) const;
+    
+    /**
+     * @brief Gibt den Sitzungsschlüssel zurück.
+     * 
+     * @return Der Seed, aus dem alle Würfe dieser Sitzung stammen
+     */
+    quint64 sessionSeed() const;
+    
+    /**
+     * @brief Gibt die Anzahl der bisherigen Würfelereignisse zurück.
+     * 
+     * Die Nummern reichen höchstens bis INT_MAX; danach beginnt beim
+     * nächsten Wurf eine neue Sitzung und die Zählung wieder bei 0.
+     * 
+     * @return Die Nummer des nächsten Würfelereignisses
+     */
+    quint64 rollEventCount() const;
+    
+    /**
+     * @brief Beginnt eine neue Sitzung mit dem angegebenen Schlüssel.
+     * 
+     * Der Ereigniszähler beginnt wieder bei 0. Bereits vorhandene Würfe
+     * stammen aus der alten Sitzung und gelten danach als nicht nachprüfbar.
+     * 
+     * @param seed Der neue Sitzungsschlüssel
+     */
+    void setSessionSeed(quint64 seed);
+    
+    /**
+     * @brief Gibt den Zustand der Sitzung zurück.
+     * 
+     * @return Sitzungsschlüssel, Ereigniszähler und nächster Würfelschlüssel
+     */
+    SnapshotFile::Session session() const;
+    
+    /**
+     * @brief Übernimmt Charaktere und Sitzung, z.B. aus einem Snapshot.
+     * 
+     * Würfelschlüssel und -ereignisse müssen bereits in den Spalten stehen.
+     * Sendet rowsReset() und charactersChanged().
+     * 
+     * @param store Die Charaktere
+     * @param session Die fortzusetzende Sitzung
+     */
+    void restore(const CharacterStore &store, const SnapshotFile::Session &session);
+    
+    /**
+     * @brief Gibt den Würfelschlüssel eines Charakters zurück.
+     * 
+     * Der Schlüssel wird beim Hinzufügen vergeben und ändert sich nicht, wenn
+     * andere Charaktere entfernt werden.
+     * 
+     * @param index Der Index des Charakters
+     * @return Der Würfelschlüssel oder -1 bei ungültigem Index
+     */
+    int rollKey(int index) const;
+    
+    /**
+     * @brief Gibt das Würfelereignis zurück, aus dem ein Wurf stammt.
+     * 
+     * @param index Der Index des Charakters
+     * @param rollField InitiativeRoll oder eine der LastXxxSaveRoll-Spalten
+     * @return Die Ereignisnummer oder -1, wenn der Wurf nicht aus dieser Sitzung stammt
+     */
+    int rollEvent(int index, CharacterStore::Field rollField) const;
+    
+    /**
+     * @brief Berechnet einen Wurf dieser Sitzung in O(1) nach.
+     * 
+     * @param event Die Nummer des Würfelereignisses
+     * @param rollKey Der Würfelschlüssel des Charakters
+     * @return Das W20-Ergebnis (1-20)
+     */
+    int replayRoll(quint64 event, int rollKey) const;
+    
+    /**
+     * @brief Prüft alle Würfe mit bekanntem Würfelereignis gegen die DiceEngine.
+     * 
+     * Würfe ohne Ereignis (z.B. von Hand eingetragene) werden übersprungen.
+     * 
+     * @return true, wenn jeder nachprüfbare Wurf mit dem nachgerechneten übereinstimmt
+     */
+    bool verifyRolls() const;
+    
     /**
      * @brief Speichert die Charakterliste in einer Datei.
      * 
@@ -129,7 +398,11 @@ public:
      * Qt bietet umfangreiche Unterstützung für JSON mit Klassen wie QJsonObject,
      * QJsonArray und QJsonDocument. Diese werden hier verwendet, um die Charakterdaten
      * in ein JSON-Format zu konvertieren und in eine Datei zu schreiben.
-     * 
+     *
+     * Neben den Charakteren werden Sitzungsschlüssel, Ereigniszähler sowie
+     * Würfelschlüssel und Würfelereignisse gespeichert, damit die Würfe nach
+     * dem Laden mit verifyRolls() geprüft werden können.
+     *
      * Qt-Konzept: Dateioperationen
      * QFile ist Qt's Klasse für Dateioperationen. Sie bietet plattformunabhängige
      * Methoden zum Öffnen, Lesen, Schreiben und Schließen von Dateien.
@@ -139,18 +412,111 @@ public:
      */
     bool saveToFile(const QString &filename = "characters.json");
     
+    /**
+     * @brief Schreibt Charaktere und Sitzung als JSON-Datei.
+     * 
+     * Dasselbe Format wie saveToFile(), aber für einen Schnappschuss statt des
+     * laufenden Trackers. Greift auf keine Member zu und darf daher in einem
+     * anderen Thread laufen (siehe AutoSaver). Die alte Datei wird über
+     * QSaveFile erst ersetzt, wenn die neue vollständig geschrieben ist.
+     * 
+     * @param filename Der Dateiname
+     * @param store Die zu speichernden Charaktere, z.B. aus snapshot()
+     * @param session Die zu speichernde Sitzung, z.B. aus session()
+     * @return true, wenn die Datei vollständig geschrieben wurde
+     */
+    static bool writeJsonFile(const QString &filename, const CharacterStore &store,
+                              const SnapshotFile::Session &session);
+    
     /**
      * @brief Lädt die Charakterliste aus einer Datei.
      * 
      * Qt-Konzept: Fehlerbehandlung
      * Qt-Funktionen geben oft bool-Werte zurück, um Erfolg oder Misserfolg anzuzeigen.
      * Dies ist ein einfacher Ansatz zur Fehlerbehandlung, der hier verwendet wird.
+     *
+     * Enthält die Datei eine Sitzung, wird diese fortgesetzt. Ältere Dateien,
+     * die nur ein Array von Charakteren enthalten, werden weiterhin gelesen.
+     *
+     * Die Datei wird mit dem RosterStreamReader blockweise gelesen, sodass
+     * auch sehr große Dateien nicht vollständig im Speicher liegen. Der
+     * Fortschritt wird über loadProgress() gemeldet. Bei einem Fehler bleibt
+     * die aktuelle Charakterliste erhalten.
      * 
      * @param filename Der Dateiname zum Laden der Daten
      * @return true, wenn das Laden erfolgreich war, sonst false
      */
     bool loadFromFile(const QString &filename = "characters.json");
     
+    /**
+     * @brief Speichert Charaktere und Sitzung als binären Snapshot.
+     * 
+     * Schneller zu laden als JSON (siehe SnapshotFile). Für den Austausch mit
+     * anderen Programmen bleibt saveToFile() das richtige Format.
+     * 
+     * @param filename Der Dateiname des Snapshots
+     * @return true, wenn das Speichern erfolgreich war, sonst false
+     */
+    bool saveSnapshot(const QString &filename = "characters.dndsnap");
+    
+    /**
+     * @brief Gibt Namen frei, die kein Charakter mehr benutzt.
+     * 
+     * Wird vor jedem Speichern aufgerufen (saveSnapshot(), ChangeJournal,
+     * AutoSaver), damit der NamePool bei vielen Umbenennungen nicht ohne
+     * Grenze wächst. Signale werden nicht gesendet, da sich kein sichtbarer
+     * Wert ändert.
+     * 
+     * @return Die Anzahl der freigegebenen Namen
+     */
+    int compactNames();
+    
+    /**
+     * @brief Importiert eine Monsterliste im CSV- oder TSV-Format.
+     * 
+     * Die Charaktere werden an die aktuelle Liste angehängt. Die Datei wird
+     * mit dem RosterCsvReader auf mehreren Kernen gelesen und mit
+     * appendCharacters() als eine einzige Änderung übernommen. Bei einem
+     * Fehler bleibt die aktuelle Charakterliste unverändert.
+     * 
+     * @param filename Der Dateiname
+     * @return true, wenn der Import erfolgreich war, sonst false
+     */
+    bool importCsvFile(const QString &filename);
+    
+    /**
+     * @brief Lädt Charaktere und Sitzung aus einem binären Snapshot.
+     * 
+     * Bei einem ungültigen Snapshot bleibt die aktuelle Charakterliste erhalten.
+     * 
+     * @param filename Der Dateiname des Snapshots
+     * @return true, wenn das Laden erfolgreich war, sonst false
+     */
+    bool loadSnapshot(const QString &filename = "characters.dndsnap");
+    
+    /**
+     * @brief Speichert Charaktere und Sitzung als Begegnung in einem Archiv.
+     * 
+     * Eine Begegnung gleichen Namens wird ersetzt (siehe EncounterArchive).
+     * 
+     * @param archiveFilename Der Dateiname des Archivs
+     * @param name Der Name der Begegnung
+     * @return true, wenn das Speichern erfolgreich war, sonst false
+     */
+    bool saveEncounter(const QString &archiveFilename, const QString &name);
+    
+    /**
+     * @brief Lädt eine einzelne Begegnung aus einem Archiv.
+     * 
+     * Gelesen werden nur der Index und diese eine Begegnung. Bei einem
+     * Fehler bleibt die aktuelle Charakterliste erhalten.
+     * 
+     * @param archiveFilename Der Dateiname des Archivs
+     * @param name Der Name der Begegnung
+     * @return true, wenn das Laden erfolgreich war, sonst false
+     */
+    bool loadEncounter(const QString &archiveFilename, const QString &name);
+    
     /**
      * @brief Würfelt Willenskraft-Rettungswürfe für alle Charaktere.
      * 
@@ -225,14 +591,179 @@ signals:
      */
     void savesRolled();
     
+    /**
+     * @brief Signal, das gesendet wird, wenn Charaktere eingefügt wurden.
+     * 
+     * @param first Der erste neue Index
+     * @param last Der letzte neue Index (einschließlich)
+     */
+    void rowsInserted(int first, int last);
+    
+    /**
+     * @brief Signal, das gesendet wird, bevor Charaktere entfernt werden.
+     * 
+     * Die Charaktere sind noch im Store; Modelle rufen hier
+     * beginRemoveRows() auf. Auf jedes rowsAboutToBeRemoved() folgt ein
+     * rowsRemoved() mit demselben Bereich. Innerhalb eines ChangeBatch wird
+     * stattdessen am Ende rowsReset() gesendet.
+     * 
+     * @param first Der erste zu entfernende Index
+     * @param last Der letzte zu entfernende Index (einschließlich)
+     */
+    void rowsAboutToBeRemoved(int first, int last);
+    
+    /**
+     * @brief Signal, das gesendet wird, wenn Charaktere entfernt wurden.
+     * 
+     * Die Indizes beziehen sich auf den Zustand vor dem Entfernen.
+     * 
+     * @param first Der erste entfernte Index
+     * @param last Der letzte entfernte Index (einschließlich)
+     */
+    void rowsRemoved(int first, int last);
+    
+    /**
+     * @brief Signal, das gesendet wird, wenn Werte vorhandener Charaktere geändert wurden.
+     * 
+     * @param first Der erste betroffene Index
+     * @param last Der letzte betroffene Index (einschließlich)
+     * @param fields Bitmaske der geänderten Spalten (CharacterStore::FieldMask)
+     */
+    void rowsUpdated(int first, int last, quint32 fields);
+    
+    /**
+     * @brief Signal, das gesendet wird, wenn sich die Liste grundlegend geändert hat.
+     * 
+     * Z.B. nach dem Laden einer Datei oder wenn ein Batch Einfügen und
+     * Entfernen mischt. Empfänger müssen alles neu lesen.
+     */
+    void rowsReset();
+    
+    /**
+     * @brief Signal, das während loadFromFile() den Lesefortschritt meldet.
+     * 
+     * @param bytesRead Die bisher gelesenen Bytes
+     * @param bytesTotal Die Größe der Datei
+     */
+    void loadProgress(qint64 bytesRead, qint64 bytesTotal);
+    
 private:
     /**
-     * Qt-Konzept: QVector als Container
-     * QVector ist Qt's Implementierung eines dynamischen Arrays. Es bietet ähnliche
-     * Funktionalität wie std::vector, ist aber besser in das Qt-Framework integriert.
-     * QVector unterstützt implizites Sharing (Copy-on-Write) für effiziente Kopieroperationen.
+     * @brief Die groben Signale, die in einem Batch vorgemerkt werden.
+     */
+    enum CoarseSignal {
+        CharactersChangedSignal = 0x1,  ///< charactersChanged()
+        InitiativeRolledSignal = 0x2,   ///< initiativeRolled()
+        SavesRolledSignal = 0x4         ///< savesRolled()
+    };
+    
+    /**
+     * @brief Meldet eingefügte Zeilen oder merkt sie im Batch vor.
+     * 
+     * @param first Der erste neue Index
+     * @param last Der letzte neue Index
+     */
+    void notifyInserted(int first, int last);
+    
+    /**
+     * @brief Meldet Zeilen, die gleich entfernt werden (nicht im Batch).
+     * 
+     * @param first Der erste zu entfernende Index
+     * @param last Der letzte zu entfernende Index
+     */
+    void notifyAboutToBeRemoved(int first, int last);
+    
+    /**
+     * @brief Meldet entfernte Zeilen oder merkt sie im Batch vor.
+     * 
+     * @param first Der erste entfernte Index
+     * @param last Der letzte entfernte Index
+     */
+    void notifyRemoved(int first, int last);
+    
+    /**
+     * @brief Meldet geänderte Werte oder merkt sie im Batch vor.
+     * 
+     * @param first Der erste betroffene Index
+     * @param last Der letzte betroffene Index
+     * @param fields Die geänderten Spalten
+     */
+    void notifyUpdated(int first, int last, CharacterStore::FieldMask fields);
+    
+    /**
+     * @brief Meldet eine grundlegende Änderung oder merkt sie im Batch vor.
+     */
+    void notifyReset();
+    
+    /**
+     * @brief Sendet ein grobes Signal oder merkt es im Batch vor.
+     * 
+     * @param signal Das zu sendende Signal
+     */
+    void notifyCoarse(CoarseSignal signal);
+    
+    /**
+     * @brief Sendet alle im Batch gesammelten Signale.
+     */
+    void flushChanges();
+    
+    /**
+     * @brief Würfelt einen W20 für jeden Eintrag einer Wurf-Spalte.
+     * 
+     * Die ganze Spalte ist ein Würfelereignis. Zusammenhängende Bereiche von
+     * Würfelschlüsseln werden jeweils in einem Aufruf von der DiceEngine gefüllt.
+     * 
+     * @param field Die Wurf-Spalte im CharacterStore
+     */
+    void rollColumn(CharacterStore::Field field);
+    
+    /**
+     * @brief Reserviert die Nummer für das nächste Würfelereignis.
+     * 
+     * Die Ereignisspalten speichern die Nummer als int, -1 steht für einen
+     * nicht nachprüfbaren Wurf. Sind alle Nummern bis INT_MAX vergeben,
+     * beginnt vorher eine neue Sitzung (siehe setSessionSeed()), damit keine
+     * Nummer überläuft und mit -1 oder älteren Ereignissen zusammenfällt.
+     * 
+     * @return Eine Ereignisnummer im Bereich 0 bis INT_MAX
+     */
+    quint64 nextRollEvent();
+    
+    /**
+     * @brief Würfelt einen W20 für einen einzelnen Charakter als eigenes Würfelereignis.
+     * 
+     * @param index Der Index des Charakters
+     * @param field Die Wurf-Spalte im CharacterStore
+     */
+    void rollSingle(int index, CharacterStore::Field field);
+    
+    /**
+     * @brief Baut nach dem Laden die Reihenfolge neu auf und meldet den neuen Stand.
+     */
+    void finishLoading();
+    
+    /**
+     * Die Charaktere werden spaltenweise gespeichert (siehe CharacterStore),
+     * damit Operationen wie rollAllInitiatives() nur die benötigten Spalten
+     * durchlaufen.
+     */
+    CharacterStore m_store;  ///< Die Charaktere in spaltenweiser Speicherung
+    InitiativeOrder m_order; ///< Die laufend sortierte Initiative-Reihenfolge
+    DiceEngine m_dice;       ///< Generator aller Würfe, Seed = Sitzungsschlüssel
+    int m_nextRollKey;       ///< Der Würfelschlüssel für den nächsten Charakter
+    
+    /**
+     * Gesammelte Änderungen eines Batches. Eingefügt wird immer am Ende, daher
+     * reicht für neue Zeilen der erste neue Index. Geänderte Zeilen werden zu
+     * einem umschließenden Bereich zusammengefasst.
      */
-    QVector<Character> m_characters;  ///< Die Liste der Charaktere
+    int m_batchDepth;                         ///< Verschachtelungstiefe der Batches
+    bool m_pendingReset;                      ///< Batch erfordert rowsReset()
+    int m_pendingInsertFirst;                 ///< Erster im Batch eingefügter Index (-1 = keiner)
+    int m_pendingUpdateFirst;                 ///< Erster geänderter Index (-1 = keiner)
+    int m_pendingUpdateLast;                  ///< Letzter geänderter Index
+    CharacterStore::FieldMask m_pendingFields; ///< Vereinigung der geänderten Spalten
+    int m_pendingSignals;                     ///< Vorgemerkte grobe Signale (CoarseSignal)
 };
 
 #endif // INITIATIVETRACKER_H 
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "mainwindow.h"  // Einbinden der MainWindow-Klasse
+#include "trace.h"       // Log-Kategorien und binäre Aufzeichnung
 
 // Qt-Includes für die Anwendung
 #include <QApplication>  // Hauptklasse für Qt-Anwendungen mit GUI
@@ -33,6 +34,15 @@ int main(int argc, char *argv[])
     // alle Qt-Ressourcen und verwaltet die Ereignisverarbeitung.
     QApplication a(argc, argv);
     
+#if DND_BINARY_TRACE
+    // Binäre Aufzeichnung starten, wenn eine Zieldatei angegeben ist
+    // (z.B. DND_TRACE_FILE=trace.bin). Die Datei wird beim Beenden geschrieben.
+    const QString traceFile = qEnvironmentVariable("DND_TRACE_FILE");
+    if (!traceFile.isEmpty()) {
+        Trace::start();
+    }
+#endif
+    
     // Übersetzungen einrichten
     // Qt-Konzept: Internationalisierung (i18n)
     // Qt bietet umfassende Unterstützung für mehrsprachige Anwendungen.
@@ -69,5 +79,13 @@ int main(int argc, char *argv[])
     // 4. Aktualisieren der Benutzeroberfläche
     // Die Schleife läuft, bis die Anwendung beendet wird (z.B. durch Schließen des Hauptfensters).
     // Der Rückgabewert von exec() wird als Rückgabewert der main()-Funktion verwendet.
-    return a.exec();
+    const int result = a.exec();
+    
+#if DND_BINARY_TRACE
+    if (!traceFile.isEmpty()) {
+        Trace::stop(traceFile);
+    }
+#endif
+    
+    return result;
 } 
\ No newline at end of file
@@ -1,18 +1,16 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
+#include "encounterarchive.h"
+#include "snapshotfile.h"
+#include "trace.h"
 #include <QMessageBox>
-#include <QDebug>
 #include <QDesktopServices>
-#include <QPushButton>
 #include <QStandardItemModel>
 #include <QSortFilterProxyModel>
 #include <QHeaderView>
 #include <QFileDialog>
+#include <QInputDialog>
 #include <QCloseEvent>
-#include <QColor>
-#include <QBrush>
-#include <QFont>
-#include <QSignalBlocker>
 #include <QVBoxLayout>
 #include <QJsonDocument>
 #include <QJsonObject>
@@ -35,40 +33,41 @@ MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
     , m_initiativeTracker(this)
+    , m_storage(&m_initiativeTracker)
+    , m_service(&m_initiativeTracker)
 {
     // Lädt und initialisiert die UI aus der .ui-Datei
     ui->setupUi(this);
     
-    // Erstelle das Datenmodell für die Tabelle
-    m_model = new QStandardItemModel(this);
+    // Erstelle das Datenmodell für die Tabelle. Es liest direkt aus dem
+    // Tracker und meldet Änderungen selbst an die View.
+    m_model = new CharacterTableModel(&m_initiativeTracker, this);
     m_proxyModel = new QSortFilterProxyModel(this);
     m_proxyModel->setSourceModel(m_model);
+    m_proxyModel->setSortRole(CharacterTableModel::SortRole);
     
-    // Verbinde das Signal itemChanged des Modells mit unserem Slot
-    connect(m_model, &QStandardItemModel::itemChanged, this, &MainWindow::onItemChanged);
-    
-    // Setze die Spaltenüberschriften
-    QStringList headers;
-    headers << "Name" 
-            << "Initiative Mod" << "Initiative Ergebnis" << "Würfeln"
-            << "Willenskraft" << "Will Ergebnis" << "Würfeln"
-            << "Reflex" << "Reflex Ergebnis" << "Würfeln"
-            << "Konstitution" << "Konst. Ergebnis" << "Würfeln";
-    m_model->setHorizontalHeaderLabels(headers);
     // Konfiguriere die TableView
     ui->characterTableView->setModel(m_proxyModel);
     ui->characterTableView->setSortingEnabled(true);
     ui->characterTableView->setSelectionBehavior(QAbstractItemView::SelectRows);
     ui->characterTableView->setSelectionMode(QAbstractItemView::SingleSelection);
-    ui->characterTableView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    ui->characterTableView->setEditTriggers(QAbstractItemView::DoubleClicked | QAbstractItemView::EditKeyPressed);
+    
+    // Die Würfeln-Buttons zeichnet ein gemeinsamer Delegate, statt pro Zelle ein Widget anzulegen
+    m_rollButtonDelegate = new RollButtonDelegate("Würfeln", this);
+    ui->characterTableView->setItemDelegateForColumn(ROLL_INITIATIVE_COLUMN, m_rollButtonDelegate);
+    ui->characterTableView->setItemDelegateForColumn(ROLL_WILL_COLUMN, m_rollButtonDelegate);
+    ui->characterTableView->setItemDelegateForColumn(ROLL_REFLEX_COLUMN, m_rollButtonDelegate);
+    ui->characterTableView->setItemDelegateForColumn(ROLL_FORTITUDE_COLUMN, m_rollButtonDelegate);
+    connect(m_rollButtonDelegate, &RollButtonDelegate::rollRequested, this, &MainWindow::onRollRequested);
     ui->characterTableView->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
     ui->characterTableView->horizontalHeader()->setStretchLastSection(true);
     ui->characterTableView->setAlternatingRowColors(true);
     
     // Verbinde Signale und Slots
-    connect(&m_initiativeTracker, &InitiativeTracker::charactersChanged, this, &MainWindow::onCharactersChanged);
     connect(&m_initiativeTracker, &InitiativeTracker::initiativeRolled, this, &MainWindow::onInitiativeRolled);
-    connect(&m_initiativeTracker, &InitiativeTracker::savesRolled, this, &MainWindow::onSavesRolled);
+    connect(&m_initiativeTracker, &InitiativeTracker::loadProgress, this, &MainWindow::onLoadProgress);
+    connect(m_storage.autoSaver(), &AutoSaver::saveFinished, this, &MainWindow::onSaveFinished);
     
     // Erstelle das TextEdit für die empfangenen Nachrichten
     m_messageDisplay = ui->messageDisplay;
@@ -98,13 +97,9 @@ MainWindow::MainWindow(QWidget *parent)
     // Initialisiere den WebSocket-Server
     setupWebSocketServer();
     
-    // Lade gespeicherte Charaktere, falls vorhanden
-    if (m_initiativeTracker.loadFromFile()) {
-        qDebug() << "Charakterdaten erfolgreich geladen.";
-    }
-    
-    // Aktualisiere die Tabelle
-    updateTable();
+    // Lade gespeicherte Charaktere, falls vorhanden (das Modell wird über
+    // rowsReset() aktualisiert)
+    loadCharacters();
 }
 
 /**
@@ -115,15 +110,10 @@ MainWindow::MainWindow(QWidget *parent)
 MainWindow::~MainWindow()
 {
     // Speichere die Charaktere beim Beenden
-    if (m_initiativeTracker.saveToFile()) {
-        qDebug() << "Charakterdaten erfolgreich gespeichert.";
-    }
+    saveCharacters();
     
-    // Schließe den WebSocket-Server
-    if (m_webSocketServer) {
-        m_webSocketServer->close();
-        qDeleteAll(m_clients);
-    }
+    // Schließe den WebSocket-Server und beende den Netzwerk-Thread
+    m_service.stop();
     
     delete ui;
 }
@@ -153,32 +143,20 @@ void MainWindow::closeEvent(QCloseEvent *event)
  */
 void MainWindow::loadCharacters()
 {
-    // Versucht, die Charakterdaten aus der Datei zu laden
-    bool success = m_initiativeTracker.loadFromFile();
-    
-    if (success) {
-        qDebug() << "Charakterdaten erfolgreich geladen.";
-    } else {
-        qDebug() << "Keine gespeicherten Charakterdaten gefunden oder Fehler beim Laden.";
-    }
+    // Journal, Snapshot oder JSON-Datei; danach wird jede Änderung gespeichert
+    m_storage.load();
 }
 
 /**
  * @brief Speichert die aktuellen Charakterdaten
  * 
- * Wird beim Beenden der Anwendung aufgerufen, um die Charakterdaten
- * für den nächsten Start zu speichern.
+ * Wird beim Beenden der Anwendung aufgerufen. Das Journal enthält bereits
+ * jede Änderung und der AutoSaver hat die JSON-Datei meist schon
+ * geschrieben. Hier wird nur auf ihn gewartet und das Journal verdichtet.
  */
 void MainWindow::saveCharacters()
 {
-    // Speichert die Charakterdaten in der Datei
-    bool success = m_initiativeTracker.saveToFile();
-    
-    if (success) {
-        qDebug() << "Charakterdaten erfolgreich gespeichert.";
-    } else {
-        qDebug() << "Fehler beim Speichern der Charakterdaten.";
-    }
+    m_storage.save();
 }
 
 /**
@@ -189,39 +167,25 @@ void MainWindow::saveCharacters()
  */
 void MainWindow::on_addButton_clicked()
 {
-    qDebug() << "on_addButton_clicked: Start";
-    
     // Hole die Werte aus den Eingabefeldern
     QString name = ui->nameLineEdit->text().trimmed();
-    qDebug() << "on_addButton_clicked: Name =" << name;
-    
     int initiativeModifier = ui->initiativeSpinBox->value();
-    qDebug() << "on_addButton_clicked: Initiative =" << initiativeModifier;
-    
     int willSave = ui->willSpinBox->value();
-    qDebug() << "on_addButton_clicked: Will =" << willSave;
-    
     int reflexSave = ui->reflexSpinBox->value();
-    qDebug() << "on_addButton_clicked: Reflex =" << reflexSave;
-    
     int fortitudeSave = ui->fortitudeSpinBox->value();
-    qDebug() << "on_addButton_clicked: Fortitude =" << fortitudeSave;
+    TRACE_DEBUG(lcUi) << "on_addButton_clicked:" << name << initiativeModifier
+                      << willSave << reflexSave << fortitudeSave;
     
     // Überprüfe, ob ein Name eingegeben wurde
     if (name.isEmpty()) {
         QMessageBox::warning(this, "Fehler", "Bitte geben Sie einen Namen ein.");
-        qDebug() << "on_addButton_clicked: Leerer Name, Abbruch";
         return;
     }
     
-    qDebug() << "on_addButton_clicked: Erstelle neuen Charakter";
     // Erstelle einen neuen Charakter und füge ihn hinzu
     Character character(name, initiativeModifier, willSave, reflexSave, fortitudeSave);
-    
-    qDebug() << "on_addButton_clicked: Füge Charakter zum Tracker hinzu";
     m_initiativeTracker.addCharacter(character);
     
-    qDebug() << "on_addButton_clicked: Leere Eingabefelder";
     // Leere die Eingabefelder
     ui->nameLineEdit->clear();
     ui->initiativeSpinBox->setValue(0);
@@ -229,8 +193,6 @@ void MainWindow::on_addButton_clicked()
     ui->reflexSpinBox->setValue(0);
     ui->fortitudeSpinBox->setValue(0);
     ui->nameLineEdit->setFocus();
-    
-    qDebug() << "on_addButton_clicked: Ende";
 }
 
 /**
@@ -265,7 +227,7 @@ void MainWindow::on_removeButton_clicked()
 void MainWindow::on_clearButton_clicked()
 {
     // Überprüfen, ob Charaktere vorhanden sind
-    if (m_initiativeTracker.getCharacters().isEmpty()) {
+    if (m_initiativeTracker.isEmpty()) {
         return;
     }
     
@@ -288,7 +250,7 @@ void MainWindow::on_clearButton_clicked()
 void MainWindow::on_rollInitiativeButton_clicked()
 {
     // Überprüfen, ob Charaktere vorhanden sind
-    if (m_initiativeTracker.getCharacters().isEmpty()) {
+    if (m_initiativeTracker.isEmpty()) {
         QMessageBox::information(this, "Information", "Fügen Sie zuerst Charaktere hinzu.");
         return;
     }
@@ -300,20 +262,32 @@ void MainWindow::on_rollInitiativeButton_clicked()
 /**
  * @brief Slot, der aufgerufen wird, wenn der "Speichern"-Button geklickt wird
  * 
- * Öffnet einen Datei-Dialog zum Speichern der Charakterdaten.
+ * Öffnet einen Datei-Dialog zum Speichern der Charakterdaten. Die Datei
+ * wird im Hintergrund geschrieben, die Oberfläche bleibt bedienbar.
  */
 void MainWindow::on_saveButton_clicked()
 {
     // Öffne einen Datei-Dialog zum Speichern
     QString filename = QFileDialog::getSaveFileName(
-        this, "Charaktere speichern", "", "JSON-Dateien (*.json);;Alle Dateien (*)");
+        this, "Charaktere speichern", "",
+        "JSON-Dateien (*.json);;Snapshot-Dateien (*.dndsnap);;"
+        "Encounter-Archive (*.dndarch);;Alle Dateien (*)");
     
-    if (!filename.isEmpty()) {
-        if (m_initiativeTracker.saveToFile(filename)) {
-            QMessageBox::information(this, "Erfolg", "Charaktere erfolgreich gespeichert.");
-        } else {
-            QMessageBox::warning(this, "Fehler", "Fehler beim Speichern der Charaktere.");
+    if (filename.isEmpty()) {
+        return;
+    }
+    
+    // Gespeichert wird im Hintergrund, das Ergebnis meldet onSaveFinished().
+    // Das Format ergibt sich aus der Dateiendung.
+    if (filename.endsWith(".dndarch", Qt::CaseInsensitive)) {
+        bool ok = false;
+        const QString name = QInputDialog::getText(this, tr("Begegnung speichern"),
+            tr("Name der Begegnung:"), QLineEdit::Normal, QString(), &ok).trimmed();
+        if (ok && !name.isEmpty()) {
+            m_storage.autoSaver()->saveEncounter(filename, name);
         }
+    } else {
+        m_storage.autoSaver()->saveAs(filename);
     }
 }
 
@@ -326,12 +300,36 @@ void MainWindow::on_loadButton_clicked()
 {
     QString fileName = QFileDialog::getOpenFileName(this,
         tr("Charaktere laden"), "",
-        tr("JSON-Dateien (*.json);;Alle Dateien (*)"));
+        tr("JSON-Dateien (*.json);;Snapshot-Dateien (*.dndsnap);;"
+           "Encounter-Archive (*.dndarch);;Alle Dateien (*)"));
         
-    if (!fileName.isEmpty()) {
-        if (m_initiativeTracker.loadFromFile(fileName)) {
-            updateTable();
-            qDebug() << "Charaktere erfolgreich geladen aus:" << fileName;
+    if (!fileName.isEmpty() && EncounterArchive::isArchive(fileName)) {
+        // Aus einem Archiv wird nur die gewählte Begegnung gelesen
+        EncounterArchive archive(fileName);
+        if (!archive.open() || archive.count() == 0) {
+            QMessageBox::warning(this, tr("Fehler"),
+                tr("Das Archiv enthält keine lesbaren Begegnungen."));
+            return;
+        }
+        bool ok = false;
+        const QString name = QInputDialog::getItem(this, tr("Begegnung laden"),
+            tr("Begegnung:"), archive.names(), 0, false, &ok);
+        if (!ok) {
+            return;
+        }
+        if (m_initiativeTracker.loadEncounter(fileName, name)) {
+            TRACE_INFO(lcStorage) << "Begegnung" << name << "geladen aus:" << fileName;
+        } else {
+            QMessageBox::warning(this, tr("Fehler"),
+                tr("Fehler beim Laden der Begegnung."));
+        }
+    } else if (!fileName.isEmpty()) {
+        // Snapshots werden an ihrer Kennung erkannt, alles andere als JSON gelesen
+        const bool loaded = SnapshotFile::isSnapshot(fileName)
+            ? m_initiativeTracker.loadSnapshot(fileName)
+            : m_initiativeTracker.loadFromFile(fileName);
+        if (loaded) {
+            TRACE_INFO(lcStorage) << "Charaktere erfolgreich geladen aus:" << fileName;
         } else {
             QMessageBox::warning(this, tr("Fehler"),
                 tr("Fehler beim Laden der Charaktere."));
@@ -339,6 +337,24 @@ void MainWindow::on_loadButton_clicked()
     }
 }
 
+/**
+ * @brief Slot, der aufgerufen wird, wenn der "Importieren"-Button geklickt wird
+ * 
+ * Öffnet einen Datei-Dialog und hängt die Charaktere der Datei an.
+ */
+void MainWindow::on_importButton_clicked()
+{
+    QString fileName = QFileDialog::getOpenFileName(this,
+        tr("Monsterliste importieren"), "",
+        tr("CSV/TSV-Dateien (*.csv *.tsv *.txt);;Alle Dateien (*)"));
+        
+    if (!fileName.isEmpty() && !m_initiativeTracker.importCsvFile(fileName)) {
+        QMessageBox::warning(this, tr("Fehler"),
+            tr("Fehler beim Importieren der Monsterliste. Die erste Zeile muss "
+               "die Spaltennamen enthalten, darunter \"name\"."));
+    }
+}
+
 /**
  * @brief Slot, der aufgerufen wird, wenn der "Log anzeigen/ausblenden"-Button geklickt wird.
  * 
@@ -353,298 +369,72 @@ void MainWindow::on_toggleLogButton_clicked()
     }
 }
 
-void MainWindow::onCharactersChanged()
-{
-    static bool isUpdating = false;
-    
-    qDebug() << "onCharactersChanged: Start";
-    
-    // Verhindere rekursive Aufrufe
-    if (isUpdating) {
-        qDebug() << "onCharactersChanged: Bereits beim Aktualisieren, ignoriere";
-        return;
-    }
-    
-    isUpdating = true;
-    
-    // Aktualisiere die Tabelle, wenn sich die Charakterliste ändert
-    updateTable();
-    
-    isUpdating = false;
-    
-    qDebug() << "onCharactersChanged: Ende";
-}
-
 void MainWindow::onInitiativeRolled()
 {
-    qDebug() << "onInitiativeRolled: Start";
-    
-    // Aktualisiere die Tabelle
-    updateTable();
-    
-    // Sortiere nach Initiative
+    // Die Werte aktualisiert das Modell selbst, hier wird nur nach Initiative sortiert
     ui->characterTableView->sortByColumn(TOTAL_INITIATIVE_COLUMN, Qt::DescendingOrder);
-    qDebug() << "onInitiativeRolled: Nach Initiative sortiert";
-    
-    // Aktualisiere die Buttons nach dem Sortieren
-    QVector<Character> characters = m_initiativeTracker.getCharacters();
-    qDebug() << "onInitiativeRolled: Anzahl Charaktere =" << characters.size();
-    
-    for (int i = 0; i < characters.size(); ++i) {
-        const Character &character = characters[i];
-        
-        // Finde die tatsächliche Zeile nach dem Sortieren
-        QModelIndex sourceIndex = m_model->index(i, 0);
-        QModelIndex proxyIndex = m_proxyModel->mapFromSource(sourceIndex);
-        int visualRow = proxyIndex.row();
-        
-        qDebug() << "onInitiativeRolled: Charakter" << i << "(" << character.getName() << ") ist jetzt in Zeile" << visualRow;
-        
-        // Erstelle die Buttons für die Würfelwürfe
-        createRollButton(visualRow, ROLL_INITIATIVE_COLUMN, "d20", character.getInitiativeModifier(), "Würfeln");
-        createRollButton(visualRow, ROLL_WILL_COLUMN, "will", character.getWillSave(), "Würfeln");
-        createRollButton(visualRow, ROLL_REFLEX_COLUMN, "reflex", character.getReflexSave(), "Würfeln");
-        createRollButton(visualRow, ROLL_FORTITUDE_COLUMN, "fortitude", character.getFortitudeSave(), "Würfeln");
-    }
-    
-    qDebug() << "onInitiativeRolled: Ende";
-}
-
-void MainWindow::onSavesRolled()
-{
-    // Aktualisiere die Tabelle, wenn Rettungswürfe gewürfelt wurden
-    updateTable();
 }
 
-void MainWindow::updateTable()
+void MainWindow::onRollRequested(const QModelIndex &index)
 {
-    qDebug() << "updateTable: Start";
-    
-    // Speichere den aktuell ausgewählten Index
-    QModelIndex currentIndex = ui->characterTableView->currentIndex();
-    qDebug() << "updateTable: Aktueller Index =" << currentIndex;
-    
-    // Lösche alle Zeilen im Modell
-    m_model->removeRows(0, m_model->rowCount());
-    qDebug() << "updateTable: Zeilen gelöscht";
-    
-    // Hole die Charakterliste
-    QVector<Character> characters = m_initiativeTracker.getCharacters();
-    qDebug() << "updateTable: Anzahl Charaktere =" << characters.size();
-    
-    // Aktiviere die Bearbeitung für die Tabelle, damit die Buttons angezeigt werden können
-    ui->characterTableView->setEditTriggers(QAbstractItemView::DoubleClicked | QAbstractItemView::EditKeyPressed);
-    
-    // Füge jeden Charakter zur Tabelle hinzu
-    for (int i = 0; i < characters.size(); ++i) {
-        qDebug() << "updateTable: Verarbeite Charakter" << i << ":" << characters[i].getName();
-        const Character &character = characters[i];
-        
-        // Erstelle die Items für die Zeile
-        QList<QStandardItem*> rowItems;
-        
-        // Name
-        QStandardItem *nameItem = new QStandardItem(character.getName());
-        QFont boldFont = nameItem->font();
-        boldFont.setBold(true);
-        nameItem->setFont(boldFont);
-        nameItem->setEditable(false); // Name nicht editierbar
-        rowItems.append(nameItem);
-        
-        // Initiative Modifier - editierbar
-        QStandardItem *initiativeModItem = new QStandardItem(QString::number(character.getInitiativeModifier()));
-        initiativeModItem->setEditable(true);
-        // Speichere den ursprünglichen Wert für die Wiederherstellung
-        initiativeModItem->setData(QString::number(character.getInitiativeModifier()), Qt::UserRole + 1);
-        rowItems.append(initiativeModItem);
-        
-        // Initiative Ergebnis - nicht editierbar
-        QStandardItem *totalInitiativeItem = new QStandardItem();
-        if (character.getInitiativeRoll() > 0) {
-            totalInitiativeItem->setText(QString("%1 (%2)").arg(character.getTotalInitiative())
-                                        .arg(character.getInitiativeRoll()));
-            totalInitiativeItem->setForeground(QBrush(QColor(0, 100, 0))); // Dunkelgrün
-        } else {
-            totalInitiativeItem->setText("-");
-        }
-        QFont totalFont = totalInitiativeItem->font();
-        totalFont.setBold(true);
-        totalInitiativeItem->setFont(totalFont);
-        totalInitiativeItem->setEditable(false);
-        rowItems.append(totalInitiativeItem);
-        
-        // Initiative würfeln (leere Zelle für den Button)
-        QStandardItem *rollInitiativeItem = new QStandardItem();
-        rollInitiativeItem->setEditable(false);
-        rowItems.append(rollInitiativeItem);
-        
-        // Willenskraft Modifikator - editierbar
-        QStandardItem *willSaveItem = new QStandardItem(QString::number(character.getWillSave()));
-        willSaveItem->setEditable(true);
-        // Speichere den ursprünglichen Wert für die Wiederherstellung
-        willSaveItem->setData(QString::number(character.getWillSave()), Qt::UserRole + 1);
-        rowItems.append(willSaveItem);
-        
-        // Willenskraft Ergebnis - nicht editierbar
-        QStandardItem *willResultItem = new QStandardItem();
-        if (character.getLastWillSaveRoll() > 0) {
-            willResultItem->setText(QString("%1 (%2)").arg(character.getLastWillSaveRoll() + character.getWillSave())
-                                   .arg(character.getLastWillSaveRoll()));
-            willResultItem->setForeground(QBrush(QColor(0, 100, 0))); // Dunkelgrün
-        } else {
-            willResultItem->setText("-");
-        }
-        willResultItem->setEditable(false);
-        rowItems.append(willResultItem);
-        
-        // Willenskraft würfeln (leere Zelle für den Button)
-        QStandardItem *rollWillItem = new QStandardItem();
-        rollWillItem->setEditable(false);
-        rowItems.append(rollWillItem);
-        
-        // Reflex Modifikator - editierbar
-        QStandardItem *reflexSaveItem = new QStandardItem(QString::number(character.getReflexSave()));
-        reflexSaveItem->setEditable(true);
-        // Speichere den ursprünglichen Wert für die Wiederherstellung
-        reflexSaveItem->setData(QString::number(character.getReflexSave()), Qt::UserRole + 1);
-        rowItems.append(reflexSaveItem);
-        
-        // Reflex Ergebnis - nicht editierbar
-        QStandardItem *reflexResultItem = new QStandardItem();
-        if (character.getLastReflexSaveRoll() > 0) {
-            reflexResultItem->setText(QString("%1 (%2)").arg(character.getLastReflexSaveRoll() + character.getReflexSave())
-                                     .arg(character.getLastReflexSaveRoll()));
-            reflexResultItem->setForeground(QBrush(QColor(0, 100, 0))); // Dunkelgrün
-        } else {
-            reflexResultItem->setText("-");
-        }
-        reflexResultItem->setEditable(false);
-        rowItems.append(reflexResultItem);
-        
-        // Reflex würfeln (leere Zelle für den Button)
-        QStandardItem *rollReflexItem = new QStandardItem();
-        rollReflexItem->setEditable(false);
-        rowItems.append(rollReflexItem);
-        
-        // Konstitution Modifikator - editierbar
-        QStandardItem *fortitudeSaveItem = new QStandardItem(QString::number(character.getFortitudeSave()));
-        fortitudeSaveItem->setEditable(true);
-        // Speichere den ursprünglichen Wert für die Wiederherstellung
-        fortitudeSaveItem->setData(QString::number(character.getFortitudeSave()), Qt::UserRole + 1);
-        rowItems.append(fortitudeSaveItem);
-        
-        // Konstitution Ergebnis - nicht editierbar
-        QStandardItem *fortitudeResultItem = new QStandardItem();
-        if (character.getLastFortitudeSaveRoll() > 0) {
-            fortitudeResultItem->setText(QString("%1 (%2)").arg(character.getLastFortitudeSaveRoll() + character.getFortitudeSave())
-                                        .arg(character.getLastFortitudeSaveRoll()));
-            fortitudeResultItem->setForeground(QBrush(QColor(0, 100, 0))); // Dunkelgrün
-        } else {
-            fortitudeResultItem->setText("-");
-        }
-        fortitudeResultItem->setEditable(false);
-        rowItems.append(fortitudeResultItem);
-        
-        // Konstitution würfeln (leere Zelle für den Button)
-        QStandardItem *rollFortitudeItem = new QStandardItem();
-        rollFortitudeItem->setEditable(false);
-        rowItems.append(rollFortitudeItem);
-        
-        // Füge die Zeile zum Modell hinzu
-        m_model->appendRow(rowItems);
-        qDebug() << "updateTable: Zeile für Charakter" << i << "hinzugefügt";
-        
-        // Speichere die Zeilen-ID als Eigenschaft für jedes Item
-        for (QStandardItem *item : rowItems) {
-            item->setData(i, Qt::UserRole);
-        }
-    }
-    
-    qDebug() << "updateTable: Erstelle Buttons";
-    // Erstelle die Buttons für alle Zeilen
-    for (int i = 0; i < characters.size(); ++i) {
-        const Character &character = characters[i];
-        
-        // Erstelle die Buttons für die Würfelwürfe
-        qDebug() << "updateTable: Erstelle Buttons für Zeile" << i;
-        
-        createRollButton(i, ROLL_INITIATIVE_COLUMN, "d20", character.getInitiativeModifier(), "Würfeln");
-        createRollButton(i, ROLL_WILL_COLUMN, "will", character.getWillSave(), "Würfeln");
-        createRollButton(i, ROLL_REFLEX_COLUMN, "reflex", character.getReflexSave(), "Würfeln");
-        createRollButton(i, ROLL_FORTITUDE_COLUMN, "fortitude", character.getFortitudeSave(), "Würfeln");
-    }
+    // Konvertiere den Proxy-Index in den Quellindex
+    QModelIndex sourceIndex = m_proxyModel->mapToSource(index);
+    if (!sourceIndex.isValid()) return;
+    int sourceRow = sourceIndex.row();
     
-    // Stelle die Auswahl wieder her, falls möglich
-    if (currentIndex.isValid() && currentIndex.row() < characters.size()) {
-        ui->characterTableView->setCurrentIndex(currentIndex);
-        qDebug() << "updateTable: Auswahl wiederhergestellt";
+    // Führe den Würfelwurf der angeklickten Spalte durch
+    switch (sourceIndex.column()) {
+    case ROLL_INITIATIVE_COLUMN:
+        m_initiativeTracker.rollInitiativeForCharacter(sourceRow);
+        break;
+    case ROLL_WILL_COLUMN:
+        m_initiativeTracker.rollWillSaveForCharacter(sourceRow);
+        break;
+    case ROLL_REFLEX_COLUMN:
+        m_initiativeTracker.rollReflexSaveForCharacter(sourceRow);
+        break;
+    case ROLL_FORTITUDE_COLUMN:
+        m_initiativeTracker.rollFortitudeSaveForCharacter(sourceRow);
+        break;
+    default:
+        break;
     }
-    
-    qDebug() << "updateTable: Ende";
 }
 
-void MainWindow::createRollButton(int row, int column, const QString &diceType, int modifier, const QString &label)
+void MainWindow::onLoadProgress(qint64 bytesRead, qint64 bytesTotal)
 {
-    qDebug() << "createRollButton: Start - Zeile:" << row << "Spalte:" << column << "Typ:" << diceType;
-    
-    // Erstelle einen Button für den Würfelwurf
-    QPushButton *button = new QPushButton(label);
-    button->setProperty("row", row);
-    button->setProperty("column", column);
-    button->setProperty("diceType", diceType);
-    button->setProperty("modifier", modifier);
-    
-    qDebug() << "createRollButton: Button erstellt";
-    
-    // Verbinde den Button mit dem Slot
-    connect(button, &QPushButton::clicked, this, &MainWindow::onRollDiceButtonClicked);
-    
-    qDebug() << "createRollButton: Button verbunden";
-    
-    // Setze den Button in die Tabelle
-    QModelIndex index = m_proxyModel->index(row, 0);
-    qDebug() << "createRollButton: Index erstellt - gültig:" << index.isValid() << " Zeile:" << index.row() << " Spalte:" << index.column();
-    
-    if (index.isValid()) {
-        ui->characterTableView->setIndexWidget(index, button);
-        qDebug() << "createRollButton: Button in Tabelle gesetzt";
-    } else {
-        qDebug() << "createRollButton: Ungültiger Index, Button nicht gesetzt";
-        delete button; // Verhindere Memory-Leak
+    if (bytesTotal <= 0 || bytesRead >= bytesTotal) {
+        ui->statusbar->clearMessage();
+        return;
     }
     
-    qDebug() << "createRollButton: Ende";
+    // Das Laden läuft ohne Ereignisschleife, daher sofort neu zeichnen
+    ui->statusbar->showMessage(tr("Lade Charaktere: %1 %").arg(bytesRead * 100 / bytesTotal));
+    ui->statusbar->repaint();
 }
 
-void MainWindow::onRollDiceButtonClicked()
+/**
+ * @brief Meldet das Ergebnis eines Speichervorgangs im Hintergrund
+ * 
+ * Für das automatische Speichern wird nur ein Fehler in der Statusleiste
+ * gemeldet, für "Speichern" wie bisher ein Dialog angezeigt.
+ * 
+ * @param filename Die geschriebene Datei
+ * @param success true, wenn die Datei vollständig geschrieben wurde
+ */
+void MainWindow::onSaveFinished(const QString &filename, bool success)
 {
-    // Hole den Sender-Button
-    QPushButton *button = qobject_cast<QPushButton*>(sender());
-    if (!button) return;
-    
-    // Hole die Eigenschaften des Buttons
-    int row = button->property("row").toInt();
-    int column = button->property("column").toInt();
-    QString diceType = button->property("diceType").toString();
-    
-    // Konvertiere den Proxy-Index in den Quellindex
-    QModelIndex proxyIndex = m_proxyModel->index(row, 0);
-    QModelIndex sourceIndex = m_proxyModel->mapToSource(proxyIndex);
-    int sourceRow = sourceIndex.row();
+    if (filename == m_storage.autoSaver()->filename()) {
+        if (!success) {
+            ui->statusbar->showMessage(tr("Automatisches Speichern fehlgeschlagen"), 5000);
+        }
+        return;
+    }
     
-    // Führe den entsprechenden Würfelwurf durch
-    if (diceType == "d20") {
-        // Initiative würfeln
-        m_initiativeTracker.rollInitiativeForCharacter(sourceRow);
-    } else if (diceType == "will") {
-        // Willenskraft würfeln
-        m_initiativeTracker.rollWillSaveForCharacter(sourceRow);
-    } else if (diceType == "reflex") {
-        // Reflex würfeln
-        m_initiativeTracker.rollReflexSaveForCharacter(sourceRow);
-    } else if (diceType == "fortitude") {
-        // Konstitution würfeln
-        m_initiativeTracker.rollFortitudeSaveForCharacter(sourceRow);
+    if (success) {
+        QMessageBox::information(this, "Erfolg", "Charaktere erfolgreich gespeichert.");
+    } else {
+        QMessageBox::warning(this, "Fehler", "Fehler beim Speichern der Charaktere.");
     }
 }
 
@@ -666,219 +456,68 @@ void MainWindow::on_rollFortitudeButton_clicked()
     m_initiativeTracker.rollAllFortitudeSaves();
 }
 
-void MainWindow::onItemChanged(QStandardItem *item)
-{
-    qDebug() << "onItemChanged: Start - Spalte:" << item->column();
-    
-    // Hole die Zeilen-ID aus den Eigenschaften des Items
-    int characterIndex = item->data(Qt::UserRole).toInt();
-    qDebug() << "onItemChanged: Character-Index:" << characterIndex;
-    
-    // Hole die Spalte des geänderten Items
-    int column = item->column();
-    
-    // Überprüfe, ob die Spalte editierbar ist
-    if (column != 1 && column != 4 && column != 7 && column != 10) {
-        qDebug() << "onItemChanged: Spalte nicht editierbar, ignoriere Änderung";
-        return;
-    }
-    
-    // Hole den neuen Wert
-    bool ok;
-    int newValue = item->text().toInt(&ok);
-    qDebug() << "onItemChanged: Neuer Wert:" << newValue << "Gültig:" << ok;
-    
-    // Wenn der Wert kein gültiger Integer ist, ignoriere die Änderung
-    if (!ok) {
-        qDebug() << "onItemChanged: Ungültiger Wert, ignoriere Änderung";
-        // Blockiere Signale, um eine Endlosschleife zu vermeiden
-        QSignalBlocker blocker(m_model);
-        item->setText(item->data(Qt::UserRole + 1).toString()); // Stelle den ursprünglichen Wert wieder her
-        return;
-    }
-    
-    // Aktualisiere den entsprechenden Wert im Character-Objekt
-    Character &character = m_initiativeTracker.getCharacterRef(characterIndex);
-    
-    // Blockiere Signale, um eine Endlosschleife zu vermeiden
-    QSignalBlocker blocker(m_model);
-    
-    if (column == 1) { // Initiative Modifier
-        qDebug() << "onItemChanged: Setze Initiative Modifier auf" << newValue;
-        character.setInitiativeModifier(newValue);
-    } else if (column == 4) { // Willenskraft
-        qDebug() << "onItemChanged: Setze Willenskraft auf" << newValue;
-        character.setWillSave(newValue);
-    } else if (column == 7) { // Reflex
-        qDebug() << "onItemChanged: Setze Reflex auf" << newValue;
-        character.setReflexSave(newValue);
-    } else if (column == 10) { // Konstitution
-        qDebug() << "onItemChanged: Setze Konstitution auf" << newValue;
-        character.setFortitudeSave(newValue);
-    }
-    
-    qDebug() << "onItemChanged: Ende";
-}
-
 /**
  * @brief Richtet den WebSocket-Server ein
  * 
- * Erstellt und konfiguriert den WebSocket-Server, der auf eingehende
- * Verbindungen wartet und Nachrichten empfängt.
+ * Startet den TrackerService, dessen Server in einem eigenen Netzwerk-Thread
+ * auf Verbindungen wartet. Befehle führt der Dienst selbst aus; hier
+ * werden nur Meldungen angezeigt und Würfelergebnisse übernommen.
  */
 void MainWindow::setupWebSocketServer()
 {
-    qDebug() << "setupWebSocketServer: Start";
-    
-    // Erstelle den WebSocket-Server
-    m_webSocketServer = new QWebSocketServer(QStringLiteral("D&D Initiative Tracker Server"),
-                                            QWebSocketServer::NonSecureMode, this);
+    connect(&m_service, &TrackerService::messageReceived, this, &MainWindow::onServerMessage);
+    connect(&m_service, &TrackerService::messageLogged, this, &MainWindow::displayReceivedMessage);
+    connect(&m_service, &TrackerService::clientConnected, this, [this](const QString &peer) {
+        m_messageDisplay->append("Neue Verbindung hergestellt: " + peer);
+    });
+    connect(&m_service, &TrackerService::clientDisconnected, this, [this](const QString &peer) {
+        m_messageDisplay->append("Verbindung getrennt: " + peer);
+    });
     
     // Versuche, den Server auf Port 8088 zu starten
-    if (m_webSocketServer->listen(QHostAddress::LocalHost, 8088)) {
-        qDebug() << "WebSocket-Server gestartet auf Port 8088";
-        
-        // Verbinde das Signal für neue Verbindungen
-        connect(m_webSocketServer, &QWebSocketServer::newConnection,
-                this, &MainWindow::onNewWebSocketConnection);
-        
+    if (m_service.start(QHostAddress::LocalHost, 8088)) {
         // Zeige eine Meldung im TextEdit an
         m_messageDisplay->append("WebSocket-Server gestartet auf ws://localhost:8088");
         m_messageDisplay->append("Warte auf Verbindungen...");
     } else {
-        qDebug() << "Fehler beim Starten des WebSocket-Servers:" << m_webSocketServer->errorString();
-        m_messageDisplay->append("Fehler beim Starten des WebSocket-Servers: " + m_webSocketServer->errorString());
+        m_messageDisplay->append("Fehler beim Starten des WebSocket-Servers: " + m_service.errorString());
     }
-    
-    qDebug() << "setupWebSocketServer: Ende";
-}
-
-/**
- * @brief Slot, der aufgerufen wird, wenn eine neue WebSocket-Verbindung hergestellt wird
- * 
- * Akzeptiert die Verbindung, verbindet die Signale und fügt den Client zur Liste hinzu.
- */
-void MainWindow::onNewWebSocketConnection()
-{
-    qDebug() << "onNewWebSocketConnection: Neue Verbindung";
-    
-    // Akzeptiere die Verbindung
-    QWebSocket *socket = m_webSocketServer->nextPendingConnection();
-    
-    // Verbinde die Signale
-    connect(socket, &QWebSocket::textMessageReceived, this, &MainWindow::processWebSocketMessage);
-    connect(socket, &QWebSocket::disconnected, this, &MainWindow::socketDisconnected);
-    
-    // Füge den Client zur Liste hinzu
-    m_clients << socket;
-    
-    // Zeige eine Meldung im TextEdit an
-    m_messageDisplay->append("Neue Verbindung hergestellt: " + socket->peerAddress().toString());
-    
-    qDebug() << "onNewWebSocketConnection: Client hinzugefügt";
 }
 
 /**
- * @brief Verarbeitet eine empfangene WebSocket-Nachricht
+ * @brief Übernimmt Würfelergebnisse aus einer WebSocket-Nachricht
  * 
- * Parst die JSON-Nachricht und zeigt sie im TextEdit an.
+ * Befehle hat der TrackerService zu diesem Zeitpunkt bereits ausgeführt
+ * und beantwortet.
  * 
- * @param message Die empfangene Nachricht
+ * @param clientId Der sendende Client
+ * @param jsonObj Die dekodierte Nachricht
+ * @param encoding Die Kodierung des Clients
  */
-void MainWindow::processWebSocketMessage(const QString &message)
+void MainWindow::onServerMessage(quint64 clientId, const QJsonObject &jsonObj, MessageCodec::Encoding encoding)
 {
-    qDebug() << "processWebSocketMessage: Nachricht empfangen:" << message;
+    Q_UNUSED(clientId);
+    Q_UNUSED(encoding);
     
-    // Zeige die Nachricht im TextEdit an
-    displayReceivedMessage(message);
-    
-    // Versuche, die Nachricht als JSON zu parsen
-    QJsonDocument jsonDoc = QJsonDocument::fromJson(message.toUtf8());
-    if (!jsonDoc.isNull() && jsonDoc.isObject()) {
-        QJsonObject jsonObj = jsonDoc.object();
+    // Verarbeite Würfelwurf-Nachrichten
+    if (jsonObj["type"].toString() == "roll_result") {
+        QJsonObject payload = jsonObj["payload"].toObject();
+        QJsonObject processedData = jsonObj["processedData"].toObject();
         
-        // Verarbeite Würfelwurf-Nachrichten
-        if (jsonObj["type"].toString() == "roll_result") {
-            QJsonObject payload = jsonObj["payload"].toObject();
-            QJsonObject processedData = jsonObj["processedData"].toObject();
-            
-            QString playerName = processedData["playerName"].toString();
-            QJsonArray operants = processedData["operants"].toArray();
-            
-            if (!operants.isEmpty()) {
-                QJsonObject firstOperant = operants[0].toObject();
-                QJsonObject result = firstOperant["result"].toObject();
-                QJsonArray operands = result["operands"].toArray();
-                
-                QString diceRoll = calculateDiceRollDescription(operands);
-                int rollResult = calculateDiceRollResult(operands);
-                
-                updateDiceRollTable(playerName, diceRoll, rollResult);
-            }
-        }
+        QString playerName = processedData["playerName"].toString();
+        QJsonArray operants = processedData["operants"].toArray();
         
-        // Verarbeite andere Nachrichtentypen...
-        if (jsonObj.contains("command")) {
-            QString command = jsonObj["command"].toString();
-            QWebSocket *client = qobject_cast<QWebSocket *>(sender());
-            QJsonObject response;
+        if (!operants.isEmpty()) {
+            QJsonObject firstOperant = operants[0].toObject();
+            QJsonObject result = firstOperant["result"].toObject();
+            QJsonArray operands = result["operands"].toArray();
             
-            if (command == "rollInitiative") {
-                // Initiative für alle Charaktere würfeln
-                m_initiativeTracker.rollAllInitiatives();
-                
-                // Sende eine Antwort zurück
-                if (client) {
-                    response["status"] = "success";
-                    response["message"] = "Initiative für alle Charaktere gewürfelt";
-                    client->sendTextMessage(QJsonDocument(response).toJson());
-                }
-            }
-            else if (command == "rollWillSave") {
-                // Willenskraft für alle Charaktere würfeln
-                m_initiativeTracker.rollAllWillSaves();
-                
-                // Sende eine Antwort zurück
-                if (client) {
-                    response["status"] = "success";
-                    response["message"] = "Willenskraft für alle Charaktere gewürfelt";
-                    client->sendTextMessage(QJsonDocument(response).toJson());
-                }
-            }
-            else if (command == "rollReflexSave") {
-                // Reflex für alle Charaktere würfeln
-                m_initiativeTracker.rollAllReflexSaves();
-                
-                // Sende eine Antwort zurück
-                if (client) {
-                    response["status"] = "success";
-                    response["message"] = "Reflex für alle Charaktere gewürfelt";
-                    client->sendTextMessage(QJsonDocument(response).toJson());
-                }
-            }
-            else if (command == "rollFortitudeSave") {
-                // Konstitution für alle Charaktere würfeln
-                m_initiativeTracker.rollAllFortitudeSaves();
-                
-                // Sende eine Antwort zurück
-                if (client) {
-                    response["status"] = "success";
-                    response["message"] = "Konstitution für alle Charaktere gewürfelt";
-                    client->sendTextMessage(QJsonDocument(response).toJson());
-                }
-            }
-            else {
-                // Unbekannter Befehl
-                if (client) {
-                    response["status"] = "error";
-                    response["message"] = "Unbekannter Befehl: " + command;
-                    client->sendTextMessage(QJsonDocument(response).toJson());
-                }
-            }
+            QString diceRoll = calculateDiceRollDescription(operands);
+            int rollResult = calculateDiceRollResult(operands);
+            
+            updateDiceRollTable(playerName, diceRoll, rollResult);
         }
     }
-    
-    qDebug() << "processWebSocketMessage: Ende";
 }
 
 /**
@@ -890,40 +529,11 @@ void MainWindow::processWebSocketMessage(const QString &message)
  */
 void MainWindow::displayReceivedMessage(const QString &message)
 {
-    qDebug() << "displayReceivedMessage: Start";
-    
     // Formatiere die Nachricht für die Anzeige
     QString formattedMessage = QTime::currentTime().toString("[hh:mm:ss] ") + message;
     
     // Füge die Nachricht zum TextEdit hinzu
     m_messageDisplay->append(formattedMessage);
-    
-    qDebug() << "displayReceivedMessage: Ende";
-}
-
-/**
- * @brief Slot, der aufgerufen wird, wenn eine WebSocket-Verbindung getrennt wird
- * 
- * Entfernt den Client aus der Liste und gibt die Ressourcen frei.
- */
-void MainWindow::socketDisconnected()
-{
-    qDebug() << "socketDisconnected: Start";
-    
-    // Hole den Sender
-    QWebSocket *client = qobject_cast<QWebSocket *>(sender());
-    if (client) {
-        // Entferne den Client aus der Liste
-        m_clients.removeAll(client);
-        
-        // Zeige eine Meldung im TextEdit an
-        m_messageDisplay->append("Verbindung getrennt: " + client->peerAddress().toString());
-        
-        // Gib die Ressourcen frei
-        client->deleteLater();
-    }
-    
-    qDebug() << "socketDisconnected: Ende";
 }
 
 void MainWindow::updateDiceRollTable(const QString &playerName, const QString &diceRoll, int result)
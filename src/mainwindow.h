@@ -9,13 +9,15 @@
 #include <QDesktopServices>
 #include <QUrl>
 #include <QPushButton>
-#include <QWebSocketServer>
-#include <QWebSocket>
 #include <QTextEdit>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
 #include "initiativetracker.h"
+#include "trackerstorage.h"
+#include "trackerservice.h"
+#include "charactertablemodel.h"
+#include "rollbuttondelegate.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -100,6 +102,13 @@ private slots:
      */
     void on_loadButton_clicked();
     
+    /**
+     * @brief Slot, der aufgerufen wird, wenn der "Importieren"-Button geklickt wird.
+     * 
+     * Hängt die Charaktere einer CSV- oder TSV-Datei an die Liste an.
+     */
+    void on_importButton_clicked();
+    
     /**
      * @brief Slot, der aufgerufen wird, wenn der "Log anzeigen/ausblenden"-Button geklickt wird.
      * 
@@ -108,25 +117,37 @@ private slots:
     void on_toggleLogButton_clicked();
     
     /**
-     * @brief Slot, der aufgerufen wird, wenn sich die Charakterliste ändert.
+     * @brief Slot, der aufgerufen wird, wenn die Initiative gewürfelt wurde.
      * 
-     * Aktualisiert die Tabelle mit den aktuellen Charakterdaten.
+     * Sortiert die Tabelle nach Initiative. Die Werte selbst aktualisiert das
+     * CharacterTableModel.
      */
-    void onCharactersChanged();
+    void onInitiativeRolled();
     
     /**
-     * @brief Slot, der aufgerufen wird, wenn die Initiative gewürfelt wurde.
+     * @brief Slot, der aufgerufen wird, wenn ein Würfeln-Button der Tabelle geklickt wird.
      * 
-     * Aktualisiert die Tabelle mit den neuen Initiative-Werten und sortiert sie.
+     * Würfelt den Wurf der angeklickten Spalte für den Charakter der Zeile.
+     * 
+     * @param index Die angeklickte Zelle im Proxy-Modell
      */
-    void onInitiativeRolled();
+    void onRollRequested(const QModelIndex &index);
     
     /**
-     * @brief Slot, der aufgerufen wird, wenn ein TaleSpire-Würfel-Button geklickt wird.
+     * @brief Slot, der den Fortschritt beim Laden einer JSON-Datei anzeigt.
      * 
-     * Öffnet einen TaleSpire-Würfel-Link im Standard-Browser.
+     * @param bytesRead Die bisher gelesenen Bytes
+     * @param bytesTotal Die Größe der Datei
      */
-    void onRollDiceButtonClicked();
+    void onLoadProgress(qint64 bytesRead, qint64 bytesTotal);
+    
+    /**
+     * @brief Slot, der das Ergebnis eines Speichervorgangs im Hintergrund meldet.
+     * 
+     * @param filename Die geschriebene Datei
+     * @param success true, wenn die Datei vollständig geschrieben wurde
+     */
+    void onSaveFinished(const QString &filename, bool success);
     
     /**
      * @brief Slot, der aufgerufen wird, wenn der "Willenskraft würfeln"-Button geklickt wird.
@@ -150,47 +171,18 @@ private slots:
     void on_rollFortitudeButton_clicked();
     
     /**
-     * @brief Slot, der aufgerufen wird, wenn Rettungswürfe gewürfelt wurden.
-     * 
-     * Aktualisiert die Tabelle mit den neuen Rettungswurf-Werten.
-     */
-    void onSavesRolled();
-    
-    /**
-     * @brief Slot, der aufgerufen wird, wenn ein Item im Modell geändert wurde.
-     * 
-     * Aktualisiert das entsprechende Character-Objekt mit dem neuen Wert.
+     * @brief Slot, der aufgerufen wird, wenn ein WebSocket-Client eine Nachricht gesendet hat.
      * 
-     * @param item Das geänderte Item
-     */
-    void onItemChanged(QStandardItem *item);
-    
-    /**
-     * @brief Slot, der aufgerufen wird, wenn eine neue WebSocket-Verbindung hergestellt wird.
-     */
-    void onNewWebSocketConnection();
-    
-    /**
-     * @brief Slot, der aufgerufen wird, wenn eine Nachricht von einem WebSocket empfangen wird.
+     * Übernimmt Würfelergebnisse in die Würfelwurf-Tabelle. Befehle führt
+     * der TrackerService selbst aus.
      * 
-     * @param message Die empfangene Nachricht
-     */
-    void processWebSocketMessage(const QString &message);
-    
-    /**
-     * @brief Slot, der aufgerufen wird, wenn eine WebSocket-Verbindung getrennt wird.
+     * @param clientId Der sendende Client
+     * @param jsonObj Die dekodierte Nachricht
+     * @param encoding Die Kodierung des Clients
      */
-    void socketDisconnected();
+    void onServerMessage(quint64 clientId, const QJsonObject &jsonObj, MessageCodec::Encoding encoding);
 
 private:
-    /**
-     * @brief Aktualisiert die Tabelle mit den aktuellen Charakterdaten.
-     * 
-     * Diese Methode wird aufgerufen, wenn sich die Charakterliste ändert oder
-     * wenn die Initiative gewürfelt wurde.
-     */
-    void updateTable();
-    
     /**
      * @brief Aktualisiert die Würfelwurf-Tabelle mit neuen Daten.
      * 
@@ -216,37 +208,29 @@ private:
      */
     int calculateDiceRollResult(const QJsonArray &operands);
     
-    /**
-     * @brief Erstellt einen TaleSpire-Würfel-Button für eine Zelle in der Tabelle.
-     * 
-     * @param row Die Zeile in der Tabelle
-     * @param column Die Spalte in der Tabelle
-     * @param diceType Der Typ des Würfels (z.B. "d20")
-     * @param modifier Der Modifikator für den Würfelwurf
-     * @param label Die Beschriftung des Buttons
-     */
-    void createRollButton(int row, int column, const QString &diceType, int modifier, const QString &label);
-    
     Ui::MainWindow *ui;                      ///< Die UI-Komponenten des Hauptfensters
     InitiativeTracker m_initiativeTracker;   ///< Der Initiative-Tracker für die Charaktere
-    QStandardItemModel *m_model;             ///< Das Datenmodell für die Tabelle
+    TrackerStorage m_storage;                ///< Journal, Snapshot und JSON-Datei des Trackers
+    TrackerService m_service;                ///< WebSocket-Server im Netzwerk-Thread, Befehle und Änderungen
+    CharacterTableModel *m_model;            ///< Das Datenmodell für die Tabelle, liest direkt aus dem Tracker
     QSortFilterProxyModel *m_proxyModel;     ///< Das Proxy-Modell für die Sortierung der Tabelle
+    RollButtonDelegate *m_rollButtonDelegate; ///< Zeichnet die Würfeln-Buttons aller Zeilen
     QStandardItemModel *m_diceRollModel;     ///< Das Datenmodell für die Würfelwurf-Tabelle
     
-    // Spaltenindizes für die Tabelle
-    static const int NAME_COLUMN = 0;
-    static const int INITIATIVE_MOD_COLUMN = 1;
-    static const int TOTAL_INITIATIVE_COLUMN = 2;
-    static const int ROLL_INITIATIVE_COLUMN = 3;
-    static const int WILL_SAVE_COLUMN = 4;
-    static const int WILL_RESULT_COLUMN = 5;
-    static const int ROLL_WILL_COLUMN = 6;
-    static const int REFLEX_SAVE_COLUMN = 7;
-    static const int REFLEX_RESULT_COLUMN = 8;
-    static const int ROLL_REFLEX_COLUMN = 9;
-    static const int FORTITUDE_SAVE_COLUMN = 10;
-    static const int FORTITUDE_RESULT_COLUMN = 11;
-    static const int ROLL_FORTITUDE_COLUMN = 12;
+    // Spaltenindizes für die Tabelle (siehe CharacterTableModel::Column)
+    static const int NAME_COLUMN = CharacterTableModel::NameColumn;
+    static const int INITIATIVE_MOD_COLUMN = CharacterTableModel::InitiativeModifierColumn;
+    static const int TOTAL_INITIATIVE_COLUMN = CharacterTableModel::TotalInitiativeColumn;
+    static const int ROLL_INITIATIVE_COLUMN = CharacterTableModel::RollInitiativeColumn;
+    static const int WILL_SAVE_COLUMN = CharacterTableModel::WillSaveColumn;
+    static const int WILL_RESULT_COLUMN = CharacterTableModel::WillResultColumn;
+    static const int ROLL_WILL_COLUMN = CharacterTableModel::RollWillColumn;
+    static const int REFLEX_SAVE_COLUMN = CharacterTableModel::ReflexSaveColumn;
+    static const int REFLEX_RESULT_COLUMN = CharacterTableModel::ReflexResultColumn;
+    static const int ROLL_REFLEX_COLUMN = CharacterTableModel::RollReflexColumn;
+    static const int FORTITUDE_SAVE_COLUMN = CharacterTableModel::FortitudeSaveColumn;
+    static const int FORTITUDE_RESULT_COLUMN = CharacterTableModel::FortitudeResultColumn;
+    static const int ROLL_FORTITUDE_COLUMN = CharacterTableModel::RollFortitudeColumn;
     
     /**
      * @brief Lädt die gespeicherten Charakterdaten.
@@ -259,8 +243,8 @@ private:
     /**
      * @brief Speichert die aktuellen Charakterdaten.
      * 
-     * Wird beim Beenden der Anwendung aufgerufen, um die Charakterdaten
-     * für den nächsten Start zu speichern.
+     * Wird beim Beenden der Anwendung aufgerufen. Wartet auf den AutoSaver
+     * und verdichtet das Änderungsjournal.
      */
     void saveCharacters();
     
@@ -276,10 +260,7 @@ private:
      */
     void displayReceivedMessage(const QString &message);
     
-    // Neue WebSocket-Member
-    QWebSocketServer *m_webSocketServer;
-    QList<QWebSocket*> m_clients;
-    QTextEdit *m_messageDisplay;
+    QTextEdit *m_messageDisplay;             ///< Zeigt empfangene Nachrichten an
 };
 
 #endif // MAINWINDOW_H 
\ No newline at end of file
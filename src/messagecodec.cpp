@@ -0,0 +1,75 @@
+#include "messagecodec.h"
+#include <QCborMap>
+#include <QCborStreamReader>
+#include <QCborValue>
+#include <QJsonDocument>
+#include <QJsonParseError>
+
+/**
+ * @brief Dekodiert eine Nachricht
+ *
+ * @param data Die empfangenen Bytes
+ * @param encoding Die Kodierung der Nachricht
+ * @param message Nimmt die dekodierte Nachricht auf
+ * @param error Nimmt bei einem Fehler die Beschreibung auf
+ * @return true, wenn die Nachricht gültig ist
+ */
+bool MessageCodec::decode(const QByteArray &data, Encoding encoding, QJsonObject *message, QString *error)
+{
+    if (encoding == Json) {
+        QJsonParseError parseError;
+        const QJsonDocument document = QJsonDocument::fromJson(data, &parseError);
+        if (parseError.error != QJsonParseError::NoError || !document.isObject()) {
+            if (error) {
+                *error = parseError.error != QJsonParseError::NoError
+                    ? QStringLiteral("Ungültiges JSON: ") + parseError.errorString()
+                    : QStringLiteral("Die Nachricht ist kein JSON-Objekt");
+            }
+            return false;
+        }
+        *message = document.object();
+        return true;
+    }
+
+    // Erst nur den Typ des obersten Elements lesen, damit andere Nachrichten
+    // nicht erst vollständig dekodiert werden
+    QCborStreamReader reader(data);
+    if (!reader.isMap()) {
+        if (error) {
+            *error = QStringLiteral("Die Nachricht ist keine CBOR-Map");
+        }
+        return false;
+    }
+
+    const QCborValue value = QCborValue::fromCbor(reader);
+    if (reader.lastError() != QCborError::NoError) {
+        if (error) {
+            *error = QStringLiteral("Ungültiges CBOR: ") + reader.lastError().toString();
+        }
+        return false;
+    }
+    if (reader.currentOffset() != data.size()) {
+        if (error) {
+            *error = QStringLiteral("Ungültiges CBOR: Daten nach dem Ende der Nachricht");
+        }
+        return false;
+    }
+
+    *message = value.toMap().toJsonObject();
+    return true;
+}
+
+/**
+ * @brief Kodiert eine Nachricht
+ *
+ * @param message Die zu sendende Nachricht
+ * @param encoding Die gewünschte Kodierung
+ * @return Die kodierten Bytes
+ */
+QByteArray MessageCodec::encode(const QJsonObject &message, Encoding encoding)
+{
+    if (encoding == Json) {
+        return QJsonDocument(message).toJson(QJsonDocument::Compact);
+    }
+    return QCborMap::fromJsonObject(message).toCborValue().toCbor();
+}
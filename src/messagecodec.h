@@ -0,0 +1,67 @@
+#ifndef MESSAGECODEC_H
+#define MESSAGECODEC_H
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QMetaType>
+#include <QString>
+
+/**
+ * @brief Die MessageCodec-Klasse wandelt WebSocket-Nachrichten in JSON-Objekte um und zurück.
+ *
+ * Die WebSocket-Schnittstelle versteht zwei Kodierungen:
+ * - JSON in Textnachrichten, wie sie websocket_client.html sendet
+ * - CBOR (RFC 8949) in Binärnachrichten, für Automatisierungs-Clients
+ *
+ * Ein Client wählt die Kodierung mit der Art der Nachricht: Auf eine
+ * Textnachricht antwortet der Server mit JSON, auf eine Binärnachricht mit
+ * CBOR. Der Inhalt ist in beiden Fällen derselbe, z.B.
+ * {"command": "rollInitiative"}, und wird intern als QJsonObject verarbeitet.
+ *
+ * Qt-Konzept: CBOR
+ * CBOR ist ein binäres Gegenstück zu JSON. Zahlen stehen als Binärwerte
+ * und Zeichenketten mit vorangestellter Länge in der Nachricht, das
+ * Dekodieren kommt daher ohne Suche nach Anführungszeichen und ohne
+ * Umwandlung von Text in Zahlen aus. QCborStreamReader liest eine Nachricht
+ * Element für Element, QCborValue hält sie als Baum.
+ */
+class MessageCodec
+{
+public:
+    /**
+     * @brief Die Kodierung einer Nachricht.
+     */
+    enum Encoding {
+        Json,  ///< JSON-Text in einer Textnachricht
+        Cbor   ///< CBOR in einer Binärnachricht
+    };
+
+    /**
+     * @brief Dekodiert eine Nachricht.
+     *
+     * Die Nachricht muss ein JSON-Objekt bzw. eine CBOR-Map sein.
+     *
+     * @param data Die empfangenen Bytes (bei JSON UTF-8)
+     * @param encoding Die Kodierung der Nachricht
+     * @param message Nimmt die dekodierte Nachricht auf
+     * @param error Nimmt bei einem Fehler die Beschreibung auf (darf nullptr sein)
+     * @return true, wenn die Nachricht gültig ist
+     */
+    static bool decode(const QByteArray &data, Encoding encoding, QJsonObject *message, QString *error = nullptr);
+
+    /**
+     * @brief Kodiert eine Nachricht.
+     *
+     * JSON wird kompakt ohne Einrückung geschrieben.
+     *
+     * @param message Die zu sendende Nachricht
+     * @param encoding Die gewünschte Kodierung
+     * @return Die kodierten Bytes (bei JSON UTF-8)
+     */
+    static QByteArray encode(const QJsonObject &message, Encoding encoding);
+};
+
+// Für Queued-Verbindungen zwischen Netzwerk- und Tracker-Thread
+Q_DECLARE_METATYPE(MessageCodec::Encoding)
+
+#endif // MESSAGECODEC_H
@@ -0,0 +1,82 @@
+#include "namepool.h"
+
+/**
+ * @brief Erstellt einen Pool, der nur den leeren Namen enthält
+ */
+NamePool::NamePool()
+{
+    clear();
+}
+
+/**
+ * @brief Gibt die Id eines Namens zurück und nimmt ihn bei Bedarf auf
+ *
+ * @param name Der Name
+ * @return Die Id des Namens
+ */
+NamePool::Id NamePool::intern(const QString &name)
+{
+    const auto it = m_ids.constFind(name);
+    if (it != m_ids.constEnd()) {
+        return it.value();
+    }
+
+    const Id id = Id(m_names.size());
+    m_names.append(name);
+    m_ids.insert(name, id);
+    return id;
+}
+
+/**
+ * @brief Sucht die Id eines Namens, ohne ihn aufzunehmen
+ *
+ * @param name Der Name
+ * @return Die Id oder InvalidId
+ */
+NamePool::Id NamePool::find(const QString &name) const
+{
+    return m_ids.value(name, InvalidId);
+}
+
+/**
+ * @brief Gibt den Namen zu einer Id zurück
+ *
+ * @param id Die Id
+ * @return Eine Referenz auf den Namen im Pool
+ */
+const QString &NamePool::name(Id id) const
+{
+    return m_names.at(int(id));
+}
+
+/**
+ * @brief Gibt die Anzahl der unterschiedlichen Namen zurück
+ *
+ * @return Die Anzahl einschließlich des leeren Namens
+ */
+int NamePool::size() const
+{
+    return m_names.size();
+}
+
+/**
+ * @brief Reserviert Platz für die angegebene Anzahl an Namen
+ *
+ * @param count Die erwartete Anzahl unterschiedlicher Namen
+ */
+void NamePool::reserve(int count)
+{
+    m_names.reserve(count);
+    m_ids.reserve(count);
+}
+
+/**
+ * @brief Entfernt alle Namen außer dem leeren Namen
+ */
+void NamePool::clear()
+{
+    m_names.clear();
+    m_ids.clear();
+    m_names.append(QString());
+    m_ids.insert(QString(), EmptyId);
+}
@@ -0,0 +1,100 @@
+#ifndef NAMEPOOL_H
+#define NAMEPOOL_H
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief Die NamePool-Klasse vergibt für jeden unterschiedlichen Namen eine kleine Nummer.
+ *
+ * Ein Kampf enthält oft viele gleichnamige Gegner ("Goblin", "Skelett").
+ * Statt jeden Namen pro Charakter zu speichern, legt der Pool jeden
+ * unterschiedlichen Namen genau einmal ab. Der CharacterStore merkt sich pro
+ * Charakter nur die Nummer (Id) des Namens.
+ *
+ * Damit sind Vergleich und Hash zweier Namen ein Vergleich zweier Zahlen,
+ * und beim Speichern steht jeder Name nur einmal in der Datei.
+ *
+ * Die Id 0 ist immer der leere Name. Ids bleiben gültig, bis clear()
+ * aufgerufen wird; nicht mehr benutzte Namen bleiben bis dahin im Pool.
+ * Der CharacterStore baut den Pool deshalb beim Speichern mit
+ * CharacterStore::compactNames() neu auf.
+ *
+ * C++ Konzept: String Interning
+ * Gleiche Zeichenketten werden auf ein einziges, gemeinsames Exemplar
+ * abgebildet. Wer nur dieses Exemplar bzw. seine Nummer kennt, muss nie
+ * Zeichen für Zeichen vergleichen.
+ *
+ * Qt-Konzept: Implizites Teilen
+ * Die Namen liegen in einem QVector und einem QHash. Eine Kopie des Pools
+ * teilt sich beide mit dem Original; kopiert wird erst, wenn eine Seite
+ * einen neuen Namen aufnimmt.
+ */
+class NamePool
+{
+public:
+    /**
+     * @brief Die Nummer eines Namens im Pool.
+     */
+    typedef quint32 Id;
+
+    static constexpr Id EmptyId = 0;            ///< Die Id des leeren Namens
+    static constexpr Id InvalidId = 0xffffffff; ///< Ergebnis von find() für unbekannte Namen
+
+    /**
+     * @brief Erstellt einen Pool, der nur den leeren Namen enthält.
+     */
+    NamePool();
+
+    /**
+     * @brief Gibt die Id eines Namens zurück und nimmt ihn bei Bedarf auf.
+     *
+     * @param name Der Name
+     * @return Die Id des Namens
+     */
+    Id intern(const QString &name);
+
+    /**
+     * @brief Sucht die Id eines Namens, ohne ihn aufzunehmen.
+     *
+     * @param name Der Name
+     * @return Die Id oder InvalidId, wenn der Name nicht im Pool ist
+     */
+    Id find(const QString &name) const;
+
+    /**
+     * @brief Gibt den Namen zu einer Id zurück.
+     *
+     * @param id Eine von intern() gelieferte Id
+     * @return Eine Referenz auf den Namen im Pool
+     */
+    const QString &name(Id id) const;
+
+    /**
+     * @brief Gibt die Anzahl der unterschiedlichen Namen zurück.
+     *
+     * @return Die Anzahl einschließlich des leeren Namens
+     */
+    int size() const;
+
+    /**
+     * @brief Reserviert Platz für die angegebene Anzahl an Namen.
+     *
+     * @param count Die erwartete Anzahl unterschiedlicher Namen
+     */
+    void reserve(int count);
+
+    /**
+     * @brief Entfernt alle Namen außer dem leeren Namen.
+     *
+     * Alle vorher vergebenen Ids außer EmptyId werden ungültig.
+     */
+    void clear();
+
+private:
+    QVector<QString> m_names;  ///< Die Namen, Index = Id
+    QHash<QString, Id> m_ids;  ///< Die Id zu jedem Namen
+};
+
+#endif // NAMEPOOL_H
@@ -0,0 +1,184 @@
+#include "randomstream.h"
+#include <atomic>
+
+/**
+ * @brief Erzeugt den anfänglichen Basis-Seed aus dem Zufallsgerät des Systems
+ *
+ * @return Ein zufälliger 64-Bit-Seed
+ */
+static quint64 initialSeed()
+{
+    std::random_device rd;
+    return (static_cast<quint64>(rd()) << 32) | static_cast<quint64>(rd());
+}
+
+/**
+ * @brief Gibt den prozessweiten Basis-Seed zurück
+ *
+ * Als funktionslokale statische Variable wird er beim ersten Zugriff
+ * initialisiert, unabhängig von der Reihenfolge globaler Initialisierungen.
+ */
+static std::atomic<quint64> &baseSeedRef()
+{
+    static std::atomic<quint64> seed(initialSeed());
+    return seed;
+}
+
+static std::atomic<int> s_nextStream(0);       ///< Nächste freie Stream-Nummer
+static std::atomic<quint32> s_generation(0);   ///< Wird bei setBaseSeed() erhöht
+
+/**
+ * @brief Zustand des Generators eines Threads
+ */
+struct LocalStream
+{
+    std::mt19937 generator;  ///< Der threadeigene Generator
+    int stream = -1;         ///< Die Stream-Nummer (-1 = noch nicht vergeben)
+    bool fixed = false;      ///< Wurde die Nummer mit setLocalStream() festgelegt?
+    quint32 generation = 0;  ///< Die Generation, zu der der Seed passt
+};
+
+/**
+ * @brief Seedet den Generator eines Threads aus Basis-Seed und Stream-Nummer
+ *
+ * Festgelegte Streams erhalten ein zusätzliches Wort in der seed_seq und
+ * damit andere Folgen als automatische Streams mit derselben Nummer.
+ *
+ * @param state Der Zustand des Threads
+ */
+static void seedState(LocalStream &state)
+{
+    const quint64 seed = baseSeedRef().load();
+    if (state.fixed) {
+        std::seed_seq sequence{ static_cast<quint32>(seed),
+                                static_cast<quint32>(seed >> 32),
+                                static_cast<quint32>(state.stream),
+                                1u };
+        state.generator.seed(sequence);
+    } else {
+        std::seed_seq sequence{ static_cast<quint32>(seed),
+                                static_cast<quint32>(seed >> 32),
+                                static_cast<quint32>(state.stream) };
+        state.generator.seed(sequence);
+    }
+}
+
+/**
+ * @brief Gibt den Zustand des aufrufenden Threads ohne Seeden zurück
+ */
+static LocalStream &threadState()
+{
+    thread_local LocalStream state;
+    return state;
+}
+
+/**
+ * @brief Gibt den Zustand des aufrufenden Threads zurück und seedet ihn bei Bedarf
+ *
+ * Der Seed wird über std::seed_seq aus Basis-Seed und Stream-Nummer gebildet.
+ * seed_seq verteilt die Eingabe über den gesamten Zustand des Mersenne-Twisters,
+ * sodass auch benachbarte Stream-Nummern unabhängige Folgen liefern. Die
+ * automatische Nummer folgt der Reihenfolge des ersten Wurfs und ist über
+ * mehrere Threads hinweg nicht reproduzierbar (siehe setLocalStream()).
+ */
+static LocalStream &localState()
+{
+    LocalStream &state = threadState();
+
+    const quint32 generation = s_generation.load(std::memory_order_acquire);
+    if (state.stream < 0 || state.generation != generation) {
+        // Ein festgelegter Stream behält seine Nummer über setBaseSeed() hinweg
+        if (!state.fixed) {
+            state.stream = s_nextStream.fetch_add(1);
+        }
+        state.generation = generation;
+        seedState(state);
+    }
+
+    return state;
+}
+
+/**
+ * @brief Setzt den Basis-Seed und beginnt die Stream-Nummerierung von vorn
+ *
+ * Sollte aufgerufen werden, während kein anderer Thread würfelt.
+ *
+ * @param seed Der neue Basis-Seed
+ */
+void RandomStream::setBaseSeed(quint64 seed)
+{
+    baseSeedRef().store(seed);
+    s_nextStream.store(0);
+    s_generation.fetch_add(1, std::memory_order_release);
+}
+
+/**
+ * @brief Gibt den aktuellen Basis-Seed zurück
+ *
+ * @return Der Basis-Seed
+ */
+quint64 RandomStream::baseSeed()
+{
+    return baseSeedRef().load();
+}
+
+/**
+ * @brief Gibt den Generator des aufrufenden Threads zurück
+ *
+ * @return Der threadeigene Mersenne-Twister
+ */
+std::mt19937 &RandomStream::local()
+{
+    return localState().generator;
+}
+
+/**
+ * @brief Gibt die Stream-Nummer des aufrufenden Threads zurück
+ *
+ * @return Die Stream-Nummer
+ */
+int RandomStream::localStream()
+{
+    return localState().stream;
+}
+
+/**
+ * @brief Legt den Stream des aufrufenden Threads selbst fest
+ *
+ * @param stream Die Nummer oder -1 für eine automatische Nummer
+ */
+void RandomStream::setLocalStream(int stream)
+{
+    LocalStream &state = threadState();
+    if (stream < 0) {
+        state.stream = -1;
+        state.fixed = false;
+        return;
+    }
+
+    state.stream = stream;
+    state.fixed = true;
+    state.generation = s_generation.load(std::memory_order_acquire);
+    seedState(state);
+}
+
+/**
+ * @brief Gibt an, ob der Stream des aufrufenden Threads festgelegt wurde
+ *
+ * @return true für einen festgelegten Stream
+ */
+bool RandomStream::hasFixedLocalStream()
+{
+    return threadState().fixed;
+}
+
+/**
+ * @brief Würfelt einen W20 mit dem Generator des aufrufenden Threads
+ *
+ * @return Ein Wert zwischen 1 und 20
+ */
+int RandomStream::rollD20()
+{
+    std::uniform_int_distribution<> d20(1, 20);
+    return d20(local());
+}
@@ -0,0 +1,97 @@
+#ifndef RANDOMSTREAM_H
+#define RANDOMSTREAM_H
+
+#include <QtGlobal>
+#include <random>
+
+/**
+ * @brief Die RandomStream-Klasse stellt jedem Thread einen eigenen Zufallsgenerator bereit.
+ *
+ * Früher teilten sich alle Character-Objekte einen statischen Mersenne-Twister.
+ * Würfeln aus mehreren Threads war damit ein Data Race. Jetzt erhält jeder
+ * Thread beim ersten Wurf einen eigenen Generator mit einer fortlaufenden
+ * Stream-Nummer. Der Seed dieses Generators wird deterministisch aus dem
+ * Basis-Seed und der Stream-Nummer gebildet, sodass sich die Streams nicht
+ * überschneiden.
+ *
+ * Die automatische Nummer hängt davon ab, in welcher Reihenfolge die Threads
+ * zum ersten Mal würfeln. Reproduzierbar ist sie daher nur für einen
+ * einzelnen Thread; welcher von mehreren Threads welche Folge bekommt,
+ * entscheidet der Scheduler. Threads, deren Würfe bei gleichem Basis-Seed
+ * wiederholbar sein sollen (z.B. Worker eines Pools), wählen ihren Stream
+ * mit setLocalStream() selbst, etwa über ihren Worker- oder Blockindex.
+ *
+ * C++ Konzept: thread_local
+ * Eine Variable mit thread_local existiert einmal pro Thread. Jeder Thread
+ * sieht seine eigene Kopie, daher ist kein Mutex nötig.
+ *
+ * C++ Konzept: std::atomic
+ * Die Vergabe der Stream-Nummern erfolgt über einen atomaren Zähler, damit
+ * zwei Threads niemals dieselbe Nummer erhalten.
+ */
+class RandomStream
+{
+public:
+    /**
+     * @brief Setzt den Basis-Seed und beginnt die Stream-Nummerierung von vorn.
+     *
+     * Alle Threads erzeugen ihren Generator beim nächsten Wurf neu. Der
+     * aufrufende Thread erhält dabei als Erster die Stream-Nummer 0, sofern er
+     * als Erster wieder würfelt.
+     *
+     * @param seed Der neue Basis-Seed
+     */
+    static void setBaseSeed(quint64 seed);
+
+    /**
+     * @brief Gibt den aktuellen Basis-Seed zurück.
+     *
+     * Ohne Aufruf von setBaseSeed() stammt er aus std::random_device.
+     *
+     * @return Der Basis-Seed
+     */
+    static quint64 baseSeed();
+
+    /**
+     * @brief Gibt den Generator des aufrufenden Threads zurück.
+     *
+     * @return Der threadeigene Mersenne-Twister
+     */
+    static std::mt19937 &local();
+
+    /**
+     * @brief Gibt die Stream-Nummer des aufrufenden Threads zurück.
+     *
+     * @return Die Stream-Nummer
+     */
+    static int localStream();
+
+    /**
+     * @brief Legt den Stream des aufrufenden Threads selbst fest.
+     *
+     * Der Generator wird sofort aus Basis-Seed und stream neu geseedet und
+     * nach setBaseSeed() mit derselben Nummer. Festgelegte Streams liegen in
+     * einem eigenen Bereich und überschneiden sich nicht mit den automatisch
+     * vergebenen, auch bei gleicher Nummer. Mit -1 erhält der Thread beim
+     * nächsten Wurf wieder eine automatische Nummer.
+     *
+     * @param stream Eine vom Aufrufer vergebene Nummer >= 0, z.B. der Worker-Index, oder -1
+     */
+    static void setLocalStream(int stream);
+
+    /**
+     * @brief Gibt an, ob der Stream des aufrufenden Threads mit setLocalStream() festgelegt wurde.
+     *
+     * @return true für einen festgelegten Stream
+     */
+    static bool hasFixedLocalStream();
+
+    /**
+     * @brief Würfelt einen W20 mit dem Generator des aufrufenden Threads.
+     *
+     * @return Ein Wert zwischen 1 und 20
+     */
+    static int rollD20();
+};
+
+#endif // RANDOMSTREAM_H
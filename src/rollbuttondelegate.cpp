@@ -0,0 +1,173 @@
+#include "rollbuttondelegate.h"
+#include <QAbstractItemView>
+#include <QApplication>
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QStyle>
+
+namespace {
+
+/**
+ * @brief Gibt die Mausposition eines Ereignisses zurück
+ *
+ * @param event Das Mausereignis
+ * @return Die Position relativ zum Viewport der View
+ */
+QPoint mousePosition(const QMouseEvent *event)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    return event->position().toPoint();
+#else
+    return event->pos();
+#endif
+}
+
+/**
+ * @brief Lässt die View eine Zelle neu zeichnen
+ *
+ * Nötig, damit der gedrückte Zustand sofort sichtbar wird. Ohne eigenes
+ * Widget gibt es niemanden, der das sonst auslöst.
+ *
+ * @param option Die Optionen der Zelle (enthält die View)
+ * @param index Die Zelle
+ */
+void repaintCell(const QStyleOptionViewItem &option, const QModelIndex &index)
+{
+    QAbstractItemView *view = qobject_cast<QAbstractItemView *>(const_cast<QWidget *>(option.widget));
+    if (view) {
+        view->update(index);
+    }
+}
+
+} // namespace
+
+/**
+ * @brief Erstellt den Delegate
+ *
+ * @param label Die Beschriftung der Buttons
+ * @param parent Das Elternobjekt
+ */
+RollButtonDelegate::RollButtonDelegate(const QString &label, QObject *parent)
+    : QStyledItemDelegate(parent)
+    , m_label(label)
+{
+}
+
+/**
+ * @brief Zeichnet Hintergrund und Button der Zelle
+ *
+ * @param painter Der Painter der View
+ * @param option Position und Zustand der Zelle
+ * @param index Die Zelle
+ */
+void RollButtonDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    // Hintergrund und Auswahl wie bei jeder anderen Zelle
+    QStyledItemDelegate::paint(painter, option, index);
+
+    QStyleOptionButton button;
+    button.rect = buttonRect(option.rect);
+    button.text = m_label;
+    button.fontMetrics = option.fontMetrics;
+    button.state = QStyle::State_Enabled;
+    if (option.state & QStyle::State_MouseOver) {
+        button.state |= QStyle::State_MouseOver;
+    }
+    if (m_pressedIndex.isValid() && m_pressedIndex == index) {
+        button.state |= QStyle::State_Sunken;
+    } else {
+        button.state |= QStyle::State_Raised;
+    }
+
+    QStyle *style = option.widget ? option.widget->style() : QApplication::style();
+    style->drawControl(QStyle::CE_PushButton, &button, painter, option.widget);
+}
+
+/**
+ * @brief Gibt die Größe eines Buttons mit der Beschriftung zurück
+ *
+ * @param option Position und Zustand der Zelle
+ * @param index Die Zelle
+ * @return Die bevorzugte Größe
+ */
+QSize RollButtonDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    Q_UNUSED(index);
+
+    QStyleOptionButton button;
+    button.text = m_label;
+    button.fontMetrics = option.fontMetrics;
+    const QSize textSize = option.fontMetrics.size(Qt::TextShowMnemonic, m_label);
+
+    QStyle *style = option.widget ? option.widget->style() : QApplication::style();
+    return style->sizeFromContents(QStyle::CT_PushButton, &button, textSize, option.widget);
+}
+
+/**
+ * @brief Wertet Maus- und Tastaturereignisse der Zelle aus
+ *
+ * @param event Das Ereignis
+ * @param model Das Modell der View
+ * @param option Position und Zustand der Zelle
+ * @param index Die Zelle
+ * @return true, wenn das Ereignis verarbeitet wurde
+ */
+bool RollButtonDelegate::editorEvent(QEvent *event, QAbstractItemModel *model,
+                                     const QStyleOptionViewItem &option, const QModelIndex &index)
+{
+    switch (event->type()) {
+    case QEvent::MouseButtonPress:
+    case QEvent::MouseButtonDblClick: {
+        const QMouseEvent *mouseEvent = static_cast<QMouseEvent *>(event);
+        if (mouseEvent->button() != Qt::LeftButton
+            || !buttonRect(option.rect).contains(mousePosition(mouseEvent))) {
+            break;
+        }
+        m_pressedIndex = index;
+        repaintCell(option, index);
+        return true;
+    }
+
+    case QEvent::MouseButtonRelease: {
+        const QMouseEvent *mouseEvent = static_cast<QMouseEvent *>(event);
+        if (!m_pressedIndex.isValid()) {
+            break;
+        }
+
+        // Nur auslösen, wenn die Maus noch über demselben Button ist
+        const QModelIndex pressedIndex = m_pressedIndex;
+        m_pressedIndex = QPersistentModelIndex();
+        repaintCell(option, pressedIndex);
+        if (pressedIndex == index && buttonRect(option.rect).contains(mousePosition(mouseEvent))) {
+            emit rollRequested(index);
+        }
+        return true;
+    }
+
+    case QEvent::KeyPress: {
+        const QKeyEvent *keyEvent = static_cast<QKeyEvent *>(event);
+        if (keyEvent->key() == Qt::Key_Space) {
+            emit rollRequested(index);
+            return true;
+        }
+        break;
+    }
+
+    default:
+        break;
+    }
+
+    return QStyledItemDelegate::editorEvent(event, model, option, index);
+}
+
+/**
+ * @brief Berechnet die Fläche des Buttons innerhalb der Zelle
+ *
+ * @param cellRect Die Fläche der Zelle
+ * @return Die Zelle mit zwei Pixeln Abstand zum Rand
+ */
+QRect RollButtonDelegate::buttonRect(const QRect &cellRect)
+{
+    return cellRect.adjusted(2, 2, -2, -2);
+}
@@ -0,0 +1,92 @@
+#ifndef ROLLBUTTONDELEGATE_H
+#define ROLLBUTTONDELEGATE_H
+
+#include <QStyledItemDelegate>
+#include <QPersistentModelIndex>
+
+/**
+ * @brief Der RollButtonDelegate zeichnet die Würfeln-Buttons in der Charaktertabelle.
+ *
+ * Früher bekam jede Würfeln-Zelle ein eigenes QPushButton-Widget mit eigener
+ * connect()-Verbindung, bei 1000 Charakteren also 4000 Widgets. Der Delegate
+ * zeichnet stattdessen nur ein Bild eines Buttons in die Zelle und prüft
+ * Mausklicks selbst. Es gibt einen Delegate für alle Zellen, egal wie viele
+ * Zeilen die Tabelle hat.
+ *
+ * Qt-Konzept: Delegates
+ * Eine View zeichnet ihre Zellen nicht selbst, sondern überlässt das einem
+ * QAbstractItemDelegate. paint() wird nur für sichtbare Zellen aufgerufen,
+ * editorEvent() erhält Maus- und Tastaturereignisse der Zelle. Mit
+ * QStyle::drawControl() sieht der gezeichnete Button genauso aus wie ein
+ * echter QPushButton.
+ */
+class RollButtonDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Erstellt den Delegate.
+     *
+     * @param label Die Beschriftung der Buttons
+     * @param parent Das Elternobjekt
+     */
+    explicit RollButtonDelegate(const QString &label, QObject *parent = nullptr);
+
+    /**
+     * @brief Zeichnet den Button in die Zelle.
+     *
+     * @param painter Der Painter der View
+     * @param option Position und Zustand der Zelle
+     * @param index Die Zelle
+     */
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+
+    /**
+     * @brief Gibt die bevorzugte Größe der Zelle zurück.
+     *
+     * @param option Position und Zustand der Zelle
+     * @param index Die Zelle
+     * @return Die Größe eines Buttons mit der Beschriftung
+     */
+    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+
+signals:
+    /**
+     * @brief Wird gesendet, wenn der Button einer Zelle geklickt wurde.
+     *
+     * @param index Die Zelle im Modell der View (z.B. im Proxy-Modell)
+     */
+    void rollRequested(const QModelIndex &index);
+
+protected:
+    /**
+     * @brief Wertet Maus- und Tastaturereignisse der Zelle aus.
+     *
+     * Ein Klick zählt wie bei einem echten Button erst, wenn die Maustaste
+     * über demselben Button gedrückt und losgelassen wurde. Die Leertaste
+     * löst den Button der aktuellen Zelle aus.
+     *
+     * @param event Das Ereignis
+     * @param model Das Modell der View
+     * @param option Position und Zustand der Zelle
+     * @param index Die Zelle
+     * @return true, wenn das Ereignis verarbeitet wurde
+     */
+    bool editorEvent(QEvent *event, QAbstractItemModel *model,
+                     const QStyleOptionViewItem &option, const QModelIndex &index) override;
+
+private:
+    /**
+     * @brief Berechnet die Fläche des Buttons innerhalb der Zelle.
+     *
+     * @param cellRect Die Fläche der Zelle
+     * @return Die Zelle mit etwas Abstand zum Rand
+     */
+    static QRect buttonRect(const QRect &cellRect);
+
+    QString m_label;                       ///< Die Beschriftung der Buttons
+    QPersistentModelIndex m_pressedIndex;  ///< Die Zelle, deren Button gerade gedrückt ist
+};
+
+#endif // ROLLBUTTONDELEGATE_H
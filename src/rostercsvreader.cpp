@@ -0,0 +1,404 @@
+#include "rostercsvreader.h"
+#include "trace.h"
+#include <QHash>
+#include <QThread>
+#include <QThreadPool>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+/**
+ * @brief Ein Feld einer Zeile als Bereich im Text
+ */
+struct FieldRef {
+    const char *begin = nullptr;  ///< Erstes Zeichen
+    const char *end = nullptr;    ///< Hinter dem letzten Zeichen
+    bool copied = false;          ///< Liegt das Feld im Puffer statt im Text?
+};
+
+/**
+ * @brief Das Ergebnis eines Blocks
+ */
+struct ChunkResult {
+    CharacterStore store;        ///< Die Charaktere des Blocks
+    qint64 errorOffset = -1;     ///< Anfang der fehlerhaften Zeile im Text (-1 = kein Fehler)
+    QString error;               ///< Die Fehlerbeschreibung
+};
+
+/**
+ * @brief Sucht ein Zeichen in einem Bereich
+ *
+ * @param begin Anfang des Bereichs
+ * @param end Ende des Bereichs
+ * @param c Das gesuchte Zeichen
+ * @return Die Fundstelle oder end
+ */
+const char *find(const char *begin, const char *end, char c)
+{
+    const void *found = std::memchr(begin, c, size_t(end - begin));
+    return found ? static_cast<const char *>(found) : end;
+}
+
+/**
+ * @brief Liest das nächste Feld einer Zeile
+ *
+ * Danach steht cursor hinter dem Trennzeichen bzw. am Zeilenende. Felder in
+ * Anführungszeichen ohne "" zeigen direkt in den Text, sonst in buffer.
+ *
+ * @param cursor Die aktuelle Position in der Zeile
+ * @param lineEnd Das Ende der Zeile
+ * @param delimiter Das Trennzeichen
+ * @param buffer Puffer für Felder mit "" im Text
+ * @param field Erhält das Feld ohne Anführungszeichen und äußere Leerzeichen
+ * @return false bei einem nicht geschlossenen Anführungszeichen
+ */
+bool readField(const char **cursor, const char *lineEnd, char delimiter, QByteArray *buffer, FieldRef *field)
+{
+    const char *p = *cursor;
+    while (p < lineEnd && *p == ' ') {
+        ++p;
+    }
+
+    field->copied = false;
+    if (p < lineEnd && *p == '"') {
+        const char *start = ++p;
+        buffer->clear();
+        for (;;) {
+            const char *quote = find(p, lineEnd, '"');
+            if (quote == lineEnd) {
+                return false;
+            }
+            if (quote + 1 < lineEnd && quote[1] == '"') {
+                // "" steht für ein einzelnes Anführungszeichen
+                buffer->append(p, int(quote + 1 - p));
+                p = quote + 2;
+                field->copied = true;
+                continue;
+            }
+            if (field->copied) {
+                buffer->append(p, int(quote - p));
+                field->begin = buffer->constData();
+                field->end = field->begin + buffer->size();
+            } else {
+                field->begin = start;
+                field->end = quote;
+            }
+            p = quote + 1;
+            break;
+        }
+        while (p < lineEnd && *p == ' ') {
+            ++p;
+        }
+        if (p < lineEnd && *p != delimiter) {
+            return false;
+        }
+    } else {
+        const char *next = find(p, lineEnd, delimiter);
+        field->begin = p;
+        field->end = next;
+        while (field->end > field->begin && field->end[-1] == ' ') {
+            --field->end;
+        }
+        p = next;
+    }
+
+    if (p < lineEnd) {
+        ++p;
+    }
+    *cursor = p;
+    return true;
+}
+
+/**
+ * @brief Liest eine ganze Zahl ohne Umweg über QString
+ *
+ * @param begin Anfang der Zahl
+ * @param end Ende der Zahl
+ * @param value Erhält die Zahl (leeres Feld = 0)
+ * @return false, wenn das Feld keine Zahl mit höchstens 9 Ziffern ist
+ */
+bool parseInt(const char *begin, const char *end, int *value)
+{
+    if (begin == end) {
+        *value = 0;
+        return true;
+    }
+
+    const bool negative = *begin == '-';
+    if (*begin == '-' || *begin == '+') {
+        ++begin;
+    }
+    if (begin == end || end - begin > 9) {
+        return false;
+    }
+
+    int result = 0;
+    for (; begin < end; ++begin) {
+        if (*begin < '0' || *begin > '9') {
+            return false;
+        }
+        result = result * 10 + (*begin - '0');
+    }
+    *value = negative ? -result : result;
+    return true;
+}
+
+/**
+ * @brief Parst einen Block aus ganzen Zeilen in einen eigenen Store
+ *
+ * Läuft in einem Thread des Pools und schreibt nur in result.
+ *
+ * @param data Der gesamte Text
+ * @param begin Anfang des Blocks
+ * @param end Ende des Blocks
+ * @param columns Trennzeichen und Spaltenzuordnung
+ * @param result Erhält Charaktere oder Fehler
+ */
+void parseChunk(const char *data, qint64 begin, qint64 end, const RosterCsvReader::Columns &columns,
+                ChunkResult *result)
+{
+    CharacterStore &store = result->store;
+    const char *p = data + begin;
+    const char *chunkEnd = data + end;
+
+    // Zeilen zählen, damit die Spalten nur einmal wachsen
+    store.resize(int(std::count(p, chunkEnd, '\n')) + 1);
+
+    // Gleiche Namen anhand ihrer Bytes erkennen; die Schlüssel zeigen in den Text
+    QHash<QByteArray, NamePool::Id> nameIds;
+    QByteArray buffer;
+    int row = 0;
+    while (p < chunkEnd) {
+        const char *lineEnd = find(p, chunkEnd, '\n');
+        const char *next = lineEnd < chunkEnd ? lineEnd + 1 : chunkEnd;
+        if (lineEnd > p && lineEnd[-1] == '\r') {
+            --lineEnd;
+        }
+
+        const char *cursor = p;
+        while (cursor < lineEnd && (*cursor == ' ' || *cursor == '\t')) {
+            ++cursor;
+        }
+        if (cursor == lineEnd) {
+            p = next;
+            continue;
+        }
+
+        cursor = p;
+        for (int column = 0; column < columns.fields.size(); ++column) {
+            FieldRef field;
+            if (!readField(&cursor, lineEnd, columns.delimiter, &buffer, &field)) {
+                result->errorOffset = p - data;
+                result->error = QStringLiteral("Anführungszeichen in Spalte %1 nicht geschlossen").arg(column + 1);
+                return;
+            }
+
+            const int length = int(field.end - field.begin);
+            if (column == columns.nameColumn) {
+                if (length == 0) {
+                    result->errorOffset = p - data;
+                    result->error = QStringLiteral("Name fehlt");
+                    return;
+                }
+                const QByteArray key = field.copied ? QByteArray(field.begin, length)
+                                                    : QByteArray::fromRawData(field.begin, length);
+                auto it = nameIds.constFind(key);
+                if (it == nameIds.constEnd()) {
+                    it = nameIds.insert(key, store.internName(QString::fromUtf8(field.begin, length)));
+                }
+                store.setNameId(row, it.value());
+            } else if (columns.fields.at(column) >= 0) {
+                int value = 0;
+                if (!parseInt(field.begin, field.end, &value)) {
+                    result->errorOffset = p - data;
+                    result->error = QStringLiteral("Ungültige Zahl in Spalte %1").arg(column + 1);
+                    return;
+                }
+                store.setValue(row, CharacterStore::Field(columns.fields.at(column)), value);
+            }
+        }
+
+        ++row;
+        p = next;
+    }
+    store.resize(row);
+}
+
+} // namespace
+
+/**
+ * @brief Erstellt einen Leser mit idealThreadCount() Threads
+ */
+RosterCsvReader::RosterCsvReader()
+    : m_maxThreadCount(qMax(1, QThread::idealThreadCount()))
+    , m_chunkCount(0)
+{
+}
+
+/**
+ * @brief Liest alle Charaktere aus einem CSV- oder TSV-Text
+ *
+ * @param data Der Inhalt der Datei
+ * @param store Erhält die Charaktere
+ * @return true, wenn alle Zeilen gültig waren
+ */
+bool RosterCsvReader::read(const QByteArray &data, CharacterStore *store)
+{
+    m_error.clear();
+    m_chunkCount = 0;
+
+    const char *text = data.constData();
+    const qint64 size = data.size();
+
+    // Kopfzeile, ggf. nach einer UTF-8-BOM
+    const qint64 headerStart = data.startsWith("\xEF\xBB\xBF") ? 3 : 0;
+    const qint64 headerEnd = find(text + headerStart, text + size, '\n') - text;
+    QByteArray header = data.mid(int(headerStart), int(headerEnd - headerStart));
+    if (header.endsWith('\r')) {
+        header.chop(1);
+    }
+    Columns columns;
+    if (!readHeader(header, &columns)) {
+        return false;
+    }
+
+    // Blockgrenzen auf den jeweils nächsten Zeilenanfang legen
+    const qint64 bodyStart = qMin(headerEnd + 1, size);
+    const qint64 bodySize = size - bodyStart;
+    const int chunkCount = int(qBound<qint64>(1, bodySize / MinChunkSize, m_maxThreadCount));
+    QVector<qint64> bounds;
+    bounds.append(bodyStart);
+    for (int i = 1; i < chunkCount; ++i) {
+        const qint64 nominal = qMax(bounds.last(), bodyStart + bodySize * i / chunkCount);
+        bounds.append(qMin(find(text + nominal, text + size, '\n') - text + 1, size));
+    }
+    bounds.append(size);
+
+    // Den ersten Block liest der aufrufende Thread selbst
+    QVector<ChunkResult> results(chunkCount);
+    ChunkResult *out = results.data();
+    {
+        QThreadPool pool;
+        pool.setMaxThreadCount(qMax(1, chunkCount - 1));
+        for (int i = 1; i < chunkCount; ++i) {
+            pool.start([text, &bounds, &columns, out, i]() {
+                parseChunk(text, bounds.at(i), bounds.at(i + 1), columns, out + i);
+            });
+        }
+        parseChunk(text, bounds.at(0), bounds.at(1), columns, out);
+        pool.waitForDone();
+    }
+
+    // Der erste Fehler in Dateireihenfolge wird gemeldet
+    for (const ChunkResult &result : results) {
+        if (result.errorOffset >= 0) {
+            const qint64 line = std::count(text, text + result.errorOffset, '\n') + 1;
+            m_error = QStringLiteral("Zeile %1: %2").arg(line).arg(result.error);
+            return false;
+        }
+    }
+
+    // Blöcke in ihrer Reihenfolge spaltenweise zusammenfügen
+    CharacterStore loaded = results.at(0).store;
+    for (int i = 1; i < chunkCount; ++i) {
+        loaded.append(results.at(i).store);
+    }
+    *store = loaded;
+    m_chunkCount = chunkCount;
+    TRACE_EVENT(RosterImported, loaded.size(), chunkCount);
+    return true;
+}
+
+/**
+ * @brief Beschreibt den letzten Fehler
+ *
+ * @return Die Fehlerbeschreibung oder ein leerer String
+ */
+QString RosterCsvReader::errorString() const
+{
+    return m_error;
+}
+
+/**
+ * @brief Gibt die höchste Anzahl an Threads zurück
+ *
+ * @return Die Anzahl der Threads
+ */
+int RosterCsvReader::maxThreadCount() const
+{
+    return m_maxThreadCount;
+}
+
+/**
+ * @brief Legt die höchste Anzahl an Threads fest
+ *
+ * @param count Die Anzahl der Threads
+ */
+void RosterCsvReader::setMaxThreadCount(int count)
+{
+    m_maxThreadCount = qMax(1, count);
+}
+
+/**
+ * @brief Gibt an, in wie viele Blöcke die letzte Datei geteilt wurde
+ *
+ * @return Die Anzahl der Blöcke
+ */
+int RosterCsvReader::chunkCount() const
+{
+    return m_chunkCount;
+}
+
+/**
+ * @brief Liest die Kopfzeile
+ *
+ * @param line Die Kopfzeile ohne Zeilenende
+ * @param columns Erhält Trennzeichen und Spaltenzuordnung
+ * @return false, wenn die Namensspalte fehlt
+ */
+bool RosterCsvReader::readHeader(const QByteArray &line, Columns *columns)
+{
+    static const QHash<QByteArray, int> knownColumns = {
+        { "initiativemodifier", CharacterStore::InitiativeModifier },
+        { "initiative", CharacterStore::InitiativeModifier },
+        { "initiativeroll", CharacterStore::InitiativeRoll },
+        { "willsave", CharacterStore::WillSave },
+        { "will", CharacterStore::WillSave },
+        { "reflexsave", CharacterStore::ReflexSave },
+        { "reflex", CharacterStore::ReflexSave },
+        { "fortitudesave", CharacterStore::FortitudeSave },
+        { "fortitude", CharacterStore::FortitudeSave },
+        { "lastwillsaveroll", CharacterStore::LastWillSaveRoll },
+        { "lastreflexsaveroll", CharacterStore::LastReflexSaveRoll },
+        { "lastfortitudesaveroll", CharacterStore::LastFortitudeSaveRoll }
+    };
+
+    if (line.contains('\t')) {
+        columns->delimiter = '\t';
+    } else if (line.contains(';') && !line.contains(',')) {
+        columns->delimiter = ';';
+    } else {
+        columns->delimiter = ',';
+    }
+
+    columns->nameColumn = -1;
+    columns->fields.clear();
+    const QList<QByteArray> names = line.split(columns->delimiter);
+    for (QByteArray name : names) {
+        name = name.trimmed().toLower();
+        if (name.size() >= 2 && name.startsWith('"') && name.endsWith('"')) {
+            name = name.mid(1, name.size() - 2);
+        }
+        if (name == "name" && columns->nameColumn < 0) {
+            columns->nameColumn = columns->fields.size();
+        }
+        columns->fields.append(knownColumns.value(name, -1));
+    }
+
+    if (columns->nameColumn < 0) {
+        m_error = QStringLiteral("Die Kopfzeile enthält keine Spalte \"name\"");
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,114 @@
+#ifndef ROSTERCSVREADER_H
+#define ROSTERCSVREADER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+#include "characterstore.h"
+
+/**
+ * @brief Der RosterCsvReader liest Monsterlisten im CSV- oder TSV-Format auf mehreren Kernen.
+ *
+ * Die erste Zeile nennt die Spalten. Erkannt werden die Schlüssel der
+ * JSON-Dateien ("name", "initiativeModifier", "willSave", ...) und die
+ * Kurzformen "initiative", "will", "reflex" und "fortitude", ohne
+ * Unterscheidung von Groß- und Kleinschreibung. Nur "name" ist Pflicht,
+ * fehlende Zahlenspalten sind 0, unbekannte Spalten werden ignoriert.
+ *
+ * Das Trennzeichen wird aus der Kopfzeile bestimmt: Tab (TSV), sonst
+ * Semikolon, wenn die Zeile kein Komma enthält (deutsches Excel), sonst
+ * Komma. Felder dürfen in Anführungszeichen stehen ("Ork, der Große");
+ * ein doppeltes Anführungszeichen steht darin für ein einzelnes.
+ * Zeilenumbrüche innerhalb eines Feldes werden nicht unterstützt.
+ *
+ * Ablauf:
+ * - Der Inhalt nach der Kopfzeile wird in etwa gleich große Blöcke geteilt,
+ *   deren Grenzen immer auf einen Zeilenanfang fallen.
+ * - Jeder Block wird in einem eigenen Thread zu einem eigenen
+ *   CharacterStore geparst. Gleiche Namen werden dabei anhand ihrer Bytes
+ *   erkannt und nur einmal in einen QString umgewandelt.
+ * - Die Blöcke werden in ihrer Reihenfolge spaltenweise zusammengefügt
+ *   (CharacterStore::append()).
+ *
+ * Kleine Dateien (unter MinChunkSize) werden ohne zusätzliche Threads gelesen.
+ *
+ * Qt-Konzept: QThreadPool
+ * Ein eigener QThreadPool mit je einem Thread pro Block führt die Blöcke
+ * aus; waitForDone() wartet, bis alle fertig sind. Da jeder Block nur in
+ * seinen eigenen Store schreibt, ist keine Sperre nötig.
+ */
+class RosterCsvReader
+{
+public:
+    /**
+     * @brief Erstellt einen Leser, der idealThreadCount() Threads verwendet.
+     */
+    RosterCsvReader();
+
+    /**
+     * @brief Liest alle Charaktere aus einem CSV- oder TSV-Text.
+     *
+     * Würfelschlüssel und Würfelereignisse der gelesenen Charaktere sind -1.
+     * Bei einem Fehler bleibt store unverändert.
+     *
+     * @param data Der Inhalt der Datei (UTF-8)
+     * @param store Erhält die Charaktere (wird ersetzt)
+     * @return true, wenn alle Zeilen gültig waren
+     */
+    bool read(const QByteArray &data, CharacterStore *store);
+
+    /**
+     * @brief Beschreibt den letzten Fehler.
+     *
+     * @return Die Fehlerbeschreibung mit Zeilennummer oder ein leerer String
+     */
+    QString errorString() const;
+
+    /**
+     * @brief Gibt die höchste Anzahl an Threads zurück.
+     *
+     * @return Die Anzahl der Threads
+     */
+    int maxThreadCount() const;
+
+    /**
+     * @brief Legt die höchste Anzahl an Threads fest.
+     *
+     * @param count Die Anzahl der Threads (mindestens 1)
+     */
+    void setMaxThreadCount(int count);
+
+    /**
+     * @brief Gibt an, in wie viele Blöcke die letzte Datei geteilt wurde.
+     *
+     * @return Die Anzahl der Blöcke
+     */
+    int chunkCount() const;
+
+    static constexpr int MinChunkSize = 256 * 1024;  ///< Mindestgröße eines Blocks in Byte
+
+    /**
+     * @brief Spaltenzuordnung für den Block-Parser.
+     */
+    struct Columns {
+        int nameColumn = -1;     ///< Position der Namensspalte
+        QVector<int> fields;     ///< CharacterStore::Field pro Spalte (-1 = ignorieren)
+        char delimiter = ',';    ///< Das Trennzeichen
+    };
+
+private:
+    /**
+     * @brief Liest die Kopfzeile.
+     *
+     * @param line Die Kopfzeile ohne Zeilenende
+     * @param columns Erhält Trennzeichen und Spaltenzuordnung
+     * @return false, wenn die Namensspalte fehlt
+     */
+    bool readHeader(const QByteArray &line, Columns *columns);
+
+    int m_maxThreadCount;  ///< Höchstens so viele Threads
+    int m_chunkCount;      ///< Anzahl der Blöcke beim letzten read()
+    QString m_error;       ///< Der letzte Fehler
+};
+
+#endif // ROSTERCSVREADER_H
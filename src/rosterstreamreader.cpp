@@ -0,0 +1,398 @@
+#include "rosterstreamreader.h"
+#include <QIODevice>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonParseError>
+
+namespace {
+
+const int MaxKeyLength = 64;  // Längere Schlüssel des Wurzelobjekts interessieren nicht
+
+/**
+ * @brief Prüft, ob ein Zeichen JSON-Leerraum ist
+ *
+ * @param c Das Zeichen
+ * @return true für Leerzeichen, Tab, Zeilenumbruch und Wagenrücklauf
+ */
+bool isWhitespace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+} // namespace
+
+/**
+ * @brief Erstellt einen Leser
+ *
+ * @param parent Das Elternobjekt
+ */
+RosterStreamReader::RosterStreamReader(QObject *parent)
+    : QObject(parent)
+    , m_store(nullptr)
+    , m_hasSession(false)
+    , m_mode(StartMode)
+    , m_depth(0)
+    , m_inString(false)
+    , m_escaped(false)
+    , m_expectKey(false)
+    , m_readingKey(false)
+    , m_charactersDepth(-1)
+    , m_sawCharacters(false)
+    , m_expectCharacter(false)
+    , m_capturingSession(false)
+    , m_captureDepth(-1)
+{
+}
+
+/**
+ * @brief Liest alle Charaktere blockweise aus einem Gerät
+ *
+ * @param device Das zum Lesen geöffnete Gerät
+ * @param store Erhält die Charaktere
+ * @return true, wenn die Datei vollständig und gültig war
+ */
+bool RosterStreamReader::read(QIODevice *device, CharacterStore *store)
+{
+    // Zustand zurücksetzen, damit ein Leser mehrfach verwendet werden kann
+    m_store = store;
+    m_store->clear();
+    m_session = SnapshotFile::Session();
+    m_hasSession = false;
+    m_error.clear();
+    m_mode = StartMode;
+    m_depth = 0;
+    m_inString = false;
+    m_escaped = false;
+    m_expectKey = false;
+    m_readingKey = false;
+    m_key.clear();
+    m_charactersDepth = -1;
+    m_sawCharacters = false;
+    m_expectCharacter = false;
+    m_capturingSession = false;
+    m_captureDepth = -1;
+    m_capture.clear();
+
+    const qint64 bytesTotal = device->isSequential() ? 0 : device->size();
+    qint64 bytesRead = 0;
+    qint64 lastReported = 0;
+    emit progress(0, bytesTotal);
+
+    QByteArray chunk(ChunkSize, Qt::Uninitialized);
+    for (;;) {
+        const qint64 count = device->read(chunk.data(), ChunkSize);
+        if (count < 0) {
+            m_error = device->errorString();
+            return false;
+        }
+        if (count == 0) {
+            break;
+        }
+        if (!feed(chunk.constData(), count)) {
+            return false;
+        }
+
+        bytesRead += count;
+        if (bytesRead - lastReported >= ProgressInterval) {
+            emit progress(bytesRead, bytesTotal);
+            lastReported = bytesRead;
+        }
+    }
+    emit progress(bytesRead, bytesTotal);
+
+    if (m_mode != DoneMode || m_inString || m_depth != 0) {
+        m_error = QStringLiteral("Die Datei ist unvollständig");
+        return false;
+    }
+    if (!m_sawCharacters) {
+        m_error = QStringLiteral("Die Datei enthält kein Array \"characters\"");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Gibt an, ob die Datei eine gültige Sitzung enthielt
+ *
+ * @return true, wenn session() gültig ist
+ */
+bool RosterStreamReader::hasSession() const
+{
+    return m_hasSession;
+}
+
+/**
+ * @brief Gibt die gelesene Sitzung zurück
+ *
+ * @return Die Sitzung
+ */
+SnapshotFile::Session RosterStreamReader::session() const
+{
+    return m_session;
+}
+
+/**
+ * @brief Beschreibt den letzten Fehler
+ *
+ * @return Die Fehlerbeschreibung
+ */
+QString RosterStreamReader::errorString() const
+{
+    return m_error;
+}
+
+/**
+ * @brief Verfolgt Strings und Klammern eines Blocks und zeichnet Objekte auf
+ *
+ * Der Zustand bleibt zwischen zwei Blöcken erhalten, daher darf ein Block
+ * mitten in einem String oder Objekt enden. Im Charakter-Array sind nur
+ * Objekte, Kommas und Leerraum erlaubt; der Wert von "characters" muss ein
+ * Array sein.
+ *
+ * @param data Der Block
+ * @param size Die Länge des Blocks
+ * @return false bei einem Strukturfehler
+ */
+bool RosterStreamReader::feed(const char *data, qint64 size)
+{
+    for (qint64 i = 0; i < size; ++i) {
+        const char c = data[i];
+
+        if (m_captureDepth >= 0) {
+            m_capture.append(c);
+        }
+
+        // In Strings zählen Klammern nicht
+        if (m_inString) {
+            if (m_escaped) {
+                m_escaped = false;
+            } else if (c == '\\') {
+                m_escaped = true;
+            } else if (c == '"') {
+                m_inString = false;
+                m_readingKey = false;
+                continue;
+            }
+            if (m_readingKey && m_key.size() < MaxKeyLength) {
+                m_key.append(c);
+            }
+            continue;
+        }
+
+        // Der Wert von "characters" muss ein Array sein
+        if (m_mode == RootObjectMode && m_depth == 1 && !m_expectKey && !m_sawCharacters
+            && m_key == "characters" && c != '[' && !isWhitespace(c)) {
+            m_error = QStringLiteral("\"characters\" ist kein Array");
+            return false;
+        }
+
+        // Zwischen den Charakteren stehen nur Kommas und Leerraum
+        if (m_depth == m_charactersDepth && m_captureDepth < 0 && !isWhitespace(c)) {
+            if (c == ',') {
+                if (m_expectCharacter) {
+                    m_error = QStringLiteral("Fehlender Charakter vor Komma");
+                    return false;
+                }
+                m_expectCharacter = true;
+                continue;
+            }
+            if (c == ']') {
+                if (m_expectCharacter && m_store->size() > 0) {
+                    m_error = QStringLiteral("Komma nach dem letzten Charakter");
+                    return false;
+                }
+            } else if (c != '{' || !m_expectCharacter) {
+                m_error = QStringLiteral("Ungültiges Element nach Charakter %1").arg(m_store->size());
+                return false;
+            }
+        }
+
+        switch (c) {
+        case '"':
+            m_inString = true;
+            if (m_mode == RootObjectMode && m_depth == 1 && m_expectKey) {
+                m_readingKey = true;
+                m_key.clear();
+            }
+            break;
+
+        case '{':
+        case '[':
+            if (m_mode == StartMode) {
+                // Das erste Zeichen entscheidet über das Format
+                if (c == '[') {
+                    m_mode = LegacyMode;
+                    m_charactersDepth = 1;
+                    m_sawCharacters = true;
+                    m_expectCharacter = true;
+                } else {
+                    m_mode = RootObjectMode;
+                    m_expectKey = true;
+                }
+            } else if (m_mode == DoneMode) {
+                m_error = QStringLiteral("Daten nach dem Ende des Dokuments");
+                return false;
+            } else if (m_captureDepth < 0) {
+                if (c == '{' && m_depth == m_charactersDepth) {
+                    // Ein Charakter beginnt
+                    m_expectCharacter = false;
+                    m_captureDepth = m_depth;
+                    m_capturingSession = false;
+                    m_capture.clear();
+                    m_capture.append(c);
+                } else if (c == '{' && m_mode == RootObjectMode && m_depth == 1 && m_key == "session") {
+                    m_captureDepth = m_depth;
+                    m_capturingSession = true;
+                    m_capture.clear();
+                    m_capture.append(c);
+                } else if (c == '[' && m_mode == RootObjectMode && m_depth == 1 && m_key == "characters") {
+                    if (m_sawCharacters) {
+                        m_error = QStringLiteral("\"characters\" ist doppelt vorhanden");
+                        return false;
+                    }
+                    m_charactersDepth = 2;
+                    m_sawCharacters = true;
+                    m_expectCharacter = true;
+                }
+            }
+            ++m_depth;
+            break;
+
+        case '}':
+        case ']':
+            if (m_depth == 0) {
+                m_error = QStringLiteral("Unerwartete schließende Klammer");
+                return false;
+            }
+            --m_depth;
+            if (m_captureDepth >= 0 && m_depth == m_captureDepth) {
+                if (!finishCapture()) {
+                    return false;
+                }
+            }
+            if (m_depth < m_charactersDepth) {
+                m_charactersDepth = -1;
+            }
+            if (m_depth == 0) {
+                m_mode = DoneMode;
+            }
+            break;
+
+        case ':':
+            if (m_mode == RootObjectMode && m_depth == 1) {
+                m_expectKey = false;
+            }
+            break;
+
+        case ',':
+            if (m_mode == RootObjectMode && m_depth == 1) {
+                m_expectKey = true;
+                m_key.clear();
+            }
+            break;
+
+        default:
+            if (!isWhitespace(c) && (m_mode == StartMode || m_mode == DoneMode)) {
+                m_error = QStringLiteral("Kein JSON-Objekt oder -Array");
+                return false;
+            }
+            break;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Wertet das aufgezeichnete Objekt aus und beendet die Aufzeichnung
+ *
+ * @return false, wenn das Objekt kein gültiges JSON ist
+ */
+bool RosterStreamReader::finishCapture()
+{
+    const bool ok = m_capturingSession ? readSession(m_capture) : appendCharacter(m_capture);
+    m_captureDepth = -1;
+    m_capture.clear();
+    return ok;
+}
+
+/**
+ * @brief Hängt einen Charakter aus einem JSON-Objekt an den Store an
+ *
+ * @param json Das Charakter-Objekt als Text
+ * @return false, wenn das Objekt kein gültiges JSON ist
+ */
+bool RosterStreamReader::appendCharacter(const QByteArray &json)
+{
+    QJsonParseError parseError;
+    const QJsonDocument document = QJsonDocument::fromJson(json, &parseError);
+    if (!document.isObject()) {
+        m_error = QStringLiteral("Ungültiger Charakter %1: %2")
+            .arg(m_store->size() + 1).arg(parseError.errorString());
+        return false;
+    }
+    const QJsonObject characterObject = document.object();
+
+    // Erstelle einen neuen Charakter mit den Daten aus dem JSON-Objekt
+    Character character(
+        characterObject["name"].toString(),
+        characterObject["initiativeModifier"].toInt(),
+        characterObject["willSave"].toInt(),
+        characterObject["reflexSave"].toInt(),
+        characterObject["fortitudeSave"].toInt()
+    );
+
+    // Setze die gespeicherten Würfe (fehlende Werte bleiben 0)
+    character.setInitiativeRoll(characterObject["initiativeRoll"].toInt());
+    character.setLastWillSaveRoll(characterObject["lastWillSaveRoll"].toInt());
+    character.setLastReflexSaveRoll(characterObject["lastReflexSaveRoll"].toInt());
+    character.setLastFortitudeSaveRoll(characterObject["lastFortitudeSaveRoll"].toInt());
+    m_store->append(character);
+
+    // Würfelschlüssel und Ereignisse; ohne Schlüssel bleiben alle -1
+    const int index = m_store->size() - 1;
+    const int key = characterObject["rollKey"].toInt(-1);
+    if (key >= 0) {
+        m_store->setValue(index, CharacterStore::RollKey, key);
+        m_store->setValue(index, CharacterStore::InitiativeRollEvent, characterObject["initiativeRollEvent"].toInt(-1));
+        m_store->setValue(index, CharacterStore::WillSaveRollEvent, characterObject["willSaveRollEvent"].toInt(-1));
+        m_store->setValue(index, CharacterStore::ReflexSaveRollEvent, characterObject["reflexSaveRollEvent"].toInt(-1));
+        m_store->setValue(index, CharacterStore::FortitudeSaveRollEvent, characterObject["fortitudeSaveRollEvent"].toInt(-1));
+    }
+
+    return true;
+}
+
+/**
+ * @brief Liest die Sitzung aus einem JSON-Objekt
+ *
+ * Eine unvollständige Sitzung ist kein Fehler; die Datei wird dann wie eine
+ * ältere Datei ohne Sitzung behandelt.
+ *
+ * @param json Das Sitzungsobjekt als Text
+ * @return false, wenn das Objekt kein gültiges JSON ist
+ */
+bool RosterStreamReader::readSession(const QByteArray &json)
+{
+    QJsonParseError parseError;
+    const QJsonDocument document = QJsonDocument::fromJson(json, &parseError);
+    if (!document.isObject()) {
+        m_error = QStringLiteral("Ungültige Sitzung: %1").arg(parseError.errorString());
+        return false;
+    }
+    const QJsonObject sessionObject = document.object();
+
+    // Der Sitzungsschlüssel ist als Hex-String gespeichert (siehe saveToFile())
+    bool seedOk = false;
+    bool eventsOk = false;
+    const quint64 seed = sessionObject["seed"].toString().toULongLong(&seedOk, 16);
+    const quint64 events = sessionObject["rollEvents"].toString().toULongLong(&eventsOk);
+    if (seedOk && eventsOk) {
+        m_session.seed = seed;
+        m_session.rollEvents = events;
+        m_session.nextRollKey = sessionObject["nextRollKey"].toInt();
+        m_hasSession = true;
+    }
+
+    return true;
+}
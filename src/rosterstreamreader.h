@@ -0,0 +1,155 @@
+#ifndef ROSTERSTREAMREADER_H
+#define ROSTERSTREAMREADER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QString>
+#include "characterstore.h"
+#include "snapshotfile.h"
+
+class QIODevice;
+
+/**
+ * @brief Der RosterStreamReader liest eine JSON-Charakterdatei Stück für Stück.
+ *
+ * QJsonDocument::fromJson() braucht die ganze Datei als QByteArray und baut
+ * daraus einen vollständigen Baum auf. Bei sehr großen Dateien liegt der
+ * Inhalt dann mehrfach im Speicher. Dieser Leser liest die Datei in festen
+ * Blöcken und verfolgt nur Verschachtelungstiefe und Strings. Sobald ein
+ * Charakter-Objekt vollständig gelesen ist, wird nur dieses eine Objekt mit
+ * QJsonDocument geparst und an den CharacterStore angehängt. Zusätzlicher
+ * Speicher: ein Block der Datei und ein einzelnes Charakter-Objekt.
+ *
+ * Unterstützt werden beide Formate von InitiativeTracker::saveToFile():
+ * das Objekt mit "session" und "characters" (in beliebiger Reihenfolge) und
+ * ältere Dateien, die nur aus dem Array der Charaktere bestehen.
+ *
+ * Geprüft werden nur die Struktur (Klammern und Strings) und jedes einzelne
+ * Charakter-Objekt, nicht jedes Zeichen zwischen den Objekten.
+ *
+ * Qt-Konzept: QIODevice
+ * QFile, QBuffer und Netzwerkverbindungen sind alle QIODevices. Der Leser
+ * arbeitet mit jedem davon, weil er nur read() aufruft.
+ */
+class RosterStreamReader : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Erstellt einen Leser.
+     *
+     * @param parent Das Elternobjekt
+     */
+    explicit RosterStreamReader(QObject *parent = nullptr);
+
+    /**
+     * @brief Liest alle Charaktere aus einem geöffneten Gerät.
+     *
+     * Die Charaktere werden mit ihren gespeicherten Würfelschlüsseln und
+     * -ereignissen angehängt. Ob diese gültig sind, entscheidet der
+     * Aufrufer anhand von hasSession().
+     *
+     * @param device Das zum Lesen geöffnete Gerät
+     * @param store Erhält die Charaktere (wird vorher geleert)
+     * @return true, wenn die Datei vollständig und gültig war
+     */
+    bool read(QIODevice *device, CharacterStore *store);
+
+    /**
+     * @brief Gibt an, ob die Datei eine gültige Sitzung enthielt.
+     *
+     * @return true, wenn session() gültig ist
+     */
+    bool hasSession() const;
+
+    /**
+     * @brief Gibt die gelesene Sitzung zurück.
+     *
+     * @return Die Sitzung (nur gültig, wenn hasSession() true ist)
+     */
+    SnapshotFile::Session session() const;
+
+    /**
+     * @brief Beschreibt den letzten Fehler.
+     *
+     * @return Die Fehlerbeschreibung oder ein leerer String
+     */
+    QString errorString() const;
+
+    static constexpr int ChunkSize = 64 * 1024;          ///< Größe eines gelesenen Blocks
+    static constexpr qint64 ProgressInterval = 1024 * 1024;  ///< Bytes zwischen zwei progress()-Signalen
+
+signals:
+    /**
+     * @brief Meldet den Fortschritt beim Lesen.
+     *
+     * @param bytesRead Die bisher gelesenen Bytes
+     * @param bytesTotal Die Größe der Datei (0, falls unbekannt)
+     */
+    void progress(qint64 bytesRead, qint64 bytesTotal);
+
+private:
+    /**
+     * @brief Wo im Dokument sich der Leser befindet.
+     */
+    enum Mode {
+        StartMode,       ///< Vor dem ersten Zeichen
+        LegacyMode,      ///< Im Array eines alten Dokuments
+        RootObjectMode,  ///< Im Objekt mit "session" und "characters"
+        DoneMode         ///< Nach dem Ende des Dokuments
+    };
+
+    /**
+     * @brief Verarbeitet einen gelesenen Block.
+     *
+     * @param data Der Block
+     * @param size Die Länge des Blocks
+     * @return false bei einem Strukturfehler
+     */
+    bool feed(const char *data, qint64 size);
+
+    /**
+     * @brief Wertet ein vollständig gelesenes Objekt aus.
+     *
+     * @return false, wenn das Objekt kein gültiges JSON ist
+     */
+    bool finishCapture();
+
+    /**
+     * @brief Hängt einen Charakter aus einem JSON-Objekt an den Store an.
+     *
+     * @param json Das Charakter-Objekt als Text
+     * @return false, wenn das Objekt kein gültiges JSON ist
+     */
+    bool appendCharacter(const QByteArray &json);
+
+    /**
+     * @brief Liest die Sitzung aus einem JSON-Objekt.
+     *
+     * @param json Das Sitzungsobjekt als Text
+     * @return false, wenn das Objekt kein gültiges JSON ist
+     */
+    bool readSession(const QByteArray &json);
+
+    CharacterStore *m_store;          ///< Das Ziel der Charaktere
+    SnapshotFile::Session m_session;  ///< Die gelesene Sitzung
+    bool m_hasSession;                ///< Wurde eine gültige Sitzung gelesen?
+    QString m_error;                  ///< Der letzte Fehler
+
+    Mode m_mode;                ///< Die aktuelle Position im Dokument
+    int m_depth;                ///< Anzahl der offenen Klammern
+    bool m_inString;            ///< Steht der Leser in einem String?
+    bool m_escaped;             ///< War das letzte Zeichen im String ein Backslash?
+    bool m_expectKey;           ///< Erwartet das Wurzelobjekt als Nächstes einen Schlüssel?
+    bool m_readingKey;          ///< Wird gerade ein Schlüssel des Wurzelobjekts gelesen?
+    QByteArray m_key;           ///< Der zuletzt gelesene Schlüssel des Wurzelobjekts
+    int m_charactersDepth;      ///< Tiefe innerhalb des Charakter-Arrays (-1 = nicht darin)
+    bool m_sawCharacters;       ///< Wurde das Charakter-Array bereits geöffnet?
+    bool m_expectCharacter;     ///< Erwartet das Charakter-Array als Nächstes ein Objekt?
+    bool m_capturingSession;    ///< Ist das aufgezeichnete Objekt die Sitzung?
+    int m_captureDepth;         ///< Tiefe vor dem aufgezeichneten Objekt (-1 = keine Aufzeichnung)
+    QByteArray m_capture;       ///< Das aktuell aufgezeichnete Objekt
+};
+
+#endif // ROSTERSTREAMREADER_H
@@ -0,0 +1,167 @@
+#include "initiativetracker.h"
+#include "trace.h"
+#include "trackerservice.h"
+#include "trackerstorage.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QHostAddress>
+
+#ifdef Q_OS_UNIX
+#include <QSocketNotifier>
+#include <csignal>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#ifdef Q_OS_UNIX
+/// Beide Enden der Verbindung, über die Signal-Handler die Ereignisschleife wecken
+static int s_signalSockets[2] = { -1, -1 };
+
+/**
+ * @brief Signal-Handler für SIGINT und SIGTERM
+ *
+ * In einem Signal-Handler dürfen keine Qt-Funktionen aufgerufen werden.
+ * Er schreibt daher nur ein Byte in den Socket; den Rest erledigt die
+ * Ereignisschleife.
+ *
+ * @param signal Das Signal
+ */
+static void onUnixSignal(int signal)
+{
+    const char byte = char(signal);
+    const ssize_t written = ::write(s_signalSockets[0], &byte, 1);
+    Q_UNUSED(written);
+}
+
+/**
+ * @brief Beendet die Ereignisschleife bei SIGINT und SIGTERM
+ *
+ * So werden die Dateien auch bei Strg+C oder beim Stoppen des Dienstes
+ * vollständig gespeichert. Ohne diese Behandlung ginge nichts verloren
+ * (das Journal enthält jede Änderung), der nächste Start müsste aber das
+ * Journal abspielen.
+ *
+ * @param app Die Anwendung
+ */
+static void quitOnUnixSignals(QCoreApplication *app)
+{
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, s_signalSockets) != 0) {
+        qWarning() << "Signale können nicht abgefangen werden.";
+        return;
+    }
+
+    QSocketNotifier *notifier = new QSocketNotifier(s_signalSockets[1], QSocketNotifier::Read, app);
+    QObject::connect(notifier, &QSocketNotifier::activated, app, [notifier]() {
+        notifier->setEnabled(false);
+        char byte = 0;
+        const ssize_t received = ::read(s_signalSockets[1], &byte, 1);
+        Q_UNUSED(received);
+        qInfo() << "Signal" << int(byte) << "empfangen, Server wird beendet.";
+        QCoreApplication::quit();
+    });
+
+    struct sigaction action = {};
+    action.sa_handler = onUnixSignal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+}
+#endif
+
+/**
+ * @brief Hauptfunktion des Servers ohne Oberfläche
+ *
+ * Stellt einen InitiativeTracker mit Speicherung (TrackerStorage) und
+ * WebSocket-Schnittstelle (TrackerService) bereit, z.B. als Hintergrunddienst
+ * für ein Stream-Overlay. Gesteuert wird der Tracker nur über WebSocket.
+ *
+ * Qt-Konzept: QCoreApplication
+ * QCoreApplication bietet die Ereignisschleife ohne Fenster, Schriftarten
+ * und Grafik. Das Programm linkt nur QtCore, QtNetwork und QtWebSockets und
+ * startet daher schneller und braucht weniger Speicher als die Anwendung
+ * mit Oberfläche.
+ *
+ * @param argc Anzahl der Kommandozeilenargumente
+ * @param argv Array der Kommandozeilenargumente
+ * @return 0 bei normalem Beenden, 1 wenn der Server nicht starten konnte
+ */
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("DnDInitiativeTrackerServer"));
+    QCoreApplication::setApplicationVersion(QStringLiteral("1.0.0"));
+
+#if DND_BINARY_TRACE
+    // Binäre Aufzeichnung wie in der Anwendung mit Oberfläche
+    const QString traceFile = qEnvironmentVariable("DND_TRACE_FILE");
+    if (!traceFile.isEmpty()) {
+        Trace::start();
+    }
+#endif
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("D&D Initiative Tracker als WebSocket-Server ohne Oberfläche"));
+    parser.addHelpOption();
+    parser.addVersionOption();
+    const QCommandLineOption portOption({ QStringLiteral("p"), QStringLiteral("port") },
+        QStringLiteral("Port des WebSocket-Servers (Standard: 8088)"), QStringLiteral("port"), QStringLiteral("8088"));
+    const QCommandLineOption addressOption({ QStringLiteral("a"), QStringLiteral("address") },
+        QStringLiteral("Adresse, auf der der Server lauscht (Standard: 127.0.0.1, 0.0.0.0 = alle)"),
+        QStringLiteral("adresse"), QStringLiteral("127.0.0.1"));
+    const QCommandLineOption dataOption({ QStringLiteral("d"), QStringLiteral("data-dir") },
+        QStringLiteral("Verzeichnis für characters.json, Snapshot und Journal (Standard: aktuelles Verzeichnis)"),
+        QStringLiteral("verzeichnis"));
+    parser.addOption(portOption);
+    parser.addOption(addressOption);
+    parser.addOption(dataOption);
+    parser.process(app);
+
+    bool portOk = false;
+    const uint port = parser.value(portOption).toUInt(&portOk);
+    const QHostAddress address(parser.value(addressOption));
+    if (!portOk || port > 65535 || address.isNull()) {
+        qWarning() << "Ungültiger Port oder ungültige Adresse.";
+        parser.showHelp(1);
+    }
+
+    InitiativeTracker tracker;
+    TrackerStorage storage(&tracker, parser.value(dataOption));
+    storage.load();
+
+    // Meldungen für den Betreiber gehen immer aus, unabhängig von DND_TRACE_LEVEL
+    TrackerService service(&tracker);
+    QObject::connect(&service, &TrackerService::clientConnected, [](const QString &peer) {
+        qInfo() << "Neue Verbindung hergestellt:" << peer;
+    });
+    QObject::connect(&service, &TrackerService::clientDisconnected, [](const QString &peer) {
+        qInfo() << "Verbindung getrennt:" << peer;
+    });
+
+    if (!service.start(address, quint16(port))) {
+        qWarning() << "Fehler beim Starten des WebSocket-Servers:" << service.errorString();
+        storage.save();
+        return 1;
+    }
+    qInfo() << "WebSocket-Server gestartet auf" << address.toString() << "Port" << service.serverPort();
+
+#ifdef Q_OS_UNIX
+    quitOnUnixSignals(&app);
+#endif
+
+    const int result = app.exec();
+
+    // Zuerst keine neuen Befehle mehr annehmen, dann vollständig speichern
+    service.stop();
+    storage.save();
+
+#if DND_BINARY_TRACE
+    if (!traceFile.isEmpty()) {
+        Trace::stop(traceFile);
+    }
+#endif
+
+    return result;
+}
@@ -0,0 +1,291 @@
+#include "snapshotfile.h"
+#include "trace.h"
+#include <QFile>
+#include <QSaveFile>
+#include <QHash>
+#include <QtEndian>
+#include <climits>
+#include <cstring>
+
+namespace {
+
+const char Magic[8] = { 'D', 'N', 'D', 'S', 'N', 'A', 'P', '\0' };
+
+// Positionen der Felder im Kopf
+const int VersionOffset = 8;
+const int HeaderSizeOffset = 12;
+const int CountOffset = 16;
+const int FieldCountOffset = 20;
+const int SeedOffset = 24;
+const int RollEventsOffset = 32;
+const int NextRollKeyOffset = 40;
+const int JournalGenerationOffset = 44;
+const int ColumnsOffsetOffset = 48;
+const int NamesOffsetOffset = 56;
+const int StringsOffsetOffset = 64;
+const int StringsSizeOffset = 72;
+
+/**
+ * @brief Rundet eine Position auf das nächste Vielfache von 8 auf
+ *
+ * @param offset Die Position
+ * @return Die ausgerichtete Position
+ */
+quint64 align8(quint64 offset)
+{
+    return (offset + 7) & ~quint64(7);
+}
+
+/**
+ * @brief Prüft, ob ein Abschnitt vollständig hinter dem Kopf in den Daten liegt
+ *
+ * Offset und Länge stammen aus der Datei und können beliebig groß sein.
+ * Geprüft wird daher mit einer Subtraktion, die nicht überlaufen kann,
+ * statt offset + length zu bilden.
+ *
+ * @param offset Der Anfang des Abschnitts
+ * @param length Die Länge des Abschnitts
+ * @param size Die Länge der Daten
+ * @return true, wenn der Abschnitt in den Daten liegt
+ */
+bool sectionInData(quint64 offset, quint64 length, quint64 size)
+{
+    return offset >= SnapshotFile::HeaderSize && offset <= size && length <= size - offset;
+}
+
+} // namespace
+
+/**
+ * @brief Baut einen Snapshot im Speicher auf
+ *
+ * @param store Die zu speichernden Charaktere
+ * @param session Die zu speichernde Sitzung
+ * @return Der Inhalt einer Snapshot-Datei
+ */
+QByteArray SnapshotFile::toData(const CharacterStore &store, const Session &session)
+{
+    const quint32 count = quint32(store.size());
+
+    // Stringtabelle aus dem NamePool aufbauen; jeder benutzte Name steht nur
+    // einmal darin. Die Position wird über die Id gefunden, ohne zu hashen.
+    const NamePool &pool = store.namePool();
+    QVector<qint64> nameOffsets(pool.size(), -1);
+    QVector<quint32> nameIndex(int(count) * 2);
+    QString strings;
+    for (int i = 0; i < int(count); ++i) {
+        const NamePool::Id id = store.nameId(i);
+        const QString &name = pool.name(id);
+        if (nameOffsets.at(int(id)) < 0) {
+            nameOffsets[int(id)] = strings.size();
+            strings += name;
+        }
+        nameIndex[2 * i] = quint32(nameOffsets.at(int(id)));
+        nameIndex[2 * i + 1] = quint32(name.size());
+    }
+
+    const quint64 columnsOffset = HeaderSize;
+    const quint64 columnsSize = quint64(count) * CharacterStore::FieldCount * sizeof(qint32);
+    const quint64 namesOffset = align8(columnsOffset + columnsSize);
+    const quint64 namesSize = quint64(count) * 2 * sizeof(quint32);
+    const quint64 stringsOffset = align8(namesOffset + namesSize);
+    const quint64 stringsSize = quint64(strings.size()) * sizeof(quint16);
+
+    QByteArray buffer(int(stringsOffset + stringsSize), '\0');
+    uchar *data = reinterpret_cast<uchar *>(buffer.data());
+
+    // Kopf
+    std::memcpy(data, Magic, sizeof(Magic));
+    qToLittleEndian<quint32>(Version, data + VersionOffset);
+    qToLittleEndian<quint32>(HeaderSize, data + HeaderSizeOffset);
+    qToLittleEndian<quint32>(count, data + CountOffset);
+    qToLittleEndian<quint32>(CharacterStore::FieldCount, data + FieldCountOffset);
+    qToLittleEndian<quint64>(session.seed, data + SeedOffset);
+    qToLittleEndian<quint64>(session.rollEvents, data + RollEventsOffset);
+    qToLittleEndian<qint32>(session.nextRollKey, data + NextRollKeyOffset);
+    qToLittleEndian<quint32>(session.journalGeneration, data + JournalGenerationOffset);
+    qToLittleEndian<quint64>(columnsOffset, data + ColumnsOffsetOffset);
+    qToLittleEndian<quint64>(namesOffset, data + NamesOffsetOffset);
+    qToLittleEndian<quint64>(stringsOffset, data + StringsOffsetOffset);
+    qToLittleEndian<quint64>(stringsSize, data + StringsSizeOffset);
+
+    // Spalten, Namensindex und Stringtabelle; die Datei speichert jede Spalte
+    // als qint32, unabhängig von ihrer Breite im Store
+    QVector<int> values(count);
+    for (int field = 0; field < CharacterStore::FieldCount; ++field) {
+        uchar *columnData = data + columnsOffset + quint64(field) * count * sizeof(qint32);
+        store.readValues(CharacterStore::Field(field), 0, count, values.data());
+        qToLittleEndian<qint32>(values.constData(), count, columnData);
+    }
+    qToLittleEndian<quint32>(nameIndex.constData(), count * 2, data + namesOffset);
+    qToLittleEndian<quint16>(strings.utf16(), strings.size(), data + stringsOffset);
+
+    return buffer;
+}
+
+/**
+ * @brief Schreibt einen Snapshot
+ *
+ * Die ganze Datei wird zuerst im Speicher aufgebaut und dann mit einem
+ * einzigen write() in eine temporäre Datei geschrieben, die danach die alte ersetzt.
+ *
+ * @param filename Der Dateiname
+ * @param store Die zu speichernden Charaktere
+ * @param session Die zu speichernde Sitzung
+ * @return true, wenn die Datei vollständig geschrieben wurde
+ */
+bool SnapshotFile::write(const QString &filename, const CharacterStore &store, const Session &session)
+{
+    const QByteArray buffer = toData(store, session);
+
+    // QSaveFile ersetzt die alte Datei erst mit commit()
+    QSaveFile file(filename);
+    if (!file.open(QIODevice::WriteOnly) || file.write(buffer) != buffer.size() || !file.commit()) {
+        TRACE_WARNING(lcStorage) << "Snapshot konnte nicht geschrieben werden:" << filename;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Liest einen Snapshot über QFile::map()
+ *
+ * @param filename Der Dateiname
+ * @param store Erhält die geladenen Charaktere
+ * @param session Erhält die geladene Sitzung
+ * @return true, wenn der Snapshot gültig war und geladen wurde
+ */
+bool SnapshotFile::read(const QString &filename, CharacterStore *store, Session *session)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        TRACE_INFO(lcStorage) << "Snapshot existiert nicht oder konnte nicht geöffnet werden:" << filename;
+        return false;
+    }
+
+    const quint64 fileSize = quint64(file.size());
+    if (fileSize < HeaderSize) {
+        TRACE_WARNING(lcStorage) << "Snapshot ist zu kurz:" << filename;
+        return false;
+    }
+
+    uchar *data = file.map(0, qint64(fileSize));
+    if (!data) {
+        TRACE_WARNING(lcStorage) << "Snapshot konnte nicht eingeblendet werden:" << filename;
+        return false;
+    }
+
+    const bool loaded = fromData(data, fileSize, store, session);
+    file.unmap(data);
+    if (!loaded) {
+        TRACE_WARNING(lcStorage) << "Ungültiger oder veralteter Snapshot:" << filename;
+    }
+    return loaded;
+}
+
+/**
+ * @brief Liest einen Snapshot aus dem Speicher
+ *
+ * @param data Der Inhalt einer Snapshot-Datei
+ * @param size Die Länge in Byte
+ * @param store Erhält die geladenen Charaktere
+ * @param session Erhält die geladene Sitzung
+ * @return true, wenn der Snapshot gültig war und geladen wurde
+ */
+bool SnapshotFile::fromData(const uchar *data, quint64 size, CharacterStore *store, Session *session)
+{
+    if (size < HeaderSize) {
+        return false;
+    }
+
+    // Kopf prüfen
+    const quint32 version = qFromLittleEndian<quint32>(data + VersionOffset);
+    const quint32 headerSize = qFromLittleEndian<quint32>(data + HeaderSizeOffset);
+    const quint32 count = qFromLittleEndian<quint32>(data + CountOffset);
+    const quint32 fieldCount = qFromLittleEndian<quint32>(data + FieldCountOffset);
+    const quint64 columnsOffset = qFromLittleEndian<quint64>(data + ColumnsOffsetOffset);
+    const quint64 namesOffset = qFromLittleEndian<quint64>(data + NamesOffsetOffset);
+    const quint64 stringsOffset = qFromLittleEndian<quint64>(data + StringsOffsetOffset);
+    const quint64 stringsSize = qFromLittleEndian<quint64>(data + StringsSizeOffset);
+
+    const bool headerValid = std::memcmp(data, Magic, sizeof(Magic)) == 0
+        && version == Version
+        && headerSize == HeaderSize
+        && fieldCount == quint32(CharacterStore::FieldCount)
+        && count <= quint32(INT_MAX / CharacterStore::FieldCount);
+    if (!headerValid) {
+        return false;
+    }
+
+    // Alle Abschnitte müssen vollständig in der Datei liegen. count ist oben
+    // begrenzt, die berechneten Längen können also nicht überlaufen.
+    const quint64 columnsSize = quint64(count) * CharacterStore::FieldCount * sizeof(qint32);
+    const quint64 namesSize = quint64(count) * 2 * sizeof(quint32);
+    const bool valid = sectionInData(columnsOffset, columnsSize, size)
+        && sectionInData(namesOffset, namesSize, size)
+        && sectionInData(stringsOffset, stringsSize, size)
+        && stringsSize % sizeof(quint16) == 0;
+    if (!valid) {
+        return false;
+    }
+
+    CharacterStore loaded;
+    loaded.resize(int(count));
+
+    // Jede Spalte ist ein Block aus count qint32-Werten innerhalb des oben
+    // geprüften Abschnitts. Ein Block wird in einen int-Puffer gelesen und
+    // über writeValues() übernommen, das jeden Wert wie jeder andere Weg in
+    // den Store auf die Breite der Spalte begrenzt.
+    const quint64 columnStride = quint64(count) * sizeof(qint32);
+    QVector<int> values(int(count));
+    for (int field = 0; field < CharacterStore::FieldCount; ++field) {
+        const uchar *columnData = data + columnsOffset + quint64(field) * columnStride;
+        qFromLittleEndian<qint32>(columnData, count, values.data());
+        loaded.writeValues(CharacterStore::Field(field), 0, int(count), values.constData());
+    }
+
+    // Namen aus der Stringtabelle; jede Position wird nur einmal gelesen und
+    // in den NamePool aufgenommen, alle weiteren Charaktere bekommen die Id
+    const quint64 stringsLength = stringsSize / sizeof(quint16);
+    const uchar *names = data + namesOffset;
+    QHash<quint64, NamePool::Id> sharedNames;
+    QVector<quint16> utf16;
+    for (quint32 i = 0; i < count; ++i) {
+        const quint32 offset = qFromLittleEndian<quint32>(names + 8 * quint64(i));
+        const quint32 length = qFromLittleEndian<quint32>(names + 8 * quint64(i) + 4);
+        if (quint64(offset) + length > stringsLength) {
+            return false;
+        }
+
+        const quint64 key = (quint64(offset) << 32) | length;
+        auto it = sharedNames.constFind(key);
+        if (it == sharedNames.constEnd()) {
+            utf16.resize(int(length));
+            qFromLittleEndian<quint16>(data + stringsOffset + quint64(offset) * sizeof(quint16), length, utf16.data());
+            it = sharedNames.insert(key, loaded.internName(QString(reinterpret_cast<const QChar *>(utf16.constData()), int(length))));
+        }
+        loaded.setNameId(int(i), it.value());
+    }
+
+    session->seed = qFromLittleEndian<quint64>(data + SeedOffset);
+    session->rollEvents = qFromLittleEndian<quint64>(data + RollEventsOffset);
+    session->nextRollKey = qFromLittleEndian<qint32>(data + NextRollKeyOffset);
+    session->journalGeneration = qFromLittleEndian<quint32>(data + JournalGenerationOffset);
+
+    *store = loaded;
+    return true;
+}
+
+/**
+ * @brief Prüft die Kennung am Dateianfang
+ *
+ * @param filename Der Dateiname
+ * @return true, wenn die Datei ein Snapshot ist
+ */
+bool SnapshotFile::isSnapshot(const QString &filename)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    return file.read(sizeof(Magic)) == QByteArray(Magic, sizeof(Magic));
+}
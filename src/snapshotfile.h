@@ -0,0 +1,112 @@
+#ifndef SNAPSHOTFILE_H
+#define SNAPSHOTFILE_H
+
+#include <QByteArray>
+#include <QString>
+#include "characterstore.h"
+
+/**
+ * @brief Die SnapshotFile-Klasse speichert und lädt den CharacterStore in einem binären Format.
+ *
+ * Das JSON-Format braucht für jedes Feld eine Suche nach dem Schlüssel und
+ * eine Umwandlung von Text in Zahlen. Der Snapshot legt die Daten dagegen so
+ * ab, wie sie im CharacterStore liegen: pro Feld eine Spalte aus 32-Bit-Zahlen
+ * fester Breite. Beim Laden wird die Datei mit QFile::map() eingeblendet und
+ * jede Spalte mit einer einzigen Kopie in den Store übernommen.
+ *
+ * Aufbau (alle Zahlen Little Endian):
+ * - Kopf (80 Byte): "DNDSNAP" + '\0', Version, Kopfgröße, Anzahl der
+ *   Charaktere, Anzahl der Spalten, Sitzung (Seed, Würfelereignisse, nächster
+ *   Würfelschlüssel, Journal-Generation) und die Positionen der folgenden Abschnitte
+ * - Spalten: FieldCount Blöcke mit je count qint32-Werten
+ * - Namensindex: pro Charakter ein fester Eintrag (Position, Länge) in der Stringtabelle
+ * - Stringtabelle: alle unterschiedlichen Namen als UTF-16
+ *
+ * Gleiche Namen (z.B. zehn "Goblin") stehen nur einmal in der Stringtabelle
+ * und teilen sich nach dem Laden dieselbe Id im NamePool des Stores.
+ *
+ * Ändern sich die Spalten des CharacterStore, muss Version erhöht werden.
+ *
+ * Qt-Konzept: QFile::map()
+ * map() blendet eine Datei in den Adressraum des Programms ein. Der Inhalt
+ * kann dann wie ein Array gelesen werden; das Betriebssystem lädt die Seiten
+ * erst beim Zugriff, ohne Umweg über einen eigenen Lesepuffer.
+ */
+class SnapshotFile
+{
+public:
+    /**
+     * @brief Die Sitzungsdaten, die mit den Charakteren gespeichert werden.
+     */
+    struct Session {
+        quint64 seed = 0;               ///< Der Sitzungsschlüssel der DiceEngine
+        quint64 rollEvents = 0;         ///< Die Anzahl der bisher vergebenen Würfelereignisse
+        int nextRollKey = 0;            ///< Der Würfelschlüssel für den nächsten Charakter
+        quint32 journalGeneration = 0;  ///< Das ChangeJournal, das auf diesem Snapshot aufbaut (0 = keines)
+    };
+
+    static constexpr quint32 Version = 1;      ///< Aktuelle Formatversion
+    static constexpr quint32 HeaderSize = 80;  ///< Größe des Kopfes in Byte
+
+    /**
+     * @brief Schreibt einen Snapshot.
+     *
+     * Die Datei wird über QSaveFile geschrieben und erst am Ende umbenannt.
+     * Bricht das Schreiben ab, bleibt der alte Snapshot vollständig erhalten.
+     *
+     * @param filename Der Dateiname
+     * @param store Die zu speichernden Charaktere
+     * @param session Die zu speichernde Sitzung
+     * @return true, wenn die Datei vollständig geschrieben wurde
+     */
+    static bool write(const QString &filename, const CharacterStore &store, const Session &session);
+
+    /**
+     * @brief Liest einen Snapshot.
+     *
+     * Bei einem Fehler (fehlende Datei, falsche Version, beschädigter Inhalt)
+     * bleiben store und session unverändert.
+     *
+     * @param filename Der Dateiname
+     * @param store Erhält die geladenen Charaktere
+     * @param session Erhält die geladene Sitzung
+     * @return true, wenn der Snapshot gültig war und geladen wurde
+     */
+    static bool read(const QString &filename, CharacterStore *store, Session *session);
+
+    /**
+     * @brief Baut einen Snapshot im Speicher auf.
+     *
+     * Derselbe Inhalt, den write() in die Datei schreibt, z.B. für einen
+     * Eintrag im EncounterArchive.
+     *
+     * @param store Die zu speichernden Charaktere
+     * @param session Die zu speichernde Sitzung
+     * @return Der Inhalt einer Snapshot-Datei
+     */
+    static QByteArray toData(const CharacterStore &store, const Session &session);
+
+    /**
+     * @brief Liest einen Snapshot aus dem Speicher.
+     *
+     * Prüft den Inhalt genauso wie read(). Bei einem Fehler bleiben store
+     * und session unverändert.
+     *
+     * @param data Der Inhalt einer Snapshot-Datei
+     * @param size Die Länge in Byte
+     * @param store Erhält die geladenen Charaktere
+     * @param session Erhält die geladene Sitzung
+     * @return true, wenn der Snapshot gültig war und geladen wurde
+     */
+    static bool fromData(const uchar *data, quint64 size, CharacterStore *store, Session *session);
+
+    /**
+     * @brief Prüft anhand der Kennung am Dateianfang, ob eine Datei ein Snapshot ist.
+     *
+     * @param filename Der Dateiname
+     * @return true, wenn die Datei mit "DNDSNAP" beginnt
+     */
+    static bool isSnapshot(const QString &filename);
+};
+
+#endif // SNAPSHOTFILE_H
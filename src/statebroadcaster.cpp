@@ -0,0 +1,375 @@
+#include "statebroadcaster.h"
+#include "initiativetracker.h"
+#include "trace.h"
+#include <QJsonArray>
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+/**
+ * @brief Die Felder, die Clients sehen, mit ihren Namen in der Nachricht.
+ *
+ * Die Namen entsprechen denen der JSON-Datei (InitiativeTracker::writeJsonFile()).
+ */
+struct ClientField {
+    CharacterStore::Field field;
+    const char *key;
+};
+
+const ClientField clientFields[] = {
+    { CharacterStore::InitiativeModifier, "initiativeModifier" },
+    { CharacterStore::InitiativeRoll, "initiativeRoll" },
+    { CharacterStore::WillSave, "willSave" },
+    { CharacterStore::ReflexSave, "reflexSave" },
+    { CharacterStore::FortitudeSave, "fortitudeSave" },
+    { CharacterStore::LastWillSaveRoll, "lastWillSaveRoll" },
+    { CharacterStore::LastReflexSaveRoll, "lastReflexSaveRoll" },
+    { CharacterStore::LastFortitudeSaveRoll, "lastFortitudeSaveRoll" },
+};
+
+/**
+ * @brief Die Felder, die Clients sehen, als Bitmaske
+ */
+CharacterStore::FieldMask clientFieldMask()
+{
+    CharacterStore::FieldMask mask = CharacterStore::NameBit;
+    for (const ClientField &clientField : clientFields) {
+        mask |= CharacterStore::fieldBit(clientField.field);
+    }
+    return mask;
+}
+
+/**
+ * @brief Die Felder, deren Änderung die Initiative-Reihenfolge verschieben kann
+ */
+const CharacterStore::FieldMask orderFields = CharacterStore::fieldBit(CharacterStore::InitiativeModifier)
+    | CharacterStore::fieldBit(CharacterStore::InitiativeRoll) | CharacterStore::NameBit;
+
+/**
+ * @brief Wandelt eine Liste von Indizes in ein JSON-Array um
+ */
+QJsonArray intArray(const QVector<int> &values)
+{
+    QJsonArray array;
+    for (int value : values) {
+        array.append(value);
+    }
+    return array;
+}
+
+} // namespace
+
+/**
+ * @brief Erstellt einen StateBroadcaster für einen Tracker
+ *
+ * @param tracker Der beobachtete Tracker
+ * @param parent Das Elternobjekt
+ */
+StateBroadcaster::StateBroadcaster(InitiativeTracker *tracker, QObject *parent)
+    : QObject(parent)
+    , m_tracker(tracker)
+    , m_dirtyFields(0)
+    , m_clientRows(0)
+    , m_reset(false)
+    , m_active(false)
+    , m_flushScheduled(false)
+{
+    connect(m_tracker, &InitiativeTracker::rowsInserted, this, &StateBroadcaster::onRowsInserted);
+    connect(m_tracker, &InitiativeTracker::rowsRemoved, this, &StateBroadcaster::onRowsRemoved);
+    connect(m_tracker, &InitiativeTracker::rowsUpdated, this, &StateBroadcaster::onRowsUpdated);
+    connect(m_tracker, &InitiativeTracker::rowsReset, this, &StateBroadcaster::onRowsReset);
+}
+
+/**
+ * @brief Gibt zurück, ob Änderungen gesammelt werden
+ */
+bool StateBroadcaster::isActive() const
+{
+    return m_active;
+}
+
+/**
+ * @brief Schaltet das Sammeln ein oder aus
+ *
+ * @param active true, wenn mindestens ein Client abonniert hat
+ */
+void StateBroadcaster::setActive(bool active)
+{
+    if (m_active == active) {
+        return;
+    }
+    m_active = active;
+    clearPending();
+    if (active) {
+        resetClientState();
+    }
+    TRACE_DEBUG(lcNet) << "StateBroadcaster aktiv:" << active;
+}
+
+/**
+ * @brief Gibt zurück, ob gesammelte Änderungen auf flush() warten
+ */
+bool StateBroadcaster::hasPendingChanges() const
+{
+    return m_reset || !m_dirtyRows.isEmpty() || !m_removed.isEmpty();
+}
+
+/**
+ * @brief Baut den ganzen Zustand des Trackers
+ *
+ * @return Eine Nachricht mit "type": "state" und allen Charakteren
+ */
+QJsonObject StateBroadcaster::fullState() const
+{
+    const CharacterStore &store = m_tracker->store();
+    const CharacterStore::FieldMask fields = clientFieldMask();
+
+    QJsonArray characters;
+    for (int i = 0; i < store.size(); ++i) {
+        characters.append(characterObject(store, i, fields));
+    }
+
+    QJsonObject message;
+    message[QLatin1String("type")] = QStringLiteral("state");
+    message[QLatin1String("count")] = store.size();
+    message[QLatin1String("characters")] = characters;
+    message[QLatin1String("order")] = intArray(m_tracker->initiativeOrder().indices());
+    return message;
+}
+
+/**
+ * @brief Baut ein Charakter-Objekt mit ausgewählten Feldern
+ *
+ * @param store Die Charaktere
+ * @param index Der Index des Charakters
+ * @param fields Die zu übertragenden Felder
+ * @return Das Objekt mit "index" und den gewählten Feldern
+ */
+QJsonObject StateBroadcaster::characterObject(const CharacterStore &store, int index, CharacterStore::FieldMask fields)
+{
+    QJsonObject object;
+    object[QLatin1String("index")] = index;
+    if (fields & CharacterStore::NameBit) {
+        object[QLatin1String("name")] = store.name(index);
+    }
+    for (const ClientField &clientField : clientFields) {
+        if (fields & CharacterStore::fieldBit(clientField.field)) {
+            object[QLatin1String(clientField.key)] = store.value(index, clientField.field);
+        }
+    }
+    return object;
+}
+
+/**
+ * @brief Sendet die gesammelten Änderungen mit deltaReady()
+ */
+void StateBroadcaster::flush()
+{
+    m_flushScheduled = false;
+    if (!m_active || !hasPendingChanges()) {
+        return;
+    }
+
+    if (m_reset) {
+        clearPending();
+        resetClientState();
+        emit deltaReady(fullState());
+        return;
+    }
+
+    const CharacterStore &store = m_tracker->store();
+    std::sort(m_dirtyRows.begin(), m_dirtyRows.end());
+
+    QJsonArray characters;
+    for (int index : std::as_const(m_dirtyRows)) {
+        if (index < store.size()) {
+            characters.append(characterObject(store, index, m_dirty.at(index)));
+        }
+    }
+
+    // Nur die Ränge, die sich gegenüber dem Client geändert haben; Entfernen
+    // allein verschiebt keine Ränge, die der Client nicht selbst nachführt
+    QVector<int> orderChanges;
+    if (m_dirtyFields & orderFields) {
+        const QVector<int> &order = m_tracker->initiativeOrder().indices();
+        for (int rank = 0; rank < order.size(); ++rank) {
+            if (rank >= m_clientOrder.size() || m_clientOrder.at(rank) != order.at(rank)) {
+                orderChanges << rank << order.at(rank);
+            }
+        }
+        m_clientOrder = order;
+    }
+
+    QJsonObject message;
+    message[QLatin1String("type")] = QStringLiteral("delta");
+    message[QLatin1String("count")] = store.size();
+    if (!m_removed.isEmpty()) {
+        message[QLatin1String("removed")] = intArray(m_removed);
+    }
+    message[QLatin1String("characters")] = characters;
+    if (!orderChanges.isEmpty()) {
+        message[QLatin1String("orderChanges")] = intArray(orderChanges);
+    }
+
+    const bool changed = !characters.isEmpty() || !m_removed.isEmpty() || !orderChanges.isEmpty();
+    m_clientRows = store.size();
+    clearPending();
+    if (changed) {
+        emit deltaReady(message);
+    }
+}
+
+/**
+ * @brief Merkt neue Charaktere mit allen Feldern vor
+ *
+ * @param first Der erste neue Index
+ * @param last Der letzte neue Index
+ */
+void StateBroadcaster::onRowsInserted(int first, int last)
+{
+    markRows(first, last, CharacterStore::AllFields);
+}
+
+/**
+ * @brief Merkt den entfernten Bereich vor und verschiebt die vorgemerkten Indizes
+ *
+ * Neue Charaktere werden immer angehängt, daher kennen die Clients genau die
+ * ersten m_clientRows Charaktere. Nur dieser Teil des Bereichs wird gesendet;
+ * noch nicht gesendete Charaktere verschwinden einfach aus den Vormerkungen.
+ *
+ * @param first Der erste entfernte Index
+ * @param last Der letzte entfernte Index
+ */
+void StateBroadcaster::onRowsRemoved(int first, int last)
+{
+    if (!m_active || m_reset || first > last) {
+        return;
+    }
+    const int count = last - first + 1;
+
+    // Vorgemerkte Felder wandern mit ihren Charakteren
+    if (first < m_dirty.size()) {
+        m_dirty.remove(first, qMin(count, m_dirty.size() - first));
+    }
+    QVector<int> rows;
+    rows.reserve(m_dirtyRows.size());
+    for (int index : std::as_const(m_dirtyRows)) {
+        if (index < first) {
+            rows.append(index);
+        } else if (index > last) {
+            rows.append(index - count);
+        }
+    }
+    m_dirtyRows = rows;
+
+    // Die Reihenfolge so nachführen, wie es der Client beim Entfernen tut
+    const int clientLast = qMin(last, m_clientRows - 1);
+    if (first <= clientLast) {
+        const int clientCount = clientLast - first + 1;
+        m_removed << first << clientLast;
+        m_clientRows -= clientCount;
+        m_clientOrder.erase(std::remove_if(m_clientOrder.begin(), m_clientOrder.end(),
+                                           [first, clientLast](int index) {
+                                               return index >= first && index <= clientLast;
+                                           }),
+                            m_clientOrder.end());
+        for (int &index : m_clientOrder) {
+            if (index > clientLast) {
+                index -= clientCount;
+            }
+        }
+    }
+    scheduleFlush();
+}
+
+/**
+ * @brief Merkt die geänderten Felder vor
+ *
+ * @param first Der erste betroffene Index
+ * @param last Der letzte betroffene Index
+ * @param fields Bitmaske der geänderten Spalten
+ */
+void StateBroadcaster::onRowsUpdated(int first, int last, quint32 fields)
+{
+    markRows(first, last, fields);
+}
+
+/**
+ * @brief Merkt den ganzen Zustand vor
+ */
+void StateBroadcaster::onRowsReset()
+{
+    if (!m_active) {
+        return;
+    }
+    clearPending();
+    m_reset = true;
+    scheduleFlush();
+}
+
+/**
+ * @brief Merkt Felder für einen Bereich von Charakteren vor
+ *
+ * Interne Spalten werden herausgefiltert, damit z.B. ein neuer
+ * Würfelschlüssel allein keine Nachricht auslöst.
+ *
+ * @param first Der erste Index
+ * @param last Der letzte Index
+ * @param fields Die geänderten Felder
+ */
+void StateBroadcaster::markRows(int first, int last, CharacterStore::FieldMask fields)
+{
+    fields &= clientFieldMask();
+    if (!m_active || m_reset || fields == 0 || first > last) {
+        return;
+    }
+
+    if (m_dirty.size() <= last) {
+        m_dirty.resize(last + 1);
+    }
+    for (int index = first; index <= last; ++index) {
+        if (m_dirty.at(index) == 0) {
+            m_dirtyRows.append(index);
+        }
+        m_dirty[index] |= fields;
+    }
+    m_dirtyFields |= fields;
+    scheduleFlush();
+}
+
+/**
+ * @brief Plant flush() für das Ende des aktuellen Durchlaufs ein
+ */
+void StateBroadcaster::scheduleFlush()
+{
+    if (m_flushScheduled) {
+        return;
+    }
+    m_flushScheduled = true;
+    QMetaObject::invokeMethod(this, &StateBroadcaster::flush, Qt::QueuedConnection);
+}
+
+/**
+ * @brief Verwirft alle gesammelten Änderungen
+ */
+void StateBroadcaster::clearPending()
+{
+    m_dirty.clear();
+    m_dirtyRows.clear();
+    m_dirtyFields = 0;
+    m_removed.clear();
+    m_reset = false;
+}
+
+/**
+ * @brief Übernimmt den aktuellen Zustand als den, den die Clients kennen
+ *
+ * Neue Abonnenten erhalten fullState(); ab dann beziehen sich "removed" und
+ * "orderChanges" auf diesen Zustand.
+ */
+void StateBroadcaster::resetClientState()
+{
+    m_clientOrder = m_tracker->initiativeOrder().indices();
+    m_clientRows = m_tracker->store().size();
+}
@@ -0,0 +1,178 @@
+#ifndef STATEBROADCASTER_H
+#define STATEBROADCASTER_H
+
+#include <QJsonObject>
+#include <QObject>
+#include <QVector>
+#include "characterstore.h"
+
+class InitiativeTracker;
+
+/**
+ * @brief Der StateBroadcaster sammelt die Änderungen des Trackers für abonnierte WebSocket-Clients.
+ *
+ * Overlays und Spieler-Bildschirme sollen sehen, wenn gewürfelt wird, ohne
+ * ständig nachzufragen. Der StateBroadcaster hört dazu auf die genauen
+ * Signale des Trackers (rowsInserted(), rowsUpdated(), ...) und merkt sich
+ * pro Charakter, welche Felder sich geändert haben. Am Ende des aktuellen
+ * Durchlaufs der Ereignisschleife sendet er alle gesammelten Änderungen als
+ * eine Nachricht mit deltaReady():
+ *
+ * @code
+ * {"type": "delta", "count": 12,
+ *  "removed": [4, 5],
+ *  "characters": [{"index": 3, "initiativeRoll": 17}, ...],
+ *  "orderChanges": [0, 3, 1, 0]}
+ * @endcode
+ *
+ * Es stehen nur die geänderten Charaktere und Felder in der Nachricht.
+ * "removed" enthält Paare aus erstem und letztem entfernten Index in der
+ * Reihenfolge des Entfernens; der Client entfernt sie zuerst und verschiebt
+ * dabei die folgenden Indizes (auch in seiner Reihenfolge). "orderChanges"
+ * enthält Paare aus Rang und Index für jeden Rang der Initiative-Reihenfolge,
+ * der sich gegenüber dem Client geändert hat; die Reihenfolge hat danach
+ * "count" Einträge. Nur wenn die Liste neu geladen wird, wird stattdessen der
+ * ganze Zustand gesendet (fullState(), "type": "state").
+ *
+ * Solange kein Client abonniert hat, ist der StateBroadcaster inaktiv und
+ * sammelt nichts (setActive()).
+ *
+ * Qt-Konzept: Zusammenfassen mit einem Queued-Aufruf
+ * Die erste Änderung plant flush() mit QMetaObject::invokeMethod() und
+ * Qt::QueuedConnection ein. Der Aufruf läuft erst, wenn die Ereignisschleife
+ * wieder an der Reihe ist; alle Änderungen bis dahin landen in derselben
+ * Nachricht, egal wie viele Signale der Tracker sendet.
+ */
+class StateBroadcaster : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Erstellt einen StateBroadcaster für einen Tracker.
+     *
+     * @param tracker Der beobachtete Tracker
+     * @param parent Das Elternobjekt
+     */
+    explicit StateBroadcaster(InitiativeTracker *tracker, QObject *parent = nullptr);
+
+    /**
+     * @brief Gibt zurück, ob Änderungen gesammelt werden.
+     */
+    bool isActive() const;
+
+    /**
+     * @brief Schaltet das Sammeln ein oder aus.
+     *
+     * Beim Einschalten beginnt das Sammeln ohne offene Änderungen; neue
+     * Abonnenten erhalten zuerst fullState().
+     *
+     * @param active true, wenn mindestens ein Client abonniert hat
+     */
+    void setActive(bool active);
+
+    /**
+     * @brief Gibt zurück, ob gesammelte Änderungen auf flush() warten.
+     */
+    bool hasPendingChanges() const;
+
+    /**
+     * @brief Baut den ganzen Zustand des Trackers.
+     *
+     * @return Eine Nachricht mit "type": "state" und allen Charakteren
+     */
+    QJsonObject fullState() const;
+
+    /**
+     * @brief Baut ein Charakter-Objekt mit ausgewählten Feldern.
+     *
+     * Interne Spalten (Würfelschlüssel, Würfelereignisse) werden nie übertragen.
+     *
+     * @param store Die Charaktere
+     * @param index Der Index des Charakters
+     * @param fields Die zu übertragenden Felder
+     * @return Das Objekt mit "index" und den gewählten Feldern
+     */
+    static QJsonObject characterObject(const CharacterStore &store, int index, CharacterStore::FieldMask fields);
+
+public slots:
+    /**
+     * @brief Sendet die gesammelten Änderungen mit deltaReady().
+     *
+     * Wird automatisch einmal pro Durchlauf der Ereignisschleife aufgerufen.
+     */
+    void flush();
+
+signals:
+    /**
+     * @brief Signal mit den gesammelten Änderungen oder dem ganzen Zustand.
+     *
+     * @param message Die an alle Abonnenten zu sendende Nachricht
+     */
+    void deltaReady(const QJsonObject &message);
+
+private slots:
+    /**
+     * @brief Merkt neue Charaktere mit allen Feldern vor.
+     *
+     * @param first Der erste neue Index
+     * @param last Der letzte neue Index
+     */
+    void onRowsInserted(int first, int last);
+
+    /**
+     * @brief Merkt den entfernten Bereich vor und verschiebt die vorgemerkten Indizes.
+     *
+     * @param first Der erste entfernte Index
+     * @param last Der letzte entfernte Index
+     */
+    void onRowsRemoved(int first, int last);
+
+    /**
+     * @brief Merkt die geänderten Felder vor.
+     *
+     * @param first Der erste betroffene Index
+     * @param last Der letzte betroffene Index
+     * @param fields Bitmaske der geänderten Spalten
+     */
+    void onRowsUpdated(int first, int last, quint32 fields);
+
+    /**
+     * @brief Merkt den ganzen Zustand vor.
+     */
+    void onRowsReset();
+
+private:
+    /**
+     * @brief Merkt Felder für einen Bereich von Charakteren vor.
+     */
+    void markRows(int first, int last, CharacterStore::FieldMask fields);
+
+    /**
+     * @brief Plant flush() für das Ende des aktuellen Durchlaufs ein.
+     */
+    void scheduleFlush();
+
+    /**
+     * @brief Verwirft alle gesammelten Änderungen.
+     */
+    void clearPending();
+
+    /**
+     * @brief Übernimmt den aktuellen Zustand als den, den die Clients kennen.
+     */
+    void resetClientState();
+
+    InitiativeTracker *m_tracker;                 ///< Der beobachtete Tracker
+    QVector<CharacterStore::FieldMask> m_dirty;   ///< Geänderte Felder pro Charakter
+    QVector<int> m_dirtyRows;                     ///< Charaktere mit Einträgen in m_dirty
+    CharacterStore::FieldMask m_dirtyFields;      ///< Alle geänderten Felder zusammen
+    QVector<int> m_removed;                       ///< Entfernte Bereiche als Paare (erster, letzter Index)
+    QVector<int> m_clientOrder;                   ///< Die Reihenfolge, wie sie die Clients kennen
+    int m_clientRows;                             ///< Anzahl der Charaktere, die die Clients kennen
+    bool m_reset;                                 ///< Der ganze Zustand muss gesendet werden
+    bool m_active;                                ///< Werden Änderungen gesammelt?
+    bool m_flushScheduled;                        ///< Ist flush() bereits eingeplant?
+};
+
+#endif // STATEBROADCASTER_H
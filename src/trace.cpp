@@ -0,0 +1,146 @@
+#include "trace.h"
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QFile>
+#include <atomic>
+
+Q_LOGGING_CATEGORY(lcTracker, "dnd.tracker", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcStorage, "dnd.storage", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcUi, "dnd.ui", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcNet, "dnd.net", QtInfoMsg)
+
+namespace {
+
+QVector<Trace::Record> s_buffer;        // Der Ringpuffer
+quint64 s_mask = 0;                     // capacity - 1
+std::atomic<bool> s_recording(false);   // Läuft die Aufzeichnung?
+std::atomic<quint64> s_next(0);         // Nächste Schreibposition (wächst unbegrenzt)
+std::atomic<quint32> s_nextThread(0);   // Vergibt die Thread-Kennungen
+QElapsedTimer s_clock;                  // Zeitbasis seit start()
+
+/**
+ * @brief Gibt die Kennung des aktuellen Threads zurück
+ *
+ * @return Eine kleine, pro Thread feste Zahl ab 1
+ */
+quint32 threadTag()
+{
+    thread_local const quint32 tag = s_nextThread.fetch_add(1, std::memory_order_relaxed) + 1;
+    return tag;
+}
+
+} // namespace
+
+/**
+ * @brief Startet die Aufzeichnung mit einem neuen Ringpuffer
+ *
+ * @param capacity Die gewünschte Anzahl der Datensätze
+ */
+void Trace::start(int capacity)
+{
+    s_recording.store(false, std::memory_order_release);
+
+    // Auf eine Zweierpotenz aufrunden, damit die Position mit einer Maske statt
+    // mit einer Division berechnet werden kann
+    quint64 size = 1;
+    while (size < quint64(qMax(capacity, 1))) {
+        size <<= 1;
+    }
+    s_buffer = QVector<Record>(int(size));
+    s_mask = size - 1;
+    s_next.store(0, std::memory_order_relaxed);
+    s_clock.start();
+
+    s_recording.store(true, std::memory_order_release);
+}
+
+/**
+ * @brief Gibt an, ob gerade aufgezeichnet wird
+ *
+ * @return true während der Aufzeichnung
+ */
+bool Trace::isRecording()
+{
+    return s_recording.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Schreibt einen Datensatz in den Ringpuffer
+ *
+ * @param event Das Ereignis
+ * @param a Erster Wert
+ * @param b Zweiter Wert
+ */
+void Trace::record(Event event, qint32 a, qint32 b)
+{
+    if (!s_recording.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    // Jeder Aufruf bekommt seinen eigenen Platz, auch aus mehreren Threads
+    const quint64 position = s_next.fetch_add(1, std::memory_order_relaxed);
+    Record &slot = s_buffer.data()[position & s_mask];
+    slot.timestampNs = quint64(s_clock.nsecsElapsed());
+    slot.event = event;
+    slot.reserved = 0;
+    slot.thread = threadTag();
+    slot.a = a;
+    slot.b = b;
+}
+
+/**
+ * @brief Gibt die aufgezeichneten Datensätze in zeitlicher Reihenfolge zurück
+ *
+ * @return Die Datensätze
+ */
+QVector<Trace::Record> Trace::records()
+{
+    QVector<Record> result;
+    if (s_buffer.isEmpty()) {
+        return result;
+    }
+
+    // Bei einem übergelaufenen Puffer beginnen die ältesten Einträge hinter der Schreibposition
+    const quint64 written = s_next.load(std::memory_order_acquire);
+    const quint64 capacity = s_mask + 1;
+    const quint64 count = qMin(written, capacity);
+    const quint64 first = written - count;
+
+    result.reserve(int(count));
+    for (quint64 i = first; i < written; ++i) {
+        result.append(s_buffer.at(int(i & s_mask)));
+    }
+    return result;
+}
+
+/**
+ * @brief Beendet die Aufzeichnung und schreibt die Datensätze in eine Datei
+ *
+ * @param filename Der Dateiname oder leer
+ * @return true, wenn kein Fehler aufgetreten ist
+ */
+bool Trace::stop(const QString &filename)
+{
+    s_recording.store(false, std::memory_order_release);
+    if (filename.isEmpty()) {
+        return true;
+    }
+
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly)) {
+        TRACE_WARNING(lcStorage) << "Trace-Datei konnte nicht geschrieben werden:" << filename;
+        return false;
+    }
+
+    const QVector<Record> data = records();
+    QDataStream stream(&file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.writeRawData("DNDTRACE", 8);
+    stream << quint32(1) << quint32(sizeof(Record)) << quint64(data.size());
+    for (const Record &record : data) {
+        stream << record.timestampNs << record.event << record.reserved << record.thread
+               << record.a << record.b;
+    }
+
+    return stream.status() == QDataStream::Ok;
+}
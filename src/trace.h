@@ -0,0 +1,172 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <QLoggingCategory>
+#include <QString>
+#include <QVector>
+
+/**
+ * @file trace.h
+ * @brief Kategorisierte Log-Ausgaben mit Stufen, die beim Kompilieren entfernt werden können.
+ *
+ * Statt qDebug() verwendet der Code TRACE_DEBUG(), TRACE_INFO() und
+ * TRACE_WARNING() mit einer Kategorie. Welche Stufen überhaupt im Programm
+ * landen, legt DND_TRACE_LEVEL beim Kompilieren fest (siehe CMakeLists.txt).
+ * Ist eine Stufe abgeschaltet, wird der Ausdruck nie ausgewertet; auch die
+ * Argumente werden nicht formatiert. Zur Laufzeit lassen sich die übrigen
+ * Kategorien wie gewohnt über QT_LOGGING_RULES steuern, z.B.
+ * QT_LOGGING_RULES="dnd.net.debug=true".
+ *
+ * Für Messungen gibt es zusätzlich einen binären Modus (Trace-Klasse), der
+ * nur feste Zahlen in einen Ringpuffer schreibt und erst beim Beenden eine
+ * Datei erzeugt.
+ *
+ * Qt-Konzept: QLoggingCategory
+ * Eine Kategorie gibt Log-Ausgaben einen Namen (z.B. "dnd.tracker"). qCDebug()
+ * prüft zuerst, ob die Kategorie für Debug-Ausgaben aktiv ist, und baut die
+ * Nachricht nur dann zusammen.
+ *
+ * C++ Konzept: Präprozessor
+ * Die Makros werden vor dem Kompilieren ersetzt. "while (false)" vor einem
+ * Ausdruck sorgt dafür, dass der Ausdruck zwar gültig sein muss, aber nie
+ * ausgeführt wird; der Compiler entfernt ihn vollständig.
+ */
+
+#define DND_TRACE_LEVEL_OFF 0      ///< Keine Ausgaben
+#define DND_TRACE_LEVEL_WARNING 1  ///< Nur Warnungen
+#define DND_TRACE_LEVEL_INFO 2     ///< Warnungen und Informationen
+#define DND_TRACE_LEVEL_DEBUG 3    ///< Alle Ausgaben
+
+#ifndef DND_TRACE_LEVEL
+#define DND_TRACE_LEVEL DND_TRACE_LEVEL_INFO
+#endif
+
+#ifndef DND_BINARY_TRACE
+#define DND_BINARY_TRACE 0
+#endif
+
+Q_DECLARE_LOGGING_CATEGORY(lcTracker)  ///< "dnd.tracker": Charakterliste und Würfe
+Q_DECLARE_LOGGING_CATEGORY(lcStorage)  ///< "dnd.storage": Speichern und Laden
+Q_DECLARE_LOGGING_CATEGORY(lcUi)       ///< "dnd.ui": Hauptfenster
+Q_DECLARE_LOGGING_CATEGORY(lcNet)      ///< "dnd.net": WebSocket-Server
+
+/// Verwirft einen Log-Ausdruck, ohne ihn auszuwerten
+#define DND_TRACE_DISCARD while (false) QMessageLogger().noDebug()
+
+#if DND_TRACE_LEVEL >= DND_TRACE_LEVEL_DEBUG
+#define TRACE_DEBUG(category) qCDebug(category)
+#else
+#define TRACE_DEBUG(category) DND_TRACE_DISCARD
+#endif
+
+#if DND_TRACE_LEVEL >= DND_TRACE_LEVEL_INFO
+#define TRACE_INFO(category) qCInfo(category)
+#else
+#define TRACE_INFO(category) DND_TRACE_DISCARD
+#endif
+
+#if DND_TRACE_LEVEL >= DND_TRACE_LEVEL_WARNING
+#define TRACE_WARNING(category) qCWarning(category)
+#else
+#define TRACE_WARNING(category) DND_TRACE_DISCARD
+#endif
+
+/**
+ * @brief Die Trace-Klasse zeichnet Ereignisse als feste Binärdatensätze auf.
+ *
+ * Ein Datensatz besteht nur aus Zeitstempel, Ereignisnummer und zwei Zahlen.
+ * record() formatiert nichts und reserviert keinen Speicher, sondern schreibt
+ * in einen vorher angelegten Ringpuffer. Ist der Puffer voll, werden die
+ * ältesten Einträge überschrieben. stop() schreibt den Puffer in eine Datei.
+ *
+ * Aufgerufen wird record() über das Makro TRACE_EVENT(), das nur mit
+ * DND_BINARY_TRACE=1 etwas tut und sonst komplett entfällt.
+ *
+ * start() und stop() dürfen nur aufgerufen werden, während kein anderer
+ * Thread record() aufruft. record() selbst ist threadsicher.
+ */
+class Trace
+{
+public:
+    /**
+     * @brief Die aufgezeichneten Ereignisse.
+     *
+     * Die Nummern stehen in der Datei und dürfen sich nicht ändern.
+     */
+    enum Event : quint16 {
+        CharacterAdded = 1,     ///< a = Index
+        CharacterRemoved = 2,   ///< a = erster Index, b = Anzahl
+        ColumnRolled = 3,       ///< a = Spalte (CharacterStore::Field), b = Anzahl der Würfe
+        SingleRolled = 4,       ///< a = Spalte (CharacterStore::Field), b = Index
+        FileSaved = 5,          ///< a = Anzahl der Charaktere
+        FileLoaded = 6,         ///< a = Anzahl der Charaktere
+        MessageReceived = 7,    ///< a = Länge der Nachricht (Zeichen bzw. Byte), b = 1 bei CBOR
+        ClientConnected = 8,    ///< a = Anzahl der Clients
+        ClientDisconnected = 9, ///< a = Anzahl der Clients
+        JournalCompacted = 10,  ///< a = Anzahl der Charaktere, b = neue Generation
+        RosterImported = 11,    ///< a = Anzahl der Charaktere, b = Anzahl der Blöcke
+        MessageDropped = 12     ///< a = Client-Id, b = 0 eingehend (Rate-Limit), 1 ausgehend (langsamer Client)
+    };
+
+    /**
+     * @brief Ein aufgezeichnetes Ereignis (24 Byte).
+     */
+    struct Record {
+        quint64 timestampNs;  ///< Nanosekunden seit start()
+        quint16 event;        ///< Die Ereignisnummer
+        quint16 reserved;     ///< Immer 0
+        quint32 thread;       ///< Kennung des aufzeichnenden Threads
+        qint32 a;             ///< Erster Wert (je nach Ereignis)
+        qint32 b;             ///< Zweiter Wert (je nach Ereignis)
+    };
+
+    /**
+     * @brief Startet die Aufzeichnung mit einem neuen Ringpuffer.
+     *
+     * @param capacity Die Anzahl der Datensätze im Puffer (wird auf eine Zweierpotenz aufgerundet)
+     */
+    static void start(int capacity = 65536);
+
+    /**
+     * @brief Gibt an, ob gerade aufgezeichnet wird.
+     *
+     * @return true während der Aufzeichnung
+     */
+    static bool isRecording();
+
+    /**
+     * @brief Zeichnet ein Ereignis auf, falls die Aufzeichnung läuft.
+     *
+     * @param event Das Ereignis
+     * @param a Erster Wert
+     * @param b Zweiter Wert
+     */
+    static void record(Event event, qint32 a = 0, qint32 b = 0);
+
+    /**
+     * @brief Gibt die aufgezeichneten Datensätze in zeitlicher Reihenfolge zurück.
+     *
+     * @return Die Datensätze (höchstens capacity viele)
+     */
+    static QVector<Record> records();
+
+    /**
+     * @brief Beendet die Aufzeichnung und schreibt die Datensätze in eine Datei.
+     *
+     * Dateiformat (Little Endian): "DNDTRACE", quint32 Version (1),
+     * quint32 Datensatzgröße (24), quint64 Anzahl, danach die Datensätze.
+     *
+     * @param filename Der Dateiname oder leer, um nur anzuhalten
+     * @return true, wenn die Datei geschrieben wurde oder keine verlangt war
+     */
+    static bool stop(const QString &filename = QString());
+};
+
+#if DND_BINARY_TRACE
+#define TRACE_EVENT(event, a, b) \
+    do { if (Trace::isRecording()) Trace::record(Trace::event, (a), (b)); } while (false)
+#else
+#define TRACE_EVENT(event, a, b) do { } while (false)
+#endif
+
+#endif // TRACE_H
@@ -0,0 +1,528 @@
+#include "trackerserver.h"
+#include "trace.h"
+#include <QMetaMethod>
+#include <QTimer>
+#include <QWebSocket>
+#include <QWebSocketServer>
+#include <utility>
+
+/**
+ * @brief Erstellt einen Server, der noch nicht lauscht
+ *
+ * @param parent Das Elternobjekt
+ */
+TrackerServer::TrackerServer(QObject *parent)
+    : QObject(parent)
+    , m_server(new QWebSocketServer(QStringLiteral("D&D Initiative Tracker Server"),
+                                    QWebSocketServer::NonSecureMode, this))
+    , m_drainTimer(new QTimer(this))
+    , m_nextClientId(1)
+    , m_droppedMessages(0)
+    , m_droppedUpdates(0)
+    , m_subscriberCount(0)
+{
+    connect(m_server, &QWebSocketServer::newConnection, this, &TrackerServer::onNewConnection);
+
+    // Der Timer ist ein Kindobjekt und wandert mit moveToThread() mit
+    m_drainTimer->setSingleShot(true);
+    connect(m_drainTimer, &QTimer::timeout, this, &TrackerServer::drainQueues);
+    m_clock.start();
+}
+
+/**
+ * @brief Trennt alle Clients und schließt den Server
+ */
+TrackerServer::~TrackerServer()
+{
+    close();
+}
+
+/**
+ * @brief Beginnt, auf Verbindungen zu warten
+ *
+ * @param address Die Adresse
+ * @param port Der Port (0 = frei wählen)
+ * @return true, wenn der Server lauscht
+ */
+bool TrackerServer::listen(const QHostAddress &address, quint16 port)
+{
+    if (!m_server->listen(address, port)) {
+        TRACE_WARNING(lcNet) << "Fehler beim Starten des WebSocket-Servers:" << m_server->errorString();
+        return false;
+    }
+    TRACE_INFO(lcNet) << "WebSocket-Server gestartet auf Port" << m_server->serverPort();
+    return true;
+}
+
+/**
+ * @brief Trennt alle Clients und beendet das Warten auf Verbindungen
+ */
+void TrackerServer::close()
+{
+    m_server->close();
+    for (const Client &client : std::as_const(m_clients)) {
+        // Beim Löschen soll onDisconnected() nicht mehr aufgerufen werden
+        client.socket->disconnect(this);
+        delete client.socket;
+    }
+    m_clients.clear();
+    m_ids.clear();
+    m_backlog.clear();
+    m_drainTimer->stop();
+    if (m_subscriberCount != 0) {
+        m_subscriberCount = 0;
+        emit subscriberCountChanged(0);
+    }
+}
+
+/**
+ * @brief Gibt den Port zurück, auf dem der Server lauscht
+ *
+ * @return Der Port oder 0
+ */
+quint16 TrackerServer::serverPort() const
+{
+    return m_server->serverPort();
+}
+
+/**
+ * @brief Gibt die Beschreibung des letzten Fehlers zurück
+ */
+QString TrackerServer::errorString() const
+{
+    return m_server->errorString();
+}
+
+/**
+ * @brief Gibt die Anzahl der verbundenen Clients zurück
+ */
+int TrackerServer::clientCount() const
+{
+    return m_clients.size();
+}
+
+/**
+ * @brief Gibt die Anzahl der Clients mit Abonnement zurück
+ */
+int TrackerServer::subscriberCount() const
+{
+    return m_subscriberCount;
+}
+
+/**
+ * @brief Setzt die Grenzen für alle Verbindungen
+ *
+ * @param limits Die neuen Grenzen
+ */
+void TrackerServer::setLimits(const Limits &limits)
+{
+    m_limits = limits;
+}
+
+/**
+ * @brief Gibt die Grenzen für alle Verbindungen zurück
+ */
+TrackerServer::Limits TrackerServer::limits() const
+{
+    return m_limits;
+}
+
+/**
+ * @brief Gibt die Anzahl der wegen des Rate-Limits verworfenen Nachrichten zurück
+ */
+quint64 TrackerServer::droppedMessageCount() const
+{
+    return m_droppedMessages;
+}
+
+/**
+ * @brief Gibt die Anzahl der an langsame Clients nicht gesendeten Änderungsnachrichten zurück
+ */
+quint64 TrackerServer::droppedUpdateCount() const
+{
+    return m_droppedUpdates;
+}
+
+/**
+ * @brief Sendet eine fertig kodierte Nachricht an einen Client
+ *
+ * @param clientId Der Client
+ * @param data Die Nachricht
+ * @param encoding Die Kodierung von data
+ */
+void TrackerServer::send(quint64 clientId, const QByteArray &data, MessageCodec::Encoding encoding)
+{
+    const auto it = m_clients.constFind(clientId);
+    if (it == m_clients.constEnd()) {
+        // Der Client wurde inzwischen getrennt
+        return;
+    }
+    sendFrame(it->socket, data, encoding);
+}
+
+/**
+ * @brief Kodiert eine Nachricht und sendet sie an einen Client
+ *
+ * @param clientId Der Client
+ * @param message Die Nachricht
+ * @param encoding Die gewünschte Kodierung
+ */
+void TrackerServer::sendMessage(quint64 clientId, const QJsonObject &message, MessageCodec::Encoding encoding)
+{
+    const auto it = m_clients.constFind(clientId);
+    if (it == m_clients.constEnd()) {
+        return;
+    }
+    sendFrame(it->socket, MessageCodec::encode(message, encoding), encoding);
+}
+
+/**
+ * @brief Sendet eine Nachricht an alle Clients mit Abonnement
+ *
+ * Clients, deren Sendepuffer voll ist, werden übersprungen und erhalten
+ * später den ganzen Zustand (siehe onBytesWritten()).
+ *
+ * @param message Die Nachricht
+ */
+void TrackerServer::broadcast(const QJsonObject &message)
+{
+    QByteArray encoded[2];
+    for (auto it = m_clients.begin(); it != m_clients.end(); ++it) {
+        Client &client = it.value();
+        if (!client.subscribed) {
+            continue;
+        }
+        if (client.stale || client.socket->bytesToWrite() > m_limits.maxBytesToWrite) {
+            if (!client.stale) {
+                client.stale = true;
+                TRACE_WARNING(lcNet) << "Client" << it.key() << "liest zu langsam, Änderungen werden zurückgehalten";
+            }
+            ++m_droppedUpdates;
+            TRACE_EVENT(MessageDropped, qint32(it.key()), 1);
+            continue;
+        }
+        QByteArray &data = encoded[client.encoding];
+        if (data.isEmpty()) {
+            data = MessageCodec::encode(message, client.encoding);
+        }
+        sendFrame(client.socket, data, client.encoding);
+    }
+}
+
+/**
+ * @brief Nimmt eine neue Verbindung an
+ */
+void TrackerServer::onNewConnection()
+{
+    while (QWebSocket *socket = m_server->nextPendingConnection()) {
+        connect(socket, &QWebSocket::textMessageReceived, this, &TrackerServer::onTextMessageReceived);
+        connect(socket, &QWebSocket::binaryMessageReceived, this, &TrackerServer::onBinaryMessageReceived);
+        connect(socket, &QWebSocket::bytesWritten, this, &TrackerServer::onBytesWritten);
+        connect(socket, &QWebSocket::disconnected, this, &TrackerServer::onDisconnected);
+        socket->setMaxAllowedIncomingMessageSize(quint64(m_limits.maxMessageSize));
+
+        const quint64 clientId = m_nextClientId++;
+        Client client;
+        client.socket = socket;
+        client.tokens = m_limits.burst;
+        client.lastRefill = m_clock.elapsed();
+        m_clients.insert(clientId, client);
+        m_ids.insert(socket, clientId);
+
+        TRACE_EVENT(ClientConnected, m_clients.size(), 0);
+        TRACE_DEBUG(lcNet) << "Neue Verbindung, Clients:" << m_clients.size();
+        emit clientConnected(socket->peerAddress().toString());
+    }
+}
+
+/**
+ * @brief Verarbeitet eine Textnachricht (JSON)
+ *
+ * @param message Die Nachricht
+ */
+void TrackerServer::onTextMessageReceived(const QString &message)
+{
+    // Nur die Länge protokollieren, nicht den ganzen Inhalt
+    TRACE_EVENT(MessageReceived, message.size(), 0);
+    TRACE_DEBUG(lcNet) << "Textnachricht:" << message.size() << "Zeichen";
+    receiveFrame(qobject_cast<QWebSocket *>(sender()), message.toUtf8(), MessageCodec::Json);
+}
+
+/**
+ * @brief Verarbeitet eine Binärnachricht (CBOR)
+ *
+ * @param message Die Nachricht
+ */
+void TrackerServer::onBinaryMessageReceived(const QByteArray &message)
+{
+    TRACE_EVENT(MessageReceived, message.size(), 1);
+    TRACE_DEBUG(lcNet) << "Binärnachricht:" << message.size() << "Byte";
+    receiveFrame(qobject_cast<QWebSocket *>(sender()), message, MessageCodec::Cbor);
+}
+
+/**
+ * @brief Prüft, ob ein langsamer Client seinen Sendepuffer geleert hat
+ *
+ * Erst wenn der Puffer wieder halb leer ist, wird der ganze Zustand
+ * angefordert; so pendelt ein knapp zu langsamer Client nicht ständig
+ * zwischen Änderungen und vollem Zustand.
+ */
+void TrackerServer::onBytesWritten()
+{
+    QWebSocket *socket = qobject_cast<QWebSocket *>(sender());
+    const quint64 clientId = m_ids.value(socket);
+    const auto it = m_clients.find(clientId);
+    if (it == m_clients.end() || !it->stale || socket->bytesToWrite() > m_limits.maxBytesToWrite / 2) {
+        return;
+    }
+
+    it->stale = false;
+    if (it->subscribed) {
+        TRACE_DEBUG(lcNet) << "Client" << clientId << "holt auf, sende ganzen Zustand";
+        emit resyncRequired(clientId, it->encoding);
+    }
+}
+
+/**
+ * @brief Holt wartende Nachrichten nach, soweit die Token-Buckets es erlauben
+ *
+ * Die Clients kommen der Reihe nach dran; jeder verbraucht nur seine
+ * eigenen Marken.
+ */
+void TrackerServer::drainQueues()
+{
+    const QList<quint64> backlog = std::exchange(m_backlog, QList<quint64>());
+    for (const quint64 clientId : backlog) {
+        auto it = m_clients.find(clientId);
+        if (it == m_clients.end()) {
+            continue;
+        }
+        refill(&it.value());
+        while (!it->queue.isEmpty() && it->tokens >= 1.0) {
+            it->tokens -= 1.0;
+            const Frame frame = it->queue.dequeue();
+            processFrame(clientId, frame.data, frame.encoding);
+
+            // Die Verarbeitung kann Clients trennen
+            it = m_clients.find(clientId);
+            if (it == m_clients.end()) {
+                break;
+            }
+        }
+        if (it == m_clients.end()) {
+            continue;
+        }
+        if (it->queue.isEmpty()) {
+            it->dropping = false;
+        } else {
+            m_backlog.append(clientId);
+        }
+    }
+
+    if (!m_backlog.isEmpty()) {
+        m_drainTimer->start(qMax(1, 1000 / qMax(1, m_limits.messagesPerSecond)));
+    }
+}
+
+/**
+ * @brief Entfernt einen getrennten Client
+ */
+void TrackerServer::onDisconnected()
+{
+    QWebSocket *socket = qobject_cast<QWebSocket *>(sender());
+    const quint64 clientId = m_ids.take(socket);
+    if (clientId == 0) {
+        return;
+    }
+
+    Client client = m_clients.take(clientId);
+    if (client.subscribed) {
+        --m_subscriberCount;
+        emit subscriberCountChanged(m_subscriberCount);
+    }
+
+    TRACE_EVENT(ClientDisconnected, m_clients.size(), 0);
+    emit clientDisconnected(socket->peerAddress().toString());
+    socket->deleteLater();
+}
+
+/**
+ * @brief Nimmt eine Nachricht an: sofort verarbeiten, einreihen oder verwerfen
+ *
+ * @param socket Die Verbindung
+ * @param data Die Nachricht
+ * @param encoding Die Kodierung der Nachricht
+ */
+void TrackerServer::receiveFrame(QWebSocket *socket, const QByteArray &data, MessageCodec::Encoding encoding)
+{
+    const quint64 clientId = m_ids.value(socket);
+    const auto it = m_clients.find(clientId);
+    if (it == m_clients.end()) {
+        return;
+    }
+
+    Client &client = it.value();
+    if (m_limits.messagesPerSecond <= 0) {
+        processFrame(clientId, data, encoding);
+        return;
+    }
+
+    // Ohne Rückstand sofort verarbeiten, solange Marken da sind
+    refill(&client);
+    if (client.queue.isEmpty() && client.tokens >= 1.0) {
+        client.tokens -= 1.0;
+        processFrame(clientId, data, encoding);
+        return;
+    }
+
+    if (client.queue.size() >= m_limits.maxQueuedMessages) {
+        ++m_droppedMessages;
+        TRACE_EVENT(MessageDropped, qint32(clientId), 0);
+        if (!client.dropping) {
+            client.dropping = true;
+            TRACE_WARNING(lcNet) << "Client" << clientId << "sendet zu schnell, Nachrichten werden verworfen";
+            sendStatus(&client, false, QStringLiteral("Zu viele Nachrichten, Nachricht verworfen"), encoding);
+        }
+        return;
+    }
+
+    if (client.queue.isEmpty()) {
+        m_backlog.append(clientId);
+    }
+    client.queue.enqueue(Frame{ data, encoding });
+    if (!m_drainTimer->isActive()) {
+        m_drainTimer->start(qMax(1, 1000 / m_limits.messagesPerSecond));
+    }
+}
+
+/**
+ * @brief Dekodiert eine Nachricht und verarbeitet sie
+ *
+ * @param clientId Der sendende Client
+ * @param data Die Nachricht
+ * @param encoding Die Kodierung der Nachricht
+ */
+void TrackerServer::processFrame(quint64 clientId, const QByteArray &data, MessageCodec::Encoding encoding)
+{
+    // Den Anzeigetext nur bauen, wenn ihn jemand anzeigt (der Server ohne
+    // Oberfläche hat keinen Empfänger)
+    const bool logging = isSignalConnected(QMetaMethod::fromSignal(&TrackerServer::messageLogged));
+
+    QJsonObject object;
+    if (encoding == MessageCodec::Json) {
+        // Texte, die kein JSON-Objekt sind, werden nur angezeigt
+        if (logging) {
+            emit messageLogged(QString::fromUtf8(data));
+        }
+        if (MessageCodec::decode(data, MessageCodec::Json, &object)) {
+            handleMessage(clientId, object, MessageCodec::Json);
+        }
+        return;
+    }
+
+    QString error;
+    if (!MessageCodec::decode(data, MessageCodec::Cbor, &object, &error)) {
+        TRACE_WARNING(lcNet) << "Ungültige Binärnachricht:" << error;
+        const auto it = m_clients.find(clientId);
+        if (it != m_clients.end()) {
+            sendStatus(&it.value(), false, error, MessageCodec::Cbor);
+        }
+        return;
+    }
+
+    // Lesbar anzeigen
+    if (logging) {
+        emit messageLogged(QString::fromUtf8(MessageCodec::encode(object, MessageCodec::Json)));
+    }
+    handleMessage(clientId, object, MessageCodec::Cbor);
+}
+
+/**
+ * @brief Füllt den Token-Bucket eines Clients nach der vergangenen Zeit auf
+ *
+ * @param client Der Client
+ */
+void TrackerServer::refill(Client *client) const
+{
+    const qint64 now = m_clock.elapsed();
+    const double added = double(now - client->lastRefill) * m_limits.messagesPerSecond / 1000.0;
+    client->tokens = qMin(double(m_limits.burst), client->tokens + added);
+    client->lastRefill = now;
+}
+
+/**
+ * @brief Verarbeitet eine dekodierte Nachricht
+ *
+ * @param clientId Der sendende Client
+ * @param message Die Nachricht
+ * @param encoding Die Kodierung der Nachricht
+ */
+void TrackerServer::handleMessage(quint64 clientId, const QJsonObject &message, MessageCodec::Encoding encoding)
+{
+    const QString command = message.value(QLatin1String("command")).toString();
+    if (command == QLatin1String("subscribe")) {
+        Client *client = &m_clients[clientId];
+        client->encoding = encoding;
+        client->stale = false;
+        setSubscribed(client, true);
+        sendStatus(client, true, QStringLiteral("Änderungen abonniert"), encoding);
+        emit subscribed(clientId, encoding);
+        return;
+    }
+    if (command == QLatin1String("unsubscribe")) {
+        Client *client = &m_clients[clientId];
+        setSubscribed(client, false);
+        sendStatus(client, true, QStringLiteral("Abonnement beendet"), encoding);
+        return;
+    }
+
+    emit messageReceived(clientId, message, encoding);
+}
+
+/**
+ * @brief Sendet eine Statusantwort im Format des CommandDispatcher
+ *
+ * @param client Der Client
+ * @param success Erfolg oder Fehler
+ * @param text Die Meldung
+ * @param encoding Die Kodierung
+ */
+void TrackerServer::sendStatus(Client *client, bool success, const QString &text, MessageCodec::Encoding encoding)
+{
+    QJsonObject response;
+    response[QLatin1String("status")] = success ? QStringLiteral("success") : QStringLiteral("error");
+    response[QLatin1String("message")] = text;
+    sendFrame(client->socket, MessageCodec::encode(response, encoding), encoding);
+}
+
+/**
+ * @brief Sendet Bytes als Text- oder Binärnachricht
+ *
+ * @param socket Die Verbindung
+ * @param data Die Nachricht
+ * @param encoding Die Kodierung von data
+ */
+void TrackerServer::sendFrame(QWebSocket *socket, const QByteArray &data, MessageCodec::Encoding encoding)
+{
+    if (encoding == MessageCodec::Cbor) {
+        socket->sendBinaryMessage(data);
+    } else {
+        socket->sendTextMessage(QString::fromUtf8(data));
+    }
+}
+
+/**
+ * @brief Setzt das Abonnement eines Clients und meldet die neue Anzahl
+ *
+ * @param client Der Client
+ * @param subscribed Das neue Abonnement
+ */
+void TrackerServer::setSubscribed(Client *client, bool subscribed)
+{
+    if (client->subscribed == subscribed) {
+        return;
+    }
+    client->subscribed = subscribed;
+    m_subscriberCount += subscribed ? 1 : -1;
+    emit subscriberCountChanged(m_subscriberCount);
+}
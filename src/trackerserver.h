@@ -0,0 +1,366 @@
+#ifndef TRACKERSERVER_H
+#define TRACKERSERVER_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QHostAddress>
+#include <QJsonObject>
+#include <QList>
+#include <QObject>
+#include <QQueue>
+#include <QString>
+#include "messagecodec.h"
+
+class QTimer;
+class QWebSocket;
+class QWebSocketServer;
+
+/**
+ * @brief Der TrackerServer nimmt die WebSocket-Verbindungen der Clients an.
+ *
+ * Der Server kümmert sich um alles, was mit den Verbindungen zu tun hat:
+ * Annehmen und Trennen, Dekodieren der Nachrichten (JSON oder CBOR, siehe
+ * MessageCodec) und Senden in der Kodierung des jeweiligen Clients. Was eine
+ * Nachricht bedeutet, entscheidet der Besitzer: Er erhält jede dekodierte
+ * Nachricht mit messageReceived() und beantwortet sie mit send().
+ *
+ * Jeder Client hat eine Id, die sich nie wiederholt. Anders als ein Zeiger
+ * auf den QWebSocket bleibt sie auch nach dem Trennen eindeutig; eine späte
+ * Antwort an einen getrennten Client wird einfach verworfen.
+ *
+ * Zwei Befehle beantwortet der Server selbst:
+ * - {"command": "subscribe"}: Der Client erhält ab jetzt alle Nachrichten,
+ *   die mit broadcast() gesendet werden, in der Kodierung dieser Nachricht.
+ *   Danach wird subscribed() gesendet, damit der Besitzer dem Client den
+ *   aktuellen Zustand schicken kann.
+ * - {"command": "unsubscribe"}: Beendet das Abonnement.
+ *
+ * Damit ein einzelner Client weder den Tracker noch die anderen Clients
+ * ausbremst, gelten für jede Verbindung Grenzen (siehe Limits):
+ * - Eingehend: Ein Token-Bucket erlaubt im Mittel messagesPerSecond
+ *   Nachrichten und kurzzeitig burst auf einmal. Was darüber hinausgeht,
+ *   wartet in einer Warteschlange des Clients und wird nachgeholt, sobald
+ *   wieder Marken da sind. Ist auch die Warteschlange voll, werden weitere
+ *   Nachrichten verworfen; der Client erhält einmal eine Fehlerantwort.
+ * - Ausgehend: Liegen bei einem Abonnenten mehr als maxBytesToWrite Bytes
+ *   ungesendet im Puffer, erhält er keine Änderungsnachrichten mehr. Sobald
+ *   der Puffer wieder geleert ist, wird resyncRequired() gesendet; der
+ *   Besitzer schickt dann den ganzen Zustand, der alle verworfenen
+ *   Änderungen zusammenfasst.
+ *
+ * Antworten auf Befehle werden immer gesendet; ihre Menge begrenzt bereits
+ * das Rate-Limit der eingehenden Nachrichten.
+ *
+ * Qt-Konzept: Signale über Objektgrenzen
+ * Der Server kennt weder den Tracker noch das Hauptfenster. Er meldet nur
+ * über Signale, was passiert ist; so kann derselbe Server im Hauptfenster
+ * und in einem Programm ohne Oberfläche verwendet werden.
+ *
+ * Der Server darf in einem eigenen Thread laufen (siehe TrackerService).
+ * Seine Methoden dürfen dann nur aus diesem Thread aufgerufen werden, von
+ * außen also über Signale oder QMetaObject::invokeMethod().
+ */
+class TrackerServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Die Grenzen für jede Verbindung.
+     */
+    struct Limits {
+        int messagesPerSecond = 20;           ///< Nachrichten pro Sekunde im Mittel (0 = unbegrenzt)
+        int burst = 40;                       ///< So viele Nachrichten dürfen auf einmal kommen
+        int maxQueuedMessages = 64;           ///< Wartende Nachrichten pro Client, danach wird verworfen
+        qint64 maxBytesToWrite = 1024 * 1024; ///< Ungesendete Bytes, ab denen Änderungen verworfen werden
+        qint64 maxMessageSize = 256 * 1024;   ///< Größte erlaubte eingehende Nachricht
+    };
+
+    /**
+     * @brief Erstellt einen Server, der noch nicht lauscht.
+     *
+     * @param parent Das Elternobjekt
+     */
+    explicit TrackerServer(QObject *parent = nullptr);
+
+    /**
+     * @brief Trennt alle Clients und schließt den Server.
+     */
+    ~TrackerServer() override;
+
+    /**
+     * @brief Beginnt, auf Verbindungen zu warten.
+     *
+     * @param address Die Adresse (Standard: nur lokal)
+     * @param port Der Port (0 = frei wählen)
+     * @return true, wenn der Server lauscht
+     */
+    bool listen(const QHostAddress &address = QHostAddress::LocalHost, quint16 port = 8088);
+
+    /**
+     * @brief Trennt alle Clients und beendet das Warten auf Verbindungen.
+     */
+    void close();
+
+    /**
+     * @brief Gibt den Port zurück, auf dem der Server lauscht.
+     *
+     * @return Der Port oder 0, wenn der Server nicht lauscht
+     */
+    quint16 serverPort() const;
+
+    /**
+     * @brief Gibt die Beschreibung des letzten Fehlers zurück.
+     */
+    QString errorString() const;
+
+    /**
+     * @brief Gibt die Anzahl der verbundenen Clients zurück.
+     */
+    int clientCount() const;
+
+    /**
+     * @brief Gibt die Anzahl der Clients mit Abonnement zurück.
+     */
+    int subscriberCount() const;
+
+    /**
+     * @brief Setzt die Grenzen für alle Verbindungen.
+     *
+     * maxMessageSize gilt erst für neue Verbindungen.
+     *
+     * @param limits Die neuen Grenzen
+     */
+    void setLimits(const Limits &limits);
+
+    /**
+     * @brief Gibt die Grenzen für alle Verbindungen zurück.
+     */
+    Limits limits() const;
+
+    /**
+     * @brief Gibt die Anzahl der wegen des Rate-Limits verworfenen Nachrichten zurück.
+     */
+    quint64 droppedMessageCount() const;
+
+    /**
+     * @brief Gibt die Anzahl der an langsame Clients nicht gesendeten Änderungsnachrichten zurück.
+     */
+    quint64 droppedUpdateCount() const;
+
+public slots:
+    /**
+     * @brief Sendet eine fertig kodierte Nachricht an einen Client.
+     *
+     * @param clientId Der Client
+     * @param data Die Nachricht
+     * @param encoding Die Kodierung von data (Text- oder Binärnachricht)
+     */
+    void send(quint64 clientId, const QByteArray &data, MessageCodec::Encoding encoding);
+
+    /**
+     * @brief Kodiert eine Nachricht und sendet sie an einen Client.
+     *
+     * @param clientId Der Client
+     * @param message Die Nachricht
+     * @param encoding Die gewünschte Kodierung
+     */
+    void sendMessage(quint64 clientId, const QJsonObject &message, MessageCodec::Encoding encoding);
+
+    /**
+     * @brief Sendet eine Nachricht an alle Clients mit Abonnement.
+     *
+     * Die Nachricht wird pro Kodierung nur einmal kodiert.
+     *
+     * @param message Die Nachricht
+     */
+    void broadcast(const QJsonObject &message);
+
+signals:
+    /**
+     * @brief Signal für jede dekodierte Nachricht eines Clients.
+     *
+     * @param clientId Der sendende Client
+     * @param message Die Nachricht
+     * @param encoding Die Kodierung, in der geantwortet werden soll
+     */
+    void messageReceived(quint64 clientId, const QJsonObject &message, MessageCodec::Encoding encoding);
+
+    /**
+     * @brief Signal für jede empfangene Nachricht in lesbarer Form, zur Anzeige.
+     *
+     * Der Text wird nur gebaut, solange das Signal verbunden ist.
+     *
+     * @param text Die Nachricht (CBOR als JSON-Text)
+     */
+    void messageLogged(const QString &text);
+
+    /**
+     * @brief Signal, wenn sich ein Client verbunden hat.
+     *
+     * @param peer Die Adresse des Clients
+     */
+    void clientConnected(const QString &peer);
+
+    /**
+     * @brief Signal, wenn ein Client getrennt wurde.
+     *
+     * @param peer Die Adresse des Clients
+     */
+    void clientDisconnected(const QString &peer);
+
+    /**
+     * @brief Signal, wenn ein Client abonniert hat.
+     *
+     * @param clientId Der Client
+     * @param encoding Die Kodierung seiner Abonnement-Nachrichten
+     */
+    void subscribed(quint64 clientId, MessageCodec::Encoding encoding);
+
+    /**
+     * @brief Signal, wenn ein langsamer Abonnent Änderungen verpasst hat und den ganzen Zustand braucht.
+     *
+     * @param clientId Der Client
+     * @param encoding Die Kodierung seiner Abonnement-Nachrichten
+     */
+    void resyncRequired(quint64 clientId, MessageCodec::Encoding encoding);
+
+    /**
+     * @brief Signal, wenn sich die Anzahl der Abonnenten geändert hat.
+     *
+     * @param count Die neue Anzahl
+     */
+    void subscriberCountChanged(int count);
+
+private slots:
+    /**
+     * @brief Nimmt eine neue Verbindung an.
+     */
+    void onNewConnection();
+
+    /**
+     * @brief Verarbeitet eine Textnachricht (JSON).
+     *
+     * @param message Die Nachricht
+     */
+    void onTextMessageReceived(const QString &message);
+
+    /**
+     * @brief Verarbeitet eine Binärnachricht (CBOR).
+     *
+     * @param message Die Nachricht
+     */
+    void onBinaryMessageReceived(const QByteArray &message);
+
+    /**
+     * @brief Prüft, ob ein langsamer Client seinen Sendepuffer geleert hat.
+     */
+    void onBytesWritten();
+
+    /**
+     * @brief Holt wartende Nachrichten nach, soweit die Token-Buckets es erlauben.
+     */
+    void drainQueues();
+
+    /**
+     * @brief Entfernt einen getrennten Client.
+     */
+    void onDisconnected();
+
+private:
+    /**
+     * @brief Eine empfangene, noch nicht verarbeitete Nachricht.
+     */
+    struct Frame {
+        QByteArray data;                 ///< Die Nachricht (JSON als UTF-8)
+        MessageCodec::Encoding encoding; ///< Die Kodierung der Nachricht
+    };
+
+    /**
+     * @brief Der Zustand einer Verbindung.
+     */
+    struct Client {
+        QWebSocket *socket = nullptr;                      ///< Die Verbindung
+        MessageCodec::Encoding encoding = MessageCodec::Json; ///< Kodierung der Abonnement-Nachrichten
+        bool subscribed = false;                           ///< Erhält der Client broadcast()?
+        bool stale = false;                                ///< Hat der Client Änderungen verpasst?
+        bool dropping = false;                             ///< Wurde die Fehlerantwort schon gesendet?
+        double tokens = 0.0;                               ///< Marken im Token-Bucket
+        qint64 lastRefill = 0;                             ///< Zeitpunkt der letzten Auffüllung (ms)
+        QQueue<Frame> queue;                               ///< Wartende Nachrichten
+    };
+
+    /**
+     * @brief Nimmt eine Nachricht an: sofort verarbeiten, einreihen oder verwerfen.
+     *
+     * @param socket Die Verbindung
+     * @param data Die Nachricht
+     * @param encoding Die Kodierung der Nachricht
+     */
+    void receiveFrame(QWebSocket *socket, const QByteArray &data, MessageCodec::Encoding encoding);
+
+    /**
+     * @brief Dekodiert eine Nachricht und verarbeitet sie.
+     *
+     * Ungültige Binärnachrichten werden mit einer Fehlerantwort beantwortet,
+     * ungültige Texte nur angezeigt.
+     *
+     * @param clientId Der sendende Client
+     * @param data Die Nachricht
+     * @param encoding Die Kodierung der Nachricht
+     */
+    void processFrame(quint64 clientId, const QByteArray &data, MessageCodec::Encoding encoding);
+
+    /**
+     * @brief Füllt den Token-Bucket eines Clients nach der vergangenen Zeit auf.
+     */
+    void refill(Client *client) const;
+
+    /**
+     * @brief Verarbeitet eine dekodierte Nachricht.
+     *
+     * @param clientId Der sendende Client
+     * @param message Die Nachricht
+     * @param encoding Die Kodierung der Nachricht
+     */
+    void handleMessage(quint64 clientId, const QJsonObject &message, MessageCodec::Encoding encoding);
+
+    /**
+     * @brief Sendet eine Statusantwort im Format des CommandDispatcher.
+     *
+     * @param client Der Client
+     * @param success Erfolg oder Fehler
+     * @param text Die Meldung
+     * @param encoding Die Kodierung
+     */
+    void sendStatus(Client *client, bool success, const QString &text, MessageCodec::Encoding encoding);
+
+    /**
+     * @brief Sendet Bytes als Text- oder Binärnachricht.
+     *
+     * @param socket Die Verbindung
+     * @param data Die Nachricht
+     * @param encoding Die Kodierung von data
+     */
+    static void sendFrame(QWebSocket *socket, const QByteArray &data, MessageCodec::Encoding encoding);
+
+    /**
+     * @brief Setzt das Abonnement eines Clients und meldet die neue Anzahl.
+     */
+    void setSubscribed(Client *client, bool subscribed);
+
+    QWebSocketServer *m_server;           ///< Der eigentliche WebSocket-Server
+    QHash<quint64, Client> m_clients;     ///< Die Verbindungen nach Id
+    QHash<QWebSocket *, quint64> m_ids;   ///< Die Id jeder Verbindung
+    QList<quint64> m_backlog;             ///< Clients mit wartenden Nachrichten, der Reihe nach
+    QTimer *m_drainTimer;                 ///< Holt wartende Nachrichten nach
+    QElapsedTimer m_clock;                ///< Uhr für die Token-Buckets
+    Limits m_limits;                      ///< Die Grenzen für jede Verbindung
+    quint64 m_nextClientId;               ///< Die Id des nächsten Clients
+    quint64 m_droppedMessages;            ///< Wegen des Rate-Limits verworfene Nachrichten
+    quint64 m_droppedUpdates;             ///< An langsame Clients nicht gesendete Änderungen
+    int m_subscriberCount;                ///< Anzahl der Clients mit Abonnement
+};
+
+#endif // TRACKERSERVER_H
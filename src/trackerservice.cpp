@@ -0,0 +1,260 @@
+#include "trackerservice.h"
+#include "initiativetracker.h"
+#include "trackerserver.h"
+#include "trace.h"
+#include <QMetaMethod>
+
+/**
+ * @brief Erstellt einen Dienst für einen Tracker, der noch nicht lauscht
+ *
+ * @param tracker Der Tracker
+ * @param parent Das Elternobjekt
+ */
+TrackerService::TrackerService(InitiativeTracker *tracker, QObject *parent)
+    : QObject(parent)
+    , m_dispatcher(tracker)
+    , m_broadcaster(tracker)
+    , m_server(nullptr)
+    , m_serverPort(0)
+{
+    // Die Kodierung wandert in Queued-Verbindungen zwischen den Threads
+    qRegisterMetaType<MessageCodec::Encoding>("MessageCodec::Encoding");
+    m_networkThread.setObjectName(QStringLiteral("dnd-network"));
+}
+
+/**
+ * @brief Beendet Server und Netzwerk-Thread
+ */
+TrackerService::~TrackerService()
+{
+    stop();
+}
+
+/**
+ * @brief Startet den Netzwerk-Thread und den Server
+ *
+ * @param address Die Adresse
+ * @param port Der Port (0 = frei wählen)
+ * @return true, wenn der Server lauscht
+ */
+bool TrackerService::start(const QHostAddress &address, quint16 port)
+{
+    if (m_server) {
+        return true;
+    }
+
+    // Der Server wird hier erstellt und dann mit allen Kindobjekten in den
+    // Netzwerk-Thread verschoben; gelöscht wird er dort, wenn der Thread endet
+    m_server = new TrackerServer;
+    m_server->setLimits(m_limits);
+    m_server->moveToThread(&m_networkThread);
+    connect(&m_networkThread, &QThread::finished, m_server, &QObject::deleteLater);
+
+    // Netzwerk -> Tracker (Queued, da der Server in einem anderen Thread lebt)
+    connect(m_server, &TrackerServer::messageReceived, this, &TrackerService::onMessageReceived);
+    connect(m_server, &TrackerServer::subscribed, this, &TrackerService::onSubscribed);
+    connect(m_server, &TrackerServer::resyncRequired, this, &TrackerService::onSubscribed);
+    connect(m_server, &TrackerServer::subscriberCountChanged, this, &TrackerService::onSubscriberCountChanged);
+    connect(m_server, &TrackerServer::clientConnected, this, &TrackerService::clientConnected);
+    connect(m_server, &TrackerServer::clientDisconnected, this, &TrackerService::clientDisconnected);
+
+    // Tracker -> Netzwerk
+    connect(&m_broadcaster, &StateBroadcaster::deltaReady, m_server, &TrackerServer::broadcast);
+
+    // Den Anzeigetext braucht nur, wer messageLogged() verbunden hat
+    updateMessageLogging();
+
+    m_networkThread.start();
+
+    // Auf das Ergebnis von listen() warten, damit der Aufrufer es anzeigen kann
+    TrackerServer *server = m_server;
+    bool listening = false;
+    QMetaObject::invokeMethod(server, [&]() {
+        listening = server->listen(address, port);
+        m_serverPort = server->serverPort();
+        m_errorString = server->errorString();
+    }, Qt::BlockingQueuedConnection);
+
+    if (!listening) {
+        const QString error = m_errorString;
+        stop();
+        m_errorString = error;
+        return false;
+    }
+
+    TRACE_INFO(lcNet) << "Netzwerk-Thread gestartet, Port" << m_serverPort;
+    return true;
+}
+
+/**
+ * @brief Trennt alle Clients und beendet den Netzwerk-Thread
+ */
+void TrackerService::stop()
+{
+    if (!m_server) {
+        return;
+    }
+
+    TrackerServer *server = m_server;
+    QMetaObject::invokeMethod(server, [server]() {
+        server->close();
+    }, Qt::BlockingQueuedConnection);
+
+    m_networkThread.quit();
+    m_networkThread.wait();
+    m_server = nullptr;
+    m_logConnection = QMetaObject::Connection();
+    m_serverPort = 0;
+    m_broadcaster.setActive(false);
+}
+
+/**
+ * @brief Gibt zurück, ob der Server lauscht
+ */
+bool TrackerService::isRunning() const
+{
+    return m_server != nullptr;
+}
+
+/**
+ * @brief Gibt den Port zurück, auf dem der Server lauscht
+ *
+ * @return Der Port oder 0
+ */
+quint16 TrackerService::serverPort() const
+{
+    return m_serverPort;
+}
+
+/**
+ * @brief Gibt die Beschreibung des letzten Fehlers zurück
+ */
+QString TrackerService::errorString() const
+{
+    return m_errorString;
+}
+
+/**
+ * @brief Setzt Rate-Limit und Puffergrenzen für jede Verbindung
+ *
+ * @param limits Die Grenzen
+ */
+void TrackerService::setLimits(const TrackerServer::Limits &limits)
+{
+    m_limits = limits;
+}
+
+/**
+ * @brief Gibt die Befehlstabelle zurück
+ */
+CommandDispatcher *TrackerService::dispatcher()
+{
+    return &m_dispatcher;
+}
+
+/**
+ * @brief Gibt den StateBroadcaster zurück
+ */
+StateBroadcaster *TrackerService::broadcaster()
+{
+    return &m_broadcaster;
+}
+
+/**
+ * @brief Führt die Befehle einer Nachricht aus und schickt die Antwort zurück
+ *
+ * Läuft im Tracker-Thread. Die Antwort ist bereits kodiert und wird dem
+ * Server in seine Warteschlange gestellt.
+ *
+ * @param clientId Der sendende Client
+ * @param message Die Nachricht
+ * @param encoding Die Kodierung des Clients
+ */
+void TrackerService::onMessageReceived(quint64 clientId, const QJsonObject &message, MessageCodec::Encoding encoding)
+{
+    if (CommandDispatcher::isCommand(message) && m_server) {
+        const CommandDispatcher::Response response = m_dispatcher.dispatch(message);
+        const QByteArray data = response.encoded(encoding);
+        TrackerServer *server = m_server;
+        QMetaObject::invokeMethod(server, [server, clientId, data, encoding]() {
+            server->send(clientId, data, encoding);
+        });
+    }
+
+    emit messageReceived(clientId, message, encoding);
+}
+
+/**
+ * @brief Schickt einem neuen oder langsamen Abonnenten den ganzen Zustand
+ *
+ * Der Zustand wird hier gelesen und im Netzwerk-Thread kodiert. Einem
+ * langsamen Client ersetzt er alle Änderungen, die er verpasst hat.
+ *
+ * @param clientId Der Client
+ * @param encoding Die Kodierung des Clients
+ */
+void TrackerService::onSubscribed(quint64 clientId, MessageCodec::Encoding encoding)
+{
+    if (!m_server) {
+        return;
+    }
+    // Offene Änderungen zuerst senden; sie stecken schon im Zustand und
+    // kommen beim neuen Client vor dem state an, wo er sie verwirft
+    m_broadcaster.flush();
+    const QJsonObject state = m_broadcaster.fullState();
+    TrackerServer *server = m_server;
+    QMetaObject::invokeMethod(server, [server, clientId, state, encoding]() {
+        server->sendMessage(clientId, state, encoding);
+    });
+}
+
+/**
+ * @brief Schaltet den StateBroadcaster nach der Anzahl der Abonnenten ein oder aus
+ *
+ * @param count Die Anzahl der Abonnenten
+ */
+void TrackerService::onSubscriberCountChanged(int count)
+{
+    m_broadcaster.setActive(count > 0);
+}
+
+/**
+ * @brief Leitet messageLogged() des Servers nur weiter, wenn es verbunden wird
+ *
+ * @param signal Das verbundene Signal
+ */
+void TrackerService::connectNotify(const QMetaMethod &signal)
+{
+    if (signal == QMetaMethod::fromSignal(&TrackerService::messageLogged)) {
+        updateMessageLogging();
+    }
+}
+
+/**
+ * @brief Beendet die Weiterleitung, wenn messageLogged() nicht mehr verbunden ist
+ *
+ * @param signal Das getrennte Signal
+ */
+void TrackerService::disconnectNotify(const QMetaMethod &signal)
+{
+    if (signal == QMetaMethod::fromSignal(&TrackerService::messageLogged)) {
+        updateMessageLogging();
+    }
+}
+
+/**
+ * @brief Verbindet oder trennt messageLogged() des Servers nach Bedarf
+ *
+ * Ist die Weiterleitung getrennt, ist das Signal des Servers unverbunden und
+ * der Netzwerk-Thread kodiert CBOR-Nachrichten nicht mehr zur Anzeige um.
+ */
+void TrackerService::updateMessageLogging()
+{
+    const bool wanted = isSignalConnected(QMetaMethod::fromSignal(&TrackerService::messageLogged));
+    if (wanted && m_server && !m_logConnection) {
+        m_logConnection = connect(m_server, &TrackerServer::messageLogged, this, &TrackerService::messageLogged);
+    } else if (!wanted && m_logConnection) {
+        disconnect(m_logConnection);
+        m_logConnection = QMetaObject::Connection();
+    }
+}
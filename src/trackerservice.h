@@ -0,0 +1,201 @@
+#ifndef TRACKERSERVICE_H
+#define TRACKERSERVICE_H
+
+#include <QHostAddress>
+#include <QJsonObject>
+#include <QObject>
+#include <QThread>
+#include "commanddispatcher.h"
+#include "messagecodec.h"
+#include "statebroadcaster.h"
+#include "trackerserver.h"
+
+class InitiativeTracker;
+
+/**
+ * @brief Der TrackerService stellt einen Tracker über WebSocket bereit, mit dem Netzwerk in einem eigenen Thread.
+ *
+ * Der TrackerServer mit allen Verbindungen läuft in einem eigenen
+ * Netzwerk-Thread. Dort werden Nachrichten empfangen und dekodiert sowie
+ * Antworten und Änderungsnachrichten kodiert und gesendet. Der Tracker, die
+ * Befehlstabelle (CommandDispatcher) und der StateBroadcaster bleiben im
+ * Thread des TrackerService, im Programm mit Oberfläche also im GUI-Thread.
+ *
+ * Zwischen den Threads wandern nur Nachrichten:
+ * - Netzwerk -> Tracker: Jede dekodierte Nachricht kommt über eine
+ *   Queued-Verbindung in die Ereigniswarteschlange des Tracker-Threads und
+ *   wird dort der Reihe nach ausgeführt.
+ * - Tracker -> Netzwerk: Antworten, der Zustand für neue Abonnenten und
+ *   Änderungsnachrichten werden ebenso in die Warteschlange des
+ *   Netzwerk-Threads gestellt.
+ *
+ * Eine lange Aktualisierung der Tabelle hält so keine Verbindung auf, und
+ * viele Nachrichten auf einmal blockieren nicht die Oberfläche beim Lesen
+ * und Dekodieren.
+ *
+ * Qt-Konzept: QThread und moveToThread()
+ * Jedes QObject gehört zu einem Thread; seine Slots laufen bei
+ * Queued-Verbindungen im Thread des Empfängers. moveToThread() verschiebt
+ * den Server samt Kindobjekten (QWebSocketServer, Verbindungen) in den
+ * Netzwerk-Thread, dessen Ereignisschleife QThread::start() startet.
+ */
+class TrackerService : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Erstellt einen Dienst für einen Tracker, der noch nicht lauscht.
+     *
+     * @param tracker Der Tracker; er muss im Thread des Dienstes leben
+     * @param parent Das Elternobjekt
+     */
+    explicit TrackerService(InitiativeTracker *tracker, QObject *parent = nullptr);
+
+    /**
+     * @brief Beendet Server und Netzwerk-Thread.
+     */
+    ~TrackerService() override;
+
+    /**
+     * @brief Startet den Netzwerk-Thread und den Server.
+     *
+     * Wartet, bis der Server lauscht oder der Start fehlgeschlagen ist.
+     *
+     * @param address Die Adresse (Standard: nur lokal)
+     * @param port Der Port (0 = frei wählen)
+     * @return true, wenn der Server lauscht
+     */
+    bool start(const QHostAddress &address = QHostAddress::LocalHost, quint16 port = 8088);
+
+    /**
+     * @brief Trennt alle Clients und beendet den Netzwerk-Thread.
+     */
+    void stop();
+
+    /**
+     * @brief Gibt zurück, ob der Server lauscht.
+     */
+    bool isRunning() const;
+
+    /**
+     * @brief Gibt den Port zurück, auf dem der Server lauscht.
+     *
+     * @return Der Port oder 0
+     */
+    quint16 serverPort() const;
+
+    /**
+     * @brief Gibt die Beschreibung des letzten Fehlers zurück.
+     */
+    QString errorString() const;
+
+    /**
+     * @brief Setzt Rate-Limit und Puffergrenzen für jede Verbindung.
+     *
+     * Die Grenzen gelten ab dem nächsten start().
+     *
+     * @param limits Die Grenzen
+     */
+    void setLimits(const TrackerServer::Limits &limits);
+
+    /**
+     * @brief Gibt die Befehlstabelle zurück, z.B. um eigene Befehle zu registrieren.
+     */
+    CommandDispatcher *dispatcher();
+
+    /**
+     * @brief Gibt den StateBroadcaster zurück.
+     */
+    StateBroadcaster *broadcaster();
+
+signals:
+    /**
+     * @brief Signal für jede dekodierte Nachricht, nachdem Befehle ausgeführt wurden.
+     *
+     * @param clientId Der sendende Client
+     * @param message Die Nachricht
+     * @param encoding Die Kodierung des Clients
+     */
+    void messageReceived(quint64 clientId, const QJsonObject &message, MessageCodec::Encoding encoding);
+
+    /**
+     * @brief Signal für jede empfangene Nachricht in lesbarer Form, zur Anzeige.
+     *
+     * Nur solange es verbunden ist, baut der Server den Anzeigetext.
+     *
+     * @param text Die Nachricht
+     */
+    void messageLogged(const QString &text);
+
+    /**
+     * @brief Signal, wenn sich ein Client verbunden hat.
+     *
+     * @param peer Die Adresse des Clients
+     */
+    void clientConnected(const QString &peer);
+
+    /**
+     * @brief Signal, wenn ein Client getrennt wurde.
+     *
+     * @param peer Die Adresse des Clients
+     */
+    void clientDisconnected(const QString &peer);
+
+private slots:
+    /**
+     * @brief Führt die Befehle einer Nachricht aus und schickt die Antwort zurück.
+     *
+     * @param clientId Der sendende Client
+     * @param message Die Nachricht
+     * @param encoding Die Kodierung des Clients
+     */
+    void onMessageReceived(quint64 clientId, const QJsonObject &message, MessageCodec::Encoding encoding);
+
+    /**
+     * @brief Schickt einem neuen oder langsamen Abonnenten den ganzen Zustand.
+     *
+     * @param clientId Der Client
+     * @param encoding Die Kodierung des Clients
+     */
+    void onSubscribed(quint64 clientId, MessageCodec::Encoding encoding);
+
+    /**
+     * @brief Schaltet den StateBroadcaster nach der Anzahl der Abonnenten ein oder aus.
+     *
+     * @param count Die Anzahl der Abonnenten
+     */
+    void onSubscriberCountChanged(int count);
+
+protected:
+    /**
+     * @brief Leitet messageLogged() des Servers nur weiter, wenn es verbunden wird.
+     *
+     * @param signal Das verbundene Signal
+     */
+    void connectNotify(const QMetaMethod &signal) override;
+
+    /**
+     * @brief Beendet die Weiterleitung, wenn messageLogged() nicht mehr verbunden ist.
+     *
+     * @param signal Das getrennte Signal
+     */
+    void disconnectNotify(const QMetaMethod &signal) override;
+
+private:
+    /**
+     * @brief Verbindet oder trennt messageLogged() des Servers nach Bedarf.
+     */
+    void updateMessageLogging();
+
+    CommandDispatcher m_dispatcher;     ///< Führt die Befehle aus (Tracker-Thread)
+    StateBroadcaster m_broadcaster;     ///< Sammelt Änderungen (Tracker-Thread)
+    QThread m_networkThread;            ///< Der Thread für Verbindungen und Kodierung
+    TrackerServer *m_server;            ///< Der Server (lebt im Netzwerk-Thread)
+    TrackerServer::Limits m_limits;     ///< Die Grenzen für den nächsten Start
+    quint16 m_serverPort;               ///< Der Port nach dem Start
+    QString m_errorString;              ///< Der letzte Fehler
+    QMetaObject::Connection m_logConnection; ///< Weiterleitung von messageLogged()
+};
+
+#endif // TRACKERSERVICE_H
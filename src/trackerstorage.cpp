@@ -0,0 +1,103 @@
+#include "trackerstorage.h"
+#include "initiativetracker.h"
+#include "trace.h"
+#include <QDir>
+#include <QFileInfo>
+
+/**
+ * @brief Erstellt die Speicherung für einen Tracker
+ *
+ * @param tracker Der Tracker
+ * @param directory Das Verzeichnis der Dateien
+ */
+TrackerStorage::TrackerStorage(InitiativeTracker *tracker, const QString &directory)
+    : m_tracker(tracker)
+    , m_jsonFilename(QDir(directory).filePath(QStringLiteral("characters.json")))
+    , m_snapshotFilename(QDir(directory).filePath(QStringLiteral("characters.dndsnap")))
+    , m_journal(tracker, m_snapshotFilename, QDir(directory).filePath(QStringLiteral("characters.journal")))
+    , m_autoSaver(tracker, m_jsonFilename)
+{
+}
+
+/**
+ * @brief Lädt den gespeicherten Stand und beginnt, Änderungen zu speichern
+ *
+ * @return true, wenn ein gespeicherter Stand geladen wurde
+ */
+bool TrackerStorage::load()
+{
+    // Nach einem Absturz enthält das Journal alle Änderungen seit dem letzten Snapshot
+    bool success = m_journal.recover();
+
+    // Der Snapshot lädt deutlich schneller als JSON. Er wird aber nur
+    // verwendet, wenn die JSON-Datei nicht später geändert wurde (z.B. von Hand).
+    const QFileInfo snapshotInfo(m_snapshotFilename);
+    const QFileInfo jsonInfo(m_jsonFilename);
+    if (!success && snapshotInfo.exists()
+        && (!jsonInfo.exists() || snapshotInfo.lastModified() >= jsonInfo.lastModified())) {
+        success = m_tracker->loadSnapshot(m_snapshotFilename);
+    }
+
+    // Versucht, die Charakterdaten aus der JSON-Datei zu laden
+    if (!success) {
+        success = m_tracker->loadFromFile(m_jsonFilename);
+    }
+
+    if (success) {
+        TRACE_INFO(lcStorage) << "Charakterdaten erfolgreich geladen.";
+    } else {
+        TRACE_INFO(lcStorage) << "Keine gespeicherten Charakterdaten gefunden oder Fehler beim Laden.";
+    }
+
+    // Ab hier wird jede Änderung sofort im Journal gespeichert und die
+    // JSON-Datei kurz danach im Hintergrund aktualisiert
+    if (!m_journal.start()) {
+        TRACE_WARNING(lcStorage) << "Änderungsjournal konnte nicht gestartet werden.";
+    }
+    m_autoSaver.start();
+    return success;
+}
+
+/**
+ * @brief Speichert den aktuellen Stand vollständig
+ *
+ * Das Journal enthält bereits jede Änderung und der AutoSaver hat die
+ * JSON-Datei meist schon geschrieben. Hier wird nur auf ihn gewartet und
+ * das Journal verdichtet.
+ *
+ * @return true, wenn alle Dateien geschrieben wurden
+ */
+bool TrackerStorage::save()
+{
+    // Die JSON-Datei für den Austausch; geschrieben wird nur, was noch fehlt.
+    // Der Snapshot für den schnellen Start entsteht beim Verdichten des Journals.
+    bool success = m_autoSaver.saveAndWait();
+    if (m_journal.isActive()) {
+        success = m_journal.compact() && success;
+    } else {
+        success = m_tracker->saveSnapshot(m_snapshotFilename) && success;
+    }
+
+    if (success) {
+        TRACE_INFO(lcStorage) << "Charakterdaten erfolgreich gespeichert.";
+    } else {
+        TRACE_WARNING(lcStorage) << "Fehler beim Speichern der Charakterdaten.";
+    }
+    return success;
+}
+
+/**
+ * @brief Gibt den AutoSaver zurück
+ */
+AutoSaver *TrackerStorage::autoSaver()
+{
+    return &m_autoSaver;
+}
+
+/**
+ * @brief Gibt das Änderungsjournal zurück
+ */
+ChangeJournal *TrackerStorage::journal()
+{
+    return &m_journal;
+}
@@ -0,0 +1,73 @@
+#ifndef TRACKERSTORAGE_H
+#define TRACKERSTORAGE_H
+
+#include <QString>
+#include "autosaver.h"
+#include "changejournal.h"
+
+class InitiativeTracker;
+
+/**
+ * @brief Die TrackerStorage-Klasse lädt und speichert einen Tracker mit Journal, Snapshot und JSON-Datei.
+ *
+ * Sie bündelt, was beim Start und Beenden mit den Dateien passiert, damit
+ * das Hauptfenster und der Server ohne Oberfläche dieselbe Reihenfolge
+ * verwenden:
+ * - load(): Nach einem Absturz Snapshot und Journal, sonst der Snapshot,
+ *   wenn er nicht älter als die JSON-Datei ist, sonst die JSON-Datei.
+ *   Danach wird jede Änderung sofort im Journal gespeichert und die
+ *   JSON-Datei kurz danach im Hintergrund (AutoSaver).
+ * - save(): Wartet auf den AutoSaver und verdichtet das Journal zu einem
+ *   neuen Snapshot.
+ *
+ * Alle Dateien liegen in einem Verzeichnis: characters.json,
+ * characters.dndsnap und characters.journal.
+ *
+ * C++ Konzept: Komposition
+ * Journal und AutoSaver sind Member und leben genau so lange wie die
+ * TrackerStorage; der Besitzer muss sich um keinen der beiden kümmern.
+ */
+class TrackerStorage
+{
+public:
+    /**
+     * @brief Erstellt die Speicherung für einen Tracker.
+     *
+     * @param tracker Der Tracker
+     * @param directory Das Verzeichnis der Dateien (leer = aktuelles Verzeichnis)
+     */
+    explicit TrackerStorage(InitiativeTracker *tracker, const QString &directory = QString());
+
+    /**
+     * @brief Lädt den gespeicherten Stand und beginnt, Änderungen zu speichern.
+     *
+     * @return true, wenn ein gespeicherter Stand geladen wurde
+     */
+    bool load();
+
+    /**
+     * @brief Speichert den aktuellen Stand vollständig, z.B. beim Beenden.
+     *
+     * @return true, wenn alle Dateien geschrieben wurden
+     */
+    bool save();
+
+    /**
+     * @brief Gibt den AutoSaver zurück, z.B. für "Speichern unter".
+     */
+    AutoSaver *autoSaver();
+
+    /**
+     * @brief Gibt das Änderungsjournal zurück.
+     */
+    ChangeJournal *journal();
+
+private:
+    InitiativeTracker *m_tracker; ///< Der Tracker
+    QString m_jsonFilename;       ///< Die JSON-Datei
+    QString m_snapshotFilename;   ///< Der Snapshot
+    ChangeJournal m_journal;      ///< Speichert jede Änderung des Trackers sofort
+    AutoSaver m_autoSaver;        ///< Schreibt die JSON-Datei im Hintergrund
+};
+
+#endif // TRACKERSTORAGE_H
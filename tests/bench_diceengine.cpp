@@ -0,0 +1,109 @@
+#include <QtTest>
+#include <QVector>
+#include "../src/character.h"
+#include "../src/diceengine.h"
+#include "../src/initiativetracker.h"
+
+/**
+ * @brief Benchmark: Einzelwürfe über Character::rollD20() gegen die DiceEngine.
+ *
+ * Wird nicht von ctest ausgeführt. Aufruf z.B. mit
+ * ./bench_diceengine -iterations 20
+ */
+class BenchDiceEngine : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void benchmarkPerCall_data();
+    void benchmarkPerCall();
+    void benchmarkBatchScalar_data();
+    void benchmarkBatchScalar();
+    void benchmarkBatch_data();
+    void benchmarkBatch();
+    void benchmarkRollAllInitiatives_data();
+    void benchmarkRollAllInitiatives();
+
+private:
+    void addSizes();
+};
+
+void BenchDiceEngine::addSizes()
+{
+    QTest::addColumn<int>("count");
+    QTest::newRow("100") << 100;
+    QTest::newRow("10000") << 10000;
+    QTest::newRow("100000") << 100000;
+}
+
+void BenchDiceEngine::benchmarkPerCall_data()
+{
+    addSizes();
+}
+
+void BenchDiceEngine::benchmarkPerCall()
+{
+    QFETCH(int, count);
+    QVector<int> rolls(count);
+
+    // Bisheriger Weg: ein Aufruf von Mersenne-Twister und Verteilung je Wurf
+    QBENCHMARK {
+        for (int i = 0; i < count; ++i) {
+            rolls[i] = Character::rollD20();
+        }
+    }
+}
+
+void BenchDiceEngine::benchmarkBatchScalar_data()
+{
+    addSizes();
+}
+
+void BenchDiceEngine::benchmarkBatchScalar()
+{
+    QFETCH(int, count);
+    QVector<int> rolls(count);
+    quint64 batch = 0;
+
+    QBENCHMARK {
+        DiceEngine::fillD20Scalar(1, batch++, 0, rolls.data(), count);
+    }
+}
+
+void BenchDiceEngine::benchmarkBatch_data()
+{
+    addSizes();
+}
+
+void BenchDiceEngine::benchmarkBatch()
+{
+    QFETCH(int, count);
+    QVector<int> rolls(count);
+    DiceEngine engine(1);
+
+    qDebug() << "AVX2 verfügbar:" << DiceEngine::isAvx2Available();
+    QBENCHMARK {
+        engine.rollD20(rolls.data(), count);
+    }
+}
+
+void BenchDiceEngine::benchmarkRollAllInitiatives_data()
+{
+    addSizes();
+}
+
+void BenchDiceEngine::benchmarkRollAllInitiatives()
+{
+    QFETCH(int, count);
+    InitiativeTracker tracker;
+    for (int i = 0; i < count; ++i) {
+        tracker.addCharacter(Character(QString("Goblin %1").arg(i), i % 5));
+    }
+
+    QBENCHMARK {
+        tracker.rollAllInitiatives();
+    }
+}
+
+QTEST_APPLESS_MAIN(BenchDiceEngine)
+#include "bench_diceengine.moc"
@@ -0,0 +1,75 @@
+#include <QtTest>
+#include <QThread>
+#include "../src/initiativetracker.h"
+#include "../src/rostercsvreader.h"
+
+/**
+ * @brief Benchmark: CSV-Import mit einem Thread gegen alle Kerne.
+ *
+ * Wird nicht von ctest ausgeführt. Aufruf z.B. mit
+ * ./bench_rostercsvreader -iterations 10
+ */
+class BenchRosterCsvReader : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void benchmarkRead_data();
+    void benchmarkRead();
+    void benchmarkAppendToTracker();
+};
+
+namespace {
+
+QByteArray makeRoster(int count)
+{
+    QByteArray data("name,initiativeModifier,willSave,reflexSave,fortitudeSave\n");
+    for (int i = 0; i < count; ++i) {
+        data += "Skelettkrieger " + QByteArray::number(i % 200) + ',' + QByteArray::number(i % 7 - 3) + ','
+            + QByteArray::number(i % 5) + ",2,-1\n";
+    }
+    return data;
+}
+
+} // namespace
+
+void BenchRosterCsvReader::benchmarkRead_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<int>("threads");
+    for (int count : { 10000, 100000 }) {
+        QTest::addRow("%d/1", count) << count << 1;
+        QTest::addRow("%d/%d", count, QThread::idealThreadCount()) << count << QThread::idealThreadCount();
+    }
+}
+
+void BenchRosterCsvReader::benchmarkRead()
+{
+    QFETCH(int, count);
+    QFETCH(int, threads);
+    const QByteArray data = makeRoster(count);
+    RosterCsvReader reader;
+    reader.setMaxThreadCount(threads);
+    CharacterStore store;
+
+    QBENCHMARK {
+        reader.read(data, &store);
+    }
+    QCOMPARE(store.size(), count);
+}
+
+void BenchRosterCsvReader::benchmarkAppendToTracker()
+{
+    const QByteArray data = makeRoster(100000);
+    RosterCsvReader reader;
+    CharacterStore store;
+    QVERIFY(reader.read(data, &store));
+
+    QBENCHMARK {
+        InitiativeTracker tracker;
+        tracker.appendCharacters(store);
+    }
+}
+
+QTEST_APPLESS_MAIN(BenchRosterCsvReader)
+#include "bench_rostercsvreader.moc"
@@ -0,0 +1,146 @@
+#include <QtTest>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include "../src/autosaver.h"
+#include "../src/initiativetracker.h"
+
+/**
+ * @brief Die TestAutoSaver-Klasse enthält Unit-Tests für das Speichern im Hintergrund.
+ */
+class TestAutoSaver : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    /**
+     * @brief Testet, ob nach einer Änderung automatisch gespeichert wird.
+     */
+    void testSavesAfterChange();
+
+    /**
+     * @brief Testet, ob mehrere Änderungen in der Wartezeit zu einem Speichervorgang werden.
+     */
+    void testCoalescesChanges();
+
+    /**
+     * @brief Testet, ob spätere Änderungen den bereits übergebenen Schnappschuss nicht verändern.
+     */
+    void testSnapshotIsolated();
+
+    /**
+     * @brief Testet das Speichern beim Beenden.
+     */
+    void testSaveAndWait();
+};
+
+void TestAutoSaver::testSavesAfterChange()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString filename = dir.filePath("autosave.json");
+
+    InitiativeTracker tracker;
+    AutoSaver saver(&tracker, filename);
+    saver.setDelay(10);
+    QSignalSpy spy(&saver, &AutoSaver::saveFinished);
+
+    // Vor start() wird nichts gespeichert
+    tracker.addCharacter(Character("Goblin", 2));
+    QVERIFY(!saver.isDirty());
+
+    saver.start();
+    tracker.addCharacter(Character("Ork", 1));
+    QVERIFY(saver.isDirty());
+    QVERIFY(spy.wait(5000));
+    QCOMPARE(spy.first().at(0).toString(), filename);
+    QVERIFY(spy.first().at(1).toBool());
+    QVERIFY(!saver.isDirty());
+    QVERIFY(!saver.isSaving());
+
+    InitiativeTracker loaded;
+    QVERIFY(loaded.loadFromFile(filename));
+    QCOMPARE(loaded.size(), 2);
+    QCOMPARE(loaded.sessionSeed(), tracker.sessionSeed());
+}
+
+void TestAutoSaver::testCoalescesChanges()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString filename = dir.filePath("autosave.json");
+
+    InitiativeTracker tracker;
+    AutoSaver saver(&tracker, filename);
+    saver.setDelay(50);
+    saver.start();
+    QSignalSpy spy(&saver, &AutoSaver::saveFinished);
+
+    for (int i = 0; i < 10; ++i) {
+        tracker.addCharacter(Character(QString("Skelett %1").arg(i), 1));
+    }
+    tracker.rollAllInitiatives();
+
+    QVERIFY(spy.wait(5000));
+    QTest::qWait(100);
+    QCOMPARE(spy.count(), 1);
+
+    InitiativeTracker loaded;
+    QVERIFY(loaded.loadFromFile(filename));
+    QCOMPARE(loaded.size(), 10);
+    QVERIFY(loaded.verifyRolls());
+}
+
+void TestAutoSaver::testSnapshotIsolated()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString filename = dir.filePath("copy.dndsnap");
+
+    InitiativeTracker tracker;
+    tracker.addCharacter(Character("Goblin", 2));
+    AutoSaver saver(&tracker, dir.filePath("autosave.json"));
+    QSignalSpy spy(&saver, &AutoSaver::saveFinished);
+
+    // Änderungen direkt nach dem Auftrag gehören nicht mehr in die Datei
+    saver.saveAs(filename);
+    tracker.setInitiativeModifier(0, 9);
+    tracker.addCharacter(Character("Ork", 1));
+
+    QVERIFY(spy.wait(5000));
+    QCOMPARE(spy.first().at(0).toString(), filename);
+    QVERIFY(spy.first().at(1).toBool());
+
+    InitiativeTracker loaded;
+    QVERIFY(loaded.loadSnapshot(filename));
+    QCOMPARE(loaded.size(), 1);
+    QCOMPARE(loaded.characterView(0).getInitiativeModifier(), 2);
+}
+
+void TestAutoSaver::testSaveAndWait()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString filename = dir.filePath("autosave.json");
+
+    InitiativeTracker tracker;
+    AutoSaver saver(&tracker, filename);
+    saver.setDelay(60000);
+    saver.start();
+
+    // Nichts geändert, nichts zu schreiben
+    QVERIFY(saver.saveAndWait());
+    QVERIFY(!QFile::exists(filename));
+
+    tracker.addCharacter(Character("Goblin", 2));
+    tracker.addCharacter(Character("Ork", 1));
+    QVERIFY(saver.isDirty());
+    QVERIFY(saver.saveAndWait());
+    QVERIFY(!saver.isDirty());
+
+    InitiativeTracker loaded;
+    QVERIFY(loaded.loadFromFile(filename));
+    QCOMPARE(loaded.size(), 2);
+}
+
+QTEST_MAIN(TestAutoSaver)
+#include "tst_autosaver.moc"
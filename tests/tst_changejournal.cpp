@@ -0,0 +1,221 @@
+#include <QtTest>
+#include <QTemporaryDir>
+#include "../src/changejournal.h"
+#include "../src/initiativetracker.h"
+
+/**
+ * @brief Die TestChangeJournal-Klasse enthält Unit-Tests für das Änderungsjournal.
+ */
+class TestChangeJournal : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    /**
+     * @brief Testet, ob nach einem Absturz alle Änderungen aus dem Journal zurückkommen.
+     */
+    void testRecoverAfterCrash();
+
+    /**
+     * @brief Testet, ob Änderungen in einem Batch vollständig im Journal landen.
+     */
+    void testRecoverBatch();
+
+    /**
+     * @brief Testet, ob das Journal ab der eingestellten Größe verdichtet wird.
+     */
+    void testCompaction();
+
+    /**
+     * @brief Testet, ob ein abgeschnittener letzter Eintrag verworfen wird.
+     */
+    void testTornTail();
+
+    /**
+     * @brief Testet, ob ein Journal zu einem anderen Snapshot ignoriert wird.
+     */
+    void testStaleJournal();
+
+private:
+    /**
+     * @brief Vergleicht Charaktere und Sitzung zweier Tracker.
+     *
+     * @param actual Der wiederhergestellte Tracker
+     * @param expected Der ursprüngliche Tracker
+     */
+    void compareTrackers(const InitiativeTracker &actual, const InitiativeTracker &expected);
+};
+
+void TestChangeJournal::compareTrackers(const InitiativeTracker &actual, const InitiativeTracker &expected)
+{
+    QCOMPARE(actual.size(), expected.size());
+    for (int i = 0; i < expected.size(); ++i) {
+        QCOMPARE(actual.store().name(i), expected.store().name(i));
+        for (int field = 0; field < CharacterStore::FieldCount; ++field) {
+            QCOMPARE(actual.store().value(i, CharacterStore::Field(field)),
+                     expected.store().value(i, CharacterStore::Field(field)));
+        }
+    }
+    QCOMPARE(actual.sessionSeed(), expected.sessionSeed());
+    QCOMPARE(actual.rollEventCount(), expected.rollEventCount());
+    QCOMPARE(actual.session().nextRollKey, expected.session().nextRollKey);
+}
+
+void TestChangeJournal::testRecoverAfterCrash()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString snapshotFile = dir.filePath("roster.dndsnap");
+    const QString journalFile = dir.filePath("roster.journal");
+
+    InitiativeTracker tracker;
+    tracker.addCharacter(Character("Goblin", 2, 1, 0, -1));
+    {
+        // Ohne compact() am Ende, wie bei einem Absturz
+        ChangeJournal journal(&tracker, snapshotFile, journalFile);
+        QVERIFY(journal.start());
+
+        tracker.addCharacter(Character("Ork", 1));
+        tracker.addCharacter(Character("Troll", -1, 3, 2, 5));
+        tracker.rollAllInitiatives();
+        tracker.setWillSave(1, 4);
+        tracker.updateCharacter(0, Character("Hobgoblin", 3, 1, 0, -1));
+        tracker.rollReflexSaveForCharacter(2);
+        tracker.removeCharacter(1);
+        tracker.rollAllFortitudeSaves();
+        QVERIFY(journal.size() > ChangeJournal::HeaderSize);
+    }
+
+    InitiativeTracker recovered;
+    ChangeJournal journal(&recovered, snapshotFile, journalFile);
+    QVERIFY(journal.recover());
+    compareTrackers(recovered, tracker);
+    QVERIFY(recovered.verifyRolls());
+
+    // Neue Schlüssel werden nicht doppelt vergeben
+    recovered.addCharacter(Character("Oger", 0));
+    QCOMPARE(recovered.rollKey(2), tracker.session().nextRollKey);
+}
+
+void TestChangeJournal::testRecoverBatch()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString snapshotFile = dir.filePath("roster.dndsnap");
+    const QString journalFile = dir.filePath("roster.journal");
+
+    InitiativeTracker tracker;
+    tracker.addCharacter(Character("Goblin", 2));
+    {
+        ChangeJournal journal(&tracker, snapshotFile, journalFile);
+        QVERIFY(journal.start());
+
+        // Der Batch meldet die Würfe vor den neuen Zeilen
+        InitiativeTracker::ChangeBatch batch(&tracker);
+        for (int i = 0; i < 50; ++i) {
+            tracker.addCharacter(Character(QString("Ork %1").arg(i), i % 5));
+        }
+        tracker.rollAllInitiatives();
+        tracker.setInitiativeModifier(0, 7);
+    }
+
+    InitiativeTracker recovered;
+    ChangeJournal journal(&recovered, snapshotFile, journalFile);
+    QVERIFY(journal.recover());
+    compareTrackers(recovered, tracker);
+}
+
+void TestChangeJournal::testCompaction()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString snapshotFile = dir.filePath("roster.dndsnap");
+    const QString journalFile = dir.filePath("roster.journal");
+
+    InitiativeTracker tracker;
+    ChangeJournal journal(&tracker, snapshotFile, journalFile);
+    journal.setCompactionThreshold(256);
+    QVERIFY(journal.start());
+    const quint32 firstGeneration = journal.generation();
+
+    for (int i = 0; i < 20; ++i) {
+        tracker.addCharacter(Character(QString("Skelett %1").arg(i), 1));
+        QVERIFY(journal.size() < 256);
+    }
+    QVERIFY(journal.generation() > firstGeneration);
+
+    // Der Snapshot trägt die Generation des aktuellen Journals
+    CharacterStore store;
+    SnapshotFile::Session session;
+    QVERIFY(SnapshotFile::read(snapshotFile, &store, &session));
+    QCOMPARE(session.journalGeneration, journal.generation());
+
+    InitiativeTracker recovered;
+    ChangeJournal recoveredJournal(&recovered, snapshotFile, journalFile);
+    QVERIFY(recoveredJournal.recover());
+    compareTrackers(recovered, tracker);
+}
+
+void TestChangeJournal::testTornTail()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString snapshotFile = dir.filePath("roster.dndsnap");
+    const QString journalFile = dir.filePath("roster.journal");
+
+    InitiativeTracker tracker;
+    qint64 sizeBeforeLast = 0;
+    {
+        ChangeJournal journal(&tracker, snapshotFile, journalFile);
+        QVERIFY(journal.start());
+        tracker.addCharacter(Character("Goblin", 2));
+        tracker.addCharacter(Character("Ork", 1));
+        sizeBeforeLast = journal.size();
+        tracker.addCharacter(Character("Troll", 0));
+    }
+
+    // Der letzte Eintrag wurde nur zur Hälfte geschrieben
+    QFile file(journalFile);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QVERIFY(file.resize(sizeBeforeLast + (file.size() - sizeBeforeLast) / 2));
+    file.close();
+
+    InitiativeTracker recovered;
+    ChangeJournal journal(&recovered, snapshotFile, journalFile);
+    QVERIFY(journal.recover());
+    QCOMPARE(recovered.size(), 2);
+    QCOMPARE(recovered.store().name(1), QString("Ork"));
+}
+
+void TestChangeJournal::testStaleJournal()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString snapshotFile = dir.filePath("roster.dndsnap");
+    const QString journalFile = dir.filePath("roster.journal");
+
+    InitiativeTracker tracker;
+    {
+        ChangeJournal journal(&tracker, snapshotFile, journalFile);
+        QVERIFY(journal.start());
+        tracker.addCharacter(Character("Goblin", 2));
+    }
+
+    // Ein später geschriebener Snapshot enthält das Journal bereits
+    tracker.addCharacter(Character("Ork", 1));
+    QVERIFY(tracker.saveSnapshot(snapshotFile));
+
+    InitiativeTracker recovered;
+    ChangeJournal journal(&recovered, snapshotFile, journalFile);
+    QVERIFY(!journal.recover());
+    QVERIFY(recovered.isEmpty());
+
+    // Die neue Generation unterscheidet sich von der des alten Journals
+    QVERIFY(recovered.loadSnapshot(snapshotFile));
+    QVERIFY(journal.start());
+    QVERIFY(journal.generation() > 1);
+    QCOMPARE(recovered.size(), 2);
+}
+
+QTEST_MAIN(TestChangeJournal)
+#include "tst_changejournal.moc"
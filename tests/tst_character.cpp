@@ -1,5 +1,7 @@
 #include <QtTest>
+#include <QThread>
 #include "../src/character.h"
+#include "../src/randomstream.h"
 
 /**
  * @brief Die TestCharacter-Klasse enthält Unit-Tests für die Character-Klasse.
@@ -44,6 +46,30 @@ private slots:
      */
     void testGetTotalInitiative();
 
+    /**
+     * @brief Testet, ob gleicher Basis-Seed dieselben Würfe liefert.
+     */
+    void testDeterministicBaseSeed();
+
+    /**
+     * @brief Testet, ob jeder Thread einen eigenen Stream erhält.
+     */
+    void testThreadsUseSeparateStreams();
+
+    /**
+     * @brief Testet, ob festgelegte Streams unabhängig von der Thread-Reihenfolge sind.
+     */
+    void testFixedStreamsAreReproducible();
+
+    /**
+     * @brief Testet, ob ein Character nicht mehr Speicher belegt als vorgesehen.
+     */
+    void testMemoryBudget();
+
+    /**
+     * @brief Testet, ob Werte außerhalb des gepackten Bereichs begrenzt werden.
+     */
+    void testPackedValueRange();
 
 private:
     Character *m_character;
@@ -134,5 +160,159 @@ void TestCharacter::testGetTotalInitiative()
     delete m_character;
 }
 
+void TestCharacter::testDeterministicBaseSeed()
+{
+    // Würfelt zweimal mit demselben Basis-Seed
+    QVector<int> first;
+    RandomStream::setBaseSeed(1234);
+    for (int i = 0; i < 50; ++i) {
+        first.append(Character::rollD20());
+    }
+
+    QVector<int> second;
+    RandomStream::setBaseSeed(1234);
+    for (int i = 0; i < 50; ++i) {
+        second.append(Character::rollD20());
+    }
+
+    // Überprüft, ob beide Folgen übereinstimmen
+    QCOMPARE(first, second);
+    QCOMPARE(RandomStream::localStream(), 0);
+
+    delete m_character;
+}
+
+void TestCharacter::testThreadsUseSeparateStreams()
+{
+    RandomStream::setBaseSeed(99);
+    const int mainStream = RandomStream::localStream();
+
+    // Würfelt in mehreren Threads gleichzeitig
+    const int threadCount = 4;
+    QVector<int> streams(threadCount, -1);
+    QVector<bool> inRange(threadCount, false);
+    QVector<QThread *> threads;
+    for (int t = 0; t < threadCount; ++t) {
+        threads.append(QThread::create([t, &streams, &inRange]() {
+            Character character("Thread", 0);
+            bool ok = true;
+            for (int i = 0; i < 10000; ++i) {
+                character.rollInitiative();
+                ok = ok && character.getInitiativeRoll() >= 1 && character.getInitiativeRoll() <= 20;
+            }
+            streams[t] = RandomStream::localStream();
+            inRange[t] = ok;
+        }));
+        threads.last()->start();
+    }
+    for (QThread *thread : threads) {
+        thread->wait();
+        delete thread;
+    }
+
+    // Überprüft, ob alle Stream-Nummern verschieden sind
+    for (int t = 0; t < threadCount; ++t) {
+        QVERIFY(inRange[t]);
+        QVERIFY(streams[t] != mainStream);
+        for (int u = t + 1; u < threadCount; ++u) {
+            QVERIFY(streams[t] != streams[u]);
+        }
+    }
+
+    delete m_character;
+}
+
+void TestCharacter::testFixedStreamsAreReproducible()
+{
+    const int threadCount = 4;
+
+    // Jeder Worker wählt seinen Stream über seinen Index; der zweite Lauf
+    // startet die Threads in umgekehrter Reihenfolge
+    auto run = [threadCount](bool reversed) {
+        RandomStream::setBaseSeed(7);
+        QVector<QVector<int>> rolls(threadCount);
+        QVector<QThread *> threads;
+        for (int i = 0; i < threadCount; ++i) {
+            const int worker = reversed ? threadCount - 1 - i : i;
+            threads.append(QThread::create([worker, &rolls]() {
+                RandomStream::setLocalStream(worker);
+                for (int r = 0; r < 20; ++r) {
+                    rolls[worker].append(RandomStream::rollD20());
+                }
+            }));
+            threads.last()->start();
+        }
+        for (QThread *thread : threads) {
+            thread->wait();
+            delete thread;
+        }
+        return rolls;
+    };
+
+    const QVector<QVector<int>> first = run(false);
+    const QVector<QVector<int>> second = run(true);
+    QCOMPARE(first, second);
+    QVERIFY(first[0] != first[1]);
+
+    // Ein festgelegter Stream 0 ist nicht der automatische Stream 0
+    RandomStream::setBaseSeed(7);
+    QVector<int> automatic;
+    for (int r = 0; r < 20; ++r) {
+        automatic.append(RandomStream::rollD20());
+    }
+    QCOMPARE(RandomStream::localStream(), 0);
+    QVERIFY(!RandomStream::hasFixedLocalStream());
+    QVERIFY(automatic != first[0]);
+
+    // Der festgelegte Stream bleibt über setBaseSeed() erhalten
+    RandomStream::setLocalStream(2);
+    RandomStream::setBaseSeed(7);
+    QCOMPARE(RandomStream::localStream(), 2);
+    QVERIFY(RandomStream::hasFixedLocalStream());
+    RandomStream::setLocalStream(-1);
+    QVERIFY(!RandomStream::hasFixedLocalStream());
+
+    delete m_character;
+}
+
+void TestCharacter::testMemoryBudget()
+{
+    // Name plus 4 Modifikatoren zu 16 Bit und 4 Würfe zu 8 Bit, auf die
+    // Ausrichtung des QString aufgerundet; vorher waren es 8 ints (32 Byte)
+    const size_t valuesBudget = (12 + alignof(QString) - 1) / alignof(QString) * alignof(QString);
+    QVERIFY2(sizeof(Character) <= sizeof(QString) + valuesBudget,
+             qPrintable(QString("sizeof(Character) = %1").arg(sizeof(Character))));
+    QVERIFY(sizeof(Character) < sizeof(QString) + 8 * sizeof(int));
+
+    delete m_character;
+}
+
+void TestCharacter::testPackedValueRange()
+{
+    // Übliche Werte kommen unverändert zurück
+    Character character("Drache", -5, 12, -3, 30);
+    character.setInitiativeRoll(20);
+    character.setLastWillSaveRoll(1);
+    QCOMPARE(character.getInitiativeModifier(), -5);
+    QCOMPARE(character.getWillSave(), 12);
+    QCOMPARE(character.getReflexSave(), -3);
+    QCOMPARE(character.getFortitudeSave(), 30);
+    QCOMPARE(character.getInitiativeRoll(), 20);
+    QCOMPARE(character.getLastWillSaveRoll(), 1);
+    QCOMPARE(character.getTotalInitiative(), 15);
+
+    // Werte außerhalb des Typs werden auf dessen Grenzen begrenzt
+    character.setInitiativeModifier(100000);
+    character.setReflexSave(-100000);
+    character.setInitiativeRoll(1000);
+    character.setLastFortitudeSaveRoll(-1);
+    QCOMPARE(character.getInitiativeModifier(), 32767);
+    QCOMPARE(character.getReflexSave(), -32768);
+    QCOMPARE(character.getInitiativeRoll(), 255);
+    QCOMPARE(character.getLastFortitudeSaveRoll(), 0);
+
+    delete m_character;
+}
+
 QTEST_APPLESS_MAIN(TestCharacter)
 #include "tst_character.moc" 
\ No newline at end of file
@@ -0,0 +1,282 @@
+#include <QtTest>
+#include "../src/characterstore.h"
+
+/**
+ * @brief Die TestCharacterStore-Klasse enthält Unit-Tests für die CharacterStore-Klasse.
+ */
+class TestCharacterStore : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    /**
+     * @brief Testet, ob ein angehängter Charakter unverändert zurückgegeben wird.
+     */
+    void testAppendAndAt();
+
+    /**
+     * @brief Testet das Entfernen aus allen Spalten.
+     */
+    void testRemoveAt();
+
+    /**
+     * @brief Testet den direkten Zugriff auf eine Spalte.
+     */
+    void testColumnAccess();
+
+    /**
+     * @brief Testet Sichten und Iteratoren ohne Kopie.
+     */
+    void testViewsAndIteration();
+
+    /**
+     * @brief Testet, ob eine Kopie des Stores spätere Änderungen nicht sieht.
+     */
+    void testCopyIsSnapshot();
+
+    /**
+     * @brief Testet, ob gleiche Namen dieselbe Id im NamePool bekommen.
+     */
+    void testInternedNames();
+
+    /**
+     * @brief Testet die schmalen Spalten und das Begrenzen auf jedem Schreibweg.
+     */
+    void testNarrowColumns();
+
+    /**
+     * @brief Testet, ob nicht mehr benutzte Namen aus dem NamePool entfernt werden.
+     */
+    void testCompactNames();
+};
+
+void TestCharacterStore::testAppendAndAt()
+{
+    // Erstellt einen Charakter mit gewürfelten Werten
+    Character character("Goblin", 2, 1, 3, -1);
+    character.setInitiativeRoll(14);
+    character.setLastWillSaveRoll(5);
+    character.setLastReflexSaveRoll(17);
+    character.setLastFortitudeSaveRoll(9);
+
+    CharacterStore store;
+    store.append(character);
+
+    // Überprüft, ob alle Werte aus den Spalten wiederhergestellt werden
+    QCOMPARE(store.size(), 1);
+    Character restored = store.at(0);
+    QCOMPARE(restored.getName(), QString("Goblin"));
+    QCOMPARE(restored.getInitiativeModifier(), 2);
+    QCOMPARE(restored.getInitiativeRoll(), 14);
+    QCOMPARE(restored.getWillSave(), 1);
+    QCOMPARE(restored.getReflexSave(), 3);
+    QCOMPARE(restored.getFortitudeSave(), -1);
+    QCOMPARE(restored.getLastWillSaveRoll(), 5);
+    QCOMPARE(restored.getLastReflexSaveRoll(), 17);
+    QCOMPARE(restored.getLastFortitudeSaveRoll(), 9);
+    QCOMPARE(store.totalInitiative(0), 16);
+}
+
+void TestCharacterStore::testRemoveAt()
+{
+    CharacterStore store;
+    store.append(Character("Character 1", 1));
+    store.append(Character("Character 2", 2));
+    store.append(Character("Character 3", 3));
+
+    // Entfernt den mittleren Charakter
+    store.removeAt(1);
+
+    // Überprüft, ob Namen und Werte gemeinsam verschoben wurden
+    QCOMPARE(store.size(), 2);
+    QCOMPARE(store.name(1), QString("Character 3"));
+    QCOMPARE(store.value(1, CharacterStore::InitiativeModifier), 3);
+}
+
+void TestCharacterStore::testColumnAccess()
+{
+    CharacterStore store;
+    for (int i = 0; i < 10; ++i) {
+        store.append(Character(QString("Skeleton %1").arg(i), i));
+    }
+
+    // Schreibt direkt in die Wurf-Spalte
+    CharacterStore::RollValue *rolls = store.rollColumn(CharacterStore::InitiativeRoll);
+    for (int i = 0; i < store.size(); ++i) {
+        rolls[i] = 20 - i;
+    }
+
+    // Überprüft, ob die Werte beim Charakter ankommen
+    for (int i = 0; i < store.size(); ++i) {
+        QCOMPARE(store.at(i).getInitiativeRoll(), 20 - i);
+        QCOMPARE(store.totalInitiative(i), 20);
+    }
+}
+
+void TestCharacterStore::testViewsAndIteration()
+{
+    CharacterStore store;
+    for (int i = 0; i < 5; ++i) {
+        Character character(QString("Orc %1").arg(i), i, i + 1, i + 2, i + 3);
+        character.setInitiativeRoll(10 + i);
+        store.append(character);
+    }
+
+    // Die Sicht liest dieselben Werte wie die zusammengesetzte Kopie
+    int visited = 0;
+    for (CharacterView view : store) {
+        Character copy = store.at(view.index());
+        QCOMPARE(view.index(), visited);
+        QCOMPARE(view.getName(), copy.getName());
+        QCOMPARE(view.getInitiativeModifier(), copy.getInitiativeModifier());
+        QCOMPARE(view.getTotalInitiative(), copy.getTotalInitiative());
+        QCOMPARE(view.getFortitudeSave(), copy.getFortitudeSave());
+        ++visited;
+    }
+    QCOMPARE(visited, store.size());
+
+    // Die Sicht kopiert nichts und sieht daher spätere Änderungen
+    CharacterView view = store.view(2);
+    store.setValue(2, CharacterStore::WillSave, 9);
+    QCOMPARE(view.getWillSave(), 9);
+    QCOMPARE(&view.getName(), &store.name(2));
+}
+
+void TestCharacterStore::testCopyIsSnapshot()
+{
+    CharacterStore store;
+    store.append(Character("Troll", 1));
+
+    // Kopie teilt sich die Spalten, bis der Store geändert wird
+    // (nur über const lesen, da modifierColumn() sonst die Spalte abkoppelt)
+    const CharacterStore snapshot = store;
+    const CharacterStore &original = store;
+    QCOMPARE(snapshot.modifierColumn(CharacterStore::InitiativeModifier),
+             original.modifierColumn(CharacterStore::InitiativeModifier));
+
+    store.setValue(0, CharacterStore::InitiativeModifier, 7);
+    store.append(Character("Oger", 2));
+
+    QCOMPARE(snapshot.size(), 1);
+    QCOMPARE(snapshot.value(0, CharacterStore::InitiativeModifier), 1);
+    QCOMPARE(store.value(0, CharacterStore::InitiativeModifier), 7);
+}
+
+void TestCharacterStore::testInternedNames()
+{
+    CharacterStore store;
+    for (int i = 0; i < 100; ++i) {
+        store.append(Character(i % 2 ? "Goblin" : "Skelett", 1));
+    }
+
+    // Zwei unterschiedliche Namen plus der leere Name
+    QCOMPARE(store.namePool().size(), 3);
+    QCOMPARE(store.nameId(1), store.nameId(99));
+    QVERIFY(store.nameId(0) != store.nameId(1));
+    QCOMPARE(&store.name(1), &store.name(99));
+
+    // Derselbe Name ist keine Änderung
+    QCOMPARE(store.set(1, store.at(1)), CharacterStore::FieldMask(0));
+    Character renamed = store.at(1);
+    renamed.setName("Skelett");
+    QCOMPARE(store.set(1, renamed), CharacterStore::NameBit);
+    QCOMPARE(store.nameId(1), store.nameId(0));
+    QCOMPARE(store.namePool().size(), 3);
+
+    // Ein Schnappschuss sieht keine später aufgenommenen Namen
+    const CharacterStore snapshot = store;
+    store.setName(0, "Oger");
+    QCOMPARE(snapshot.namePool().size(), 3);
+    QCOMPARE(snapshot.name(0), QString("Skelett"));
+    QCOMPARE(store.name(0), QString("Oger"));
+
+    // Neue Zeilen haben den leeren Namen
+    store.resize(101);
+    QCOMPARE(store.nameId(100), NamePool::EmptyId);
+    QVERIFY(store.name(100).isEmpty());
+
+    store.clear();
+    QCOMPARE(store.namePool().size(), 1);
+}
+
+void TestCharacterStore::testNarrowColumns()
+{
+    // 4 Modifikatoren zu 16 Bit, 4 Würfe zu 8 Bit, 5 Schlüssel/Ereignisse und
+    // die Namens-Id zu 32 Bit; vorher waren es 13 ints und die Id (56 Byte)
+    QCOMPARE(sizeof(CharacterStore::ModifierValue), sizeof(qint16));
+    QCOMPARE(sizeof(CharacterStore::RollValue), sizeof(quint8));
+    QVERIFY2(CharacterStore::BytesPerRow <= 36,
+             qPrintable(QString("BytesPerRow = %1").arg(CharacterStore::BytesPerRow)));
+
+    CharacterStore store;
+    store.append(Character("Titan", 40000));
+    store.append(Character("Wurm", -40000));
+
+    // Anhängen begrenzt wie Character
+    QCOMPARE(store.value(0, CharacterStore::InitiativeModifier), 32767);
+    QCOMPARE(store.value(1, CharacterStore::InitiativeModifier), -32768);
+
+    // setValue() begrenzt Modifikatoren und Würfe, Schlüssel bleiben unverändert
+    store.setValue(0, CharacterStore::WillSave, -50000);
+    store.setValue(0, CharacterStore::InitiativeRoll, 300);
+    store.setValue(1, CharacterStore::LastReflexSaveRoll, -4);
+    store.setValue(1, CharacterStore::RollKey, 100000);
+    QCOMPARE(store.value(0, CharacterStore::WillSave), -32768);
+    QCOMPARE(store.value(0, CharacterStore::InitiativeRoll), 255);
+    QCOMPARE(store.value(1, CharacterStore::LastReflexSaveRoll), 0);
+    QCOMPARE(store.value(1, CharacterStore::RollKey), 100000);
+
+    // set() meldet nur echte Änderungen des begrenzten Werts
+    Character same = store.at(0);
+    same.setInitiativeRoll(300);
+    QCOMPARE(store.set(0, same), CharacterStore::FieldMask(0));
+
+    // writeValues() begrenzt wie die Loader, readValues() liest als int zurück
+    const int values[2] = { 1000, -1 };
+    store.writeValues(CharacterStore::LastFortitudeSaveRoll, 0, 2, values);
+    int read[2] = { 0, 0 };
+    store.readValues(CharacterStore::LastFortitudeSaveRoll, 0, 2, read);
+    QCOMPARE(read[0], 255);
+    QCOMPARE(read[1], 0);
+    QCOMPARE(store.at(0).getLastFortitudeSaveRoll(), 255);
+}
+
+void TestCharacterStore::testCompactNames()
+{
+    CharacterStore store;
+    for (int i = 0; i < 100; ++i) {
+        store.append(Character(QString("Goblin %1").arg(i), 1));
+    }
+    for (int i = 0; i < 100; ++i) {
+        store.setName(i, i % 2 ? "Goblin" : "Ork");
+    }
+    store.setName(98, QString());
+    QCOMPARE(store.namePool().size(), 103);
+
+    // Nur die benutzten Namen bleiben, die Charaktere behalten ihre Namen
+    const CharacterStore snapshot = store;
+    QCOMPARE(store.compactNames(), 100);
+    QCOMPARE(store.namePool().size(), 3);
+    QCOMPARE(store.name(0), QString("Ork"));
+    QCOMPARE(store.name(99), QString("Goblin"));
+    QCOMPARE(store.nameId(98), NamePool::EmptyId);
+    QCOMPARE(store.nameId(1), store.nameId(97));
+    QCOMPARE(store.namePool().find("Goblin 1"), NamePool::InvalidId);
+
+    // Ein Schnappschuss behält seinen Pool
+    QCOMPARE(snapshot.namePool().size(), 103);
+    QCOMPARE(snapshot.name(1), QString("Goblin"));
+
+    // Ohne unbenutzte Namen ändert sich nichts
+    QCOMPARE(store.compactNames(), 0);
+    store.removeAt(0);
+    QCOMPARE(store.compactNames(), 0);
+    for (int i = 1; i < store.size(); i += 2) {
+        store.setName(i, "Goblin");
+    }
+    QCOMPARE(store.compactNames(), 1);
+    QCOMPARE(store.namePool().size(), 2);
+}
+
+QTEST_APPLESS_MAIN(TestCharacterStore)
+#include "tst_characterstore.moc"
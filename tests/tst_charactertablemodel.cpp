@@ -0,0 +1,155 @@
+#include <QtTest>
+#include <QSignalSpy>
+#include <QAbstractItemModelTester>
+#include "../src/initiativetracker.h"
+#include "../src/charactertablemodel.h"
+
+/**
+ * @brief Die TestCharacterTableModel-Klasse enthält Unit-Tests für die CharacterTableModel-Klasse.
+ */
+class TestCharacterTableModel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    /**
+     * @brief Initialisierung vor jedem Test.
+     */
+    void init();
+
+    /**
+     * @brief Aufräumen nach jedem Test.
+     */
+    void cleanup();
+
+    /**
+     * @brief Testet, ob das Modell Zeilen des Trackers direkt anzeigt.
+     */
+    void testRowsFollowTracker();
+
+    /**
+     * @brief Testet die Darstellung der Wurfergebnisse.
+     */
+    void testResultText();
+
+    /**
+     * @brief Testet, ob ein einzelner Wurf nur die betroffene Zelle meldet.
+     */
+    void testSingleRollChangesOneCell();
+
+    /**
+     * @brief Testet das Bearbeiten der Modifikatoren über das Modell.
+     */
+    void testSetData();
+
+private:
+    InitiativeTracker *m_initiativeTracker;
+    CharacterTableModel *m_model;
+    QAbstractItemModelTester *m_tester;
+};
+
+void TestCharacterTableModel::init()
+{
+    m_initiativeTracker = new InitiativeTracker();
+    m_model = new CharacterTableModel(m_initiativeTracker);
+
+    // Prüft bei jeder Änderung, ob das Modell die Regeln von QAbstractItemModel einhält
+    m_tester = new QAbstractItemModelTester(m_model, QAbstractItemModelTester::FailureReportingMode::QtTest);
+}
+
+void TestCharacterTableModel::cleanup()
+{
+    delete m_tester;
+    delete m_model;
+    delete m_initiativeTracker;
+}
+
+void TestCharacterTableModel::testRowsFollowTracker()
+{
+    QCOMPARE(m_model->rowCount(), 0);
+    QCOMPARE(m_model->columnCount(), int(CharacterTableModel::ColumnCount));
+
+    m_initiativeTracker->addCharacter(Character("Goblin", 2));
+    m_initiativeTracker->addCharacter(Character("Ork", 1));
+    QCOMPARE(m_model->rowCount(), 2);
+    QCOMPARE(m_model->index(1, CharacterTableModel::NameColumn).data().toString(), QString("Ork"));
+    QCOMPARE(m_model->index(0, CharacterTableModel::InitiativeModifierColumn).data().toInt(), 2);
+
+    // Vor dem Entfernen sind die Daten der Zeile noch lesbar
+    QString aboutToBeRemoved;
+    connect(m_model, &QAbstractItemModel::rowsAboutToBeRemoved, this,
+            [this, &aboutToBeRemoved](const QModelIndex &, int first, int) {
+                aboutToBeRemoved = m_model->index(first, CharacterTableModel::NameColumn).data().toString();
+            });
+    m_initiativeTracker->removeCharacter(0);
+    QCOMPARE(aboutToBeRemoved, QString("Goblin"));
+    QCOMPARE(m_model->rowCount(), 1);
+    QCOMPARE(m_model->index(0, CharacterTableModel::NameColumn).data().toString(), QString("Ork"));
+
+    m_initiativeTracker->clearCharacters();
+    QCOMPARE(aboutToBeRemoved, QString("Ork"));
+    QCOMPARE(m_model->rowCount(), 0);
+    disconnect(m_model, &QAbstractItemModel::rowsAboutToBeRemoved, this, nullptr);
+}
+
+void TestCharacterTableModel::testResultText()
+{
+    m_initiativeTracker->addCharacter(Character("Goblin", 3));
+    const QModelIndex total = m_model->index(0, CharacterTableModel::TotalInitiativeColumn);
+
+    // Ohne Wurf wird ein Strich angezeigt und ans Ende sortiert
+    QCOMPARE(total.data().toString(), QString("-"));
+    QCOMPARE(total.data(CharacterTableModel::SortRole).toInt(), INT_MIN);
+
+    Character goblin = m_initiativeTracker->getCharacter(0);
+    goblin.setInitiativeRoll(14);
+    m_initiativeTracker->updateCharacter(0, goblin);
+    QCOMPARE(total.data().toString(), QString("17 (14)"));
+    QCOMPARE(total.data(CharacterTableModel::SortRole).toInt(), 17);
+}
+
+void TestCharacterTableModel::testSingleRollChangesOneCell()
+{
+    for (int i = 0; i < 5; ++i) {
+        m_initiativeTracker->addCharacter(Character(QString("Goblin %1").arg(i), i));
+    }
+
+    QSignalSpy dataChangedSpy(m_model, &QAbstractItemModel::dataChanged);
+    QSignalSpy resetSpy(m_model, &QAbstractItemModel::modelReset);
+
+    m_initiativeTracker->rollReflexSaveForCharacter(3);
+
+    // Nur die Ergebnisspalte der gewürfelten Zeile wird gemeldet
+    QCOMPARE(resetSpy.count(), 0);
+    QCOMPARE(dataChangedSpy.count(), 1);
+    const QModelIndex topLeft = dataChangedSpy.at(0).at(0).value<QModelIndex>();
+    const QModelIndex bottomRight = dataChangedSpy.at(0).at(1).value<QModelIndex>();
+    QCOMPARE(topLeft.row(), 3);
+    QCOMPARE(bottomRight.row(), 3);
+    QCOMPARE(topLeft.column(), int(CharacterTableModel::ReflexResultColumn));
+    QCOMPARE(bottomRight.column(), int(CharacterTableModel::ReflexResultColumn));
+}
+
+void TestCharacterTableModel::testSetData()
+{
+    m_initiativeTracker->addCharacter(Character("Goblin", 2, 1, 0, 0));
+    const QModelIndex will = m_model->index(0, CharacterTableModel::WillSaveColumn);
+    const QModelIndex name = m_model->index(0, CharacterTableModel::NameColumn);
+
+    QVERIFY(m_model->flags(will) & Qt::ItemIsEditable);
+    QVERIFY(!(m_model->flags(name) & Qt::ItemIsEditable));
+
+    // Ungültige Eingaben und nicht editierbare Spalten werden abgelehnt
+    QVERIFY(!m_model->setData(will, QString("abc")));
+    QVERIFY(!m_model->setData(name, QString("Ork")));
+    QCOMPARE(m_initiativeTracker->getCharacter(0).getWillSave(), 1);
+
+    QSignalSpy dataChangedSpy(m_model, &QAbstractItemModel::dataChanged);
+    QVERIFY(m_model->setData(will, 4));
+    QCOMPARE(m_initiativeTracker->getCharacter(0).getWillSave(), 4);
+    QCOMPARE(will.data().toInt(), 4);
+    QCOMPARE(dataChangedSpy.count(), 1);
+}
+
+QTEST_MAIN(TestCharacterTableModel)
+#include "tst_charactertablemodel.moc"
@@ -0,0 +1,243 @@
+#include <QtTest>
+#include <QSignalSpy>
+#include "../src/commanddispatcher.h"
+#include "../src/initiativetracker.h"
+
+/**
+ * @brief Die TestCommandDispatcher-Klasse enthält Unit-Tests für die Befehlstabelle der WebSocket-Schnittstelle.
+ */
+class TestCommandDispatcher : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    /**
+     * @brief Testet, ob die Standardbefehle den Tracker würfeln lassen.
+     */
+    void testDefaultCommands();
+
+    /**
+     * @brief Testet die Antworten auf unbekannte und fehlende Befehle.
+     */
+    void testUnknownCommand();
+
+    /**
+     * @brief Testet eigene Befehle, das Ersetzen und fehlschlagende Befehle.
+     */
+    void testRegisterCommand();
+
+    /**
+     * @brief Testet, ob Erfolgsantworten vorab gebaut und geteilt werden.
+     */
+    void testPrebuiltResponses();
+
+    /**
+     * @brief Testet einen Stapel von Befehlen mit einer Benachrichtigung und einer Antwort.
+     */
+    void testBatch();
+
+    /**
+     * @brief Testet, ob fehlerhafte Stapel abgelehnt oder abgebrochen werden.
+     */
+    void testBatchErrors();
+};
+
+void TestCommandDispatcher::testDefaultCommands()
+{
+    InitiativeTracker tracker;
+    tracker.addCharacter(Character("Aragorn", 3));
+    tracker.addCharacter(Character("Gimli", 1));
+    CommandDispatcher dispatcher(&tracker);
+
+    QCOMPARE(dispatcher.commands(), QStringList({ "rollFortitudeSave", "rollInitiative",
+                                                  "rollReflexSave", "rollWillSave" }));
+
+    QSignalSpy initiative(&tracker, &InitiativeTracker::initiativeRolled);
+    QSignalSpy saves(&tracker, &InitiativeTracker::savesRolled);
+
+    CommandDispatcher::Response response = dispatcher.dispatch(QJsonObject{ { "command", "rollInitiative" } });
+    QVERIFY(response.success);
+    QCOMPARE(response.object["status"].toString(), QString("success"));
+    QCOMPARE(response.object["message"].toString(), QString("Initiative für alle Charaktere gewürfelt"));
+    QCOMPARE(initiative.count(), 1);
+    QVERIFY(tracker.getCharacters().at(0).getInitiativeRoll() >= 1);
+
+    for (const char *command : { "rollWillSave", "rollReflexSave", "rollFortitudeSave" }) {
+        response = dispatcher.dispatch(QJsonObject{ { "command", command } });
+        QVERIFY2(response.success, command);
+    }
+    QCOMPARE(saves.count(), 3);
+    QVERIFY(tracker.verifyRolls());
+}
+
+void TestCommandDispatcher::testUnknownCommand()
+{
+    InitiativeTracker tracker;
+    CommandDispatcher dispatcher(&tracker);
+
+    CommandDispatcher::Response response = dispatcher.dispatch(QJsonObject{ { "command", "fireball" } });
+    QVERIFY(!response.success);
+    QCOMPARE(response.object["status"].toString(), QString("error"));
+    QCOMPARE(response.object["message"].toString(), QString("Unbekannter Befehl: fireball"));
+    QCOMPARE(QJsonDocument::fromJson(response.json).object(), response.object);
+
+    // Groß- und Kleinschreibung zählen wie bisher
+    QVERIFY(!dispatcher.dispatch(QJsonObject{ { "command", "RollInitiative" } }).success);
+    QVERIFY(!dispatcher.dispatch(QJsonObject{ { "command", 42 } }).success);
+    QVERIFY(!dispatcher.dispatch(QJsonObject()).success);
+}
+
+void TestCommandDispatcher::testRegisterCommand()
+{
+    InitiativeTracker tracker;
+    CommandDispatcher dispatcher(&tracker);
+
+    int calls = 0;
+    QString lastTarget;
+    dispatcher.registerCommand("ping", "pong", [&](const QJsonObject &message, QString *) {
+        ++calls;
+        lastTarget = message["target"].toString();
+        return true;
+    });
+    QVERIFY(dispatcher.contains("ping"));
+
+    CommandDispatcher::Response response = dispatcher.dispatch(QJsonObject{ { "command", "ping" },
+                                                                            { "target", "Gimli" } });
+    QVERIFY(response.success);
+    QCOMPARE(response.object["message"].toString(), QString("pong"));
+    QCOMPARE(calls, 1);
+    QCOMPARE(lastTarget, QString("Gimli"));
+
+    // Ein vorhandener Befehl wird ersetzt
+    QSignalSpy initiative(&tracker, &InitiativeTracker::initiativeRolled);
+    dispatcher.registerCommand("rollInitiative", "ersetzt", [&](const QJsonObject &, QString *) {
+        ++calls;
+        return true;
+    });
+    response = dispatcher.dispatch(QJsonObject{ { "command", "rollInitiative" } });
+    QCOMPARE(response.object["message"].toString(), QString("ersetzt"));
+    QCOMPARE(calls, 2);
+    QCOMPARE(initiative.count(), 0);
+    QCOMPARE(dispatcher.commands().size(), 5);
+
+    // Ein fehlschlagender Befehl liefert seine Fehlermeldung
+    dispatcher.registerCommand("fail", "nie", [](const QJsonObject &, QString *error) {
+        *error = "Kein Ziel";
+        return false;
+    });
+    response = dispatcher.dispatch(QJsonObject{ { "command", "fail" } });
+    QVERIFY(!response.success);
+    QCOMPARE(response.object["status"].toString(), QString("error"));
+    QCOMPARE(response.object["message"].toString(), QString("Kein Ziel"));
+}
+
+void TestCommandDispatcher::testPrebuiltResponses()
+{
+    InitiativeTracker tracker;
+    tracker.addCharacter(Character("Legolas", 4));
+    CommandDispatcher dispatcher(&tracker);
+
+    const QJsonObject message{ { "command", "rollWillSave" } };
+    const CommandDispatcher::Response first = dispatcher.dispatch(message);
+    const CommandDispatcher::Response second = dispatcher.dispatch(message);
+
+    // Beide Antworten teilen sich denselben Puffer, es wird nichts neu serialisiert
+    QCOMPARE(first.json.constData(), second.json.constData());
+    QCOMPARE(QJsonDocument::fromJson(first.json).object(), first.object);
+    QVERIFY(!first.json.contains('\n'));
+
+    // Die CBOR-Antwort für Binär-Clients ist ebenfalls vorab gebaut
+    QCOMPARE(first.cbor.constData(), second.cbor.constData());
+    QCOMPARE(&first.encoded(MessageCodec::Cbor), &first.cbor);
+    QJsonObject decoded;
+    QVERIFY(MessageCodec::decode(first.cbor, MessageCodec::Cbor, &decoded));
+    QCOMPARE(decoded, first.object);
+}
+
+void TestCommandDispatcher::testBatch()
+{
+    InitiativeTracker tracker;
+    tracker.addCharacter(Character("Aragorn", 3));
+    tracker.addCharacter(Character("Gimli", 1));
+    CommandDispatcher dispatcher(&tracker);
+
+    QSignalSpy initiative(&tracker, &InitiativeTracker::initiativeRolled);
+    QSignalSpy saves(&tracker, &InitiativeTracker::savesRolled);
+    QSignalSpy updated(&tracker, &InitiativeTracker::rowsUpdated);
+
+    const QJsonObject message{ { "commands", QJsonArray{ QJsonObject{ { "command", "rollInitiative" } },
+                                                         "rollWillSave", "rollReflexSave",
+                                                         "rollFortitudeSave" } } };
+    QVERIFY(CommandDispatcher::isCommand(message));
+    const CommandDispatcher::Response response = dispatcher.dispatch(message);
+    QVERIFY(response.success);
+    QCOMPARE(response.object["message"].toString(), QString("4 Befehle ausgeführt"));
+
+    const QJsonArray results = response.object["results"].toArray();
+    QCOMPARE(results.size(), 4);
+    QCOMPARE(results.at(0).toObject()["message"].toString(), QString("Initiative für alle Charaktere gewürfelt"));
+    QCOMPARE(results.at(3).toObject()["message"].toString(), QString("Konstitution für alle Charaktere gewürfelt"));
+
+    // Der Tracker meldet alle vier Würfe zusammen
+    QCOMPARE(initiative.count(), 1);
+    QCOMPARE(saves.count(), 1);
+    QCOMPARE(updated.count(), 1);
+    QVERIFY(tracker.verifyRolls());
+
+    // Die kodierten Formen enthalten dieselbe Antwort
+    QJsonObject decoded;
+    QVERIFY(MessageCodec::decode(response.cbor, MessageCodec::Cbor, &decoded));
+    QCOMPARE(decoded, response.object);
+    QCOMPARE(QJsonDocument::fromJson(response.json).object(), response.object);
+}
+
+void TestCommandDispatcher::testBatchErrors()
+{
+    InitiativeTracker tracker;
+    tracker.addCharacter(Character("Legolas", 4));
+    CommandDispatcher dispatcher(&tracker);
+    QSignalSpy initiative(&tracker, &InitiativeTracker::initiativeRolled);
+
+    // Ein unbekannter Befehl verhindert den ganzen Stapel
+    CommandDispatcher::Response response =
+        dispatcher.dispatch(QJsonObject{ { "commands", QJsonArray{ "rollInitiative", "fireball" } } });
+    QVERIFY(!response.success);
+    QCOMPARE(response.object["message"].toString(), QString("Befehl 2: Unbekannter Befehl: fireball"));
+    QCOMPARE(initiative.count(), 0);
+
+    QVERIFY(!dispatcher.dispatch(QJsonObject{ { "commands", "rollInitiative" } }).success);
+    QVERIFY(!dispatcher.dispatchBatch(QJsonArray()).success);
+
+    QJsonArray tooMany;
+    for (int i = 0; i <= CommandDispatcher::MaxBatchSize; ++i) {
+        tooMany.append("rollInitiative");
+    }
+    QVERIFY(!dispatcher.dispatchBatch(tooMany).success);
+    QCOMPARE(initiative.count(), 0);
+
+    // Ein fehlschlagender Befehl bricht ab und nimmt die vorherigen zurück
+    const int roll = tracker.getCharacter(0).getInitiativeRoll();
+    const quint64 events = tracker.rollEventCount();
+    int calls = 0;
+    dispatcher.registerCommand("fail", "nie", [](const QJsonObject &, QString *error) {
+        *error = "Kein Ziel";
+        return false;
+    });
+    dispatcher.registerCommand("count", "gezählt", [&](const QJsonObject &, QString *) {
+        ++calls;
+        return true;
+    });
+    response = dispatcher.dispatchBatch(QJsonArray{ "rollInitiative", "fail", "count" });
+    QVERIFY(!response.success);
+    QCOMPARE(response.object["message"].toString(), QString("Befehl 2 fehlgeschlagen, keine Änderung übernommen"));
+    const QJsonArray results = response.object["results"].toArray();
+    QCOMPARE(results.size(), 2);
+    QCOMPARE(results.at(1).toObject()["message"].toString(), QString("Kein Ziel"));
+    QCOMPARE(calls, 0);
+    QCOMPARE(tracker.getCharacter(0).getInitiativeRoll(), roll);
+    QCOMPARE(tracker.rollEventCount(), events);
+    QCOMPARE(tracker.getCharacters().size(), 1);
+}
+
+QTEST_MAIN(TestCommandDispatcher)
+#include "tst_commanddispatcher.moc"
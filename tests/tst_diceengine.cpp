@@ -0,0 +1,129 @@
+#include <QtTest>
+#include <QVector>
+#include "../src/diceengine.h"
+
+/**
+ * @brief Die TestDiceEngine-Klasse enthält Unit-Tests für die DiceEngine-Klasse.
+ */
+class TestDiceEngine : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    /**
+     * @brief Vergleicht Philox4x32-10 mit den Referenzwerten von Random123.
+     */
+    void testPhiloxKnownAnswers();
+
+    /**
+     * @brief Testet, ob der AVX2-Pfad dieselben Werte liefert wie der skalare Pfad.
+     */
+    void testSimdMatchesScalar_data();
+    void testSimdMatchesScalar();
+
+    /**
+     * @brief Testet das Füllen eines Abschnitts ab einer beliebigen Position.
+     */
+    void testFillFromOffset();
+
+    /**
+     * @brief Testet, ob einzelne Würfe in O(1) nachgerechnet werden können.
+     */
+    void testD20AtMatchesBatch();
+
+    /**
+     * @brief Testet, ob aufeinanderfolgende Batches unterschiedliche Werte liefern.
+     */
+    void testBatchesDiffer();
+};
+
+void TestDiceEngine::testPhiloxKnownAnswers()
+{
+    quint32 out[4];
+
+    const quint32 zeroCounter[4] = { 0u, 0u, 0u, 0u };
+    const quint32 zeroKey[2] = { 0u, 0u };
+    DiceEngine::philox(zeroCounter, zeroKey, out);
+    QCOMPARE(out[0], 0x6627e8d5u);
+    QCOMPARE(out[1], 0xe169c58du);
+    QCOMPARE(out[2], 0xbc57ac4cu);
+    QCOMPARE(out[3], 0x9b00dbd8u);
+
+    const quint32 piCounter[4] = { 0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u };
+    const quint32 piKey[2] = { 0xa4093822u, 0x299f31d0u };
+    DiceEngine::philox(piCounter, piKey, out);
+    QCOMPARE(out[0], 0xd16cfe09u);
+    QCOMPARE(out[1], 0x94fdccebu);
+    QCOMPARE(out[2], 0x5001e420u);
+    QCOMPARE(out[3], 0x24126ea1u);
+}
+
+void TestDiceEngine::testSimdMatchesScalar_data()
+{
+    QTest::addColumn<int>("count");
+
+    // Auch Größen, die kein Vielfaches eines Durchlaufs sind
+    QTest::newRow("leer") << 0;
+    QTest::newRow("eins") << 1;
+    QTest::newRow("31") << 31;
+    QTest::newRow("32") << 32;
+    QTest::newRow("1000") << 1000;
+    QTest::newRow("100003") << 100003;
+    QTest::newRow("parallel") << 300007;
+}
+
+void TestDiceEngine::testSimdMatchesScalar()
+{
+    QFETCH(int, count);
+
+    QVector<int> fast(count);
+    QVector<int> scalar(count);
+    QVector<int> parallel(count);
+    DiceEngine::fillD20(0x1234567890abcdefULL, 3, 0, fast.data(), count);
+    DiceEngine::fillD20Scalar(0x1234567890abcdefULL, 3, 0, scalar.data(), count);
+    DiceEngine::fillD20Parallel(0x1234567890abcdefULL, 3, 0, parallel.data(), count);
+
+    QCOMPARE(fast, scalar);
+    QCOMPARE(parallel, scalar);
+    for (int value : fast) {
+        QVERIFY(value >= 1 && value <= 20);
+    }
+}
+
+void TestDiceEngine::testFillFromOffset()
+{
+    QVector<int> whole(200);
+    DiceEngine::fillD20(99, 1, 0, whole.data(), whole.size());
+
+    // Ein nicht ausgerichteter Abschnitt muss dieselben Werte liefern
+    QVector<int> part(150);
+    DiceEngine::fillD20(99, 1, 45, part.data(), part.size());
+    QCOMPARE(part, whole.mid(45, 150));
+}
+
+void TestDiceEngine::testD20AtMatchesBatch()
+{
+    DiceEngine engine(42);
+    QVector<int> rolls(500);
+    engine.rollD20(rolls.data(), rolls.size());
+
+    // Der erste Batch hat die Nummer 0
+    for (int i = 0; i < rolls.size(); ++i) {
+        QCOMPARE(DiceEngine::d20At(42, 0, i), rolls[i]);
+    }
+    QCOMPARE(engine.batch(), quint64(1));
+}
+
+void TestDiceEngine::testBatchesDiffer()
+{
+    DiceEngine engine(7);
+    QVector<int> first(256);
+    QVector<int> second(256);
+    engine.rollD20(first.data(), first.size());
+    engine.rollD20(second.data(), second.size());
+
+    QVERIFY(first != second);
+}
+
+QTEST_APPLESS_MAIN(TestDiceEngine)
+#include "tst_diceengine.moc"
@@ -0,0 +1,220 @@
+#include <QtTest>
+#include <QTemporaryDir>
+#include "../src/encounterarchive.h"
+#include "../src/initiativetracker.h"
+
+/**
+ * @brief Die TestEncounterArchive-Klasse enthält Unit-Tests für das Archiv mit mehreren Begegnungen.
+ */
+class TestEncounterArchive : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    /**
+     * @brief Testet, ob mehrere Begegnungen gespeichert und einzeln geladen werden.
+     */
+    void testSaveAndLoad();
+
+    /**
+     * @brief Testet das Ersetzen und Entfernen von Begegnungen.
+     */
+    void testReplaceAndRemove();
+
+    /**
+     * @brief Testet, ob eine Begegnung geladen wird, ohne die anderen zu lesen.
+     */
+    void testRandomAccess();
+
+    /**
+     * @brief Testet, ob beschädigte Archive abgelehnt werden.
+     */
+    void testRejectsCorruptFiles();
+
+    /**
+     * @brief Testet Speichern und Laden über den Tracker.
+     */
+    void testTrackerEncounters();
+
+private:
+    /**
+     * @brief Erstellt eine Begegnung mit count gleichartigen Gegnern.
+     */
+    static CharacterStore makeEncounter(const QString &name, int count);
+};
+
+CharacterStore TestEncounterArchive::makeEncounter(const QString &name, int count)
+{
+    CharacterStore store;
+    for (int i = 0; i < count; ++i) {
+        store.append(Character(QString("%1 %2").arg(name).arg(i), i % 5, 1, 2, 3));
+        store.setValue(i, CharacterStore::InitiativeRoll, 1 + i % 20);
+    }
+    return store;
+}
+
+void TestEncounterArchive::testSaveAndLoad()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString filename = dir.filePath("kampagne.dndarch");
+
+    EncounterArchive archive(filename);
+    QVERIFY(!archive.open());
+    QVERIFY(archive.save("Goblinhöhle", makeEncounter("Goblin", 4), SnapshotFile::Session()));
+    SnapshotFile::Session session;
+    session.seed = 42;
+    session.rollEvents = 2;
+    session.nextRollKey = 7;
+    session.journalGeneration = 5;
+    QVERIFY(archive.save("Orklager", makeEncounter("Ork", 12), session));
+    QVERIFY(archive.save("Drachenhort", makeEncounter("Drache", 1), SnapshotFile::Session()));
+    QVERIFY(EncounterArchive::isArchive(filename));
+
+    EncounterArchive reopened(filename);
+    QVERIFY(reopened.open());
+    QCOMPARE(reopened.names(), QStringList({ "Goblinhöhle", "Orklager", "Drachenhort" }));
+    QCOMPARE(reopened.entries().at(1).characterCount, 12);
+    QVERIFY(reopened.contains("Orklager"));
+    QVERIFY(!reopened.contains("Gruft"));
+
+    CharacterStore loaded;
+    SnapshotFile::Session loadedSession;
+    QVERIFY(reopened.load("Orklager", &loaded, &loadedSession));
+    QCOMPARE(loaded.size(), 12);
+    QCOMPARE(loaded.name(11), QString("Ork 11"));
+    QCOMPARE(loaded.value(3, CharacterStore::InitiativeRoll), 4);
+    QCOMPARE(loadedSession.seed, session.seed);
+    QCOMPARE(loadedSession.nextRollKey, session.nextRollKey);
+
+    // Die Journal-Generation gehört nicht ins Archiv
+    QCOMPARE(loadedSession.journalGeneration, quint32(0));
+
+    QVERIFY(!reopened.load("Gruft", &loaded, &loadedSession));
+    QCOMPARE(loaded.size(), 12);
+}
+
+void TestEncounterArchive::testReplaceAndRemove()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString filename = dir.filePath("kampagne.dndarch");
+
+    EncounterArchive archive(filename);
+    QVERIFY(archive.save("A", makeEncounter("A", 3), SnapshotFile::Session()));
+    QVERIFY(archive.save("B", makeEncounter("B", 5), SnapshotFile::Session()));
+    QVERIFY(archive.save("C", makeEncounter("C", 2), SnapshotFile::Session()));
+
+    // Ersetzen behält die Reihenfolge
+    QVERIFY(archive.save("A", makeEncounter("Neu", 8), SnapshotFile::Session()));
+    QVERIFY(archive.remove("B"));
+    QVERIFY(!archive.remove("B"));
+
+    EncounterArchive reopened(filename);
+    QVERIFY(reopened.open());
+    QCOMPARE(reopened.names(), QStringList({ "A", "C" }));
+
+    CharacterStore loaded;
+    SnapshotFile::Session session;
+    QVERIFY(reopened.load("A", &loaded, &session));
+    QCOMPARE(loaded.size(), 8);
+    QCOMPARE(loaded.name(0), QString("Neu 0"));
+    QVERIFY(reopened.load("C", &loaded, &session));
+    QCOMPARE(loaded.size(), 2);
+    QCOMPARE(loaded.name(1), QString("C 1"));
+}
+
+void TestEncounterArchive::testRandomAccess()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString filename = dir.filePath("kampagne.dndarch");
+
+    EncounterArchive archive(filename);
+    QVERIFY(archive.save("A", makeEncounter("A", 50), SnapshotFile::Session()));
+    QVERIFY(archive.save("B", makeEncounter("B", 50), SnapshotFile::Session()));
+    QVERIFY(archive.save("C", makeEncounter("C", 50), SnapshotFile::Session()));
+
+    // Die Daten von A und C zerstören; B muss trotzdem ladbar sein
+    const QVector<EncounterArchive::Entry> entries = archive.entries();
+    QFile file(filename);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    for (int i : { 0, 2 }) {
+        QVERIFY(file.seek(qint64(entries.at(i).offset)));
+        file.write(QByteArray(int(entries.at(i).size), '\xff'));
+    }
+    file.close();
+
+    EncounterArchive reopened(filename);
+    QVERIFY(reopened.open());
+    CharacterStore loaded;
+    SnapshotFile::Session session;
+    QVERIFY(reopened.load("B", &loaded, &session));
+    QCOMPARE(loaded.size(), 50);
+    QVERIFY(!reopened.load("A", &loaded, &session));
+    QVERIFY(!reopened.load("C", &loaded, &session));
+    QCOMPARE(loaded.name(0), QString("B 0"));
+}
+
+void TestEncounterArchive::testRejectsCorruptFiles()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString filename = dir.filePath("kampagne.dndarch");
+
+    EncounterArchive archive(filename);
+    QVERIFY(archive.save("A", makeEncounter("A", 3), SnapshotFile::Session()));
+
+    QFile file(filename);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QByteArray original = file.readAll();
+    file.close();
+
+    // Abgeschnittener Index
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(original.left(original.size() - 2));
+    file.close();
+    QVERIFY(!EncounterArchive(filename).open());
+
+    // Falsche Version
+    QByteArray wrongVersion = original;
+    wrongVersion[8] = char(99);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(wrongVersion);
+    file.close();
+    QVERIFY(!EncounterArchive(filename).open());
+
+    // Ein Snapshot ist kein Archiv
+    QVERIFY(SnapshotFile::write(filename, makeEncounter("A", 1), SnapshotFile::Session()));
+    QVERIFY(!EncounterArchive::isArchive(filename));
+    QVERIFY(!EncounterArchive(filename).open());
+}
+
+void TestEncounterArchive::testTrackerEncounters()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString filename = dir.filePath("kampagne.dndarch");
+
+    InitiativeTracker tracker;
+    tracker.addCharacter(Character("Goblin", 2));
+    tracker.addCharacter(Character("Ork", 1));
+    tracker.rollAllInitiatives();
+    QVERIFY(tracker.saveEncounter(filename, "Hinterhalt"));
+
+    tracker.clearCharacters();
+    tracker.addCharacter(Character("Oger", 0));
+    QVERIFY(tracker.saveEncounter(filename, "Brücke"));
+
+    InitiativeTracker loaded;
+    QVERIFY(loaded.loadEncounter(filename, "Hinterhalt"));
+    QCOMPARE(loaded.size(), 2);
+    QCOMPARE(loaded.sessionSeed(), tracker.sessionSeed());
+    QVERIFY(loaded.verifyRolls());
+
+    QVERIFY(!loaded.loadEncounter(filename, "Gruft"));
+    QCOMPARE(loaded.size(), 2);
+}
+
+QTEST_MAIN(TestEncounterArchive)
+#include "tst_encounterarchive.moc"
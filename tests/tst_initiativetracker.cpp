@@ -1,6 +1,7 @@
 #include <QtTest>
 #include <QSignalSpy>
 #include "../src/initiativetracker.h"
+#include <limits>
 
 /**
  * @brief Die TestInitiativeTracker-Klasse enthält Unit-Tests für die InitiativeTracker-Klasse.
@@ -44,12 +45,37 @@ private slots:
      * @brief Testet das Sortieren der Charaktere nach Initiative.
      */
     void testGetSortedInitiativeOrder();
+    
+    /**
+     * @brief Testet, ob der Initiative-Index nach Einzelwürfen aktuell bleibt.
+     */
+    void testInitiativeRankAfterUpdates();
 
     /**
      * @brief Testet das Speichern und Laden der Charakterdaten.
      */
     void testSaveAndLoadFromFile();
 
+    /**
+     * @brief Testet das Speichern und Laden als binären Snapshot.
+     */
+    void testSaveAndLoadSnapshot();
+
+    /**
+     * @brief Testet das Nachrechnen und Prüfen von Würfen einer gespeicherten Sitzung.
+     */
+    void testReplayRollsFromSession();
+
+    /**
+     * @brief Testet die genauen Signale mit Zeilenbereich und Spaltenmaske.
+     */
+    void testRowSignals();
+
+    /**
+     * @brief Testet, ob ein ChangeBatch alle Änderungen zu einer Meldung zusammenfasst.
+     */
+    void testChangeBatch();
+
 private:
     InitiativeTracker *m_initiativeTracker;
     QSignalSpy *m_charactersChangedSpy;
@@ -186,6 +212,34 @@ void TestInitiativeTracker::testGetSortedInitiativeOrder()
     }
 }
 
+void TestInitiativeTracker::testInitiativeRankAfterUpdates()
+{
+    // Fügt Charaktere mit festen Würfen hinzu
+    for (int i = 0; i < 20; ++i) {
+        Character character(QString("Character %1").arg(i), i % 5);
+        character.setInitiativeRoll(1 + (i * 7) % 20);
+        m_initiativeTracker->addCharacter(character);
+    }
+    
+    // Ändert einzelne Schlüssel auf verschiedenen Wegen
+    m_initiativeTracker->rollInitiativeForCharacter(3);
+    m_initiativeTracker->setInitiativeModifier(7, 10);
+    m_initiativeTracker->removeCharacter(0);
+    m_initiativeTracker->rollInitiativeForCharacter(12);
+    
+    // Überprüft Reihenfolge und Rang gegen die aktuellen Werte
+    const QVector<int> &order = m_initiativeTracker->initiativeOrder().indices();
+    QCOMPARE(order.size(), 19);
+    for (int rank = 0; rank < order.size(); ++rank) {
+        QCOMPARE(m_initiativeTracker->initiativeRank(order[rank]), rank);
+        if (rank > 0) {
+            Character previous = m_initiativeTracker->getCharacter(order[rank - 1]);
+            Character current = m_initiativeTracker->getCharacter(order[rank]);
+            QVERIFY(previous.getTotalInitiative() >= current.getTotalInitiative());
+        }
+    }
+}
+
 void TestInitiativeTracker::testSaveAndLoadFromFile()
 {
     // Erstellt einen temporären Dateinamen für den Test
@@ -224,5 +278,217 @@ void TestInitiativeTracker::testSaveAndLoadFromFile()
     }
 }
 
+void TestInitiativeTracker::testSaveAndLoadSnapshot()
+{
+    QString tempFileName = "test_characters.dndsnap";
+    
+    m_initiativeTracker->addCharacter(Character("Character 1", 1, 2, 3, 4));
+    m_initiativeTracker->addCharacter(Character("Character 2", 2));
+    m_initiativeTracker->rollAllInitiatives();
+    m_initiativeTracker->rollWillSaveForCharacter(0);
+    QVERIFY(m_initiativeTracker->saveSnapshot(tempFileName));
+    
+    InitiativeTracker newTracker;
+    QSignalSpy resetSpy(&newTracker, &InitiativeTracker::rowsReset);
+    QVERIFY(newTracker.loadSnapshot(tempFileName));
+    QCOMPARE(resetSpy.count(), 1);
+    
+    // Charaktere, Würfe und Sitzung sind identisch
+    QCOMPARE(newTracker.size(), m_initiativeTracker->size());
+    for (int i = 0; i < newTracker.size(); ++i) {
+        QCOMPARE(newTracker.characterView(i).getName(), m_initiativeTracker->characterView(i).getName());
+        QCOMPARE(newTracker.characterView(i).getTotalInitiative(),
+                 m_initiativeTracker->characterView(i).getTotalInitiative());
+        QCOMPARE(newTracker.rollKey(i), m_initiativeTracker->rollKey(i));
+    }
+    QCOMPARE(newTracker.characterView(0).getLastWillSaveRoll(),
+             m_initiativeTracker->characterView(0).getLastWillSaveRoll());
+    QCOMPARE(newTracker.sessionSeed(), m_initiativeTracker->sessionSeed());
+    QCOMPARE(newTracker.rollEventCount(), m_initiativeTracker->rollEventCount());
+    QVERIFY(newTracker.verifyRolls());
+    
+    // Die Reihenfolge wurde für die geladenen Werte neu aufgebaut
+    QCOMPARE(newTracker.getSortedInitiativeOrder().first().getName(),
+             m_initiativeTracker->getSortedInitiativeOrder().first().getName());
+    
+    // Umbenennen hinterlässt alte Namen im Pool, bis gespeichert wird
+    for (int i = 0; i < 50; ++i) {
+        Character renamed = m_initiativeTracker->getCharacter(1);
+        renamed.setName(QString("Character 2 (%1)").arg(i));
+        m_initiativeTracker->updateCharacter(1, renamed);
+    }
+    QVERIFY(m_initiativeTracker->store().namePool().size() > 50);
+    QVERIFY(m_initiativeTracker->saveSnapshot(tempFileName));
+    QCOMPARE(m_initiativeTracker->store().namePool().size(), 3);
+    QCOMPARE(m_initiativeTracker->characterView(1).getName(), QString("Character 2 (49)"));
+    
+    QFile::remove(tempFileName);
+}
+
+void TestInitiativeTracker::testReplayRollsFromSession()
+{
+    QString tempFileName = "test_session.json";
+    
+    m_initiativeTracker->setSessionSeed(0x5eed);
+    for (int i = 0; i < 40; ++i) {
+        m_initiativeTracker->addCharacter(Character(QString("Goblin %1").arg(i), i % 3));
+    }
+    
+    // Spaltenwürfe, Einzelwürfe und Lücken in den Würfelschlüsseln mischen
+    m_initiativeTracker->rollAllInitiatives();
+    m_initiativeTracker->removeCharacter(5);
+    m_initiativeTracker->removeCharacter(17);
+    m_initiativeTracker->rollAllWillSaves();
+    m_initiativeTracker->rollReflexSaveForCharacter(3);
+    QCOMPARE(m_initiativeTracker->rollEventCount(), quint64(3));
+    QVERIFY(m_initiativeTracker->verifyRolls());
+    
+    // Jeder Wurf lässt sich einzeln über Ereignis und Schlüssel nachrechnen
+    const int index = 20;
+    const int event = m_initiativeTracker->rollEvent(index, CharacterStore::LastWillSaveRoll);
+    QCOMPARE(event, 1);
+    QCOMPARE(m_initiativeTracker->replayRoll(event, m_initiativeTracker->rollKey(index)),
+             m_initiativeTracker->getCharacter(index).getLastWillSaveRoll());
+    
+    // Ein von Hand geänderter Wurf gilt als nicht nachprüfbar
+    Character edited = m_initiativeTracker->getCharacter(0);
+    edited.setInitiativeRoll(edited.getInitiativeRoll() % 20 + 1);
+    m_initiativeTracker->updateCharacter(0, edited);
+    QCOMPARE(m_initiativeTracker->rollEvent(0, CharacterStore::InitiativeRoll), -1);
+    QVERIFY(m_initiativeTracker->verifyRolls());
+    
+    // Nach dem Laden setzt die Sitzung an derselben Stelle fort
+    QVERIFY(m_initiativeTracker->saveToFile(tempFileName));
+    InitiativeTracker newTracker;
+    QVERIFY(newTracker.loadFromFile(tempFileName));
+    QCOMPARE(newTracker.sessionSeed(), quint64(0x5eed));
+    QCOMPARE(newTracker.rollEventCount(), m_initiativeTracker->rollEventCount());
+    QVERIFY(newTracker.verifyRolls());
+    
+    m_initiativeTracker->rollAllFortitudeSaves();
+    newTracker.rollAllFortitudeSaves();
+    QCOMPARE(newTracker.getCharacters().size(), m_initiativeTracker->getCharacters().size());
+    for (int i = 0; i < newTracker.getCharacters().size(); ++i) {
+        QCOMPARE(newTracker.getCharacter(i).getLastFortitudeSaveRoll(),
+                 m_initiativeTracker->getCharacter(i).getLastFortitudeSaveRoll());
+    }
+    
+    // Das Ereignis INT_MAX wird noch vergeben, danach beginnt eine neue Sitzung
+    const CharacterStore characters = m_initiativeTracker->store();
+    SnapshotFile::Session exhausted = m_initiativeTracker->session();
+    exhausted.rollEvents = quint64(std::numeric_limits<int>::max());
+    m_initiativeTracker->restore(characters, exhausted);
+    m_initiativeTracker->rollReflexSaveForCharacter(1);
+    QCOMPARE(m_initiativeTracker->rollEvent(1, CharacterStore::LastReflexSaveRoll),
+             std::numeric_limits<int>::max());
+    QCOMPARE(m_initiativeTracker->sessionSeed(), quint64(0x5eed));
+    
+    m_initiativeTracker->rollReflexSaveForCharacter(2);
+    QVERIFY(m_initiativeTracker->sessionSeed() != quint64(0x5eed));
+    QCOMPARE(m_initiativeTracker->rollEventCount(), quint64(1));
+    QCOMPARE(m_initiativeTracker->rollEvent(2, CharacterStore::LastReflexSaveRoll), 0);
+    QCOMPARE(m_initiativeTracker->rollEvent(1, CharacterStore::LastReflexSaveRoll), -1);
+    QVERIFY(m_initiativeTracker->verifyRolls());
+    
+    QFile::remove(tempFileName);
+}
+
+void TestInitiativeTracker::testRowSignals()
+{
+    QSignalSpy insertedSpy(m_initiativeTracker, &InitiativeTracker::rowsInserted);
+    QSignalSpy removedSpy(m_initiativeTracker, &InitiativeTracker::rowsRemoved);
+    QSignalSpy updatedSpy(m_initiativeTracker, &InitiativeTracker::rowsUpdated);
+    
+    m_initiativeTracker->addCharacter(Character("Character 1", 1));
+    m_initiativeTracker->addCharacter(Character("Character 2", 2));
+    m_initiativeTracker->addCharacter(Character("Character 3", 3));
+    QCOMPARE(insertedSpy.count(), 3);
+    QCOMPARE(insertedSpy.at(2).at(0).toInt(), 2);
+    QCOMPARE(insertedSpy.at(2).at(1).toInt(), 2);
+    
+    // Einzelne Änderung: nur die Zeile und die Spalte
+    m_initiativeTracker->setReflexSave(1, 4);
+    QCOMPARE(updatedSpy.count(), 1);
+    QCOMPARE(updatedSpy.at(0).at(0).toInt(), 1);
+    QCOMPARE(updatedSpy.at(0).at(1).toInt(), 1);
+    QCOMPARE(updatedSpy.at(0).at(2).toUInt(), CharacterStore::fieldBit(CharacterStore::ReflexSave));
+    
+    // Unveränderte oder auf den alten Wert begrenzte Werte melden nichts
+    m_initiativeTracker->setReflexSave(1, 4);
+    m_initiativeTracker->setInitiativeModifier(1, 2);
+    m_initiativeTracker->setFortitudeSave(1, 100000);
+    QCOMPARE(updatedSpy.count(), 2);
+    m_initiativeTracker->setFortitudeSave(1, 200000);
+    QCOMPARE(updatedSpy.count(), 2);
+    updatedSpy.removeLast();
+    
+    // Spaltenwurf: alle Zeilen, nur Wurf und Ereignis
+    m_initiativeTracker->rollAllWillSaves();
+    QCOMPARE(updatedSpy.count(), 2);
+    QCOMPARE(updatedSpy.at(1).at(0).toInt(), 0);
+    QCOMPARE(updatedSpy.at(1).at(1).toInt(), 2);
+    QCOMPARE(updatedSpy.at(1).at(2).toUInt(),
+             CharacterStore::fieldBit(CharacterStore::LastWillSaveRoll)
+             | CharacterStore::fieldBit(CharacterStore::WillSaveRollEvent));
+    
+    // updateCharacter meldet nur tatsächlich geänderte Spalten
+    Character renamed = m_initiativeTracker->getCharacter(2);
+    renamed.setName("Character 3b");
+    m_initiativeTracker->updateCharacter(2, renamed);
+    QCOMPARE(updatedSpy.count(), 3);
+    QCOMPARE(updatedSpy.at(2).at(2).toUInt(), CharacterStore::NameBit);
+    
+    m_initiativeTracker->removeCharacter(0);
+    QCOMPARE(removedSpy.count(), 1);
+    QCOMPARE(removedSpy.at(0).at(0).toInt(), 0);
+}
+
+void TestInitiativeTracker::testChangeBatch()
+{
+    m_initiativeTracker->addCharacter(Character("Character 1", 1));
+    m_initiativeTracker->addCharacter(Character("Character 2", 2));
+    
+    QSignalSpy insertedSpy(m_initiativeTracker, &InitiativeTracker::rowsInserted);
+    QSignalSpy updatedSpy(m_initiativeTracker, &InitiativeTracker::rowsUpdated);
+    QSignalSpy resetSpy(m_initiativeTracker, &InitiativeTracker::rowsReset);
+    m_charactersChangedSpy->clear();
+    m_initiativeRolledSpy->clear();
+    
+    {
+        InitiativeTracker::ChangeBatch batch(m_initiativeTracker);
+        for (int i = 0; i < 10; ++i) {
+            m_initiativeTracker->addCharacter(Character(QString("Goblin %1").arg(i), 0));
+        }
+        m_initiativeTracker->rollAllInitiatives();
+        m_initiativeTracker->setWillSave(0, 3);
+        
+        // Innerhalb des Batches wird nichts gesendet
+        QCOMPARE(insertedSpy.count(), 0);
+        QCOMPARE(m_charactersChangedSpy->count(), 0);
+    }
+    
+    // Eine Meldung für die neuen Zeilen, eine für die vorhandenen
+    QCOMPARE(insertedSpy.count(), 1);
+    QCOMPARE(insertedSpy.at(0).at(0).toInt(), 2);
+    QCOMPARE(insertedSpy.at(0).at(1).toInt(), 11);
+    QCOMPARE(updatedSpy.count(), 1);
+    QCOMPARE(updatedSpy.at(0).at(0).toInt(), 0);
+    QCOMPARE(updatedSpy.at(0).at(1).toInt(), 1);
+    QVERIFY(updatedSpy.at(0).at(2).toUInt() & CharacterStore::fieldBit(CharacterStore::WillSave));
+    QVERIFY(updatedSpy.at(0).at(2).toUInt() & CharacterStore::fieldBit(CharacterStore::InitiativeRoll));
+    QCOMPARE(resetSpy.count(), 0);
+    QCOMPARE(m_charactersChangedSpy->count(), 1);
+    QCOMPARE(m_initiativeRolledSpy->count(), 1);
+    
+    // Entfernen im Batch führt zu einem Reset
+    {
+        InitiativeTracker::ChangeBatch batch(m_initiativeTracker);
+        m_initiativeTracker->removeCharacter(3);
+        m_initiativeTracker->addCharacter(Character("Orc", 2));
+    }
+    QCOMPARE(resetSpy.count(), 1);
+    QCOMPARE(insertedSpy.count(), 1);
+}
+
 QTEST_MAIN(TestInitiativeTracker)
 #include "tst_initiativetracker.moc" 
\ No newline at end of file
@@ -0,0 +1,110 @@
+#include <QtTest>
+#include <QCborArray>
+#include <QCborMap>
+#include <QCborStreamWriter>
+#include <QCborValue>
+#include "../src/messagecodec.h"
+
+/**
+ * @brief Die TestMessageCodec-Klasse enthält Unit-Tests für die JSON- und CBOR-Kodierung der WebSocket-Nachrichten.
+ */
+class TestMessageCodec : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    /**
+     * @brief Testet, ob eine Nachricht in beiden Kodierungen unverändert zurückkommt.
+     */
+    void testRoundTrip();
+
+    /**
+     * @brief Testet, ob ein CBOR-Client Nachrichten im eigenen Format senden kann.
+     */
+    void testDecodeForeignCbor();
+
+    /**
+     * @brief Testet, ob ungültige Nachrichten mit Fehlermeldung abgelehnt werden.
+     */
+    void testRejectsInvalidMessages();
+
+private:
+    /**
+     * @brief Erstellt eine typische Nachricht mit verschachtelten Werten.
+     */
+    static QJsonObject makeMessage();
+};
+
+QJsonObject TestMessageCodec::makeMessage()
+{
+    return QJsonObject{
+        { "command", "rollInitiative" },
+        { "target", "Größter Oger" },
+        { "values", QJsonArray{ 1, -4, 20 } },
+        { "options", QJsonObject{ { "advantage", true }, { "bonus", 2.5 } } }
+    };
+}
+
+void TestMessageCodec::testRoundTrip()
+{
+    const QJsonObject message = makeMessage();
+
+    for (MessageCodec::Encoding encoding : { MessageCodec::Json, MessageCodec::Cbor }) {
+        const QByteArray data = MessageCodec::encode(message, encoding);
+        QJsonObject decoded;
+        QString error;
+        QVERIFY2(MessageCodec::decode(data, encoding, &decoded, &error), qPrintable(error));
+        QCOMPARE(decoded, message);
+    }
+
+    // JSON wird kompakt geschrieben, CBOR ist noch kleiner
+    const QByteArray json = MessageCodec::encode(message, MessageCodec::Json);
+    const QByteArray cbor = MessageCodec::encode(message, MessageCodec::Cbor);
+    QVERIFY(!json.contains('\n'));
+    QVERIFY(cbor.size() < json.size());
+}
+
+void TestMessageCodec::testDecodeForeignCbor()
+{
+    // Ein Client schreibt die Map mit unbestimmter Länge und Ganzzahlen
+    QByteArray data;
+    QCborStreamWriter writer(&data);
+    writer.startMap();
+    writer.append(QLatin1String("command"));
+    writer.append(QLatin1String("rollWillSave"));
+    writer.append(QLatin1String("count"));
+    writer.append(qint64(3));
+    writer.endMap();
+
+    QJsonObject decoded;
+    QVERIFY(MessageCodec::decode(data, MessageCodec::Cbor, &decoded));
+    QCOMPARE(decoded["command"].toString(), QString("rollWillSave"));
+    QCOMPARE(decoded["count"].toInt(), 3);
+}
+
+void TestMessageCodec::testRejectsInvalidMessages()
+{
+    QJsonObject decoded;
+    QString error;
+
+    QVERIFY(!MessageCodec::decode("Hallo Welt", MessageCodec::Json, &decoded, &error));
+    QVERIFY(error.startsWith("Ungültiges JSON"));
+    QVERIFY(!MessageCodec::decode("[1, 2]", MessageCodec::Json, &decoded, &error));
+    QVERIFY(!error.isEmpty());
+
+    // Ein Array statt einer Map
+    QVERIFY(!MessageCodec::decode(QCborValue(QCborArray{ 1, 2 }).toCbor(), MessageCodec::Cbor, &decoded, &error));
+    QVERIFY(error.contains("Map"));
+
+    // Abgeschnitten und mit angehängten Daten
+    const QByteArray cbor = MessageCodec::encode(makeMessage(), MessageCodec::Cbor);
+    QVERIFY(!MessageCodec::decode(cbor.left(cbor.size() - 3), MessageCodec::Cbor, &decoded, &error));
+    QVERIFY(error.startsWith("Ungültiges CBOR"));
+    QVERIFY(!MessageCodec::decode(cbor + '\x01', MessageCodec::Cbor, &decoded, &error));
+    QVERIFY(error.startsWith("Ungültiges CBOR"));
+
+    QVERIFY(!MessageCodec::decode(QByteArray(), MessageCodec::Cbor, &decoded));
+}
+
+QTEST_APPLESS_MAIN(TestMessageCodec)
+#include "tst_messagecodec.moc"
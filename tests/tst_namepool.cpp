@@ -0,0 +1,74 @@
+#include <QtTest>
+#include "../src/namepool.h"
+
+/**
+ * @brief Die TestNamePool-Klasse enthält Unit-Tests für die NamePool-Klasse.
+ */
+class TestNamePool : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    /**
+     * @brief Testet, ob gleiche Namen dieselbe Id und denselben Speicher bekommen.
+     */
+    void testIntern();
+
+    /**
+     * @brief Testet die Suche ohne Aufnahme und das Leeren des Pools.
+     */
+    void testFindAndClear();
+
+    /**
+     * @brief Testet, ob eine Kopie des Pools später aufgenommene Namen nicht sieht.
+     */
+    void testCopyIsSnapshot();
+};
+
+void TestNamePool::testIntern()
+{
+    NamePool pool;
+    QCOMPARE(pool.size(), 1);
+    QCOMPARE(pool.intern(QString()), NamePool::EmptyId);
+    QCOMPARE(pool.intern(""), NamePool::EmptyId);
+
+    const NamePool::Id goblin = pool.intern("Goblin");
+    const NamePool::Id orc = pool.intern("Ork");
+    QVERIFY(goblin != orc);
+
+    // Ein neu erzeugter, gleicher String bekommt die vorhandene Id
+    const QString sameName = QString("Gob") + QString("lin");
+    QCOMPARE(pool.intern(sameName), goblin);
+    QCOMPARE(pool.size(), 3);
+    QCOMPARE(pool.name(goblin), QString("Goblin"));
+    QCOMPARE(&pool.name(goblin), &pool.name(pool.intern("Goblin")));
+}
+
+void TestNamePool::testFindAndClear()
+{
+    NamePool pool;
+    const NamePool::Id troll = pool.intern("Troll");
+    QCOMPARE(pool.find("Troll"), troll);
+    QCOMPARE(pool.find("Oger"), NamePool::InvalidId);
+    QCOMPARE(pool.size(), 2);
+
+    pool.clear();
+    QCOMPARE(pool.size(), 1);
+    QCOMPARE(pool.find("Troll"), NamePool::InvalidId);
+    QCOMPARE(pool.find(QString()), NamePool::EmptyId);
+}
+
+void TestNamePool::testCopyIsSnapshot()
+{
+    NamePool pool;
+    const NamePool::Id goblin = pool.intern("Goblin");
+    const NamePool copy = pool;
+
+    pool.intern("Ork");
+    QCOMPARE(copy.size(), 2);
+    QCOMPARE(copy.find("Ork"), NamePool::InvalidId);
+    QCOMPARE(copy.name(goblin), QString("Goblin"));
+}
+
+QTEST_APPLESS_MAIN(TestNamePool)
+#include "tst_namepool.moc"
@@ -0,0 +1,210 @@
+#include <QtTest>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include "../src/initiativetracker.h"
+#include "../src/rostercsvreader.h"
+
+/**
+ * @brief Die TestRosterCsvReader-Klasse enthält Unit-Tests für den CSV/TSV-Import.
+ */
+class TestRosterCsvReader : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    /**
+     * @brief Testet Kopfzeile, Kurzformen und fehlende Spalten.
+     */
+    void testReadCsv();
+
+    /**
+     * @brief Testet die Erkennung von Tab und Semikolon als Trennzeichen.
+     */
+    void testDelimiters();
+
+    /**
+     * @brief Testet Felder in Anführungszeichen.
+     */
+    void testQuotedFields();
+
+    /**
+     * @brief Testet, ob Fehler mit Zeilennummer gemeldet werden und den Store nicht ändern.
+     */
+    void testErrors();
+
+    /**
+     * @brief Testet, ob mehrere Blöcke dasselbe Ergebnis liefern wie ein einzelner.
+     */
+    void testParallelChunks();
+
+    /**
+     * @brief Testet den Import über den Tracker mit einer einzigen Benachrichtigung.
+     */
+    void testTrackerImport();
+
+private:
+    /**
+     * @brief Erzeugt eine CSV-Liste mit count Zeilen.
+     */
+    static QByteArray makeRoster(int count);
+};
+
+QByteArray TestRosterCsvReader::makeRoster(int count)
+{
+    QByteArray data("name,initiativeModifier,willSave,reflexSave,fortitudeSave\n");
+    for (int i = 0; i < count; ++i) {
+        data += "Skelett " + QByteArray::number(i % 50) + ',' + QByteArray::number(i % 7 - 3) + ','
+            + QByteArray::number(i % 5) + ",2,-1\n";
+    }
+    return data;
+}
+
+void TestRosterCsvReader::testReadCsv()
+{
+    const QByteArray data =
+        "\xEF\xBB\xBFName, Initiative ,Will,Notiz\r\n"
+        "Goblin,2,-1,klein\r\n"
+        "\r\n"
+        "Größter Oger,+4,3,\r\n"
+        "Goblin,2,,";
+
+    RosterCsvReader reader;
+    CharacterStore store;
+    QVERIFY2(reader.read(data, &store), qPrintable(reader.errorString()));
+    QCOMPARE(store.size(), 3);
+    QCOMPARE(reader.chunkCount(), 1);
+
+    QCOMPARE(store.name(1), QString("Größter Oger"));
+    QCOMPARE(store.value(1, CharacterStore::InitiativeModifier), 4);
+    QCOMPARE(store.value(0, CharacterStore::WillSave), -1);
+    QCOMPARE(store.value(2, CharacterStore::WillSave), 0);
+    QCOMPARE(store.value(0, CharacterStore::ReflexSave), 0);
+    QCOMPARE(store.value(0, CharacterStore::RollKey), -1);
+    QCOMPARE(store.value(0, CharacterStore::InitiativeRollEvent), -1);
+
+    // Gleiche Namen bekommen dieselbe Id
+    QCOMPARE(store.nameId(0), store.nameId(2));
+    QCOMPARE(store.namePool().size(), 3);
+}
+
+void TestRosterCsvReader::testDelimiters()
+{
+    RosterCsvReader reader;
+    CharacterStore store;
+
+    QVERIFY(reader.read("name\tinitiativeModifier\tfortitudeSave\nOrk, der Große\t1\t5\n", &store));
+    QCOMPARE(store.size(), 1);
+    QCOMPARE(store.name(0), QString("Ork, der Große"));
+    QCOMPARE(store.value(0, CharacterStore::FortitudeSave), 5);
+
+    QVERIFY(reader.read("Name;Initiative;Reflex\nTroll;-1;3\n", &store));
+    QCOMPARE(store.size(), 1);
+    QCOMPARE(store.value(0, CharacterStore::InitiativeModifier), -1);
+    QCOMPARE(store.value(0, CharacterStore::ReflexSave), 3);
+}
+
+void TestRosterCsvReader::testQuotedFields()
+{
+    const QByteArray data =
+        "\"name\",\"initiative\"\n"
+        "\"Ork, der Große\",3\n"
+        " \"Der \"\"Schlächter\"\"\" , \"-2\"\n";
+
+    RosterCsvReader reader;
+    CharacterStore store;
+    QVERIFY2(reader.read(data, &store), qPrintable(reader.errorString()));
+    QCOMPARE(store.size(), 2);
+    QCOMPARE(store.name(0), QString("Ork, der Große"));
+    QCOMPARE(store.name(1), QString("Der \"Schlächter\""));
+    QCOMPARE(store.value(1, CharacterStore::InitiativeModifier), -2);
+}
+
+void TestRosterCsvReader::testErrors()
+{
+    RosterCsvReader reader;
+    CharacterStore store;
+    store.append(Character("Unverändert", 1));
+
+    QVERIFY(!reader.read("initiative,will\n1,2\n", &store));
+    QVERIFY(reader.errorString().contains("name"));
+
+    QVERIFY(!reader.read("name,initiative\nGoblin,2\nOrk,zwei\n", &store));
+    QVERIFY(reader.errorString().startsWith("Zeile 3"));
+
+    QVERIFY(!reader.read("name,initiative\nGoblin,2\n\n\"Ork,1\n", &store));
+    QVERIFY(reader.errorString().startsWith("Zeile 4"));
+
+    QVERIFY(!reader.read("name,initiative\n,2\n", &store));
+    QVERIFY(reader.errorString().startsWith("Zeile 2"));
+
+    QCOMPARE(store.size(), 1);
+    QCOMPARE(store.name(0), QString("Unverändert"));
+}
+
+void TestRosterCsvReader::testParallelChunks()
+{
+    const QByteArray data = makeRoster(100000);
+    QVERIFY(data.size() > 4 * RosterCsvReader::MinChunkSize);
+
+    RosterCsvReader single;
+    single.setMaxThreadCount(1);
+    CharacterStore expected;
+    QVERIFY(single.read(data, &expected));
+    QCOMPARE(single.chunkCount(), 1);
+
+    RosterCsvReader parallel;
+    parallel.setMaxThreadCount(4);
+    CharacterStore store;
+    QVERIFY(parallel.read(data, &store));
+    QCOMPARE(parallel.chunkCount(), 4);
+
+    QCOMPARE(store.size(), 100000);
+    QCOMPARE(store.namePool().size(), 51);
+    for (int i = 0; i < store.size(); ++i) {
+        QCOMPARE(store.name(i), expected.name(i));
+        for (int field = 0; field < CharacterStore::FieldCount; ++field) {
+            QCOMPARE(store.value(i, CharacterStore::Field(field)),
+                     expected.value(i, CharacterStore::Field(field)));
+        }
+    }
+
+    // Ein Fehler im letzten Block wird mit der Zeile in der ganzen Datei gemeldet
+    QByteArray broken = data;
+    broken += "Lich,x\n";
+    QVERIFY(!parallel.read(broken, &store));
+    QVERIFY(parallel.errorString().startsWith("Zeile 100002"));
+}
+
+void TestRosterCsvReader::testTrackerImport()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString filename = dir.filePath("monster.csv");
+    QFile file(filename);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(makeRoster(1000));
+    file.close();
+
+    InitiativeTracker tracker;
+    tracker.addCharacter(Character("Held", 5));
+    QSignalSpy inserted(&tracker, &InitiativeTracker::rowsInserted);
+    QSignalSpy changed(&tracker, &InitiativeTracker::charactersChanged);
+
+    QVERIFY(tracker.importCsvFile(filename));
+    QCOMPARE(tracker.size(), 1001);
+    QCOMPARE(inserted.count(), 1);
+    QCOMPARE(inserted.first().at(0).toInt(), 1);
+    QCOMPARE(inserted.first().at(1).toInt(), 1000);
+    QCOMPARE(changed.count(), 1);
+
+    // Jeder importierte Charakter hat einen eigenen Würfelschlüssel
+    tracker.rollAllInitiatives();
+    QVERIFY(tracker.verifyRolls());
+    QCOMPARE(tracker.getSortedInitiativeOrder().size(), 1001);
+
+    QVERIFY(!tracker.importCsvFile(dir.filePath("fehlt.csv")));
+    QCOMPARE(tracker.size(), 1001);
+}
+
+QTEST_MAIN(TestRosterCsvReader)
+#include "tst_rostercsvreader.moc"
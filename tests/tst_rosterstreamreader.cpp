@@ -0,0 +1,183 @@
+#include <QtTest>
+#include <QSignalSpy>
+#include <QBuffer>
+#include "../src/rosterstreamreader.h"
+#include "../src/initiativetracker.h"
+
+/**
+ * @brief Die TestRosterStreamReader-Klasse enthält Unit-Tests für das blockweise Lesen von JSON-Dateien.
+ */
+class TestRosterStreamReader : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    /**
+     * @brief Testet eine von saveToFile() geschriebene Datei mit Sitzung.
+     */
+    void testReadsSavedFile();
+
+    /**
+     * @brief Testet ältere Dateien, die nur aus dem Array der Charaktere bestehen.
+     */
+    void testLegacyArray();
+
+    /**
+     * @brief Testet Objekte und Strings, die über Blockgrenzen reichen.
+     */
+    void testObjectsAcrossChunks();
+
+    /**
+     * @brief Testet, ob unvollständige oder ungültige Dateien abgelehnt werden.
+     */
+    void testRejectsInvalidData();
+
+    /**
+     * @brief Testet, ob Dokumente ohne gültiges Charakter-Array abgelehnt werden.
+     */
+    void testRejectsInvalidStructure();
+};
+
+void TestRosterStreamReader::testReadsSavedFile()
+{
+    QString tempFileName = "test_stream.json";
+
+    InitiativeTracker tracker;
+    tracker.addCharacter(Character("Goblin", 2, 1, 0, -1));
+    tracker.addCharacter(Character("Ork", 1));
+    tracker.rollAllInitiatives();
+    QVERIFY(tracker.saveToFile(tempFileName));
+
+    // "characters" steht in der Datei vor "session"
+    QFile file(tempFileName);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    RosterStreamReader reader;
+    CharacterStore store;
+    QVERIFY(reader.read(&file, &store));
+    file.close();
+
+    QVERIFY(reader.hasSession());
+    QCOMPARE(reader.session().seed, tracker.sessionSeed());
+    QCOMPARE(reader.session().rollEvents, tracker.rollEventCount());
+    QCOMPARE(store.size(), 2);
+    QCOMPARE(store.name(0), QString("Goblin"));
+    QCOMPARE(store.value(0, CharacterStore::FortitudeSave), -1);
+    QCOMPARE(store.value(1, CharacterStore::InitiativeRoll), tracker.characterView(1).getInitiativeRoll());
+    QCOMPARE(store.value(1, CharacterStore::RollKey), tracker.rollKey(1));
+
+    QFile::remove(tempFileName);
+}
+
+void TestRosterStreamReader::testLegacyArray()
+{
+    QByteArray json = "[ {\"name\": \"Goblin\", \"initiativeModifier\": 2},\n"
+                      "  {\"name\": \"Ork\", \"initiativeModifier\": 1, \"initiativeRoll\": 12} ]\n";
+    QBuffer buffer(&json);
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+
+    RosterStreamReader reader;
+    CharacterStore store;
+    QVERIFY(reader.read(&buffer, &store));
+    QVERIFY(!reader.hasSession());
+    QCOMPARE(store.size(), 2);
+    QCOMPARE(store.name(1), QString("Ork"));
+    QCOMPARE(store.value(1, CharacterStore::InitiativeRoll), 12);
+    QCOMPARE(store.value(1, CharacterStore::RollKey), -1);
+}
+
+void TestRosterStreamReader::testObjectsAcrossChunks()
+{
+    // Namen mit Klammern und maskierten Anführungszeichen, genug für mehrere Blöcke
+    const int count = 5000;
+    QByteArray json = "{\"characters\": [";
+    for (int i = 0; i < count; ++i) {
+        if (i > 0) {
+            json += ",";
+        }
+        json += "{\"name\": \"Ork \\\"{[" + QByteArray::number(i) + "]}\\\"\", \"initiativeModifier\": "
+              + QByteArray::number(i % 7) + ", \"extra\": {\"nested\": [1, 2, {\"deep\": \"}\"}]}}";
+    }
+    json += "], \"session\": {\"seed\": \"ff\", \"rollEvents\": \"3\", \"nextRollKey\": 0}}";
+    QVERIFY(json.size() > 3 * RosterStreamReader::ChunkSize);
+
+    QBuffer buffer(&json);
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+
+    RosterStreamReader reader;
+    QSignalSpy progressSpy(&reader, &RosterStreamReader::progress);
+    CharacterStore store;
+    QVERIFY2(reader.read(&buffer, &store), qPrintable(reader.errorString()));
+
+    QCOMPARE(store.size(), count);
+    QCOMPARE(store.name(1234), QString("Ork \"{[1234]}\""));
+    QCOMPARE(store.value(1234, CharacterStore::InitiativeModifier), 1234 % 7);
+    QVERIFY(reader.hasSession());
+    QCOMPARE(reader.session().seed, quint64(0xff));
+
+    // Start und Ende werden immer gemeldet
+    QVERIFY(progressSpy.count() >= 2);
+    QCOMPARE(progressSpy.last().at(0).toLongLong(), qint64(json.size()));
+}
+
+void TestRosterStreamReader::testRejectsInvalidData()
+{
+    const QList<QByteArray> invalid = {
+        "",
+        "[{\"name\": \"Goblin\"}",
+        "{\"characters\": [{\"name\": \"Goblin\"}]",
+        "[{\"name\": \"Goblin\", }]",
+        "[{\"name\": \"Goblin\"}]]",
+        "\"nur ein String\""
+    };
+
+    for (QByteArray json : invalid) {
+        QBuffer buffer(&json);
+        QVERIFY(buffer.open(QIODevice::ReadOnly));
+        RosterStreamReader reader;
+        CharacterStore store;
+        QVERIFY2(!reader.read(&buffer, &store), json.constData());
+        QVERIFY(!reader.errorString().isEmpty());
+    }
+}
+
+void TestRosterStreamReader::testRejectsInvalidStructure()
+{
+    const QList<QByteArray> invalid = {
+        "{}",
+        "{\"session\": {\"seed\": \"1\", \"rollEvents\": \"0\"}}",
+        "{\"characters\": 5}",
+        "{\"characters\": \"Goblin\"}",
+        "{\"characters\": {\"name\": \"Goblin\"}}",
+        "{\"characters\": [], \"characters\": []}",
+        "[1 2 true]",
+        "[{\"name\": \"Goblin\"}, 5]",
+        "[{\"name\": \"Goblin\"} {\"name\": \"Ork\"}]",
+        "[{\"name\": \"Goblin\"}, [\"Ork\"]]",
+        "[{\"name\": \"Goblin\"},]",
+        "[, {\"name\": \"Goblin\"}]",
+        "{\"characters\": [\"Goblin\"]}"
+    };
+
+    for (QByteArray json : invalid) {
+        QBuffer buffer(&json);
+        QVERIFY(buffer.open(QIODevice::ReadOnly));
+        RosterStreamReader reader;
+        CharacterStore store;
+        QVERIFY2(!reader.read(&buffer, &store), json.constData());
+        QVERIFY(!reader.errorString().isEmpty());
+    }
+
+    // Leere Listen sind gültig
+    const QList<QByteArray> empty = { "[]", " [ ] ", "{\"characters\": []}" };
+    for (QByteArray json : empty) {
+        QBuffer buffer(&json);
+        QVERIFY(buffer.open(QIODevice::ReadOnly));
+        RosterStreamReader reader;
+        CharacterStore store;
+        QVERIFY2(reader.read(&buffer, &store), json.constData());
+        QCOMPARE(store.size(), 0);
+    }
+}
+
+QTEST_MAIN(TestRosterStreamReader)
+#include "tst_rosterstreamreader.moc"
@@ -0,0 +1,177 @@
+#include <QtTest>
+#include <QTemporaryDir>
+#include <QtEndian>
+#include <limits>
+#include "../src/snapshotfile.h"
+
+/**
+ * @brief Die TestSnapshotFile-Klasse enthält Unit-Tests für das binäre Snapshot-Format.
+ */
+class TestSnapshotFile : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    /**
+     * @brief Testet, ob alle Spalten, Namen und die Sitzung unverändert zurückkommen.
+     */
+    void testRoundTrip();
+
+    /**
+     * @brief Testet einen Snapshot ohne Charaktere.
+     */
+    void testEmptyStore();
+
+    /**
+     * @brief Testet, ob beschädigte Dateien abgelehnt werden und den Store nicht ändern.
+     */
+    void testRejectsCorruptFiles();
+
+    /**
+     * @brief Testet, ob Abschnitte mit überlaufendem Offset im Kopf abgelehnt werden.
+     */
+    void testRejectsOverflowingOffsets();
+};
+
+void TestSnapshotFile::testRoundTrip()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString filename = dir.filePath("roster.dndsnap");
+
+    CharacterStore store;
+    store.append(Character("Goblin", 2, 1, 3, -1));
+    store.append(Character("Größter Oger", -1, 4, 0, 6));
+    store.append(Character("Goblin", 2, 1, 3, -1));
+    for (int i = 0; i < store.size(); ++i) {
+        store.setValue(i, CharacterStore::InitiativeRoll, 10 + i);
+        store.setValue(i, CharacterStore::RollKey, 7 + i);
+        store.setValue(i, CharacterStore::InitiativeRollEvent, 3);
+    }
+
+    SnapshotFile::Session session;
+    session.seed = Q_UINT64_C(0xfedcba9876543210);
+    session.rollEvents = 4;
+    session.nextRollKey = 10;
+    session.journalGeneration = 3;
+    QVERIFY(SnapshotFile::write(filename, store, session));
+    QVERIFY(SnapshotFile::isSnapshot(filename));
+
+    CharacterStore loaded;
+    SnapshotFile::Session loadedSession;
+    QVERIFY(SnapshotFile::read(filename, &loaded, &loadedSession));
+
+    QCOMPARE(loadedSession.seed, session.seed);
+    QCOMPARE(loadedSession.rollEvents, session.rollEvents);
+    QCOMPARE(loadedSession.nextRollKey, session.nextRollKey);
+    QCOMPARE(loadedSession.journalGeneration, session.journalGeneration);
+
+    QCOMPARE(loaded.size(), store.size());
+    for (int i = 0; i < store.size(); ++i) {
+        QCOMPARE(loaded.name(i), store.name(i));
+        for (int field = 0; field < CharacterStore::FieldCount; ++field) {
+            QCOMPARE(loaded.value(i, CharacterStore::Field(field)),
+                     store.value(i, CharacterStore::Field(field)));
+        }
+    }
+
+    // Gleiche Namen teilen sich nach dem Laden denselben Speicher
+    QCOMPARE(loaded.name(0).constData(), loaded.name(2).constData());
+}
+
+void TestSnapshotFile::testEmptyStore()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString filename = dir.filePath("empty.dndsnap");
+
+    QVERIFY(SnapshotFile::write(filename, CharacterStore(), SnapshotFile::Session()));
+
+    CharacterStore loaded;
+    loaded.append(Character("Alt", 0));
+    SnapshotFile::Session session;
+    QVERIFY(SnapshotFile::read(filename, &loaded, &session));
+    QVERIFY(loaded.isEmpty());
+}
+
+void TestSnapshotFile::testRejectsCorruptFiles()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString filename = dir.filePath("roster.dndsnap");
+
+    CharacterStore store;
+    store.append(Character("Goblin", 2));
+    QVERIFY(SnapshotFile::write(filename, store, SnapshotFile::Session()));
+
+    QFile file(filename);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QByteArray original = file.readAll();
+    file.close();
+
+    CharacterStore loaded;
+    loaded.append(Character("Unverändert", 1));
+    SnapshotFile::Session session;
+
+    // Abgeschnittene Datei
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(original.left(original.size() - 4));
+    file.close();
+    QVERIFY(!SnapshotFile::read(filename, &loaded, &session));
+
+    // Falsche Version
+    QByteArray wrongVersion = original;
+    wrongVersion[8] = char(99);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(wrongVersion);
+    file.close();
+    QVERIFY(!SnapshotFile::read(filename, &loaded, &session));
+
+    // Keine Snapshot-Datei
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("[{\"name\": \"Goblin\"}]");
+    file.close();
+    QVERIFY(!SnapshotFile::isSnapshot(filename));
+    QVERIFY(!SnapshotFile::read(filename, &loaded, &session));
+
+    QCOMPARE(loaded.size(), 1);
+    QCOMPARE(loaded.name(0), QString("Unverändert"));
+}
+
+void TestSnapshotFile::testRejectsOverflowingOffsets()
+{
+    CharacterStore store;
+    store.append(Character("Goblin", 2));
+    store.append(Character("Ork", 1));
+    const QByteArray original = SnapshotFile::toData(store, SnapshotFile::Session());
+
+    // Offset + Länge ergibt modulo 2^64 eine kleine Zahl; jeder Abschnitt einzeln
+    const int sectionOffsets[] = { 48, 56, 64 };
+    for (const int headerField : sectionOffsets) {
+        QByteArray corrupt = original;
+        uchar *data = reinterpret_cast<uchar *>(corrupt.data());
+        qToLittleEndian<quint64>(std::numeric_limits<quint64>::max() - 7, data + headerField);
+
+        CharacterStore loaded;
+        loaded.append(Character("Unverändert", 1));
+        SnapshotFile::Session session;
+        QVERIFY(!SnapshotFile::fromData(data, quint64(corrupt.size()), &loaded, &session));
+        QCOMPARE(loaded.size(), 1);
+    }
+
+    // Riesige Stringtabelle: stringsOffset + stringsSize läuft über
+    QByteArray corrupt = original;
+    uchar *data = reinterpret_cast<uchar *>(corrupt.data());
+    qToLittleEndian<quint64>(std::numeric_limits<quint64>::max() - 1, data + 72);
+    CharacterStore loaded;
+    SnapshotFile::Session session;
+    QVERIFY(!SnapshotFile::fromData(data, quint64(corrupt.size()), &loaded, &session));
+
+    // Das unveränderte Original wird weiterhin gelesen
+    QVERIFY(SnapshotFile::fromData(reinterpret_cast<const uchar *>(original.constData()),
+                                   quint64(original.size()), &loaded, &session));
+    QCOMPARE(loaded.size(), 2);
+}
+
+QTEST_MAIN(TestSnapshotFile)
+#include "tst_snapshotfile.moc"
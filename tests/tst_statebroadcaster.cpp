@@ -0,0 +1,320 @@
+#include <QtTest>
+#include <QSignalSpy>
+#include "../src/initiativetracker.h"
+#include "../src/statebroadcaster.h"
+
+/**
+ * @brief Die TestStateBroadcaster-Klasse enthält Unit-Tests für die Änderungsnachrichten an abonnierte Clients.
+ */
+class TestStateBroadcaster : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    /**
+     * @brief Testet den ganzen Zustand ohne interne Spalten.
+     */
+    void testFullState();
+
+    /**
+     * @brief Testet, ob mehrere Änderungen in einem Durchlauf eine Nachricht ergeben.
+     */
+    void testCoalescedDelta();
+
+    /**
+     * @brief Testet, ob nur geänderte Charaktere und Felder gesendet werden.
+     */
+    void testChangedFieldsOnly();
+
+    /**
+     * @brief Testet neue und entfernte Charaktere.
+     */
+    void testInsertAndRemove();
+
+    /**
+     * @brief Testet mehrere entfernte Bereiche und noch nicht gesendete Charaktere.
+     */
+    void testRemovedRanges();
+
+    /**
+     * @brief Testet, ob ohne Abonnenten nichts gesammelt wird.
+     */
+    void testInactive();
+
+private:
+    /**
+     * @brief Erstellt einen Tracker mit drei Charakteren.
+     */
+    static void fillTracker(InitiativeTracker *tracker);
+
+    /**
+     * @brief Wendet ein Delta so auf einen Zustand an, wie es ein Client tut.
+     */
+    static void applyDelta(QJsonObject *state, const QJsonObject &delta);
+};
+
+void TestStateBroadcaster::fillTracker(InitiativeTracker *tracker)
+{
+    tracker->addCharacter(Character("Aragorn", 3, 1, 2, 3));
+    tracker->addCharacter(Character("Gimli", 1, 2, 0, 5));
+    tracker->addCharacter(Character("Legolas", 4, 1, 5, 1));
+}
+
+void TestStateBroadcaster::applyDelta(QJsonObject *state, const QJsonObject &delta)
+{
+    QJsonArray characters = (*state)["characters"].toArray();
+    QJsonArray order = (*state)["order"].toArray();
+
+    // Entfernte Bereiche der Reihe nach; folgende Indizes rücken nach vorn
+    const QJsonArray removed = delta["removed"].toArray();
+    for (int i = 0; i + 1 < removed.size(); i += 2) {
+        const int first = removed.at(i).toInt();
+        const int last = removed.at(i + 1).toInt();
+        for (int index = last; index >= first; --index) {
+            characters.removeAt(index);
+        }
+        for (int index = first; index < characters.size(); ++index) {
+            QJsonObject character = characters.at(index).toObject();
+            character["index"] = index;
+            characters[index] = character;
+        }
+        QJsonArray shifted;
+        for (const QJsonValue &value : std::as_const(order)) {
+            const int index = value.toInt();
+            if (index < first) {
+                shifted.append(index);
+            } else if (index > last) {
+                shifted.append(index - (last - first + 1));
+            }
+        }
+        order = shifted;
+    }
+
+    // Geänderte Felder übernehmen, unbekannte Indizes sind neue Charaktere
+    for (const QJsonValue &value : delta["characters"].toArray()) {
+        const QJsonObject change = value.toObject();
+        const int index = change["index"].toInt();
+        while (characters.size() <= index) {
+            characters.append(QJsonObject());
+        }
+        QJsonObject character = characters.at(index).toObject();
+        for (auto it = change.begin(); it != change.end(); ++it) {
+            character[it.key()] = it.value();
+        }
+        characters[index] = character;
+    }
+
+    // Reihenfolge auf count Einträge bringen und geänderte Ränge setzen
+    const int count = delta["count"].toInt();
+    while (order.size() > count) {
+        order.removeLast();
+    }
+    while (order.size() < count) {
+        order.append(-1);
+    }
+    const QJsonArray orderChanges = delta["orderChanges"].toArray();
+    for (int i = 0; i + 1 < orderChanges.size(); i += 2) {
+        order[orderChanges.at(i).toInt()] = orderChanges.at(i + 1).toInt();
+    }
+
+    (*state)["count"] = count;
+    (*state)["characters"] = characters;
+    (*state)["order"] = order;
+}
+
+void TestStateBroadcaster::testFullState()
+{
+    InitiativeTracker tracker;
+    fillTracker(&tracker);
+    StateBroadcaster broadcaster(&tracker);
+
+    const QJsonObject state = broadcaster.fullState();
+    QCOMPARE(state["type"].toString(), QString("state"));
+    QCOMPARE(state["count"].toInt(), 3);
+    QCOMPARE(state["order"].toArray().size(), 3);
+
+    const QJsonArray characters = state["characters"].toArray();
+    QCOMPARE(characters.size(), 3);
+    const QJsonObject gimli = characters.at(1).toObject();
+    QCOMPARE(gimli["index"].toInt(), 1);
+    QCOMPARE(gimli["name"].toString(), QString("Gimli"));
+    QCOMPARE(gimli["fortitudeSave"].toInt(), 5);
+    QVERIFY(gimli.contains("initiativeRoll"));
+    QVERIFY(!gimli.contains("rollKey"));
+    QVERIFY(!gimli.contains("initiativeRollEvent"));
+}
+
+void TestStateBroadcaster::testCoalescedDelta()
+{
+    InitiativeTracker tracker;
+    fillTracker(&tracker);
+    StateBroadcaster broadcaster(&tracker);
+    broadcaster.setActive(true);
+    QSignalSpy spy(&broadcaster, &StateBroadcaster::deltaReady);
+    QJsonObject state = broadcaster.fullState();
+
+    // Vier Würfe ohne Batch ergeben mehrere Signale des Trackers ...
+    tracker.rollAllInitiatives();
+    tracker.rollAllWillSaves();
+    tracker.rollAllReflexSaves();
+    tracker.rollAllFortitudeSaves();
+    QVERIFY(broadcaster.hasPendingChanges());
+    QCOMPARE(spy.count(), 0);
+
+    // ... aber nur eine Nachricht am Ende des Durchlaufs
+    QTRY_COMPARE(spy.count(), 1);
+    QCoreApplication::processEvents();
+    QCOMPARE(spy.count(), 1);
+    QVERIFY(!broadcaster.hasPendingChanges());
+
+    const QJsonObject delta = spy.first().first().toJsonObject();
+    QCOMPARE(delta["type"].toString(), QString("delta"));
+    QVERIFY(!delta.contains("removed"));
+    const QJsonArray characters = delta["characters"].toArray();
+    QCOMPARE(characters.size(), 3);
+    const QJsonObject first = characters.at(0).toObject();
+    QCOMPARE(first["index"].toInt(), 0);
+    QCOMPARE(first["initiativeRoll"].toInt(), tracker.store().value(0, CharacterStore::InitiativeRoll));
+    QCOMPARE(first["lastFortitudeSaveRoll"].toInt(), tracker.store().value(0, CharacterStore::LastFortitudeSaveRoll));
+    QVERIFY(!first.contains("name"));
+    QVERIFY(!first.contains("willSave"));
+
+    // Mit den geänderten Rängen kennt der Client dieselbe Reihenfolge
+    applyDelta(&state, delta);
+    QCOMPARE(state, broadcaster.fullState());
+}
+
+void TestStateBroadcaster::testChangedFieldsOnly()
+{
+    InitiativeTracker tracker;
+    fillTracker(&tracker);
+    StateBroadcaster broadcaster(&tracker);
+    broadcaster.setActive(true);
+    QSignalSpy spy(&broadcaster, &StateBroadcaster::deltaReady);
+
+    tracker.setWillSave(2, 7);
+    broadcaster.flush();
+    QCOMPARE(spy.count(), 1);
+
+    const QJsonObject delta = spy.first().first().toJsonObject();
+    const QJsonArray characters = delta["characters"].toArray();
+    QCOMPARE(characters.size(), 1);
+    QCOMPARE(characters.at(0).toObject(), QJsonObject({ { "index", 2 }, { "willSave", 7 } }));
+
+    // Die Reihenfolge hängt nicht von der Willenskraft ab
+    QVERIFY(!delta.contains("orderChanges"));
+
+    // Der eingeplante Aufruf findet nichts mehr vor
+    QCoreApplication::processEvents();
+    QCOMPARE(spy.count(), 1);
+}
+
+void TestStateBroadcaster::testInsertAndRemove()
+{
+    InitiativeTracker tracker;
+    fillTracker(&tracker);
+    StateBroadcaster broadcaster(&tracker);
+    broadcaster.setActive(true);
+    QSignalSpy spy(&broadcaster, &StateBroadcaster::deltaReady);
+    QJsonObject state = broadcaster.fullState();
+
+    // Reihenfolge vorher: Legolas (4), Aragorn (3), Gimli (1)
+    tracker.addCharacter(Character("Boromir", 2));
+    broadcaster.flush();
+    QCOMPARE(spy.count(), 1);
+    QJsonObject delta = spy.takeFirst().first().toJsonObject();
+    QCOMPARE(delta["count"].toInt(), 4);
+    const QJsonObject boromir = delta["characters"].toArray().at(0).toObject();
+    QCOMPARE(boromir["index"].toInt(), 3);
+    QCOMPARE(boromir["name"].toString(), QString("Boromir"));
+
+    // Nur die Ränge ab Boromir ändern sich
+    QCOMPARE(delta["orderChanges"].toArray(), QJsonArray({ 2, 3, 3, 1 }));
+    applyDelta(&state, delta);
+    QCOMPARE(state, broadcaster.fullState());
+
+    // Entfernen sendet nur den Bereich; der Client verschiebt die Indizes selbst
+    tracker.setWillSave(3, 1);
+    tracker.removeCharacter(0);
+    broadcaster.flush();
+    QCOMPARE(spy.count(), 1);
+    delta = spy.takeFirst().first().toJsonObject();
+    QCOMPARE(delta["type"].toString(), QString("delta"));
+    QCOMPARE(delta["count"].toInt(), 3);
+    QCOMPARE(delta["removed"].toArray(), QJsonArray({ 0, 0 }));
+    QCOMPARE(delta["characters"].toArray(), QJsonArray({ QJsonObject({ { "index", 2 }, { "willSave", 1 } }) }));
+    QVERIFY(!delta.contains("orderChanges"));
+    applyDelta(&state, delta);
+    QCOMPARE(state, broadcaster.fullState());
+}
+
+void TestStateBroadcaster::testRemovedRanges()
+{
+    InitiativeTracker tracker;
+    fillTracker(&tracker);
+    StateBroadcaster broadcaster(&tracker);
+    broadcaster.setActive(true);
+    QSignalSpy spy(&broadcaster, &StateBroadcaster::deltaReady);
+    QJsonObject state = broadcaster.fullState();
+
+    // Boromir wird hinzugefügt und wieder entfernt, bevor ein Client ihn kennt
+    tracker.addCharacter(Character("Boromir", 2));
+    tracker.removeCharacter(1);
+    tracker.removeCharacter(2);
+    tracker.setInitiativeModifier(0, 10);
+    broadcaster.flush();
+    QCOMPARE(spy.count(), 1);
+    QJsonObject delta = spy.takeFirst().first().toJsonObject();
+    QCOMPARE(delta["count"].toInt(), 2);
+    QCOMPARE(delta["removed"].toArray(), QJsonArray({ 1, 1 }));
+    QCOMPARE(delta["characters"].toArray(),
+             QJsonArray({ QJsonObject({ { "index", 0 }, { "initiativeModifier", 10 } }) }));
+    QCOMPARE(delta["orderChanges"].toArray(), QJsonArray({ 0, 0, 1, 1 }));
+    applyDelta(&state, delta);
+    QCOMPARE(state, broadcaster.fullState());
+
+    // Mehrere Bereiche in einem Durchlauf werden der Reihe nach angewendet
+    tracker.addCharacter(Character("Frodo", 0));
+    tracker.addCharacter(Character("Sam", 0));
+    broadcaster.flush();
+    applyDelta(&state, spy.takeFirst().first().toJsonObject());
+    tracker.removeCharacter(1);
+    tracker.removeCharacter(2);
+    broadcaster.flush();
+    delta = spy.takeFirst().first().toJsonObject();
+    QCOMPARE(delta["removed"].toArray(), QJsonArray({ 1, 1, 2, 2 }));
+    applyDelta(&state, delta);
+    QCOMPARE(state, broadcaster.fullState());
+
+    // Leeren ist ein einziger Bereich
+    tracker.clearCharacters();
+    broadcaster.flush();
+    delta = spy.takeFirst().first().toJsonObject();
+    QCOMPARE(delta["removed"].toArray(), QJsonArray({ 0, 1 }));
+    QCOMPARE(delta["count"].toInt(), 0);
+    applyDelta(&state, delta);
+    QCOMPARE(state, broadcaster.fullState());
+}
+
+void TestStateBroadcaster::testInactive()
+{
+    InitiativeTracker tracker;
+    fillTracker(&tracker);
+    StateBroadcaster broadcaster(&tracker);
+    QSignalSpy spy(&broadcaster, &StateBroadcaster::deltaReady);
+
+    tracker.rollAllInitiatives();
+    QVERIFY(!broadcaster.hasPendingChanges());
+    QCoreApplication::processEvents();
+    QCOMPARE(spy.count(), 0);
+
+    // Beim Abschalten werden offene Änderungen verworfen
+    broadcaster.setActive(true);
+    tracker.rollAllWillSaves();
+    broadcaster.setActive(false);
+    QCoreApplication::processEvents();
+    QCOMPARE(spy.count(), 0);
+}
+
+QTEST_MAIN(TestStateBroadcaster)
+#include "tst_statebroadcaster.moc"
@@ -0,0 +1,122 @@
+#include <QtTest>
+#include <QTemporaryDir>
+#include "../src/trace.h"
+
+/**
+ * @brief Die TestTrace-Klasse enthält Unit-Tests für die binäre Trace-Aufzeichnung.
+ */
+class TestTrace : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    /**
+     * @brief Aufräumen nach jedem Test.
+     */
+    void cleanup();
+
+    /**
+     * @brief Testet, ob nur während der Aufzeichnung Datensätze entstehen.
+     */
+    void testRecordsOnlyWhileRecording();
+
+    /**
+     * @brief Testet, ob ein voller Ringpuffer die ältesten Einträge überschreibt.
+     */
+    void testRingBufferKeepsNewest();
+
+    /**
+     * @brief Testet den Aufbau der geschriebenen Trace-Datei.
+     */
+    void testStopWritesFile();
+
+    /**
+     * @brief Testet, ob abgeschaltete Log-Stufen ihre Argumente nicht auswerten.
+     */
+    void testDisabledLevelSkipsArguments();
+};
+
+void TestTrace::cleanup()
+{
+    Trace::stop();
+}
+
+void TestTrace::testRecordsOnlyWhileRecording()
+{
+    Trace::start(16);
+    QVERIFY(Trace::isRecording());
+    Trace::record(Trace::CharacterAdded, 3);
+    Trace::record(Trace::ColumnRolled, 1, 500);
+    Trace::stop();
+    QVERIFY(!Trace::isRecording());
+
+    // Nach stop() wird nichts mehr aufgezeichnet
+    Trace::record(Trace::CharacterAdded, 4);
+
+    const QVector<Trace::Record> records = Trace::records();
+    QCOMPARE(records.size(), 2);
+    QCOMPARE(records.at(0).event, quint16(Trace::CharacterAdded));
+    QCOMPARE(records.at(0).a, 3);
+    QCOMPARE(records.at(1).event, quint16(Trace::ColumnRolled));
+    QCOMPARE(records.at(1).b, 500);
+    QVERIFY(records.at(0).timestampNs <= records.at(1).timestampNs);
+    QCOMPARE(records.at(0).thread, records.at(1).thread);
+}
+
+void TestTrace::testRingBufferKeepsNewest()
+{
+    // 5 wird auf 8 aufgerundet
+    Trace::start(5);
+    for (int i = 0; i < 20; ++i) {
+        Trace::record(Trace::SingleRolled, 0, i);
+    }
+
+    const QVector<Trace::Record> records = Trace::records();
+    QCOMPARE(records.size(), 8);
+    for (int i = 0; i < records.size(); ++i) {
+        QCOMPARE(records.at(i).b, 12 + i);
+    }
+}
+
+void TestTrace::testStopWritesFile()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString filename = dir.filePath("trace.bin");
+
+    Trace::start(16);
+    Trace::record(Trace::MessageReceived, 42);
+    QVERIFY(Trace::stop(filename));
+
+    QFile file(filename);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QDataStream stream(&file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+
+    char magic[8];
+    QCOMPARE(stream.readRawData(magic, 8), 8);
+    QCOMPARE(QByteArray(magic, 8), QByteArray("DNDTRACE"));
+
+    quint32 version = 0;
+    quint32 recordSize = 0;
+    quint64 count = 0;
+    stream >> version >> recordSize >> count;
+    QCOMPARE(version, quint32(1));
+    QCOMPARE(recordSize, quint32(24));
+    QCOMPARE(count, quint64(1));
+
+    // Kopf (24 Byte) plus ein Datensatz
+    QCOMPARE(file.size(), qint64(24 + 24));
+}
+
+void TestTrace::testDisabledLevelSkipsArguments()
+{
+    int evaluated = 0;
+    auto argument = [&evaluated]() { ++evaluated; return 1; };
+
+    DND_TRACE_DISCARD << argument();
+    QCOMPARE(evaluated, 0);
+}
+
+QTEST_MAIN(TestTrace)
+#include "tst_trace.moc"
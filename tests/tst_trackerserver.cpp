@@ -0,0 +1,243 @@
+#include <QtTest>
+#include <QSignalSpy>
+#include <QWebSocket>
+#include <utility>
+#include "../src/commanddispatcher.h"
+#include "../src/initiativetracker.h"
+#include "../src/statebroadcaster.h"
+#include "../src/trackerserver.h"
+
+/**
+ * @brief Die TestTrackerServer-Klasse enthält Unit-Tests für den WebSocket-Server mit echten Verbindungen.
+ */
+class TestTrackerServer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    /**
+     * @brief Startet Tracker und Server auf einem freien Port.
+     */
+    void init();
+
+    /**
+     * @brief Beendet Server und Tracker.
+     */
+    void cleanup();
+
+    /**
+     * @brief Testet Befehle und Antworten in JSON und CBOR.
+     */
+    void testCommands();
+
+    /**
+     * @brief Testet, ob Abonnenten den Zustand und danach zusammengefasste Änderungen erhalten.
+     */
+    void testSubscription();
+
+    /**
+     * @brief Testet, ob ein zu schneller Client gebremst wird, ohne andere Clients aufzuhalten.
+     */
+    void testRateLimit();
+
+    /**
+     * @brief Testet, ob ein langsamer Abonnent statt verpasster Änderungen den ganzen Zustand erhält.
+     */
+    void testSlowConsumer();
+
+private:
+    /**
+     * @brief Verbindet einen Client mit dem Server.
+     */
+    QWebSocket *connectClient();
+
+    InitiativeTracker *m_tracker = nullptr;
+    CommandDispatcher *m_dispatcher = nullptr;
+    StateBroadcaster *m_broadcaster = nullptr;
+    TrackerServer *m_server = nullptr;
+};
+
+void TestTrackerServer::init()
+{
+    m_tracker = new InitiativeTracker;
+    m_tracker->addCharacter(Character("Aragorn", 3));
+    m_tracker->addCharacter(Character("Gimli", 1));
+    m_dispatcher = new CommandDispatcher(m_tracker);
+    m_broadcaster = new StateBroadcaster(m_tracker);
+    m_server = new TrackerServer;
+    QVERIFY(m_server->listen(QHostAddress::LocalHost, 0));
+
+    // Dieselbe Verdrahtung wie im Hauptfenster
+    connect(m_server, &TrackerServer::messageReceived, this,
+            [this](quint64 clientId, const QJsonObject &message, MessageCodec::Encoding encoding) {
+                const CommandDispatcher::Response response = m_dispatcher->dispatch(message);
+                m_server->send(clientId, response.encoded(encoding), encoding);
+            });
+    connect(m_server, &TrackerServer::subscriberCountChanged, this, [this](int count) {
+        m_broadcaster->setActive(count > 0);
+    });
+    const auto sendState = [this](quint64 clientId, MessageCodec::Encoding encoding) {
+        m_server->send(clientId, MessageCodec::encode(m_broadcaster->fullState(), encoding), encoding);
+    };
+    connect(m_server, &TrackerServer::subscribed, this, sendState);
+    connect(m_server, &TrackerServer::resyncRequired, this, sendState);
+    connect(m_broadcaster, &StateBroadcaster::deltaReady, m_server, &TrackerServer::broadcast);
+}
+
+void TestTrackerServer::cleanup()
+{
+    delete m_server;
+    delete m_broadcaster;
+    delete m_dispatcher;
+    delete m_tracker;
+}
+
+QWebSocket *TestTrackerServer::connectClient()
+{
+    QWebSocket *client = new QWebSocket(QString(), QWebSocketProtocol::VersionLatest, this);
+    QSignalSpy connected(client, &QWebSocket::connected);
+    client->open(QUrl(QString("ws://127.0.0.1:%1").arg(m_server->serverPort())));
+    if (!connected.wait()) {
+        return nullptr;
+    }
+    return client;
+}
+
+void TestTrackerServer::testCommands()
+{
+    QWebSocket *client = connectClient();
+    QVERIFY(client);
+    QTRY_COMPARE(m_server->clientCount(), 1);
+
+    QSignalSpy texts(client, &QWebSocket::textMessageReceived);
+    QSignalSpy binaries(client, &QWebSocket::binaryMessageReceived);
+    QSignalSpy rolled(m_tracker, &InitiativeTracker::initiativeRolled);
+
+    client->sendTextMessage("{\"command\": \"rollInitiative\"}");
+    QVERIFY(texts.wait());
+    QJsonObject response = QJsonDocument::fromJson(texts.first().first().toString().toUtf8()).object();
+    QCOMPARE(response["status"].toString(), QString("success"));
+    QCOMPARE(rolled.count(), 1);
+
+    // Eine Binärnachricht wird binär beantwortet
+    client->sendBinaryMessage(MessageCodec::encode(QJsonObject{ { "command", "fireball" } }, MessageCodec::Cbor));
+    QVERIFY(binaries.wait());
+    QVERIFY(MessageCodec::decode(binaries.first().first().toByteArray(), MessageCodec::Cbor, &response));
+    QCOMPARE(response["message"].toString(), QString("Unbekannter Befehl: fireball"));
+
+    client->sendBinaryMessage("kein CBOR");
+    QVERIFY(binaries.wait());
+    QVERIFY(MessageCodec::decode(binaries.last().first().toByteArray(), MessageCodec::Cbor, &response));
+    QCOMPARE(response["status"].toString(), QString("error"));
+    QCOMPARE(texts.count(), 1);
+
+    client->close();
+    QTRY_COMPARE(m_server->clientCount(), 0);
+}
+
+void TestTrackerServer::testSubscription()
+{
+    QWebSocket *subscriber = connectClient();
+    QWebSocket *other = connectClient();
+    QVERIFY(subscriber && other);
+
+    QSignalSpy subscriberMessages(subscriber, &QWebSocket::binaryMessageReceived);
+    QSignalSpy otherMessages(other, &QWebSocket::textMessageReceived);
+
+    // Bestätigung und ganzer Zustand
+    subscriber->sendBinaryMessage(MessageCodec::encode(QJsonObject{ { "command", "subscribe" } }, MessageCodec::Cbor));
+    QTRY_COMPARE(subscriberMessages.count(), 2);
+    QCOMPARE(m_server->subscriberCount(), 1);
+    QVERIFY(m_broadcaster->isActive());
+
+    QJsonObject message;
+    QVERIFY(MessageCodec::decode(subscriberMessages.at(1).first().toByteArray(), MessageCodec::Cbor, &message));
+    QCOMPARE(message["type"].toString(), QString("state"));
+    QCOMPARE(message["count"].toInt(), 2);
+
+    // Ein Stapel von einem anderen Client ergibt genau eine Änderungsnachricht
+    other->sendTextMessage("{\"commands\": [\"rollInitiative\", \"rollWillSave\"]}");
+    QTRY_COMPARE(otherMessages.count(), 1);
+    QTRY_COMPARE(subscriberMessages.count(), 3);
+    QTest::qWait(50);
+    QCOMPARE(subscriberMessages.count(), 3);
+    QCOMPARE(otherMessages.count(), 1);
+
+    QVERIFY(MessageCodec::decode(subscriberMessages.at(2).first().toByteArray(), MessageCodec::Cbor, &message));
+    QCOMPARE(message["type"].toString(), QString("delta"));
+    QCOMPARE(message["characters"].toArray().size(), 2);
+    QVERIFY(message["characters"].toArray().at(0).toObject().contains("lastWillSaveRoll"));
+
+    // Nach dem Trennen des Abonnenten wird nichts mehr gesammelt
+    subscriber->close();
+    QTRY_COMPARE(m_server->subscriberCount(), 0);
+    QVERIFY(!m_broadcaster->isActive());
+}
+
+void TestTrackerServer::testRateLimit()
+{
+    TrackerServer::Limits limits;
+    limits.messagesPerSecond = 4;
+    limits.burst = 2;
+    limits.maxQueuedMessages = 3;
+    m_server->setLimits(limits);
+
+    QWebSocket *noisy = connectClient();
+    QWebSocket *other = connectClient();
+    QVERIFY(noisy && other);
+    QSignalSpy noisyTexts(noisy, &QWebSocket::textMessageReceived);
+    QSignalSpy otherTexts(other, &QWebSocket::textMessageReceived);
+
+    // 2 sofort, 3 in der Warteschlange, 5 verworfen
+    for (int i = 0; i < 10; ++i) {
+        noisy->sendTextMessage("{\"command\": \"rollInitiative\"}");
+    }
+    QTRY_COMPARE(m_server->droppedMessageCount(), quint64(5));
+
+    // Der andere Client wartet nicht auf die Warteschlange
+    other->sendTextMessage("{\"command\": \"rollWillSave\"}");
+    QVERIFY(otherTexts.wait());
+    QVERIFY(noisyTexts.count() < 6);
+
+    // Die wartenden Nachrichten werden nachgeholt
+    QTRY_COMPARE(noisyTexts.count(), 6);
+    QTest::qWait(300);
+    QCOMPARE(noisyTexts.count(), 6);
+
+    // Genau eine Fehlerantwort für alle verworfenen Nachrichten
+    int errors = 0;
+    for (const QList<QVariant> &arguments : std::as_const(noisyTexts)) {
+        const QJsonObject response = QJsonDocument::fromJson(arguments.first().toString().toUtf8()).object();
+        errors += response["status"].toString() == QLatin1String("error") ? 1 : 0;
+    }
+    QCOMPARE(errors, 1);
+}
+
+void TestTrackerServer::testSlowConsumer()
+{
+    // Jeder ungesendete Puffer gilt als voll
+    TrackerServer::Limits limits;
+    limits.maxBytesToWrite = 0;
+    m_server->setLimits(limits);
+
+    QWebSocket *subscriber = connectClient();
+    QVERIFY(subscriber);
+    QSignalSpy messages(subscriber, &QWebSocket::textMessageReceived);
+    subscriber->sendTextMessage("{\"command\": \"subscribe\"}");
+    QTRY_COMPARE(messages.count(), 2);
+
+    // Die zweite Änderung trifft auf einen noch vollen Puffer
+    m_server->broadcast(QJsonObject{ { "type", "delta" }, { "n", 1 } });
+    m_server->broadcast(QJsonObject{ { "type", "delta" }, { "n", 2 } });
+    QCOMPARE(m_server->droppedUpdateCount(), quint64(1));
+
+    // Statt der verpassten Änderung kommt der ganze Zustand
+    QTRY_COMPARE(messages.count(), 4);
+    QJsonObject message = QJsonDocument::fromJson(messages.at(2).first().toString().toUtf8()).object();
+    QCOMPARE(message["n"].toInt(), 1);
+    message = QJsonDocument::fromJson(messages.at(3).first().toString().toUtf8()).object();
+    QCOMPARE(message["type"].toString(), QString("state"));
+}
+
+QTEST_MAIN(TestTrackerServer)
+#include "tst_trackerserver.moc"
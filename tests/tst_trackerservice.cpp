@@ -0,0 +1,184 @@
+#include <QtTest>
+#include <QSignalSpy>
+#include <QWebSocket>
+#include "../src/initiativetracker.h"
+#include "../src/trackerservice.h"
+
+/**
+ * @brief Die TestTrackerService-Klasse enthält Unit-Tests für den WebSocket-Server im Netzwerk-Thread.
+ */
+class TestTrackerService : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    /**
+     * @brief Startet Tracker und Dienst auf einem freien Port.
+     */
+    void init();
+
+    /**
+     * @brief Beendet Dienst und Tracker.
+     */
+    void cleanup();
+
+    /**
+     * @brief Testet Starten, Stoppen und den Fehler bei belegtem Port.
+     */
+    void testStartStop();
+
+    /**
+     * @brief Testet, ob Befehle aus dem Netzwerk-Thread im Tracker-Thread ausgeführt werden.
+     */
+    void testCommands();
+
+    /**
+     * @brief Testet Zustand und Änderungsnachrichten über den Netzwerk-Thread.
+     */
+    void testSubscription();
+
+    /**
+     * @brief Testet, ob die Anzeige der Nachrichten erst beim Verbinden beginnt.
+     */
+    void testMessageLogging();
+
+private:
+    /**
+     * @brief Verbindet einen Client mit dem Dienst.
+     */
+    QWebSocket *connectClient();
+
+    InitiativeTracker *m_tracker = nullptr;
+    TrackerService *m_service = nullptr;
+};
+
+void TestTrackerService::init()
+{
+    m_tracker = new InitiativeTracker;
+    m_tracker->addCharacter(Character("Aragorn", 3));
+    m_tracker->addCharacter(Character("Gimli", 1));
+    m_service = new TrackerService(m_tracker);
+    QVERIFY(m_service->start(QHostAddress::LocalHost, 0));
+}
+
+void TestTrackerService::cleanup()
+{
+    delete m_service;
+    delete m_tracker;
+}
+
+QWebSocket *TestTrackerService::connectClient()
+{
+    QWebSocket *client = new QWebSocket(QString(), QWebSocketProtocol::VersionLatest, this);
+    QSignalSpy connected(client, &QWebSocket::connected);
+    client->open(QUrl(QString("ws://127.0.0.1:%1").arg(m_service->serverPort())));
+    if (!connected.wait()) {
+        return nullptr;
+    }
+    return client;
+}
+
+void TestTrackerService::testStartStop()
+{
+    QVERIFY(m_service->isRunning());
+    QVERIFY(m_service->serverPort() != 0);
+
+    // Ein zweiter Dienst auf demselben Port scheitert mit Fehlermeldung
+    TrackerService second(m_tracker);
+    QVERIFY(!second.start(QHostAddress::LocalHost, m_service->serverPort()));
+    QVERIFY(!second.isRunning());
+    QVERIFY(!second.errorString().isEmpty());
+
+    m_service->stop();
+    QVERIFY(!m_service->isRunning());
+    QCOMPARE(m_service->serverPort(), quint16(0));
+
+    // Ein gestoppter Dienst lässt sich wieder starten
+    QVERIFY(m_service->start(QHostAddress::LocalHost, 0));
+    QVERIFY(connectClient());
+}
+
+void TestTrackerService::testCommands()
+{
+    QWebSocket *client = connectClient();
+    QVERIFY(client);
+
+    QSignalSpy texts(client, &QWebSocket::textMessageReceived);
+    QSignalSpy binaries(client, &QWebSocket::binaryMessageReceived);
+    QSignalSpy received(m_service, &TrackerService::messageReceived);
+
+    // Der Tracker wird im Thread des Tests geändert, nicht im Netzwerk-Thread
+    QThread *trackerThread = nullptr;
+    connect(m_tracker, &InitiativeTracker::initiativeRolled, this, [&trackerThread]() {
+        trackerThread = QThread::currentThread();
+    });
+
+    client->sendTextMessage("{\"command\": \"rollInitiative\"}");
+    QVERIFY(texts.wait());
+    QJsonObject response = QJsonDocument::fromJson(texts.first().first().toString().toUtf8()).object();
+    QCOMPARE(response["status"].toString(), QString("success"));
+    QCOMPARE(trackerThread, QThread::currentThread());
+    QCOMPARE(received.count(), 1);
+    QCOMPARE(received.first().at(2).value<MessageCodec::Encoding>(), MessageCodec::Json);
+
+    client->sendBinaryMessage(MessageCodec::encode(QJsonObject{ { "command", "fireball" } }, MessageCodec::Cbor));
+    QVERIFY(binaries.wait());
+    QVERIFY(MessageCodec::decode(binaries.first().first().toByteArray(), MessageCodec::Cbor, &response));
+    QCOMPARE(response["message"].toString(), QString("Unbekannter Befehl: fireball"));
+
+    // Eigene Befehle gelten auch für Nachrichten aus dem Netzwerk-Thread
+    m_service->dispatcher()->registerCommand("clearCharacters", "Alle Charaktere entfernt",
+        [this](const QJsonObject &, QString *) {
+            m_tracker->clearCharacters();
+            return true;
+        });
+    client->sendTextMessage("{\"command\": \"clearCharacters\"}");
+    QTRY_COMPARE(texts.count(), 2);
+    QVERIFY(m_tracker->isEmpty());
+}
+
+void TestTrackerService::testSubscription()
+{
+    QWebSocket *subscriber = connectClient();
+    QVERIFY(subscriber);
+
+    QSignalSpy messages(subscriber, &QWebSocket::textMessageReceived);
+    subscriber->sendTextMessage("{\"command\": \"subscribe\"}");
+    QTRY_COMPARE(messages.count(), 2);
+    QTRY_VERIFY(m_service->broadcaster()->isActive());
+
+    QJsonObject state = QJsonDocument::fromJson(messages.at(1).first().toString().toUtf8()).object();
+    QCOMPARE(state["type"].toString(), QString("state"));
+    QCOMPARE(state["count"].toInt(), 2);
+
+    // Eine Änderung im Tracker-Thread wird im Netzwerk-Thread gesendet
+    m_tracker->setWillSave(0, 5);
+    QTRY_COMPARE(messages.count(), 3);
+    QJsonObject delta = QJsonDocument::fromJson(messages.at(2).first().toString().toUtf8()).object();
+    QCOMPARE(delta["type"].toString(), QString("delta"));
+    QCOMPARE(delta["characters"].toArray().size(), 1);
+
+    subscriber->close();
+    QTRY_VERIFY(!m_service->broadcaster()->isActive());
+}
+
+void TestTrackerService::testMessageLogging()
+{
+    QWebSocket *client = connectClient();
+    QVERIFY(client);
+    QSignalSpy binaries(client, &QWebSocket::binaryMessageReceived);
+
+    // Ohne Empfänger wird die Nachricht nur ausgeführt
+    client->sendBinaryMessage(MessageCodec::encode(QJsonObject{ { "command", "rollInitiative" } }, MessageCodec::Cbor));
+    QVERIFY(binaries.wait());
+
+    // Mit Empfänger kommt sie als JSON-Text an, auch wenn erst nach start() verbunden
+    QSignalSpy logged(m_service, &TrackerService::messageLogged);
+    client->sendBinaryMessage(MessageCodec::encode(QJsonObject{ { "command", "rollWillSave" } }, MessageCodec::Cbor));
+    QTRY_COMPARE(logged.count(), 1);
+    const QJsonObject message = QJsonDocument::fromJson(logged.first().first().toString().toUtf8()).object();
+    QCOMPARE(message["command"].toString(), QString("rollWillSave"));
+}
+
+QTEST_MAIN(TestTrackerService)
+#include "tst_trackerservice.moc"
@@ -0,0 +1,94 @@
+#include <QtTest>
+#include <QTemporaryDir>
+#include "../src/initiativetracker.h"
+#include "../src/trackerstorage.h"
+
+/**
+ * @brief Die TestTrackerStorage-Klasse enthält Unit-Tests für das Laden und Speichern beim Start und Beenden.
+ */
+class TestTrackerStorage : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    /**
+     * @brief Testet den ersten Start ohne gespeicherte Dateien.
+     */
+    void testLoadEmpty();
+
+    /**
+     * @brief Testet, ob ein gespeicherter Stand beim nächsten Start geladen wird.
+     */
+    void testSaveAndLoad();
+
+    /**
+     * @brief Testet, ob Änderungen ohne save() aus dem Journal wiederhergestellt werden.
+     */
+    void testRecoverWithoutSave();
+};
+
+void TestTrackerStorage::testLoadEmpty()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    InitiativeTracker tracker;
+    TrackerStorage storage(&tracker, dir.path());
+    QVERIFY(!storage.load());
+    QVERIFY(tracker.isEmpty());
+    QVERIFY(storage.journal()->isActive());
+    QCOMPARE(storage.autoSaver()->filename(), dir.filePath("characters.json"));
+
+    QVERIFY(storage.save());
+    QVERIFY(QFile::exists(dir.filePath("characters.json")));
+    QVERIFY(QFile::exists(dir.filePath("characters.dndsnap")));
+}
+
+void TestTrackerStorage::testSaveAndLoad()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    {
+        InitiativeTracker tracker;
+        TrackerStorage storage(&tracker, dir.path());
+        storage.load();
+        tracker.addCharacter(Character("Aragorn", 3, 2, 1, 0));
+        tracker.addCharacter(Character("Gimli", 1));
+        tracker.rollAllInitiatives();
+        QVERIFY(storage.save());
+    }
+
+    InitiativeTracker loaded;
+    TrackerStorage storage(&loaded, dir.path());
+    QVERIFY(storage.load());
+    QCOMPARE(loaded.size(), 2);
+    QCOMPARE(loaded.getCharacter(0).getName(), QString("Aragorn"));
+    QCOMPARE(loaded.getCharacter(1).getName(), QString("Gimli"));
+    QVERIFY(loaded.verifyRolls());
+}
+
+void TestTrackerStorage::testRecoverWithoutSave()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    {
+        InitiativeTracker tracker;
+        TrackerStorage storage(&tracker, dir.path());
+        storage.load();
+        QVERIFY(storage.save());
+
+        // Ohne save() am Ende, wie bei einem Absturz
+        tracker.addCharacter(Character("Legolas", 4));
+    }
+
+    InitiativeTracker recovered;
+    TrackerStorage storage(&recovered, dir.path());
+    QVERIFY(storage.load());
+    QCOMPARE(recovered.size(), 1);
+    QCOMPARE(recovered.getCharacter(0).getName(), QString("Legolas"));
+}
+
+QTEST_MAIN(TestTrackerStorage)
+#include "tst_trackerstorage.moc"